@@ -121,6 +121,7 @@ check_function_exists("issetugid"        HAVE_ISSETUGID)
 check_function_exists("mkdtemp"          HAVE_MKDTEMP)
 check_function_exists("mkstemps"         HAVE_MKSTEMPS)
 check_function_exists("popcount"         HAVE_POPCOUNT)
+check_function_exists("posix_fadvise"    HAVE_POSIX_FADVISE)
 check_function_exists("setresgid"        HAVE_SETRESGID)
 check_function_exists("setresuid"        HAVE_SETRESUID)
 check_function_exists("strptime"         HAVE_STRPTIME)
@@ -1468,6 +1468,9 @@ main(int argc, char *argv[])
 
   wtap_init();
 
+  /* We read files straight through, so read them in large chunks. */
+  wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE);
+
 #ifdef HAVE_PLUGINS
   init_report_message(failure_warning_message, failure_warning_message,
                       NULL, NULL, NULL);
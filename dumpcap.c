@@ -330,6 +330,8 @@ typedef struct _loop_data {
     int       save_file_fd;
     guint64   bytes_written;
     guint32   autostop_files;
+    /* frame index of the current output file (pcapng only) */
+    frame_index_t frame_index;     /**< frame_index.entries is NULL if we're not indexing */
 } loop_data;
 
 typedef struct _pcap_queue_element {
@@ -396,6 +398,10 @@ static capture_options global_capture_opts;
 static gboolean quiet = FALSE;
 static gboolean use_threads = FALSE;
 static guint64 start_time;
+static guint32 frame_index_packets = 0;
+static guint32 frame_index_msecs = 0;
+
+#define LONGOPT_FRAME_INDEX (LONGOPT_NUM_CAP_COMMENT+1)
 
 static void capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
                                          const u_char *pd);
@@ -524,6 +530,9 @@ print_usage(FILE *output)
     fprintf(output, "  --capture-comment <comment>\n");
     fprintf(output, "                           add a capture comment to the output file\n");
     fprintf(output, "                           (only for pcapng)\n");
+    fprintf(output, "  --frame-index <packets>[,<ms>]\n");
+    fprintf(output, "                           add an index of every n packets and/or every\n");
+    fprintf(output, "                           n ms to the end of each output file (only for pcapng)\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -N <packet_limit>        maximum number of packets buffered within dumpcap\n");
@@ -2392,6 +2401,34 @@ capture_loop_init_filter(pcap_t *pcap_h, gboolean from_cap_pipe,
 }
 
 
+/* start a new, empty, frame index for a new output file */
+static void
+capture_loop_frame_index_start(capture_options *capture_opts, loop_data *ld)
+{
+    if (!capture_opts->use_pcapng ||
+        (frame_index_packets == 0 && frame_index_msecs == 0)) {
+        return;
+    }
+    if (ld->frame_index.entries == NULL) {
+        frame_index_init(&ld->frame_index, frame_index_packets, frame_index_msecs);
+    } else {
+        frame_index_reset(&ld->frame_index);
+    }
+}
+
+/* write the frame index, if any, at the end of the current output file */
+static gboolean
+capture_loop_frame_index_write(loop_data *ld, int *err)
+{
+    if (ld->frame_index.entries == NULL || ld->frame_index.entries->len == 0) {
+        return TRUE;
+    }
+    return pcapng_write_frame_index_block(ld->pdh,
+                                          (const frame_index_entry_t *)(void *)ld->frame_index.entries->data,
+                                          ld->frame_index.entries->len,
+                                          &ld->bytes_written, err);
+}
+
 /* set up to write to the already-opened capture output file/files */
 static gboolean
 capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *errmsg, int errmsg_len)
@@ -2466,6 +2503,7 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
 
             g_string_free(os_info_str, TRUE);
 
+            capture_loop_frame_index_start(capture_opts, ld);
         } else {
             pcap_src = g_array_index(ld->pcaps, capture_src *, 0);
             if (pcap_src->from_cap_pipe) {
@@ -2515,11 +2553,21 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
     unsigned int i;
     capture_src *pcap_src;
     guint64      end_time = create_timestamp();
+    gboolean     index_ok = TRUE;
+    int          index_err = 0;
 
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_close_output");
 
     if (capture_opts->multi_files_on) {
-        return ringbuf_libpcap_dump_close(&capture_opts->save_file, err_close);
+        index_ok = capture_loop_frame_index_write(ld, &index_err);
+        frame_index_cleanup(&ld->frame_index);
+        if (!ringbuf_libpcap_dump_close(&capture_opts->save_file, err_close)) {
+            return FALSE;
+        }
+        if (!index_ok && err_close != NULL) {
+            *err_close = index_err;
+        }
+        return index_ok;
     } else {
         if (capture_opts->use_pcapng) {
             for (i = 0; i < global_ld.pcaps->len; i++) {
@@ -2546,12 +2594,20 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
                                                             err_close);
                 }
             }
+            /* The frame index must be the last block in the file. */
+            index_ok = capture_loop_frame_index_write(ld, &index_err);
+            frame_index_cleanup(&ld->frame_index);
         }
         if (fclose(ld->pdh) == EOF) {
             if (err_close != NULL) {
                 *err_close = errno;
             }
             return (FALSE);
+        } else if (!index_ok) {
+            if (err_close != NULL) {
+                *err_close = index_err;
+            }
+            return (FALSE);
         } else {
             return (TRUE);
         }
@@ -2919,6 +2975,12 @@ do_file_switch_or_stop(capture_options *capture_opts,
             return FALSE;
         }
 
+        /* Finish the current file's frame index before we close it */
+        if (!capture_loop_frame_index_write(&global_ld, &global_ld.err)) {
+            global_ld.go = FALSE;
+            return FALSE;
+        }
+
         /* Switch to the next ringbuffer file */
         if (ringbuf_switch_file(&global_ld.pdh, &capture_opts->save_file,
                                 &global_ld.save_file_fd, &global_ld.err)) {
@@ -2965,6 +3027,7 @@ do_file_switch_or_stop(capture_options *capture_opts,
 
                 g_string_free(os_info_str, TRUE);
 
+                capture_loop_frame_index_start(capture_opts, &global_ld);
             } else {
                 pcap_src = g_array_index(global_ld.pcaps, capture_src *, 0);
                 successful = libpcap_write_file_header(global_ld.pdh, pcap_src->linktype, pcap_src->snaplen,
@@ -3062,6 +3125,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     global_ld.pdh                 = NULL;
     global_ld.autostop_files      = 0;
     global_ld.save_file_fd        = -1;
+    global_ld.frame_index.entries = NULL;
 
     /* We haven't yet gotten the capture statistics. */
     *stats_known      = FALSE;
@@ -3592,6 +3656,7 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
 
     if (global_ld.pdh) {
         gboolean successful;
+        guint64  offset = global_ld.bytes_written;
 
         /* We're supposed to write the packet to a file; do so.
            If this fails, set "ld->go" to FALSE, to stop the capture, and set
@@ -3622,6 +3687,11 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
                   "Wrote a packet of length %d captured on interface %u.",
                    phdr->caplen, pcap_src->interface_id);
 #endif
+            if (global_ld.frame_index.entries != NULL) {
+                frame_index_add(&global_ld.frame_index, offset, global_ld.bytes_written,
+                                (guint64)phdr->ts.tv_sec * 1000000000 +
+                                (guint64)phdr->ts.tv_usec * (pcap_src->ts_nsec ? 1 : 1000));
+            }
             global_ld.packet_count++;
             pcap_src->received++;
             /* if the user told us to stop after x packets, do we already have enough? */
@@ -3774,6 +3844,7 @@ main(int argc, char *argv[])
     static const struct option long_options[] = {
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'v'},
+        {"frame-index", required_argument, NULL, LONGOPT_FRAME_INDEX},
         LONGOPT_CAPTURE_COMMON
         {0, 0, 0, 0 }
     };
@@ -4248,6 +4319,21 @@ main(int argc, char *argv[])
         case 'N':
             pcap_queue_packet_limit = get_positive_int(optarg, "packet_limit");
             break;
+        case LONGOPT_FRAME_INDEX:
+        {
+            gchar **intervals = g_strsplit(optarg, ",", 2);
+
+            frame_index_packets = get_guint32(intervals[0], "frame index packet interval");
+            if (intervals[1] != NULL) {
+                frame_index_msecs = get_guint32(intervals[1], "frame index time interval");
+            }
+            g_strfreev(intervals);
+            if (frame_index_packets == 0 && frame_index_msecs == 0) {
+                cmdarg_err("--frame-index needs a packet or time interval");
+                arg_error = TRUE;
+            }
+            break;
+        }
         default:
             cmdarg_err("Invalid Option: %s", argv[optind-1]);
             /* FALLTHROUGH */
@@ -170,6 +170,7 @@ static int                    out_file_type_subtype     = WTAP_FILE_TYPE_SUBTYPE
 static int                    out_file_type_subtype     = WTAP_FILE_TYPE_SUBTYPE_PCAP; /* default to pcap     */
 #endif
 static int                    out_frame_type            = -2; /* Leave frame type alone */
+static wtap_compression_type  out_compression_type      = WTAP_UNCOMPRESSED;
 static int                    verbose                   = 0;  /* Not so verbose         */
 static struct time_adjustment time_adj                  = {{0, 0}, 0}; /* no adjustment */
 static nstime_t               relative_time_window      = {0, 0}; /* de-dup time window */
@@ -177,6 +178,11 @@ static double                 err_prob                  = 0.0;
 static time_t                 starttime                 = 0;
 static time_t                 stoptime                  = 0;
 static gboolean               check_startstop           = FALSE;
+static nstime_t               time_range_start;
+static nstime_t               time_range_stop;
+static gboolean               check_time_range          = FALSE;
+static guint32                frame_index_packets       = 0;
+static guint32                frame_index_msecs         = 0;
 static gboolean               rem_vlan                  = FALSE;
 static gboolean               dup_detect                = FALSE;
 static gboolean               dup_detect_by_time        = FALSE;
@@ -751,6 +757,13 @@ print_usage(FILE *output)
     fprintf(output, "                         to) the given time (format as YYYY-MM-DD hh:mm:ss).\n");
     fprintf(output, "  -B <stop time>         only output packets whose timestamp is before the\n");
     fprintf(output, "                         given time (format as YYYY-MM-DD hh:mm:ss).\n");
+    fprintf(output, "  --time-range <start>,<stop>\n");
+    fprintf(output, "                         only read packets whose timestamp is after (or equal\n");
+    fprintf(output, "                         to) <start> and before <stop>, skipping directly to\n");
+    fprintf(output, "                         <start> rather than reading the whole file; times are\n");
+    fprintf(output, "                         YYYY-MM-DD hh:mm:ss[.frac] or seconds since the Epoch,\n");
+    fprintf(output, "                         and either may be omitted. Packet numbers given on\n");
+    fprintf(output, "                         the command line count from <start>.\n");
     fprintf(output, "\n");
     fprintf(output, "Duplicate packet removal:\n");
     fprintf(output, "  --novlan               remove vlan info from packets before checking for duplicates.\n");
@@ -820,6 +833,11 @@ print_usage(FILE *output)
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
     fprintf(output, "                         same as the input file. An empty \"-T\" option will\n");
     fprintf(output, "                         list the encapsulation types.\n");
+    fprintf(output, "  --frame-index <packets>[,<ms>]\n");
+    fprintf(output, "                         add an index of every n packets and/or every n ms\n");
+    fprintf(output, "                         to the end of each pcapng output file.\n");
+    fprintf(output, "  --compress <type>      compress the output file(s) with <type>. An empty\n");
+    fprintf(output, "                         \"--compress\" option will list the compression types.\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h                     display this help and exit.\n");
@@ -897,6 +915,21 @@ list_encap_types(void) {
     g_free(encaps);
 }
 
+static void
+list_compression_types(void) {
+    GSList *list, *elem;
+
+    fprintf(stderr, "editcap: The available compression types for the \"--compress\" flag are:\n");
+    list = wtap_get_all_compression_type_names_list();
+    for (elem = list; elem != NULL; elem = g_slist_next(elem)) {
+        const char *name = (const char *)elem->data;
+
+        fprintf(stderr, "    %s - %s\n", name,
+                wtap_compression_type_description(wtap_name_to_compression_type(name)));
+    }
+    g_slist_free(list);
+}
+
 static int
 framenum_compare(gconstpointer a, gconstpointer b, gpointer user_data _U_)
 {
@@ -931,6 +964,33 @@ failure_message_cont(const char *msg_format, va_list ap)
     fprintf(stderr, "\n");
 }
 
+/*
+ * Read the next record; if a time range was specified, the first call
+ * skips directly to the start of the range, and reading stops at the
+ * first record at or after its end.
+ */
+static gboolean
+read_next_record(wtap *wth, gboolean first, int *err, gchar **err_info,
+                 gint64 *data_offset)
+{
+    struct wtap_pkthdr *phdr;
+
+    if (first && check_time_range && !nstime_is_unset(&time_range_start)) {
+        if (!wtap_seek_time(wth, &time_range_start, err, err_info, data_offset))
+            return FALSE;
+    } else {
+        if (!wtap_read(wth, err, err_info, data_offset))
+            return FALSE;
+    }
+
+    phdr = wtap_phdr(wth);
+    if (check_time_range && !nstime_is_unset(&time_range_stop) &&
+        (phdr->presence_flags & WTAP_HAS_TS) &&
+        nstime_cmp(&phdr->ts, &time_range_stop) >= 0)
+        return FALSE;
+    return TRUE;
+}
+
 static wtap_dumper *
 editcap_dump_open(const char *filename, guint32 snaplen,
                   GArray* shb_hdrs,
@@ -942,13 +1002,19 @@ editcap_dump_open(const char *filename, guint32 snaplen,
   if (strcmp(filename, "-") == 0) {
     /* Write to the standard output. */
     pdh = wtap_dump_open_stdout_ng(out_file_type_subtype, out_frame_type,
-                                   snaplen, FALSE /* compressed */,
+                                   snaplen, out_compression_type,
                                    shb_hdrs, idb_inf, nrb_hdrs, write_err);
   } else {
     pdh = wtap_dump_open_ng(filename, out_file_type_subtype, out_frame_type,
-                            snaplen, FALSE /* compressed */,
+                            snaplen, out_compression_type,
                             shb_hdrs, idb_inf, nrb_hdrs, write_err);
   }
+  if (pdh != NULL) {
+    if ((frame_index_packets != 0 || frame_index_msecs != 0) &&
+        !wtap_dump_set_frame_index(pdh, frame_index_packets, frame_index_msecs))
+      fprintf(stderr, "editcap: A frame index can only be written to pcapng files\n");
+    wtap_dump_set_async(pdh);
+  }
   return pdh;
 }
 
@@ -964,6 +1030,9 @@ main(int argc, char *argv[])
     int           opt;
     static const struct option long_options[] = {
         {"novlan", no_argument, NULL, 0x8100},
+        {"compress", required_argument, NULL, 0x8101},
+        {"time-range", required_argument, NULL, 0x8102},
+        {"frame-index", required_argument, NULL, 0x8103},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'V'},
         {0, 0, 0, 0 }
@@ -1041,6 +1110,9 @@ main(int argc, char *argv[])
 
     wtap_init();
 
+    /* We read files straight through, so read them in large chunks. */
+    wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE);
+
 #ifdef HAVE_PLUGINS
     /* Register wiretap plugins */
     init_report_message(failure_warning_message, failure_warning_message,
@@ -1067,6 +1139,53 @@ main(int argc, char *argv[])
             break;
         }
 
+        case 0x8101:
+        {
+            out_compression_type = wtap_name_to_compression_type(optarg);
+            if (out_compression_type == WTAP_UNKNOWN_COMPRESSION) {
+                fprintf(stderr, "editcap: \"%s\" isn't a valid compression type\n\n",
+                        optarg);
+                list_compression_types();
+                ret = INVALID_OPTION;
+                goto clean_exit;
+            }
+            if (!wtap_can_write_compression_type(out_compression_type)) {
+                fprintf(stderr, "editcap: Writing %s compressed files isn't supported by this build\n",
+                        wtap_compression_type_name(out_compression_type));
+                ret = INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+        }
+
+        case 0x8102:
+        {
+            if (!nstime_range_from_str(&time_range_start, &time_range_stop, optarg)) {
+                fprintf(stderr, "editcap: \"%s\" isn't a valid time range\n\n",
+                        optarg);
+                ret = INVALID_OPTION;
+                goto clean_exit;
+            }
+            check_time_range = TRUE;
+            break;
+        }
+
+        case 0x8103:
+        {
+            gchar **intervals = g_strsplit(optarg, ",", 2);
+
+            frame_index_packets = get_guint32(intervals[0], "frame index packet interval");
+            if (intervals[1] != NULL)
+                frame_index_msecs = get_guint32(intervals[1], "frame index time interval");
+            g_strfreev(intervals);
+            if (frame_index_packets == 0 && frame_index_msecs == 0) {
+                fprintf(stderr, "editcap: --frame-index needs a packet or time interval\n");
+                ret = INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+        }
+
         case 'a':
         {
             guint frame_number;
@@ -1298,6 +1417,9 @@ main(int argc, char *argv[])
             case'T':
                 list_encap_types();
                 break;
+            case 0x8101:
+                list_compression_types();
+                break;
             default:
                 print_usage(stderr);
                 break;
@@ -1392,7 +1514,7 @@ main(int argc, char *argv[])
         }
 
         /* Read all of the packets in turn */
-        while (wtap_read(wth, &read_err, &read_err_info, &data_offset)) {
+        while (read_next_record(wth, read_count == 0, &read_err, &read_err_info, &data_offset)) {
             if (max_packet_number <= read_count)
                 break;
 
@@ -59,6 +59,28 @@ static wmem_map_t *conversation_hashtable_no_addr2_or_port2 = NULL;
 
 static guint32 new_index;
 
+/*
+ * Bumped whenever a conversation is added to, or moved between, the hash
+ * tables, so that find_conversation_pinfo() knows when its cached result
+ * may be out of date.
+ */
+static guint32 conversation_generation;
+
+/*
+ * The result of the last find_conversation_pinfo() call for a packet,
+ * and the values it was looked up with.
+ */
+struct conversation_pinfo_cache {
+	guint32		 generation;
+	guint		 options;
+	address		 src;
+	address		 dst;
+	port_type	 ptype;
+	guint32		 srcport;
+	guint32		 destport;
+	conversation_t	*conversation;
+};
+
 /*
  * Creates a new conversation with known endpoints based on a conversation
  * created with the CONVERSATION_TEMPLATE option while keeping the
@@ -156,32 +178,40 @@ conversation_create_from_template(conversation_t *conversation, const address *a
 }
 
 /*
- * Compute the hash value for two given address/port pairs if the match
- * is to be exact.
+ * The hash values of the addresses in a key are computed once, by
+ * conversation_key_set_hashes(), and kept in the key; each table's hash
+ * function only combines them with the ports.  That way, looking a packet
+ * up in all four tables, in both directions, hashes its addresses only
+ * once.
  */
 /* http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx#existing
  * One-at-a-Time hash
  */
-static guint
-conversation_hash_exact(gconstpointer v)
+static void
+conversation_key_set_hashes(conversation_key *key)
+{
+	key->addr1_hash = add_address_to_hash(0, &key->addr1);
+	key->addr2_hash = add_address_to_hash(0, &key->addr2);
+}
+
+static inline guint
+conversation_hash_endpoint(guint hash_val, const guint32 port)
 {
-	const conversation_key *key = (const conversation_key *)v;
-	guint hash_val;
 	address tmp_addr;
 
-	hash_val = 0;
 	tmp_addr.len  = 4;
-
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
+	tmp_addr.data = &port;
 	hash_val = add_address_to_hash(hash_val, &tmp_addr);
 
-	hash_val = add_address_to_hash(hash_val, &key->addr2);
-
-	tmp_addr.data = &key->port2;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
+	/* Spread the address bits over the whole value before combining. */
+	hash_val += ( hash_val << 3 );
+	hash_val ^= ( hash_val >> 11 );
+	return hash_val;
+}
 
+static inline guint
+conversation_hash_finish(guint hash_val)
+{
 	hash_val += ( hash_val << 3 );
 	hash_val ^= ( hash_val >> 11 );
 	hash_val += ( hash_val << 15 );
@@ -189,6 +219,26 @@ conversation_hash_exact(gconstpointer v)
 	return hash_val;
 }
 
+/*
+ * Compute the hash value for two given address/port pairs if the match
+ * is to be exact.
+ */
+static guint
+conversation_hash_exact(gconstpointer v)
+{
+	const conversation_key *key = (const conversation_key *)v;
+
+	/*
+	 * The two endpoints are combined in a way that doesn't depend on
+	 * their order, so that one lookup finds the conversation whichever
+	 * direction the packet is going in; conversation_match_exact()
+	 * matches either direction too.
+	 */
+	return conversation_hash_finish(
+	    conversation_hash_endpoint(key->addr1_hash, key->port1) +
+	    conversation_hash_endpoint(key->addr2_hash, key->port2));
+}
+
 /*
  * Compare two conversation keys for an exact match.
  */
@@ -249,25 +299,10 @@ static guint
 conversation_hash_no_addr2(gconstpointer v)
 {
 	const conversation_key *key = (const conversation_key *)v;
-	guint hash_val;
-	address tmp_addr;
-
-	hash_val = 0;
-	tmp_addr.len  = 4;
-
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	tmp_addr.data = &key->port2;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
 
-	return hash_val;
+	return conversation_hash_finish(
+	    conversation_hash_endpoint(key->addr1_hash, key->port1) +
+	    conversation_hash_endpoint(0, key->port2));
 }
 
 /*
@@ -314,24 +349,10 @@ static guint
 conversation_hash_no_port2(gconstpointer v)
 {
 	const conversation_key *key = (const conversation_key *)v;
-	guint hash_val;
-	address tmp_addr;
-
-	hash_val = 0;
-	tmp_addr.len  = 4;
-
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
 
-	hash_val = add_address_to_hash(hash_val, &key->addr2);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
-
-	return hash_val;
+	return conversation_hash_finish(
+	    conversation_hash_endpoint(key->addr1_hash, key->port1) +
+	    conversation_hash_endpoint(key->addr2_hash, 0));
 }
 
 /*
@@ -378,22 +399,9 @@ static guint
 conversation_hash_no_addr2_or_port2(gconstpointer v)
 {
 	const conversation_key *key = (const conversation_key *)v;
-	guint hash_val;
-	address tmp_addr;
 
-	hash_val = 0;
-	tmp_addr.len  = 4;
-
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
-
-	return hash_val;
+	return conversation_hash_finish(
+	    conversation_hash_endpoint(key->addr1_hash, key->port1));
 }
 
 /*
@@ -445,16 +453,20 @@ conversation_init(void)
 	 * above.
 	 */
 	conversation_hashtable_exact =
-	    wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), conversation_hash_exact,
+	    wmem_map_new_open_autoreset(wmem_epan_scope(), wmem_file_scope(),
+	      WMEM_MAP_KEY_GENERIC, conversation_hash_exact,
 	      conversation_match_exact);
 	conversation_hashtable_no_addr2 =
-	    wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), conversation_hash_no_addr2,
+	    wmem_map_new_open_autoreset(wmem_epan_scope(), wmem_file_scope(),
+	      WMEM_MAP_KEY_GENERIC, conversation_hash_no_addr2,
 	      conversation_match_no_addr2);
 	conversation_hashtable_no_port2 =
-	    wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), conversation_hash_no_port2,
+	    wmem_map_new_open_autoreset(wmem_epan_scope(), wmem_file_scope(),
+	      WMEM_MAP_KEY_GENERIC, conversation_hash_no_port2,
 	      conversation_match_no_port2);
 	conversation_hashtable_no_addr2_or_port2 =
-	    wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), conversation_hash_no_addr2_or_port2,
+	    wmem_map_new_open_autoreset(wmem_epan_scope(), wmem_file_scope(),
+	      WMEM_MAP_KEY_GENERIC, conversation_hash_no_addr2_or_port2,
 	      conversation_match_no_addr2_or_port2);
 
 }
@@ -470,6 +482,46 @@ void conversation_epan_reset(void)
 	new_index = 0;
 }
 
+/*
+ * The head of a hash chain with more than one conversation also keeps
+ * the chain in an array, in setup_frame order, so that
+ * conversation_lookup_hashtable() can binary search it when it's asked
+ * for a frame before the last conversation was set up.
+ */
+static void
+conversation_chain_index(conversation_t *chain_head)
+{
+	conversation_t *cur;
+	guint len;
+
+	for (len = 0, cur = chain_head; cur; cur = cur->next)
+		len++;
+
+	if (len > chain_head->generations_alloc) {
+		chain_head->generations_alloc = len * 2;
+		chain_head->generations = (conversation_t **)wmem_realloc(wmem_file_scope(),
+		    chain_head->generations, chain_head->generations_alloc * sizeof (conversation_t *));
+	}
+	for (len = 0, cur = chain_head; cur; cur = cur->next)
+		chain_head->generations[len++] = cur;
+	chain_head->generations_len = len;
+}
+
+/*
+ * Move the array from the old head of a chain to the new one.
+ */
+static void
+conversation_chain_move_index(conversation_t *from, conversation_t *to)
+{
+	wmem_free(wmem_file_scope(), to->generations);
+	to->generations = from->generations;
+	to->generations_len = from->generations_len;
+	to->generations_alloc = from->generations_alloc;
+	from->generations = NULL;
+	from->generations_len = 0;
+	from->generations_alloc = 0;
+}
+
 /*
  * Does the right thing when inserting into one of the conversation hash tables,
  * taking into account ordering and hash chains and all that good stuff.
@@ -481,6 +533,8 @@ conversation_insert_into_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 {
 	conversation_t *chain_head, *chain_tail, *cur, *prev;
 
+	conversation_generation++;
+
 	chain_head = (conversation_t *)wmem_map_lookup(hashtable, conv->key_ptr);
 
 	if (NULL==chain_head) {
@@ -502,6 +556,12 @@ conversation_insert_into_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 			conv->last = NULL;
 			chain_tail->next = conv;
 			chain_head->last = conv;
+
+			if (chain_head->generations != NULL &&
+			    chain_head->generations_len < chain_head->generations_alloc)
+				chain_head->generations[chain_head->generations_len++] = conv;
+			else
+				conversation_chain_index(chain_head);
 		}
 		else {
 			/* Loop through the chain to find the right spot */
@@ -517,12 +577,15 @@ conversation_insert_into_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 				conv->last = chain_tail;
 				chain_head->last = NULL;
 				wmem_map_insert(hashtable, conv->key_ptr, conv);
+				conversation_chain_move_index(chain_head, conv);
+				conversation_chain_index(conv);
 			}
 			else {
 				/* Inserting into the middle of the chain */
 				conv->next = cur;
 				conv->last = NULL;
 				prev->next = conv;
+				conversation_chain_index(chain_head);
 			}
 		}
 	}
@@ -559,6 +622,8 @@ conversation_remove_from_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 				chain_head->latest_found = conv->latest_found;
 
 			wmem_map_insert(hashtable, chain_head->key_ptr, chain_head);
+			conversation_chain_move_index(conv, chain_head);
+			conversation_chain_index(chain_head);
 		}
 	}
 	else {
@@ -585,6 +650,8 @@ conversation_remove_from_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 
 		if (chain_head->latest_found == conv)
 			chain_head->latest_found = prev;
+
+		conversation_chain_index(chain_head);
 	}
 }
 
@@ -632,6 +699,7 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	new_key->ptype = ptype;
 	new_key->port1 = port1;
 	new_key->port2 = port2;
+	conversation_key_set_hashes(new_key);
 
 	conversation = wmem_new(wmem_file_scope(), conversation_t);
 	memset(conversation, 0, sizeof(conversation_t));
@@ -718,6 +786,7 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
 	}
 	conv->options &= ~NO_ADDR2;
 	copy_address_wmem(wmem_file_scope(), &conv->key_ptr->addr2, addr);
+	conversation_key_set_hashes(conv->key_ptr);
 	if (conv->options & NO_PORT2) {
 		conversation_insert_into_hashtable(conversation_hashtable_no_port2, conv);
 	} else {
@@ -726,30 +795,40 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
 	DENDENT();
 }
 
+/*
+ * Fill in a key to look up {addr1, port1, addr2, port2} with.
+ *
+ * We don't make a copy of the address data, we just copy the
+ * pointer to it, as the key only lives as long as the lookup.
+ */
+static void
+conversation_key_fill(conversation_key *key, const address *addr1, const guint addr1_hash,
+    const address *addr2, const guint addr2_hash, const port_type ptype,
+    const guint32 port1, const guint32 port2)
+{
+	key->next = NULL;
+	key->addr1 = *addr1;
+	key->addr2 = *addr2;
+	key->ptype = ptype;
+	key->port1 = port1;
+	key->port2 = port2;
+	key->addr1_hash = addr1_hash;
+	key->addr2_hash = addr2_hash;
+}
+
 /*
  * Search a particular hash table for a conversation with the specified
- * {addr1, port1, addr2, port2} and set up before frame_num.
+ * key and set up before frame_num.
  */
 static conversation_t *
-conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, const address *addr1, const address *addr2,
-    const port_type ptype, const guint32 port1, const guint32 port2)
+conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, const conversation_key *key)
 {
 	conversation_t* convo=NULL;
 	conversation_t* match=NULL;
 	conversation_t* chain_head=NULL;
-	conversation_key key;
-
-	/*
-	 * We don't make a copy of the address data, we just copy the
-	 * pointer to it, as "key" disappears when we return.
-	 */
-	key.addr1 = *addr1;
-	key.addr2 = *addr2;
-	key.ptype = ptype;
-	key.port1 = port1;
-	key.port2 = port2;
+	guint lo, hi, mid;
 
-	chain_head = (conversation_t *)wmem_map_lookup(hashtable, &key);
+	chain_head = (conversation_t *)wmem_map_lookup(hashtable, key);
 
 	if (chain_head && (chain_head->setup_frame <= frame_num)) {
 		match = chain_head;
@@ -757,12 +836,29 @@ conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, co
 		if((chain_head->last)&&(chain_head->last->setup_frame<=frame_num))
 			return chain_head->last;
 
-		if((chain_head->latest_found)&&(chain_head->latest_found->setup_frame<=frame_num))
-			match = chain_head->latest_found;
+		if (chain_head->generations != NULL) {
+			/*
+			 * Find the last conversation set up at or before
+			 * frame_num; generations[0], the chain head, was.
+			 */
+			lo = 0;
+			hi = chain_head->generations_len;
+			while (hi - lo > 1) {
+				mid = lo + (hi - lo) / 2;
+				if (chain_head->generations[mid]->setup_frame <= frame_num)
+					lo = mid;
+				else
+					hi = mid;
+			}
+			match = chain_head->generations[lo];
+		} else {
+			if((chain_head->latest_found)&&(chain_head->latest_found->setup_frame<=frame_num))
+				match = chain_head->latest_found;
 
-		for (convo = match; convo && convo->setup_frame <= frame_num; convo = convo->next) {
-			if (convo->setup_frame > match->setup_frame) {
-				match = convo;
+			for (convo = match; convo && convo->setup_frame <= frame_num; convo = convo->next) {
+				if (convo->setup_frame > match->setup_frame) {
+					match = convo;
+				}
 			}
 		}
 	}
@@ -815,6 +911,19 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
     const guint32 port_a, const guint32 port_b, const guint options)
 {
 	conversation_t *conversation;
+	conversation_key key_ab, key_ba, key_fc;
+	guint addr_a_hash, addr_b_hash;
+
+	/*
+	 * Hash the addresses once for all the lookups below: A to B,
+	 * B to A and, for Fibre Channel, whose OXID & RXID aren't
+	 * swapped, B to A with A's and B's ports.
+	 */
+	addr_a_hash = add_address_to_hash(0, addr_a);
+	addr_b_hash = add_address_to_hash(0, addr_b);
+	conversation_key_fill(&key_ab, addr_a, addr_a_hash, addr_b, addr_b_hash, ptype, port_a, port_b);
+	conversation_key_fill(&key_ba, addr_b, addr_b_hash, addr_a, addr_a_hash, ptype, port_b, port_a);
+	conversation_key_fill(&key_fc, addr_b, addr_b_hash, addr_a, addr_a_hash, ptype, port_a, port_b);
 
 	/*
 	 * First try an exact match, if we have two addresses and ports.
@@ -825,26 +934,20 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		 * start out with an exact match.
 		 */
 		DPRINT(("trying exact match"));
+		/*
+		 * (The exact match table finds the conversation in either
+		 * direction.)
+		 */
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_exact,
-			frame_num, addr_a, addr_b, ptype,
-			port_a, port_b);
-		/* Didn't work, try the other direction */
-		if (conversation == NULL) {
-			DPRINT(("trying opposite direction"));
-			conversation =
-				conversation_lookup_hashtable(conversation_hashtable_exact,
-				frame_num, addr_b, addr_a, ptype,
-				port_b, port_a);
-		}
+			frame_num, &key_ab);
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
 			 * TCP/UDP ports are in TCP/IP.
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_exact,
-				frame_num, addr_b, addr_a, ptype,
-				port_a, port_b);
+				frame_num, &key_fc);
 		}
 		DPRINT(("exact match %sfound",conversation?"":"not "));
 		if (conversation != NULL)
@@ -868,15 +971,14 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		DPRINT(("trying wildcarded dest address"));
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_no_addr2,
-			frame_num, addr_a, addr_b, ptype, port_a, port_b);
+			frame_num, &key_ab);
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
 			 * TCP/UDP ports are in TCP/IP.
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2,
-				frame_num, addr_b, addr_a, ptype,
-				port_a, port_b);
+				frame_num, &key_fc);
 		}
 		if (conversation != NULL) {
 			/*
@@ -920,7 +1022,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			DPRINT(("trying dest addr:port as source addr:port with wildcarded dest addr"));
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2,
-				frame_num, addr_b, addr_a, ptype, port_b, port_a);
+				frame_num, &key_ba);
 			if (conversation != NULL) {
 				/*
 				 * If this is for a connection-oriented
@@ -964,14 +1066,14 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		DPRINT(("trying wildcarded dest port"));
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_no_port2,
-			frame_num, addr_a, addr_b, ptype, port_a, port_b);
+			frame_num, &key_ab);
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
 			 * TCP/UDP ports are in TCP/IP
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_port2,
-				frame_num, addr_b, addr_a, ptype, port_a, port_b);
+				frame_num, &key_fc);
 		}
 		if (conversation != NULL) {
 			/*
@@ -1015,7 +1117,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			DPRINT(("trying dest addr:port as source addr:port and wildcarded dest port"));
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_port2,
-				frame_num, addr_b, addr_a, ptype, port_b, port_a);
+				frame_num, &key_ba);
 			if (conversation != NULL) {
 				/*
 				 * If this is for a connection-oriented
@@ -1054,7 +1156,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 	DPRINT(("trying wildcarding dest addr:port"));
 	conversation =
 		conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
-		frame_num, addr_a, addr_b, ptype, port_a, port_b);
+		frame_num, &key_ab);
 	if (conversation != NULL) {
 		/*
 		 * If this is for a connection-oriented protocol:
@@ -1108,11 +1210,11 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		if (addr_a->type == AT_FC)
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
-				frame_num, addr_b, addr_a, ptype, port_a, port_b);
+				frame_num, &key_fc);
 		else
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
-				frame_num, addr_b, addr_a, ptype, port_b, port_a);
+				frame_num, &key_ba);
 		if (conversation != NULL) {
 			/*
 			 * If this is for a connection-oriented protocol, set the
@@ -1147,6 +1249,51 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 	return NULL;
 }
 
+conversation_t *
+find_conversation_pinfo(packet_info *pinfo, const guint options)
+{
+	struct conversation_pinfo_cache *cache = pinfo->conv_cache;
+	conversation_t *conv;
+
+	/*
+	 * A dissector may change the addresses or ports in pinfo, e.g.
+	 * for a tunnelled packet, and a conversation may have been added
+	 * since the last lookup; only use the cached result if neither
+	 * happened.
+	 */
+	if (cache != NULL &&
+	    cache->generation == conversation_generation &&
+	    cache->options == options &&
+	    cache->ptype == pinfo->ptype &&
+	    cache->srcport == pinfo->srcport &&
+	    cache->destport == pinfo->destport &&
+	    addresses_equal(&cache->src, &pinfo->src) &&
+	    addresses_equal(&cache->dst, &pinfo->dst))
+		return cache->conversation;
+
+	conv = find_conversation(pinfo->num, &pinfo->src, &pinfo->dst,
+				 pinfo->ptype, pinfo->srcport, pinfo->destport, options);
+
+	if (cache == NULL) {
+		cache = wmem_new0(pinfo->pool, struct conversation_pinfo_cache);
+		pinfo->conv_cache = cache;
+	} else {
+		free_address_wmem(pinfo->pool, &cache->src);
+		free_address_wmem(pinfo->pool, &cache->dst);
+	}
+	/* find_conversation() may have moved the conversation between tables. */
+	cache->generation = conversation_generation;
+	cache->options = options;
+	cache->ptype = pinfo->ptype;
+	cache->srcport = pinfo->srcport;
+	cache->destport = pinfo->destport;
+	copy_address_wmem(pinfo->pool, &cache->src, &pinfo->src);
+	copy_address_wmem(pinfo->pool, &cache->dst, &pinfo->dst);
+	cache->conversation = conv;
+
+	return conv;
+}
+
 void
 conversation_add_proto_data(conversation_t *conv, const int proto, void *proto_data)
 {
@@ -1248,9 +1395,7 @@ find_or_create_conversation(packet_info *pinfo)
 	DINDENT();
 
 	/* Have we seen this conversation before? */
-	if((conv = find_conversation(pinfo->num, &pinfo->src, &pinfo->dst,
-				     pinfo->ptype, pinfo->srcport,
-				     pinfo->destport, 0)) != NULL) {
+	if((conv = find_conversation_pinfo(pinfo, 0)) != NULL) {
 		DPRINT(("found previous conversation for frame #%d (last_frame=%d)",
 				pinfo->num, conv->last_frame));
 		if (pinfo->num > conv->last_frame) {
@@ -67,6 +67,8 @@ typedef struct conversation_key {
 	port_type ptype;
 	guint32	port1;
 	guint32	port2;
+	guint	addr1_hash;	/** hash of addr1, for the conversation hash tables */
+	guint	addr2_hash;	/** hash of addr2, for the conversation hash tables */
 } conversation_key;
 
 typedef struct conversation {
@@ -83,6 +85,10 @@ typedef struct conversation {
 								/** tree containing protocol dissector client associated with conversation */
 	guint	options;			/** wildcard flags */
 	conversation_key *key_ptr;	/** pointer to the key for this conversation */
+	struct conversation **generations;
+								/** on a hash chain head, the chain in setup_frame order */
+	guint	generations_len;	/** number of conversations in generations */
+	guint	generations_alloc;	/** allocated size of generations */
 } conversation_t;
 
 /**
@@ -145,6 +151,13 @@ WS_DLL_PUBLIC conversation_t *conversation_new(const guint32 setup_frame, const
 WS_DLL_PUBLIC conversation_t *find_conversation(const guint32 frame_num, const address *addr_a, const address *addr_b,
     const port_type ptype, const guint32 port_a, const guint32 port_b, const guint options);
 
+/**
+ * Like find_conversation() for the frame, addresses, port type and ports
+ * in pinfo, but the result is kept in pinfo, so that the dissectors of
+ * the layers above don't have to look the conversation up again.
+ */
+WS_DLL_PUBLIC conversation_t *find_conversation_pinfo(packet_info *pinfo, const guint options);
+
 /**  A helper function that calls find_conversation() and, if a conversation is
  *  not found, calls conversation_new().
  *  The frame number and addresses are taken from pinfo.
@@ -0,0 +1,307 @@
+/* dissector_table_test.c
+ * Integer dissector table tests
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "epan.h"
+#include "packet.h"
+#include "proto.h"
+
+/* Patterns above 0xFFFF are looked up too, to cover the values that
+ * the index of a FT_UINT8 or FT_UINT16 table doesn't hold. */
+#define PATTERN_LIMIT   0x11000
+#define TEST_ROUNDS     2000
+
+static int proto_dtest = -1;
+static int proto_dtest_other = -1;
+
+static dissector_handle_t dtest_handles[3];
+
+static const char *dtest_tables[] = {
+    "dtest.uint8",
+    "dtest.uint16",
+    "dtest.uint32"
+};
+
+/* What the table should hold: the initial and the current handle for
+ * each pattern, mirroring dissector_add_uint() and friends. */
+typedef struct {
+    gboolean present;
+    dissector_handle_t initial;
+    dissector_handle_t current;
+} expected_entry_t;
+
+static expected_entry_t expected[PATTERN_LIMIT];
+
+static int
+dissect_dtest(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *tree _U_, void *data _U_)
+{
+    return tvb_captured_length(tvb);
+}
+
+static void
+register_dtest(register_cb cb _U_, gpointer client_data _U_)
+{
+    proto_dtest = proto_register_protocol("Dissector table test", "DTEST", "dtest");
+    proto_dtest_other = proto_register_protocol("Dissector table test (other)", "DTEST2", "dtest2");
+
+    register_dissector_table("dtest.uint8", "8-bit test table", proto_dtest, FT_UINT8, BASE_DEC);
+    register_dissector_table("dtest.uint16", "16-bit test table", proto_dtest, FT_UINT16, BASE_DEC);
+    register_dissector_table("dtest.uint32", "32-bit test table", proto_dtest, FT_UINT32, BASE_DEC);
+
+    /* epan_init() insists on these being there. */
+    register_dissector("frame", dissect_dtest, proto_dtest);
+    register_dissector("file", dissect_dtest, proto_dtest);
+    register_dissector("data", dissect_dtest, proto_dtest);
+
+    dtest_handles[0] = create_dissector_handle(dissect_dtest, proto_dtest);
+    dtest_handles[1] = create_dissector_handle(dissect_dtest, proto_dtest);
+    dtest_handles[2] = create_dissector_handle(dissect_dtest, proto_dtest_other);
+}
+
+static void
+register_dtest_handoff(register_cb cb _U_, gpointer client_data _U_)
+{
+}
+
+static void
+expected_clear(void)
+{
+    memset(expected, 0, sizeof expected);
+}
+
+static void
+expected_change(guint32 pattern, dissector_handle_t handle)
+{
+    if (expected[pattern].present) {
+        expected[pattern].current = handle;
+    } else if (handle != NULL) {
+        expected[pattern].present = TRUE;
+        expected[pattern].initial = NULL;
+        expected[pattern].current = handle;
+    }
+}
+
+static void
+expected_reset(guint32 pattern)
+{
+    if (!expected[pattern].present)
+        return;
+    if (expected[pattern].initial != NULL)
+        expected[pattern].current = expected[pattern].initial;
+    else
+        expected[pattern].present = FALSE;
+}
+
+static void
+check_table(const char *name)
+{
+    dissector_table_t table = find_dissector_table(name);
+    guint32 pattern;
+
+    g_assert(table);
+    for (pattern = 0; pattern < PATTERN_LIMIT; pattern++) {
+        dissector_handle_t handle = expected[pattern].present ? expected[pattern].current : NULL;
+
+        g_assert(dissector_get_uint_handle(table, pattern) == handle);
+    }
+}
+
+static guint32
+random_pattern(GRand *r, const char *name)
+{
+    /* Mostly in the range of the table type, now and then outside it. */
+    if (g_rand_int_range(r, 0, 16) == 0)
+        return g_rand_int_range(r, 0, PATTERN_LIMIT);
+    if (strcmp(name, "dtest.uint8") == 0)
+        return g_rand_int_range(r, 0, 0x100);
+    return g_rand_int_range(r, 0, 0x10000);
+}
+
+static void
+dtest_uint_table(gconstpointer data)
+{
+    const char *name = (const char *)data;
+    dissector_table_t table = find_dissector_table(name);
+    GRand *r;
+    int i, j;
+
+    g_assert(table);
+    r = g_rand_new_with_seed(0x1234);
+    expected_clear();
+
+    for (i = 0; i < TEST_ROUNDS; i++) {
+        guint32 pattern = random_pattern(r, name);
+        dissector_handle_t handle = dtest_handles[g_rand_int_range(r, 0, 3)];
+
+        switch (g_rand_int_range(r, 0, 5)) {
+
+        case 0:
+        case 1:
+            if (!expected[pattern].present) {
+                dissector_add_uint(name, pattern, handle);
+                expected[pattern].present = TRUE;
+                expected[pattern].initial = handle;
+                expected[pattern].current = handle;
+            }
+            break;
+
+        case 2:
+            /* Decode As, including "(none)". */
+            if (g_rand_int_range(r, 0, 4) == 0)
+                handle = NULL;
+            dissector_change_uint(name, pattern, handle);
+            expected_change(pattern, handle);
+            break;
+
+        case 3:
+            dissector_reset_uint(name, pattern);
+            expected_reset(pattern);
+            break;
+
+        case 4:
+            if (expected[pattern].present && expected[pattern].initial != NULL) {
+                dissector_delete_uint(name, pattern, expected[pattern].initial);
+                expected[pattern].present = FALSE;
+            }
+            break;
+        }
+
+        if (i % 500 == 0)
+            check_table(name);
+    }
+    check_table(name);
+
+    /* dissector_delete_all() expects every entry to have a handle. */
+    for (j = 0; j < PATTERN_LIMIT; j++) {
+        if (expected[j].present && expected[j].current == NULL) {
+            dissector_reset_uint(name, j);
+            expected_reset(j);
+        }
+    }
+    check_table(name);
+
+    /* Removes everything whose current handle belongs to the other protocol. */
+    dissector_delete_all(name, dtest_handles[2]);
+    for (j = 0; j < PATTERN_LIMIT; j++) {
+        if (expected[j].present && expected[j].current == dtest_handles[2])
+            expected[j].present = FALSE;
+    }
+    check_table(name);
+
+    /* Everything else, so that the next test starts out empty. */
+    dissector_delete_all(name, dtest_handles[0]);
+    expected_clear();
+    check_table(name);
+
+    g_rand_free(r);
+}
+
+static void
+dtest_uint_lookup_perf(void)
+{
+    static const guint16 ports[] = {
+        20, 21, 22, 23, 25, 53, 67, 68, 69, 80, 110, 123, 137, 138, 139,
+        143, 161, 162, 389, 443, 445, 514, 1812, 1813, 2049, 5060, 8080
+    };
+    dissector_table_t table;
+    GTimer *timer;
+    GRand *r;
+    guint32 *lookups;
+    guint i, j, hits;
+    guint n_lookups = 1024 * 1024;
+    gdouble elapsed;
+
+    r = g_rand_new_with_seed(0x1234);
+    lookups = g_new(guint32, n_lookups);
+    /* Half well-known ports, half ephemeral ports that aren't registered. */
+    for (i = 0; i < n_lookups; i++) {
+        if (i & 1)
+            lookups[i] = ports[g_rand_int_range(r, 0, G_N_ELEMENTS(ports))];
+        else
+            lookups[i] = g_rand_int_range(r, 1024, 0x10000);
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(ports); i++) {
+        dissector_add_uint("dtest.uint16", ports[i], dtest_handles[0]);
+        dissector_add_uint("dtest.uint32", ports[i], dtest_handles[0]);
+    }
+
+    timer = g_timer_new();
+    for (j = 1; j < G_N_ELEMENTS(dtest_tables); j++) {
+        table = find_dissector_table(dtest_tables[j]);
+        hits = 0;
+        g_timer_start(timer);
+        for (i = 0; i < n_lookups; i++) {
+            if (dissector_get_uint_handle(table, lookups[i]) != NULL)
+                hits++;
+        }
+        g_timer_stop(timer);
+        elapsed = g_timer_elapsed(timer, NULL);
+        g_test_minimized_result(elapsed, "%s: %u lookups (%u hits) in %.6f seconds",
+                dtest_tables[j], n_lookups, hits, elapsed);
+    }
+    g_timer_destroy(timer);
+
+    dissector_delete_all("dtest.uint16", dtest_handles[0]);
+    dissector_delete_all("dtest.uint32", dtest_handles[0]);
+    g_free(lookups);
+    g_rand_free(r);
+}
+
+int
+main(int argc, char **argv)
+{
+    int result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_data_func("/dissector_table/uint8", dtest_tables[0], dtest_uint_table);
+    g_test_add_data_func("/dissector_table/uint16", dtest_tables[1], dtest_uint_table);
+    g_test_add_data_func("/dissector_table/uint32", dtest_tables[2], dtest_uint_table);
+
+    if (g_test_perf())
+        g_test_add_func("/dissector_table/uint/lookup_perf", dtest_uint_lookup_perf);
+
+    epan_init(register_dtest, register_dtest_handoff, NULL, NULL);
+    result = g_test_run();
+    epan_cleanup();
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
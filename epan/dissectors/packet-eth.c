@@ -301,6 +301,7 @@ dissect_eth_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
   proto_tree        *addr_tree=NULL;
   ethertype_data_t  ethertype_data;
   heur_dtbl_entry_t *hdtbl_entry = NULL;
+  tvb_region_t      hdr;
 
   ehdr_num++;
   if(ehdr_num>=4){
@@ -324,7 +325,8 @@ dissect_eth_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
   src_addr = (const guint8*)pinfo->src.data;
   src_addr_name = get_ether_name(src_addr);
 
-  ehdr->type = tvb_get_ntohs(tvb, 12);
+  tvb_region_init(&hdr, tvb, 0, ETH_HEADER_SIZE);
+  ehdr->type = tvb_region_get_ntohs(&hdr, 12);
 
   tap_queue_packet(eth_tap, pinfo, ehdr);
 
@@ -342,12 +344,12 @@ dissect_eth_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
        destination address field; fortunately, they can be recognized by
        checking the first 5 octets of the destination address, which are
        01-00-0C-00-00 for ISL frames. */
-    if ((tvb_get_guint8(tvb, 0) == 0x01 ||
-      tvb_get_guint8(tvb, 0) == 0x0C) &&
-      tvb_get_guint8(tvb, 1) == 0x00 &&
-      tvb_get_guint8(tvb, 2) == 0x0C &&
-      tvb_get_guint8(tvb, 3) == 0x00 &&
-      tvb_get_guint8(tvb, 4) == 0x00) {
+    if ((tvb_region_get_guint8(&hdr, 0) == 0x01 ||
+      tvb_region_get_guint8(&hdr, 0) == 0x0C) &&
+      tvb_region_get_guint8(&hdr, 1) == 0x00 &&
+      tvb_region_get_guint8(&hdr, 2) == 0x0C &&
+      tvb_region_get_guint8(&hdr, 3) == 0x00 &&
+      tvb_region_get_guint8(&hdr, 4) == 0x00) {
       dissect_isl(tvb, pinfo, parent_tree, fcs_len);
       return fh_tree;
     }
@@ -510,7 +512,7 @@ dissect_eth_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 
     addr_item = proto_tree_add_ether(fh_tree, hf_eth_src, tvb, 6, 6, src_addr);
     addr_tree = proto_item_add_subtree(addr_item, ett_addr);
-    if (tvb_get_guint8(tvb, 6) & 0x01) {
+    if (tvb_region_get_guint8(&hdr, 6) & 0x01) {
       expert_add_info(pinfo, addr_item, &ei_eth_src_not_group);
     }
     addr_item=proto_tree_add_string(addr_tree, hf_eth_src_resolved, tvb, 6, 6,
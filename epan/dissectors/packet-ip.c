@@ -1884,6 +1884,7 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   proto_item *item = NULL, *ttl_item;
   guint16 ttl;
   int bit_offset;
+  tvb_region_t hdr;
 
   tree = parent_tree;
   iph = wmem_new0(wmem_packet_scope(), ws_ip);
@@ -1891,9 +1892,12 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   col_set_str(pinfo->cinfo, COL_PROTOCOL, "IPv4");
   col_clear(pinfo->cinfo, COL_INFO);
 
-  iph->ip_ver = tvb_get_bits8(tvb, 0, 4);
+  /* The fixed part of the header is read with a single bounds check */
+  tvb_region_init(&hdr, tvb, offset, IPH_MIN_LEN);
 
-  hlen = tvb_get_bits8(tvb, 4, 4) * 4;  /* IP header length, in bytes */
+  iph->ip_ver = tvb_region_get_guint8(&hdr, offset) >> 4;
+
+  hlen = (tvb_region_get_guint8(&hdr, offset) & 0x0f) * 4;  /* IP header length, in bytes */
 
   ti = proto_tree_add_item(tree, proto_ip, tvb, offset, hlen, ENC_NA);
   ip_tree = proto_item_add_subtree(ti, ett_ip);
@@ -1935,7 +1939,7 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   proto_tree_add_uint_bits_format_value(ip_tree, hf_ip_hdr_len, tvb, (offset<<3)+4, 4, hlen,
                                "%u bytes (%u)", hlen, hlen>>2);
 
-  iph->ip_tos = tvb_get_guint8(tvb, offset + 1);
+  iph->ip_tos = tvb_region_get_guint8(&hdr, offset + 1);
   if (g_ip_dscp_actif) {
     col_add_str(pinfo->cinfo, COL_DSCP_VALUE,
                 val_to_str_ext(IPDSFIELD_DSCP(iph->ip_tos), &dscp_short_vals_ext, "%u"));
@@ -1974,7 +1978,7 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
      inside an ICMP datagram; we need to somehow let the
      dissector we call know that, as it might want to avoid
      doing its checksumming. */
-  iph->ip_len = tvb_get_ntohs(tvb, offset + 2);
+  iph->ip_len = tvb_region_get_ntohs(&hdr, offset + 2);
 
   if (iph->ip_len < hlen) {
     if (ip_tso_supported && !iph->ip_len) {
@@ -2025,11 +2029,11 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
     }
   }
 
-  iph->ip_id  = tvb_get_ntohs(tvb, offset + 4);
+  iph->ip_id  = tvb_region_get_ntohs(&hdr, offset + 4);
   if (tree)
     proto_tree_add_uint(ip_tree, hf_ip_id, tvb, offset + 4, 2, iph->ip_id);
 
-  iph->ip_off = tvb_get_ntohs(tvb, offset + 6);
+  iph->ip_off = tvb_region_get_ntohs(&hdr, offset + 6);
   bit_offset = (offset + 6) * 8;
 
   flags = (iph->ip_off & (IP_RF | IP_DF | IP_MF)) >> IP_OFFSET_WIDTH;
@@ -2060,19 +2064,19 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   proto_tree_add_uint(ip_tree, hf_ip_frag_offset, tvb, offset + 6, 2,
                         (iph->ip_off & IP_OFFSET)*8);
 
-  iph->ip_ttl = tvb_get_guint8(tvb, offset + 8);
+  iph->ip_ttl = tvb_region_get_guint8(&hdr, offset + 8);
   if (tree) {
     ttl_item = proto_tree_add_item(ip_tree, hf_ip_ttl, tvb, offset + 8, 1, ENC_BIG_ENDIAN);
   } else {
     ttl_item = NULL;
   }
 
-  iph->ip_nxt = tvb_get_guint8(tvb, offset + 9);
+  iph->ip_nxt = tvb_region_get_guint8(&hdr, offset + 9);
   if (tree) {
     proto_tree_add_item(ip_tree, hf_ip_proto, tvb, offset + 9, 1, ENC_BIG_ENDIAN);
   }
 
-  iph->ip_sum = tvb_get_ntohs(tvb, offset + 10);
+  iph->ip_sum = tvb_region_get_ntohs(&hdr, offset + 10);
 
   /*
    * If checksum checking is enabled, and we have the entire IP header
@@ -2112,7 +2116,7 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
                                     offset + 10, 0, PROTO_CHECKSUM_E_UNVERIFIED);
     PROTO_ITEM_SET_GENERATED(item);
   }
-  src32 = tvb_get_ntohl(tvb, offset + IPH_SRC);
+  src32 = tvb_region_get_ntohl(&hdr, offset + IPH_SRC);
   set_address_tvb(&pinfo->net_src, AT_IPv4, 4, tvb, offset + IPH_SRC);
   copy_address_shallow(&pinfo->src, &pinfo->net_src);
   copy_address_shallow(&iph->ip_src, &pinfo->src);
@@ -2153,7 +2157,7 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   else
     dst_off = 0;
 
-  dst32 = tvb_get_ntohl(tvb, offset + IPH_DST + dst_off);
+  dst32 = tvb_region_get_ntohl(&hdr, offset + IPH_DST + dst_off);
   set_address_tvb(&pinfo->net_dst, AT_IPv4, 4, tvb, offset + IPH_DST + dst_off);
   copy_address_shallow(&pinfo->dst, &pinfo->net_dst);
   copy_address_shallow(&iph->ip_dst, &pinfo->net_dst);
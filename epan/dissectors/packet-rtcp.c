@@ -6543,6 +6543,10 @@ proto_reg_handoff_rtcp(void)
 
     heur_dissector_add( "udp", dissect_rtcp_heur_udp, "RTCP over UDP", "rtcp_udp", proto_rtcp, HEURISTIC_ENABLE);
     heur_dissector_add("stun", dissect_rtcp_heur, "RTCP over TURN", "rtcp_stun", proto_rtcp, HEURISTIC_ENABLE);
+
+    /* Version 2, and a length that's a non-zero multiple of 4 */
+    heur_dissector_set_precheck("udp", dissect_rtcp_heur_udp, proto_rtcp, 4, 0xC0, 0x80);
+    heur_dissector_set_precheck("stun", dissect_rtcp_heur, proto_rtcp, 4, 0xC0, 0x80);
 }
 
 /*
@@ -1125,7 +1125,7 @@ snort_dissector(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
                                                        WTAP_FILE_TYPE_SUBTYPE_PCAP,
                                                        pinfo->pkt_encap,
                                                        WTAP_MAX_PACKET_SIZE,
-                                                       FALSE,                 /* compressed */
+                                                       WTAP_UNCOMPRESSED,
                                                        &open_err);
                 if (!current_session.pdh) {
                     current_session.working = FALSE;
@@ -1732,6 +1732,8 @@ proto_reg_handoff_stun(void)
     dissector_add_uint_with_preference("udp.port", UDP_PORT_STUN, stun_udp_handle);
 
     heur_dissector_add("udp", dissect_stun_heur, "STUN over UDP", "stun_udp", proto_stun, HEURISTIC_ENABLE);
+    /* The heuristic never matches TURN ChannelData, whose first two bits aren't 0 */
+    heur_dissector_set_precheck("udp", dissect_stun_heur, proto_stun, STUN_HDR_LEN, 0xC0, 0x00);
 
     data_handle = find_dissector("data");
 }
@@ -803,8 +803,7 @@ gchar* tcp_follow_conv_filter(packet_info* pinfo, int* stream)
 
     if (((pinfo->net_src.type == AT_IPv4 && pinfo->net_dst.type == AT_IPv4) ||
         (pinfo->net_src.type == AT_IPv6 && pinfo->net_dst.type == AT_IPv6))
-        && (conv=find_conversation(pinfo->num, &pinfo->src, &pinfo->dst, pinfo->ptype,
-                pinfo->srcport, pinfo->destport, 0)) != NULL )
+        && (conv=find_conversation_pinfo(pinfo, 0)) != NULL )
     {
         /* TCP over IPv4/6 */
         tcpd=get_tcp_conversation_data(conv, pinfo);
@@ -1311,11 +1310,11 @@ init_tcp_conversation_data(packet_info *pinfo)
     tcpd=wmem_new0(wmem_file_scope(), struct tcp_analysis);
     tcpd->flow1.win_scale=-1;
     tcpd->flow1.window = G_MAXUINT32;
-    tcpd->flow1.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow1.multisegment_pdus=wmem_tree_new_btree(wmem_file_scope());
 
     tcpd->flow2.window = G_MAXUINT32;
     tcpd->flow2.win_scale=-1;
-    tcpd->flow2.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow2.multisegment_pdus=wmem_tree_new_btree(wmem_file_scope());
 
     /* Only allocate the data if its actually going to be analyzed */
     if (tcp_analyze_seq)
@@ -1330,7 +1329,7 @@ init_tcp_conversation_data(packet_info *pinfo)
         tcpd->flow2.process_info = wmem_new0(wmem_file_scope(), struct tcp_process_info_t);
     }
 
-    tcpd->acked_table=wmem_tree_new(wmem_file_scope());
+    tcpd->acked_table=wmem_tree_new_btree(wmem_file_scope());
     tcpd->ts_first.secs=pinfo->abs_ts.secs;
     tcpd->ts_first.nsecs=pinfo->abs_ts.nsecs;
     nstime_set_zero(&tcpd->ts_mru_syn);
@@ -5694,10 +5693,14 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     struct tcp_per_packet_data_t *tcppd=NULL;
     proto_item *item;
     proto_tree *checksum_tree;
+    tvb_region_t hdr;
+
+    /* The fixed part of the header is read with a single bounds check */
+    tvb_region_init(&hdr, tvb, offset, TCPH_MIN_LEN);
 
     tcph = wmem_new0(wmem_packet_scope(), struct tcpheader);
-    tcph->th_sport = tvb_get_ntohs(tvb, offset);
-    tcph->th_dport = tvb_get_ntohs(tvb, offset + 2);
+    tcph->th_sport = tvb_region_get_ntohs(&hdr, offset);
+    tcph->th_dport = tvb_region_get_ntohs(&hdr, offset + 2);
     copy_address_shallow(&tcph->ip_src, &pinfo->src);
     copy_address_shallow(&tcph->ip_dst, &pinfo->dst);
 
@@ -5749,12 +5752,12 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     pinfo->srcport = tcph->th_sport;
     pinfo->destport = tcph->th_dport;
 
-    tcph->th_rawseq = tvb_get_ntohl(tvb, offset + 4);
+    tcph->th_rawseq = tvb_region_get_ntohl(&hdr, offset + 4);
     tcph->th_seq = tcph->th_rawseq;
-    tcph->th_ack = tvb_get_ntohl(tvb, offset + 8);
-    th_off_x2 = tvb_get_guint8(tvb, offset + 12);
-    tcpinfo.flags = tcph->th_flags = tvb_get_ntohs(tvb, offset + 12) & TH_MASK;
-    tcph->th_win = tvb_get_ntohs(tvb, offset + 14);
+    tcph->th_ack = tvb_region_get_ntohl(&hdr, offset + 8);
+    th_off_x2 = tvb_region_get_guint8(&hdr, offset + 12);
+    tcpinfo.flags = tcph->th_flags = tvb_region_get_ntohs(&hdr, offset + 12) & TH_MASK;
+    tcph->th_win = tvb_region_get_ntohs(&hdr, offset + 14);
     real_window = tcph->th_win;
     tcph->th_hlen = hi_nibble(th_off_x2) * 4;  /* TCP header length, in bytes */
 
@@ -5764,9 +5767,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
      * in case a new conversation is found and the previous conversation needs
      * to be adjusted,
      */
-    if((conv = find_conversation(pinfo->num, &pinfo->src, &pinfo->dst,
-                     pinfo->ptype, pinfo->srcport,
-                     pinfo->destport, 0)) != NULL) {
+    if((conv = find_conversation_pinfo(pinfo, 0)) != NULL) {
         /* Update how far the conversation reaches */
         if (pinfo->num > conv->last_frame) {
             save_last_frame = conv->last_frame;
@@ -5984,7 +5985,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
         }
     } else {
         /* Note if the ACK field is non-zero */
-        if (tvb_get_ntohl(tvb, offset+8) != 0) {
+        if (tvb_region_get_ntohl(&hdr, offset+8) != 0) {
             expert_add_info(pinfo, tf, &ei_tcp_ack_nonzero);
         }
     }
@@ -6099,7 +6100,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
      * Assume, initially, that we can't desegment.
      */
     pinfo->can_desegment = 0;
-    th_sum = tvb_get_ntohs(tvb, offset + 16);
+    th_sum = tvb_region_get_ntohs(&hdr, offset + 16);
     if (!pinfo->fragmented && tvb_bytes_exist(tvb, 0, reported_len)) {
         /* The packet isn't part of an un-reassembled fragmented datagram
            and isn't truncated.  This means we have all the data, and thus
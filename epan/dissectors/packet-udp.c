@@ -422,8 +422,7 @@ static gchar* udp_follow_conv_filter(packet_info *pinfo, int* stream)
 
     if( ((pinfo->net_src.type == AT_IPv4 && pinfo->net_dst.type == AT_IPv4) ||
             (pinfo->net_src.type == AT_IPv6 && pinfo->net_dst.type == AT_IPv6))
-          && (conv=find_conversation(pinfo->num, &pinfo->src, &pinfo->dst, pinfo->ptype,
-              pinfo->srcport, pinfo->destport, 0)) != NULL )
+          && (conv=find_conversation_pinfo(pinfo, 0)) != NULL )
     {
         /* UDP over IPv4/6 */
         udpd=get_udp_conversation_data(conv, pinfo);
@@ -897,10 +896,14 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
   struct udp_analysis *udpd = NULL;
   proto_tree *process_tree;
   gboolean    udp_jumbogram = FALSE;
+  tvb_region_t hdr;
+
+  /* The header is read with a single bounds check */
+  tvb_region_init(&hdr, tvb, offset, 8);
 
   udph = wmem_new0(wmem_packet_scope(), e_udphdr);
-  udph->uh_sport = tvb_get_ntohs(tvb, offset);
-  udph->uh_dport = tvb_get_ntohs(tvb, offset + 2);
+  udph->uh_sport = tvb_region_get_ntohs(&hdr, offset);
+  udph->uh_dport = tvb_region_get_ntohs(&hdr, offset + 2);
   copy_address_shallow(&udph->ip_src, &pinfo->src);
   copy_address_shallow(&udph->ip_dst, &pinfo->dst);
 
@@ -941,7 +944,7 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
                                  ((udph->uh_dport - 32768 - 666 - 1) % 3) + 1);
   }
 
-  udph->uh_ulen = udph->uh_sum_cov = tvb_get_ntohs(tvb, offset + 4);
+  udph->uh_ulen = udph->uh_sum_cov = tvb_region_get_ntohs(&hdr, offset + 4);
   if (ip_proto == IP_PROTO_UDP) {
     len_cov_item = proto_tree_add_item(udp_tree, &hfi_udp_length, tvb, offset + 4, 2, ENC_BIG_ENDIAN);
     if (udph->uh_ulen == 0 && pinfo->src.type == AT_IPv6) {
@@ -991,7 +994,7 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
   if (udp_jumbogram)
     col_append_str(pinfo->cinfo, COL_INFO, " [Jumbogram]");
 
-  udph->uh_sum = tvb_get_ntohs(tvb, offset + 6);
+  udph->uh_sum = tvb_region_get_ntohs(&hdr, offset + 6);
   if (udph->uh_sum == 0) {
     /* No checksum supplied in the packet. */
     if (((ip_proto == IP_PROTO_UDP) && (pinfo->src.type == AT_IPv4)) || pinfo->flags.in_error_pkt) {
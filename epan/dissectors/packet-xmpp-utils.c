@@ -775,9 +775,14 @@ proto_item_get_text(proto_item *item)
     if(fi==NULL)
         return NULL;
 
-    if (fi->rep == NULL)
-        return NULL;
-
+    if (fi->rep == NULL) {
+        /* Text appended to the generic label still counts */
+        if (fi->affix == NULL)
+            return NULL;
+        result = (gchar *)wmem_alloc(wmem_packet_scope(), ITEM_LABEL_LENGTH);
+        proto_item_fill_label(fi, result);
+        return result;
+    }
 
     result = wmem_strdup(wmem_packet_scope(), fi->rep->representation);
     return result;
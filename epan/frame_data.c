@@ -184,7 +184,7 @@ frame_data_init(frame_data *fdata, guint32 num,
   fdata->flags.ref_time = 0;
   fdata->flags.ignored = 0;
   fdata->flags.has_ts = (phdr->presence_flags & WTAP_HAS_TS) ? 1 : 0;
-  fdata->flags.has_phdr_comment = (phdr->opt_comment != NULL);
+  fdata->flags.has_phdr_comment = (phdr->opt_comment != NULL || (phdr->presence_flags & WTAP_HAS_COMMENTS));
   fdata->flags.has_user_comment = 0;
   fdata->flags.need_colorize = 0;
   fdata->tsprec = (gint16)phdr->pkt_tsprec;
@@ -252,19 +252,15 @@ frame_data_reset(frame_data *fdata)
   fdata->flags.visited = 0;
   fdata->subnum = 0;
 
-  if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
-    fdata->pfd = NULL;
-  }
+  /* the proto data lives in the file scope */
+  fdata->pfd = NULL;
 }
 
 void
 frame_data_destroy(frame_data *fdata)
 {
-  if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
-    fdata->pfd = NULL;
-  }
+  /* the proto data lives in the file scope */
+  fdata->pfd = NULL;
 }
 
 /*
@@ -62,7 +62,7 @@ typedef enum {
 struct _color_filter; /* Forward */
 DIAG_OFF(pedantic)
 typedef struct _frame_data {
-  GSList      *pfd;          /**< Per frame proto data */
+  struct _proto_data_list *pfd; /**< Per frame proto data */
   guint32      num;          /**< Frame number */
   guint32      pkt_len;      /**< Packet length */
   guint32      cap_len;      /**< Amount actually captured */
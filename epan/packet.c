@@ -43,6 +43,7 @@
 
 #include "wmem/wmem.h"
 
+#include <epan/conversation.h>
 #include <epan/exceptions.h>
 #include <epan/reassemble.h>
 #include <epan/stream.h>
@@ -75,6 +76,10 @@ struct data_source {
  * a "struct dtbl_entry"; it records what dissector is assigned to
  * that uint or string value in that table.
  *
+ * "uint_index", for FT_UINT8 and FT_UINT16 tables, maps the values
+ * 0-65535 straight to the entries in "hash_table", so that the lookups
+ * done for every packet don't have to hash; see uint_index_set().
+ *
  * "dissector_handles" is a list of all dissectors that *could* be
  * used in that table; not all of them are necessarily in the table,
  * as they may be for protocols that don't have a fixed uint value,
@@ -95,6 +100,7 @@ struct data_source {
  */
 struct dissector_table {
 	GHashTable	*hash_table;
+	dtbl_entry_t	***uint_index;
 	GSList		*dissector_handles;
 	const char	*ui_name;
 	ftenum_t	type;
@@ -163,10 +169,28 @@ destroy_depend_dissector_list(void *data)
 struct heur_dissector_list {
 	protocol_t	*protocol;
 	GSList		*dissectors;
+	guint		 calls;		/* calls since the list was last reordered */
+	guint		 walks;		/* walks of the list in progress ... */
+	guint32		 walks_frame;	/* ... while dissecting this frame */
 };
 
 static GHashTable *heur_dissector_lists = NULL;
 
+/*
+ * With adaptive ordering, a list is reordered after this many calls,
+ * and for each conversation we remember, per list, the heuristic
+ * dissector that first recognized one of its packets.
+ */
+#define HEUR_REORDER_INTERVAL	4096
+
+typedef struct heur_conv_memo {
+	heur_dissector_list_t	 list;
+	heur_dtbl_entry_t	*hdtbl_entry;
+	struct heur_conv_memo	*next;
+} heur_conv_memo_t;
+
+static wmem_map_t *heur_conv_memos = NULL;
+
 /* Name hashtables for fast detection of duplicate names */
 static GHashTable* heuristic_short_names  = NULL;
 
@@ -190,12 +214,77 @@ destroy_heuristic_dissector_list(void *data)
 	g_slice_free(struct heur_dissector_list, dissector_list);
 }
 
+/*
+ * The index of a FT_UINT8 or FT_UINT16 table is a two-level array, 256
+ * pages of 256 entries, with the pages allocated as values are added.
+ * Values above 65535 (which shouldn't be in such a table, but nothing
+ * stops a dissector from looking one up) are only in the hash table.
+ */
+#define UINT_INDEX_PAGE_SHIFT	8
+#define UINT_INDEX_PAGE_SIZE	(1 << UINT_INDEX_PAGE_SHIFT)
+#define UINT_INDEX_MAX		0xFFFF
+
+static void
+uint_index_set(dissector_table_t sub_dissectors, const guint32 pattern, dtbl_entry_t *dtbl_entry)
+{
+	dtbl_entry_t **page;
+
+	if (sub_dissectors->uint_index == NULL || pattern > UINT_INDEX_MAX)
+		return;
+
+	page = sub_dissectors->uint_index[pattern >> UINT_INDEX_PAGE_SHIFT];
+	if (page == NULL) {
+		if (dtbl_entry == NULL)
+			return;
+		page = g_new0(dtbl_entry_t *, UINT_INDEX_PAGE_SIZE);
+		sub_dissectors->uint_index[pattern >> UINT_INDEX_PAGE_SHIFT] = page;
+	}
+	page[pattern & (UINT_INDEX_PAGE_SIZE - 1)] = dtbl_entry;
+}
+
+static void
+uint_index_add_entry(gpointer key, gpointer value, gpointer user_data)
+{
+	uint_index_set((dissector_table_t)user_data, GPOINTER_TO_UINT(key), (dtbl_entry_t *)value);
+}
+
+/* Rebuild the index after entries were removed from the hash table wholesale. */
+static void
+uint_index_rebuild(dissector_table_t sub_dissectors)
+{
+	guint i;
+
+	if (sub_dissectors->uint_index == NULL)
+		return;
+
+	for (i = 0; i < UINT_INDEX_PAGE_SIZE; i++) {
+		if (sub_dissectors->uint_index[i] != NULL)
+			memset(sub_dissectors->uint_index[i], 0, UINT_INDEX_PAGE_SIZE * sizeof (dtbl_entry_t *));
+	}
+	g_hash_table_foreach(sub_dissectors->hash_table, uint_index_add_entry, sub_dissectors);
+}
+
+static void
+uint_index_free(dissector_table_t sub_dissectors)
+{
+	guint i;
+
+	if (sub_dissectors->uint_index == NULL)
+		return;
+
+	for (i = 0; i < UINT_INDEX_PAGE_SIZE; i++)
+		g_free(sub_dissectors->uint_index[i]);
+	g_free(sub_dissectors->uint_index);
+	sub_dissectors->uint_index = NULL;
+}
+
 static void
 destroy_dissector_table(void *data)
 {
 	struct dissector_table *table = (struct dissector_table *)data;
 
 	g_hash_table_destroy(table->hash_table);
+	uint_index_free(table);
 	g_slist_free(table->dissector_handles);
 	g_slice_free(struct dissector_table, data);
 }
@@ -216,6 +305,9 @@ packet_init(void)
 			NULL, destroy_heuristic_dissector_list);
 
 	heuristic_short_names  = g_hash_table_new(wrs_str_hash, g_str_equal);
+
+	heur_conv_memos = wmem_map_new_open_autoreset(wmem_epan_scope(), wmem_file_scope(),
+			WMEM_MAP_KEY_DIRECT, NULL, NULL);
 }
 
 void
@@ -550,7 +642,7 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 	if (fd->flags.has_user_comment)
 		frame_dissector_data.pkt_comment = epan_get_user_comment(edt->session, fd);
 	else if (fd->flags.has_phdr_comment)
-		frame_dissector_data.pkt_comment = phdr->opt_comment;
+		frame_dissector_data.pkt_comment = wtap_phdr_get_comment(phdr);
 	else
 		frame_dissector_data.pkt_comment = NULL;
 	frame_dissector_data.file_type_subtype = file_type_subtype;
@@ -618,7 +710,7 @@ dissect_file(epan_dissect_t *edt, struct wtap_pkthdr *phdr,
 		if (fd->flags.has_user_comment)
 			file_dissector_data.pkt_comment = epan_get_user_comment(edt->session, fd);
 		else if (fd->flags.has_phdr_comment)
-			file_dissector_data.pkt_comment = phdr->opt_comment;
+			file_dissector_data.pkt_comment = wtap_phdr_get_comment(phdr);
 		else
 			file_dissector_data.pkt_comment = NULL;
 		file_dissector_data.color_edt = edt; /* Used strictly for "coloring rules" */
@@ -921,6 +1013,11 @@ find_uint_dtbl_entry(dissector_table_t sub_dissectors, const guint32 pattern)
 	/*
 	 * Find the entry.
 	 */
+	if (sub_dissectors->uint_index != NULL && pattern <= UINT_INDEX_MAX) {
+		dtbl_entry_t **page = sub_dissectors->uint_index[pattern >> UINT_INDEX_PAGE_SHIFT];
+
+		return page != NULL ? page[pattern & (UINT_INDEX_PAGE_SIZE - 1)] : NULL;
+	}
 	return (dtbl_entry_t *)g_hash_table_lookup(sub_dissectors->hash_table,
 				   GUINT_TO_POINTER(pattern));
 }
@@ -1004,6 +1101,7 @@ dissector_add_uint(const char *name, const guint32 pattern, dissector_handle_t h
 	/* do the table insertion */
 	g_hash_table_insert( sub_dissectors->hash_table,
 			     GUINT_TO_POINTER( pattern), (gpointer)dtbl_entry);
+	uint_index_set(sub_dissectors, pattern, dtbl_entry);
 
 	/*
 	 * Now, if this table supports "Decode As", add this handle
@@ -1156,6 +1254,7 @@ dissector_delete_uint(const char *name, const guint32 pattern,
 		/*
 		 * Found - remove it.
 		 */
+		uint_index_set(sub_dissectors, pattern, NULL);
 		g_hash_table_remove(sub_dissectors->hash_table,
 				    GUINT_TO_POINTER(pattern));
 	}
@@ -1199,6 +1298,7 @@ void dissector_delete_all(const char *name, dissector_handle_t handle)
 	g_assert (sub_dissectors);
 
 	g_hash_table_foreach_remove (sub_dissectors->hash_table, dissector_delete_all_check, handle);
+	uint_index_rebuild(sub_dissectors);
 }
 
 static void
@@ -1208,6 +1308,7 @@ dissector_delete_from_table(gpointer key _U_, gpointer value, gpointer user_data
 	g_assert (sub_dissectors);
 
 	g_hash_table_foreach_remove(sub_dissectors->hash_table, dissector_delete_all_check, user_data);
+	uint_index_rebuild(sub_dissectors);
 	sub_dissectors->dissector_handles = g_slist_remove(sub_dissectors->dissector_handles, user_data);
 }
 
@@ -1253,6 +1354,7 @@ dissector_change_uint(const char *name, const guint32 pattern, dissector_handle_
 	/* do the table insertion */
 	g_hash_table_insert( sub_dissectors->hash_table,
 			     GUINT_TO_POINTER( pattern), (gpointer)dtbl_entry);
+	uint_index_set(sub_dissectors, pattern, dtbl_entry);
 }
 
 /* Reset an entry in a uint dissector table to its initial value. */
@@ -1279,6 +1381,7 @@ dissector_reset_uint(const char *name, const guint32 pattern)
 	if (dtbl_entry->initial != NULL) {
 		dtbl_entry->current = dtbl_entry->initial;
 	} else {
+		uint_index_set(sub_dissectors, pattern, NULL);
 		g_hash_table_remove(sub_dissectors->hash_table,
 				    GUINT_TO_POINTER(pattern));
 	}
@@ -2307,10 +2410,13 @@ register_dissector_table(const char *name, const char *ui_name, const int proto,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->uint_index = NULL;
 	switch (type) {
 
 	case FT_UINT8:
 	case FT_UINT16:
+		sub_dissectors->uint_index = g_new0(dtbl_entry_t **, UINT_INDEX_PAGE_SIZE);
+		/* FALL THROUGH */
 	case FT_UINT24:
 	case FT_UINT32:
 		/*
@@ -2366,6 +2472,7 @@ dissector_table_t register_custom_dissector_table(const char *name,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->uint_index = NULL;
 	sub_dissectors->hash_func = hash_func;
 	sub_dissectors->hash_table = g_hash_table_new_full(hash_func,
 							       key_equal_func,
@@ -2493,6 +2600,12 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const char *dis
 	hdtbl_entry->short_name = g_strdup(short_name);
 	hdtbl_entry->list_name = g_strdup(name);
 	hdtbl_entry->enabled   = (enable == HEURISTIC_ENABLE);
+	hdtbl_entry->min_length = 0;
+	hdtbl_entry->first_byte_mask = 0;
+	hdtbl_entry->first_byte_value = 0;
+	hdtbl_entry->tries = 0;
+	hdtbl_entry->hits = 0;
+	hdtbl_entry->skipped = 0;
 
 	/* do the table insertion */
 	g_hash_table_insert(heuristic_short_names, (gpointer)hdtbl_entry->short_name, hdtbl_entry);
@@ -2512,6 +2625,42 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const char *dis
 
 
 
+static heur_conv_memo_t *
+heur_conv_memo_find(conversation_t *conversation, heur_dissector_list_t sub_dissectors)
+{
+	heur_conv_memo_t *memo;
+
+	for (memo = (heur_conv_memo_t *)wmem_map_lookup(heur_conv_memos, conversation);
+	    memo != NULL; memo = memo->next) {
+		if (memo->list == sub_dissectors)
+			return memo;
+	}
+	return NULL;
+}
+
+static void
+heur_conv_memo_add(conversation_t *conversation, heur_dissector_list_t sub_dissectors,
+		   heur_dtbl_entry_t *hdtbl_entry)
+{
+	heur_conv_memo_t *memo = wmem_new(wmem_file_scope(), heur_conv_memo_t);
+
+	memo->list = sub_dissectors;
+	memo->hdtbl_entry = hdtbl_entry;
+	memo->next = (heur_conv_memo_t *)wmem_map_lookup(heur_conv_memos, conversation);
+	wmem_map_insert(heur_conv_memos, conversation, memo);
+}
+
+static void
+heur_conv_memo_forget(gpointer key _U_, gpointer value, gpointer user_data)
+{
+	heur_conv_memo_t *memo;
+
+	for (memo = (heur_conv_memo_t *)value; memo != NULL; memo = memo->next) {
+		if (memo->hdtbl_entry == (heur_dtbl_entry_t *)user_data)
+			memo->hdtbl_entry = NULL;
+	}
+}
+
 static int
 find_matching_heur_dissector( gconstpointer a, gconstpointer b) {
 	const heur_dtbl_entry_t *hdtbl_entry_a = (const heur_dtbl_entry_t *) a;
@@ -2538,6 +2687,7 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 
 	if (found_entry) {
 		heur_dtbl_entry_t *found_hdtbl_entry = (heur_dtbl_entry_t *)(found_entry->data);
+		wmem_map_foreach(heur_conv_memos, heur_conv_memo_forget, found_hdtbl_entry);
 		g_free(found_hdtbl_entry->list_name);
 		g_hash_table_remove(heuristic_short_names, found_hdtbl_entry->short_name);
 		g_free(found_hdtbl_entry->short_name);
@@ -2547,6 +2697,137 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 	}
 }
 
+void
+heur_dissector_set_precheck(const char *name, heur_dissector_t dissector, const int proto,
+			    guint min_length, guint8 first_byte_mask, guint8 first_byte_value)
+{
+	heur_dissector_list_t  sub_dissectors = find_heur_dissector_list(name);
+	heur_dtbl_entry_t      hdtbl_entry;
+	GSList                *found_entry;
+	heur_dtbl_entry_t     *found_hdtbl_entry;
+
+	/* sanity check */
+	g_assert(sub_dissectors != NULL);
+
+	hdtbl_entry.dissector = dissector;
+	hdtbl_entry.protocol  = find_protocol_by_id(proto);
+
+	found_entry = g_slist_find_custom(sub_dissectors->dissectors,
+	    (gpointer) &hdtbl_entry, find_matching_heur_dissector);
+	g_assert(found_entry != NULL);
+
+	found_hdtbl_entry = (heur_dtbl_entry_t *)(found_entry->data);
+	found_hdtbl_entry->min_length = min_length;
+	found_hdtbl_entry->first_byte_mask = first_byte_mask;
+	found_hdtbl_entry->first_byte_value = first_byte_value & first_byte_mask;
+}
+
+static void
+heur_dissector_reset_entry_statistics(gpointer data, gpointer user_data _U_)
+{
+	heur_dtbl_entry_t *hdtbl_entry = (heur_dtbl_entry_t *)data;
+
+	hdtbl_entry->tries = 0;
+	hdtbl_entry->hits = 0;
+	hdtbl_entry->skipped = 0;
+}
+
+static void
+heur_dissector_reset_list_statistics(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	heur_dissector_list_t sub_dissectors = (heur_dissector_list_t)value;
+
+	g_slist_foreach(sub_dissectors->dissectors, heur_dissector_reset_entry_statistics, NULL);
+}
+
+void
+heur_dissector_reset_statistics(void)
+{
+	g_hash_table_foreach(heur_dissector_lists, heur_dissector_reset_list_statistics, NULL);
+}
+
+/*
+ * Sort heuristic dissectors by the number of packets they recognized,
+ * most first; g_slist_sort() is stable, so ties keep their order.
+ */
+static gint
+heur_compare_hits(gconstpointer a, gconstpointer b)
+{
+	const heur_dtbl_entry_t *hdtbl_entry_a = (const heur_dtbl_entry_t *)a;
+	const heur_dtbl_entry_t *hdtbl_entry_b = (const heur_dtbl_entry_t *)b;
+
+	if (hdtbl_entry_a->hits > hdtbl_entry_b->hits)
+		return -1;
+	if (hdtbl_entry_a->hits < hdtbl_entry_b->hits)
+		return 1;
+	return 0;
+}
+
+/*
+ * Call one heuristic dissector, unless it's disabled or the checks it
+ * declared rule the packet out.  Returns TRUE if it accepted the packet.
+ */
+static gboolean
+try_heur_dtbl_entry(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb, packet_info *pinfo,
+		    proto_tree *tree, void *data, guint16 saved_can_desegment,
+		    guint saved_layers_len)
+{
+	int proto_id;
+
+	/* XXX - why set this now and above? */
+	pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
+
+	if (hdtbl_entry->protocol != NULL &&
+		(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
+		/*
+		 * No - don't try this dissector.
+		 */
+		return FALSE;
+	}
+
+	if (tvb_reported_length(tvb) < hdtbl_entry->min_length ||
+	    (hdtbl_entry->first_byte_mask != 0 && tvb_captured_length(tvb) != 0 &&
+	     (tvb_get_guint8(tvb, 0) & hdtbl_entry->first_byte_mask) != hdtbl_entry->first_byte_value)) {
+		/*
+		 * The dissector said it won't accept this packet.
+		 */
+		hdtbl_entry->skipped++;
+		return FALSE;
+	}
+
+	if (hdtbl_entry->protocol != NULL) {
+		proto_id = proto_get_id(hdtbl_entry->protocol);
+		/* do NOT change this behavior - wslua uses the protocol short name set here in order
+		   to determine which Lua-based heurisitc dissector to call */
+		pinfo->current_proto =
+			proto_get_protocol_short_name(hdtbl_entry->protocol);
+
+		/*
+		 * Add the protocol name to the layers; we'll remove it
+		 * if the dissector fails.
+		 */
+		wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+	}
+
+	pinfo->heur_list_name = hdtbl_entry->list_name;
+
+	hdtbl_entry->tries++;
+	if ((hdtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+		hdtbl_entry->hits++;
+		return TRUE;
+	}
+
+	/*
+	 * That dissector didn't accept the packet, so
+	 * remove its protocol's name from the list
+	 * of protocols.
+	 */
+	while (wmem_list_count(pinfo->layers) > saved_layers_len) {
+		wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
+	}
+	return FALSE;
+}
+
 gboolean
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -2558,7 +2839,9 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	guint16            saved_can_desegment;
 	guint              saved_layers_len = 0;
 	heur_dtbl_entry_t *hdtbl_entry;
-	int                proto_id;
+	gboolean           adaptive = prefs.adaptive_heuristic_order;
+	conversation_t    *conversation = NULL;
+	heur_conv_memo_t  *memo = NULL;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
 	   then everytime a subdissector is called it is decremented by one.
@@ -2580,52 +2863,68 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	saved_layers_len = wmem_list_count(pinfo->layers);
 	*heur_dtbl_entry = NULL;
 
-	for (entry = sub_dissectors->dissectors; entry != NULL;
-	    entry = g_slist_next(entry)) {
-		/* XXX - why set this now and above? */
-		pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
-		hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
+	if (adaptive) {
+		/*
+		 * A heuristic dissector may call this list again, e.g. for
+		 * a tunnelled packet, so only reorder it when no walk of it
+		 * is in progress.  A walk cut short by an exception never
+		 * finishes, but it can't outlast the frame.
+		 */
+		if (sub_dissectors->walks_frame != pinfo->num) {
+			sub_dissectors->walks_frame = pinfo->num;
+			sub_dissectors->walks = 0;
+		}
+		if (++sub_dissectors->calls >= HEUR_REORDER_INTERVAL &&
+		    sub_dissectors->walks == 0) {
+			sub_dissectors->dissectors = g_slist_sort(sub_dissectors->dissectors,
+			    heur_compare_hits);
+			sub_dissectors->calls = 0;
+		}
+		sub_dissectors->walks++;
 
-		if (hdtbl_entry->protocol != NULL &&
-			(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
-			/*
-			 * No - don't try this dissector.
-			 */
-			continue;
+		/*
+		 * Try the dissector that recognized an earlier packet of
+		 * this conversation first.
+		 */
+		conversation = find_conversation(pinfo->num, &pinfo->src, &pinfo->dst,
+		    pinfo->ptype, pinfo->srcport, pinfo->destport, 0);
+		if (conversation != NULL) {
+			memo = heur_conv_memo_find(conversation, sub_dissectors);
+			if (memo != NULL && memo->hdtbl_entry != NULL &&
+			    try_heur_dtbl_entry(memo->hdtbl_entry, tvb, pinfo, tree, data,
+						saved_can_desegment, saved_layers_len)) {
+				*heur_dtbl_entry = memo->hdtbl_entry;
+				status = TRUE;
+			}
 		}
+	}
 
-		if (hdtbl_entry->protocol != NULL) {
-			proto_id = proto_get_id(hdtbl_entry->protocol);
-			/* do NOT change this behavior - wslua uses the protocol short name set here in order
-			   to determine which Lua-based heurisitc dissector to call */
-			pinfo->current_proto =
-				proto_get_protocol_short_name(hdtbl_entry->protocol);
+	for (entry = sub_dissectors->dissectors; !status && entry != NULL;
+	    entry = g_slist_next(entry)) {
+		hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
 
-			/*
-			 * Add the protocol name to the layers; we'll remove it
-			 * if the dissector fails.
-			 */
-			wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+		if (memo != NULL && hdtbl_entry == memo->hdtbl_entry) {
+			/* Already tried above. */
+			continue;
 		}
 
-		pinfo->heur_list_name = hdtbl_entry->list_name;
-
-		if ((hdtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+		if (try_heur_dtbl_entry(hdtbl_entry, tvb, pinfo, tree, data,
+					saved_can_desegment, saved_layers_len)) {
 			*heur_dtbl_entry = hdtbl_entry;
 			status = TRUE;
-			break;
-		} else {
-			/*
-			 * That dissector didn't accept the packet, so
-			 * remove its protocol's name from the list
-			 * of protocols.
-			 */
-			while (wmem_list_count(pinfo->layers) > saved_layers_len) {
-				wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
+
+			if (conversation != NULL) {
+				if (memo == NULL)
+					heur_conv_memo_add(conversation, sub_dissectors, hdtbl_entry);
+				else if (memo->hdtbl_entry == NULL)
+					memo->hdtbl_entry = hdtbl_entry;
 			}
 		}
 	}
 
+	if (adaptive)
+		sub_dissectors->walks--;
+
 	pinfo->current_proto = saved_curr_proto;
 	pinfo->heur_list_name = saved_heur_list_name;
 	pinfo->can_desegment = saved_can_desegment;
@@ -2780,6 +3079,9 @@ register_heur_dissector_list(const char *name, const int proto)
 	sub_dissectors = g_slice_new(struct heur_dissector_list);
 	sub_dissectors->protocol  = find_protocol_by_id(proto);
 	sub_dissectors->dissectors = NULL;	/* initially empty */
+	sub_dissectors->calls = 0;
+	sub_dissectors->walks = 0;
+	sub_dissectors->walks_frame = 0;
 	g_hash_table_insert(heur_dissector_lists, (gpointer)name,
 			    (gpointer) sub_dissectors);
 	return sub_dissectors;
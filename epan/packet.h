@@ -412,6 +412,12 @@ typedef struct heur_dtbl_entry {
 	const gchar *display_name;     /* the string used to present heuristic to user */
 	gchar *short_name;     /* string used for "internal" use to uniquely identify heuristic */
 	gboolean enabled;
+	guint min_length;        /* packets with a smaller reported length are never accepted */
+	guint8 first_byte_mask;  /* the first byte, masked with this, ... */
+	guint8 first_byte_value; /* ... must be this for the packet to be accepted */
+	guint64 tries;           /* number of times the dissector was called */
+	guint64 hits;            /* number of times it accepted the packet */
+	guint64 skipped;         /* number of packets rejected by the checks above */
 } heur_dtbl_entry_t;
 
 /** A protocol uses this function to register a heuristic sub-dissector list.
@@ -456,6 +462,11 @@ WS_DLL_PUBLIC gboolean has_heur_dissector_list(const gchar *name);
  *  until we find one that recognizes the protocol.
  *  Call this while the parent dissector running.
  *
+ *  With the "protocols.adaptive_heuristic_order" preference set, the
+ *  dissector that first recognized a packet of the conversation is tried
+ *  first, and the list is periodically reordered so that the dissectors
+ *  that recognize the most packets come first.
+ *
  * @param sub_dissectors the sub-dissector list
  * @param tvb the tvbuff with the (remaining) packet data
  * @param pinfo the packet info of this packet (additional info)
@@ -494,6 +505,24 @@ WS_DLL_PUBLIC heur_dtbl_entry_t* find_heur_dissector_by_unique_short_name(const
 WS_DLL_PUBLIC void heur_dissector_add(const char *name, heur_dissector_t dissector,
     const char *display_name, const char *short_name, const int proto, heuristic_enable_e enable);
 
+/** Declare checks that let a heuristic sub-dissector be skipped without
+ *  calling it.  They must only reject packets the dissector itself would
+ *  reject.
+ *
+ * @param name the name of the "parent" protocol, e.g. "udp"
+ * @param dissector the sub-dissector, as passed to heur_dissector_add()
+ * @param proto the protocol id of the sub-dissector
+ * @param min_length packets with a reported length below this are skipped
+ * @param first_byte_mask mask applied to the first byte of the packet
+ * @param first_byte_value packets whose masked first byte isn't this are
+ * skipped; use 0 for both to check only the length
+ */
+WS_DLL_PUBLIC void heur_dissector_set_precheck(const char *name, heur_dissector_t dissector,
+    const int proto, guint min_length, guint8 first_byte_mask, guint8 first_byte_value);
+
+/** Reset the call and hit counters of all heuristic sub-dissectors. */
+WS_DLL_PUBLIC void heur_dissector_reset_statistics(void);
+
 /** Remove a sub-dissector from a heuristic dissector list.
  *  Call this in the prefs_reinit function of the sub-dissector.
  *
@@ -3143,6 +3143,12 @@ prefs_register_modules(void)
                                    10,
                                    &prefs.gui_fileopen_preview);
 
+    prefs_register_bool_preference(gui_module, "fast_seek_index",
+                                   "Save the seek points of compressed capture files",
+                                   "Save the seek points of a compressed capture file to a \".fsidx\" file next to it, "
+                                   "so that opening it again doesn't require decompressing all of it twice.",
+                                   &prefs.gui_fast_seek_index);
+
     prefs_register_bool_preference(gui_module, "ask_unsaved",
                                    "Ask to save unsaved capture files",
                                    "Ask to save unsaved capture files?",
@@ -3547,6 +3553,14 @@ prefs_register_modules(void)
                                    "Look for dissectors that left some bytes undecoded.",
                                    &prefs.enable_incomplete_dissectors_check);
 
+    prefs_register_bool_preference(protocols_module, "adaptive_heuristic_order",
+                                   "Adapt the order of heuristic dissectors to the traffic",
+                                   "Try the heuristic dissector that recognized a conversation's earlier packets first, "
+                                   "and move the heuristic dissectors that recognize the most packets to the front of their list. "
+                                   "Faster, but when more than one heuristic dissector would recognize a packet, "
+                                   "which one is used can depend on the packets seen before it.",
+                                   &prefs.adaptive_heuristic_order);
+
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
      * configuration screen within the preferences dialog
@@ -3964,6 +3978,7 @@ pre_init_prefs(void)
     if (prefs.gui_fileopen_dir) g_free(prefs.gui_fileopen_dir);
     prefs.gui_fileopen_dir           = g_strdup(get_persdatafile_dir());
     prefs.gui_fileopen_preview       = 3;
+    prefs.gui_fast_seek_index        = FALSE;
     prefs.gui_ask_unsaved            = TRUE;
     prefs.gui_find_wrap              = TRUE;
     prefs.gui_use_pref_save          = FALSE;
@@ -4051,6 +4066,7 @@ pre_init_prefs(void)
     prefs.st_sort_showfullname = FALSE;
     prefs.display_hidden_proto_items = FALSE;
     prefs.display_byte_fields_with_spaces = FALSE;
+    prefs.adaptive_heuristic_order = FALSE;
 }
 
 /*
@@ -177,6 +177,7 @@ typedef struct _e_prefs {
   guint        gui_fileopen_style;
   gchar       *gui_fileopen_dir;
   guint        gui_fileopen_preview;
+  gboolean     gui_fast_seek_index;
   gboolean     gui_ask_unsaved;
   gboolean     gui_find_wrap;
   gboolean     gui_use_pref_save;
@@ -219,6 +220,7 @@ typedef struct _e_prefs {
   gboolean     display_hidden_proto_items;
   gboolean     display_byte_fields_with_spaces;
   gboolean     enable_incomplete_dissectors_check;
+  gboolean     adaptive_heuristic_order;
   gboolean     incomplete_dissectors_check_debug;
   gpointer     filter_expressions;/* Actually points to &head */
   gboolean     gui_update_enabled;
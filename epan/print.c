@@ -2329,6 +2329,11 @@ gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
             /* Print out the full details for the protocol. */
             if (fi->rep) {
                 return g_strdup(fi->rep->representation);
+            } else if (fi->affix) {
+                gchar label_str[ITEM_LABEL_LENGTH];
+
+                proto_item_fill_label(fi, label_str);
+                return g_strdup(label_str);
             } else {
                 /* Just print out the protocol abbreviation */
                 return g_strdup(fi->hfinfo->abbrev);
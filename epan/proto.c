@@ -178,6 +178,7 @@ static int hfinfo_container_bitwidth(const header_field_info *hfinfo);
 static void label_mark_truncated(char *label_str, gsize name_pos);
 #define LABEL_MARK_TRUNCATED_START(label_str) label_mark_truncated(label_str, 0)
 
+static void fill_generic_label(field_info *fi, gchar *label_str);
 static void fill_label_boolean(field_info *fi, gchar *label_str);
 static void fill_label_bitfield_char(field_info *fi, gchar *label_str);
 static void fill_label_bitfield(field_info *fi, gchar *label_str, gboolean is_signed);
@@ -333,6 +334,26 @@ static GList *pino_protocols = NULL;
 static GPtrArray *deregistered_fields = NULL;
 static GPtrArray *deregistered_data = NULL;
 
+/* Lookup index for the value_string or range_string of integer fields,
+ * built the first time such a field is formatted so that formatting a
+ * field with a big table doesn't need a linear search. Fields that share
+ * a table share its index; vse and rsi are both NULL if the table isn't
+ * worth indexing. Dissectors that change a table in place after its
+ * fields are registered call proto_invalidate_field_strings(). */
+typedef struct _hf_strings_index_t {
+	const void         *strings;	/* the table that was indexed */
+	gboolean            is_range;	/* it's a range_string */
+	guint               ref_count;
+	value_string_ext   *vse;
+	range_string_index *rsi;
+} hf_strings_index_t;
+
+/* Tables with fewer entries are searched linearly */
+#define HF_STRINGS_INDEX_MIN_ENTRIES	16
+
+/* hf_strings_index_t's, by table */
+static GHashTable *hf_strings_indexes = NULL;
+
 /* indexed by prefix, contains initializers */
 static GHashTable* prefixes = NULL;
 
@@ -356,6 +377,14 @@ static GHashTable* prefixes = NULL;
 #define ITEM_LABEL_FREE(pool, il)			\
 	wmem_free(pool, il);
 
+/* Text appended and prepended to the generic label of an item; the
+ * generic label itself is only built when the label is asked for, since
+ * most of them never are. The generic label goes at label_pos. */
+struct _item_label_affix_t {
+	gsize label_pos;
+	char  text[ITEM_LABEL_LENGTH];
+};
+
 #define PROTO_REGISTRAR_GET_NTH(hfindex, hfinfo)						\
 	if((guint)hfindex >= gpa_hfinfo.len && getenv("WIRESHARK_ABORT_ON_DISSECTOR_BUG"))	\
 		g_error("Unregistered hf! index=%d", hfindex);					\
@@ -368,6 +397,7 @@ typedef struct _gpa_hfinfo_t {
 	guint32             len;
 	guint32             allocated_len;
 	header_field_info **hfi;
+	struct _hf_strings_index_t **strings_index;
 } gpa_hfinfo_t;
 
 static gpa_hfinfo_t gpa_hfinfo;
@@ -387,6 +417,86 @@ static void save_same_name_hfinfo(gpointer data)
 	same_name_hfinfo = (header_field_info*)data;
 }
 
+static void
+hf_strings_index_free(gpointer data)
+{
+	hf_strings_index_t *strings_index = (hf_strings_index_t *)data;
+
+	if (strings_index->vse)
+		value_string_index_free(strings_index->vse);
+	if (strings_index->rsi)
+		range_string_index_free(strings_index->rsi);
+	g_free(strings_index);
+}
+
+static void
+hf_strings_index_build(hf_strings_index_t *strings_index, const gchar *name)
+{
+	if (strings_index->is_range)
+		strings_index->rsi = range_string_index_new((const range_string *)strings_index->strings,
+							    HF_STRINGS_INDEX_MIN_ENTRIES);
+	else
+		strings_index->vse = value_string_index_new((const value_string *)strings_index->strings,
+							    HF_STRINGS_INDEX_MIN_ENTRIES, name);
+}
+
+/* Drops a field's reference to its index; for a deregistered field this
+ * happens before its strings are freed and their address possibly
+ * reused for another table */
+static void
+hf_strings_index_remove(gint hf_id)
+{
+	hf_strings_index_t *strings_index = gpa_hfinfo.strings_index[hf_id];
+
+	if (strings_index == NULL)
+		return;
+
+	gpa_hfinfo.strings_index[hf_id] = NULL;
+	if (--strings_index->ref_count == 0)
+		g_hash_table_remove(hf_strings_indexes, strings_index->strings);
+}
+
+/* Returns the index for the plain value_string or range_string of a
+ * field, building or sharing it if the field hasn't been formatted yet,
+ * or NULL if the table should be searched linearly. */
+static const hf_strings_index_t *
+hf_strings_index_get(const header_field_info *hfinfo, gboolean is_range)
+{
+	hf_strings_index_t *strings_index;
+
+	if (hfinfo->strings == NULL || FIELD_DISPLAY(hfinfo->display) == BASE_CUSTOM)
+		return NULL;
+	if (hfinfo->id < 0 || (guint32)hfinfo->id >= gpa_hfinfo.len)
+		return NULL;
+
+	strings_index = gpa_hfinfo.strings_index[hfinfo->id];
+	/* Dissectors may replace the strings of a field after registering it */
+	if (strings_index != NULL && strings_index->strings != hfinfo->strings) {
+		hf_strings_index_remove(hfinfo->id);
+		strings_index = NULL;
+	}
+
+	if (strings_index == NULL) {
+		strings_index = (hf_strings_index_t *)g_hash_table_lookup(hf_strings_indexes, hfinfo->strings);
+		if (strings_index == NULL) {
+			strings_index = g_new0(hf_strings_index_t, 1);
+			strings_index->strings = hfinfo->strings;
+			strings_index->is_range = is_range;
+			hf_strings_index_build(strings_index, hfinfo->abbrev);
+			g_hash_table_insert(hf_strings_indexes, (gpointer)hfinfo->strings, strings_index);
+		}
+		strings_index->ref_count++;
+		gpa_hfinfo.strings_index[hfinfo->id] = strings_index;
+	}
+
+	/* The same table used as the other kind of strings is a bug in
+	 * the dissector; leave it to the linear search. */
+	if (strings_index->is_range != is_range)
+		return NULL;
+
+	return strings_index;
+}
+
 /* Cached value for VINES address type (used for FT_VINES) */
 static int vines_address_type = -1;
 
@@ -525,7 +635,9 @@ proto_init(void (register_all_protocols_func)(register_cb cb, gpointer client_da
 	gpa_hfinfo.len           = 0;
 	gpa_hfinfo.allocated_len = 0;
 	gpa_hfinfo.hfi           = NULL;
+	gpa_hfinfo.strings_index = NULL;
 	gpa_name_map             = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, save_same_name_hfinfo);
+	hf_strings_indexes       = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, hf_strings_index_free);
 	deregistered_fields      = g_ptr_array_new();
 	deregistered_data        = g_ptr_array_new();
 
@@ -642,6 +754,13 @@ proto_cleanup_base(void)
 		gpa_hfinfo.allocated_len = 0;
 		g_free(gpa_hfinfo.hfi);
 		gpa_hfinfo.hfi           = NULL;
+		g_free(gpa_hfinfo.strings_index);
+		gpa_hfinfo.strings_index = NULL;
+	}
+
+	if (hf_strings_indexes) {
+		g_hash_table_destroy(hf_strings_indexes);
+		hf_strings_indexes = NULL;
 	}
 
 	if (deregistered_fields) {
@@ -4980,6 +5099,7 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 		FI_SET_FLAG(fi, FI_HIDDEN);
 	fvalue_init(&fi->value, fi->hfinfo->type);
 	fi->rep        = NULL;
+	fi->affix      = NULL;
 
 	/* add the data source tvbuff */
 	fi->ds_tvb = tvb ? tvb_get_ds_tvb(tvb) : NULL;
@@ -5654,12 +5774,29 @@ proto_item_set_text(proto_item *pi, const char *format, ...)
 		ITEM_LABEL_FREE(PNODE_POOL(pi), fi->rep);
 		fi->rep = NULL;
 	}
+	if (fi->affix) {
+		wmem_free(PNODE_POOL(pi), fi->affix);
+		fi->affix = NULL;
+	}
 
 	va_start(ap, format);
 	proto_tree_set_representation(pi, format, ap);
 	va_end(ap);
 }
 
+static item_label_affix_t *
+item_label_affix_get(proto_item *pi)
+{
+	field_info *fi = PITEM_FINFO(pi);
+
+	if (fi->affix == NULL) {
+		fi->affix = wmem_new(PNODE_POOL(pi), item_label_affix_t);
+		fi->affix->label_pos = 0;
+		fi->affix->text[0]   = '\0';
+	}
+	return fi->affix;
+}
+
 /* Append to text of proto_item after having already been created. */
 void
 proto_item_append_text(proto_item *pi, const char *format, ...)
@@ -5677,12 +5814,20 @@ proto_item_append_text(proto_item *pi, const char *format, ...)
 
 	if (!PROTO_ITEM_IS_HIDDEN(pi)) {
 		/*
-		 * If we don't already have a representation,
-		 * generate the default representation.
+		 * If we don't already have a representation, add the
+		 * text after the default one, which is generated later.
 		 */
 		if (fi->rep == NULL) {
-			ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
-			proto_item_fill_label(fi, fi->rep->representation);
+			item_label_affix_t *affix = item_label_affix_get(pi);
+
+			curlen = strlen(affix->text);
+			if (ITEM_LABEL_LENGTH > curlen) {
+				va_start(ap, format);
+				g_vsnprintf(affix->text + curlen,
+					ITEM_LABEL_LENGTH - (gulong) curlen, format, ap);
+				va_end(ap);
+			}
+			return;
 		}
 
 		curlen = strlen(fi->rep->representation);
@@ -5712,14 +5857,29 @@ proto_item_prepend_text(proto_item *pi, const char *format, ...)
 
 	if (!PROTO_ITEM_IS_HIDDEN(pi)) {
 		/*
-		 * If we don't already have a representation,
-		 * generate the default representation.
+		 * If we don't already have a representation, add the
+		 * text before the default one, which is generated later.
 		 */
 		if (fi->rep == NULL) {
-			ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
-			proto_item_fill_label(fi, representation);
-		} else
-			g_strlcpy(representation, fi->rep->representation, ITEM_LABEL_LENGTH);
+			item_label_affix_t *affix = item_label_affix_get(pi);
+			gsize               curlen = strlen(affix->text);
+			gsize               len;
+
+			va_start(ap, format);
+			g_vsnprintf(representation, ITEM_LABEL_LENGTH, format, ap);
+			va_end(ap);
+			len = strlen(representation);
+
+			if (len + curlen >= ITEM_LABEL_LENGTH)
+				curlen = ITEM_LABEL_LENGTH - 1 - len;
+			memmove(affix->text + len, affix->text, curlen);
+			affix->text[len + curlen] = '\0';
+			memcpy(affix->text, representation, len);
+			affix->label_pos = MIN(affix->label_pos + len, len + curlen);
+			return;
+		}
+
+		g_strlcpy(representation, fi->rep->representation, ITEM_LABEL_LENGTH);
 
 		va_start(ap, format);
 		g_vsnprintf(fi->rep->representation,
@@ -6710,12 +6870,34 @@ proto_add_deregistered_data (void *data)
 	g_ptr_array_add(deregistered_data, data);
 }
 
+void
+proto_invalidate_field_strings (const void *strings)
+{
+	hf_strings_index_t *strings_index;
+	guint32 i;
+
+	if (hf_strings_indexes == NULL)
+		return;
+	strings_index = (hf_strings_index_t *)g_hash_table_lookup(hf_strings_indexes, strings);
+	if (strings_index == NULL)
+		return;
+
+	/* The fields using the table index it again when next formatted */
+	for (i = 0; i < gpa_hfinfo.len; i++) {
+		if (gpa_hfinfo.strings_index[i] == strings_index)
+			gpa_hfinfo.strings_index[i] = NULL;
+	}
+	g_hash_table_remove(hf_strings_indexes, strings);
+}
+
 static void
 free_deregistered_field (gpointer data, gpointer user_data _U_)
 {
 	header_field_info *hfi = (header_field_info *) data;
 	gint hf_id = hfi->id;
 
+	hf_strings_index_remove(hf_id);
+
 	g_free((char *)hfi->name);
 	g_free((char *)hfi->abbrev);
 	g_free((char *)hfi->blurb);
@@ -6781,6 +6963,8 @@ free_deregistered_field (gpointer data, gpointer user_data _U_)
 static void
 free_deregistered_data (gpointer data, gpointer user_data _U_)
 {
+	/* It may be the strings of a field that's still registered */
+	proto_invalidate_field_strings(data);
 	g_free (data);
 }
 
@@ -7398,10 +7582,15 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 		if (!gpa_hfinfo.hfi) {
 			gpa_hfinfo.allocated_len = PROTO_PRE_ALLOC_HF_FIELDS_MEM;
 			gpa_hfinfo.hfi = (header_field_info **)g_malloc(sizeof(header_field_info *)*PROTO_PRE_ALLOC_HF_FIELDS_MEM);
+			gpa_hfinfo.strings_index = (hf_strings_index_t **)g_malloc0(sizeof(hf_strings_index_t *)*PROTO_PRE_ALLOC_HF_FIELDS_MEM);
 		} else {
 			gpa_hfinfo.allocated_len += 1000;
 			gpa_hfinfo.hfi = (header_field_info **)g_realloc(gpa_hfinfo.hfi,
 						   sizeof(header_field_info *)*gpa_hfinfo.allocated_len);
+			gpa_hfinfo.strings_index = (hf_strings_index_t **)g_realloc(gpa_hfinfo.strings_index,
+						   sizeof(hf_strings_index_t *)*gpa_hfinfo.allocated_len);
+			memset(gpa_hfinfo.strings_index + gpa_hfinfo.len, 0,
+			       sizeof(hf_strings_index_t *)*(gpa_hfinfo.allocated_len - gpa_hfinfo.len));
 			/*g_warning("gpa_hfinfo.allocated_len %u", gpa_hfinfo.allocated_len);*/
 		}
 	}
@@ -7609,6 +7798,24 @@ label_fill_descr(char *label_str, gsize pos, const header_field_info *hfinfo, co
 
 void
 proto_item_fill_label(field_info *fi, gchar *label_str)
+{
+	item_label_affix_t *affix = fi->affix;
+	char                label[ITEM_LABEL_LENGTH];
+
+	if (affix == NULL) {
+		fill_generic_label(fi, label_str);
+		return;
+	}
+
+	fill_generic_label(fi, label);
+	g_strlcpy(label_str, affix->text, affix->label_pos + 1);
+	g_strlcat(label_str, label, ITEM_LABEL_LENGTH);
+	g_strlcat(label_str, affix->text + affix->label_pos, ITEM_LABEL_LENGTH);
+}
+
+/* The label of an item built from its field and its value */
+static void
+fill_generic_label(field_info *fi, gchar *label_str)
 {
 	header_field_info  *hfinfo;
 	guint8		   *bytes;
@@ -7994,8 +8201,14 @@ fill_label_boolean(field_info *fi, gchar *label_str)
 static const char *
 hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 {
-	if (hfinfo->display & BASE_RANGE_STRING)
+	const hf_strings_index_t *strings_index;
+
+	if (hfinfo->display & BASE_RANGE_STRING) {
+		strings_index = hf_strings_index_get(hfinfo, TRUE);
+		if (strings_index && strings_index->rsi)
+			return try_rval_to_str_indexed(value, strings_index->rsi);
 		return try_rval_to_str(value, (const range_string *) hfinfo->strings);
+	}
 
 	if (hfinfo->display & BASE_EXT_STRING)
 		return try_val_to_str_ext(value, (value_string_ext *) hfinfo->strings);
@@ -8006,6 +8219,10 @@ hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_UNIT_STRING)
 		return unit_name_string_get_value(value, (struct unit_name_string*) hfinfo->strings);
 
+	strings_index = hf_strings_index_get(hfinfo, FALSE);
+	if (strings_index && strings_index->vse)
+		return try_val_to_str_ext(value, strings_index->vse);
+
 	return try_val_to_str(value, (const value_string *) hfinfo->strings);
 }
 
@@ -8015,8 +8232,13 @@ hf_try_val64_to_str(guint64 value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_VAL64_STRING)
 		return try_val64_to_str(value, (const val64_string *) hfinfo->strings);
 
-	if (hfinfo->display & BASE_RANGE_STRING)
+	if (hfinfo->display & BASE_RANGE_STRING) {
+		const hf_strings_index_t *strings_index = hf_strings_index_get(hfinfo, TRUE);
+
+		if (strings_index && strings_index->rsi)
+			return try_rval64_to_str_indexed(value, strings_index->rsi);
 		return try_rval64_to_str(value, (const range_string *) hfinfo->strings);
+	}
 
 	if (hfinfo->display & BASE_UNIT_STRING)
 		return unit_name_string_get_value64(value, (struct unit_name_string*) hfinfo->strings);
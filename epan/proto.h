@@ -674,6 +674,9 @@ typedef struct _item_label_t {
 	char representation[ITEM_LABEL_LENGTH];
 } item_label_t;
 
+/** text appended and prepended to the generic label of an item (opaque) */
+typedef struct _item_label_affix_t item_label_affix_t;
+
 
 /** Contains the field information for the proto_item. */
 typedef struct field_info {
@@ -685,6 +688,7 @@ typedef struct field_info {
 	gint			 tree_type;       /**< one of ETT_ or -1 */
 	guint32			 flags;           /**< bitfield like FI_GENERATED, ... */
 	item_label_t		*rep;             /**< string for GUI tree */
+	item_label_affix_t	*affix;           /**< text added to the generic label, if rep is NULL */
 	tvbuff_t		*ds_tvb;          /**< data source tvbuff */
 	fvalue_t		 value;
 } field_info;
@@ -2131,7 +2135,10 @@ proto_tree_add_debug_text(proto_tree *tree, const char *format,
 	...) G_GNUC_PRINTF(2,3);
 
 
-/** Fill given label_str with string representation of field
+/** Fill given label_str with string representation of field.
+ The generic label of an item is only built here, when asked for; text
+ appended or prepended to it with proto_item_append_text() and
+ proto_item_prepend_text() is kept aside until then and included.
  @param fi the item to get the info from
  @param label_str the string to fill
  @todo think about changing the parameter profile */
@@ -2210,6 +2217,14 @@ proto_deregister_field (const int parent, gint hf_id);
 WS_DLL_PUBLIC void
 proto_add_deregistered_data (void *data);
 
+/** Drop the lookup index built for a value_string or range_string of
+ registered fields. Call this after changing such a table in place, or
+ before freeing it while fields still point at it; the index is built
+ again from the table the next time one of its fields is formatted.
+ @param strings the value_string or range_string */
+WS_DLL_PUBLIC void
+proto_invalidate_field_strings (const void *strings);
+
 /** Free fields deregistered in proto_deregister_field(). */
 WS_DLL_PUBLIC void
 proto_free_deregistered_fields (void);
@@ -22,6 +22,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #if 0
@@ -47,75 +49,108 @@ typedef struct _proto_data {
   void *proto_data;
 } proto_data_t;
 
-static gint
-p_compare(gconstpointer a, gconstpointer b)
+/* The protocol data of a frame or packet: an array sorted by protocol and
+   key, allocated in one piece with its header. Most frames have only a few
+   entries, so the first allocation has room for this many. */
+#define PROTO_DATA_INITIAL_CAPACITY 4
+
+struct _proto_data_list {
+  guint count;
+  guint capacity;
+};
+
+#define PROTO_DATA_ITEMS(list) ((proto_data_t *)((list) + 1))
+
+static struct _proto_data_list **
+p_get_list(wmem_allocator_t *scope, struct _packet_info* pinfo)
 {
-  const proto_data_t *ap = (const proto_data_t *)a;
-  const proto_data_t *bp = (const proto_data_t *)b;
-
-  if (ap -> proto > bp -> proto) {
-    return 1;
-  } else if (ap -> proto == bp -> proto) {
-    if (ap->key > bp->key){
-      return 1;
-    } else if (ap -> key == bp -> key) {
-      return 0;
-    }
-    return -1;
+  if (scope == pinfo->pool) {
+    return &pinfo->proto_data;
+  } else if (scope == wmem_file_scope()) {
+    return &pinfo->fd->pfd;
   } else {
-    return -1;
+    DISSECTOR_ASSERT(!"invalid wmem scope");
   }
+  return NULL;
 }
 
-void
-p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
+/* Index of the first item that isn't less than (proto, key) */
+static guint
+p_lower_bound(const struct _proto_data_list *list, int proto, guint32 key)
 {
-  proto_data_t     *p1;
-  GSList          **proto_list;
-  wmem_allocator_t *scope;
-
-  if (tmp_scope == pinfo->pool) {
-    scope = tmp_scope;
-    proto_list = &pinfo->proto_data;
-  } else if (tmp_scope == wmem_file_scope()) {
-    scope = wmem_file_scope();
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+  const proto_data_t *items = PROTO_DATA_ITEMS(list);
+  guint lo = 0, hi = list->count, mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (items[mid].proto < proto ||
+        (items[mid].proto == proto && items[mid].key < key)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
   }
+  return lo;
+}
 
-  p1 = (proto_data_t *)wmem_alloc(scope, sizeof(proto_data_t));
+/* Index of the item for (proto, key), or -1 */
+static gint
+p_find(const struct _proto_data_list *list, int proto, guint32 key)
+{
+  const proto_data_t *items;
+  guint i;
 
-  p1->proto = proto;
-  p1->key = key;
-  p1->proto_data = proto_data;
+  if (!list)
+    return -1;
 
-  /* Add it to the GSLIST */
-  *proto_list = g_slist_prepend(*proto_list, p1);
+  items = PROTO_DATA_ITEMS(list);
+  i = p_lower_bound(list, proto, key);
+  if (i < list->count && items[i].proto == proto && items[i].key == key)
+    return (gint)i;
+  return -1;
 }
 
-void *
-p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+void
+p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
 {
-  proto_data_t  temp, *p1;
-  GSList       *item;
+  struct _proto_data_list **plist = p_get_list(tmp_scope, pinfo);
+  struct _proto_data_list  *list = *plist;
+  proto_data_t             *items;
+  guint                     i;
+
+  if (!list) {
+    list = (struct _proto_data_list *)wmem_alloc(tmp_scope,
+        sizeof(*list) + PROTO_DATA_INITIAL_CAPACITY * sizeof(proto_data_t));
+    list->count = 0;
+    list->capacity = PROTO_DATA_INITIAL_CAPACITY;
+    *plist = list;
+  } else if (list->count == list->capacity) {
+    list->capacity *= 2;
+    list = (struct _proto_data_list *)wmem_realloc(tmp_scope, list,
+        sizeof(*list) + list->capacity * sizeof(proto_data_t));
+    *plist = list;
+  }
 
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  /* An item added again for the same protocol and key goes in front of the
+     old one, so that it is the one found from then on. */
+  items = PROTO_DATA_ITEMS(list);
+  i = p_lower_bound(list, proto, key);
+  memmove(&items[i + 1], &items[i], (list->count - i) * sizeof(proto_data_t));
+  items[i].proto = proto;
+  items[i].key = key;
+  items[i].proto_data = proto_data;
+  list->count++;
+}
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
+void *
+p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+{
+  struct _proto_data_list *list = *p_get_list(scope, pinfo);
+  gint i;
 
-  if (item) {
-    p1 = (proto_data_t *)item->data;
-    return p1->proto_data;
-  }
+  i = p_find(list, proto, key);
+  if (i >= 0)
+    return PROTO_DATA_ITEMS(list)[i].proto_data;
 
   return NULL;
 }
@@ -123,40 +158,33 @@ p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void
 p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
 {
-  proto_data_t  temp;
-  GSList       *item;
-  GSList      **proto_list;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
-
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-    proto_list = &pinfo->proto_data;
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+  struct _proto_data_list *list = *p_get_list(scope, pinfo);
+  proto_data_t *items;
+  gint i;
+
+  i = p_find(list, proto, key);
+  if (i >= 0) {
+    items = PROTO_DATA_ITEMS(list);
+    list->count--;
+    memmove(&items[i], &items[i + 1], (list->count - i) * sizeof(proto_data_t));
   }
+}
 
-  if (item) {
-    *proto_list = g_slist_remove(*proto_list, item->data);
-  }
+guint
+p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
+  struct _proto_data_list *list = *p_get_list(scope, pinfo);
+
+  return list ? list->count : 0;
 }
 
 gchar *
 p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, guint pfd_index){
+  struct _proto_data_list *list = *p_get_list(scope, pinfo);
   proto_data_t  *temp;
 
-  if (scope == pinfo->pool) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->proto_data, pfd_index);
-  } else if (scope == wmem_file_scope()) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->fd->pfd, pfd_index);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
+  DISSECTOR_ASSERT(list && pfd_index < list->count);
+  temp = &PROTO_DATA_ITEMS(list)[pfd_index];
 
   return wmem_strdup_printf(wmem_packet_scope(),"[%s, key %u]",proto_get_protocol_name(temp->proto), temp->key);
 }
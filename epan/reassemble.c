@@ -28,6 +28,7 @@
 #include <epan/exceptions.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
+#include <epan/wmem/wmem.h>
 
 #include <wsutil/str_util.h>
 
@@ -331,6 +332,39 @@ reassembled_key_free(gpointer ptr)
 	g_slice_free(reassembled_key, (reassembled_key *)ptr);
 }
 
+/*
+ * Index of the fragments of a reassembly, hung off the head while
+ * fragments are being added, so that adding a fragment doesn't have
+ * to walk the list.
+ *
+ * "by_offset" maps a fragment offset (or, for FD_BLOCKSEQUENCE,
+ * sequence number) to the last fragment in the list with that offset,
+ * which is where a new fragment with that offset, or the next lower
+ * one, goes.
+ *
+ * "contiguous" is how much of the PDU, from its start, is covered by
+ * fragments without a gap: a byte count or, for FD_BLOCKSEQUENCE,
+ * the first missing sequence number.
+ *
+ * Anything that rearranges the list without going through
+ * fragment_index_link() has to drop the index with fragment_index_free();
+ * it's rebuilt when it's next needed.
+ */
+typedef struct _fragment_index {
+	wmem_tree_t *by_offset;
+	guint32 contiguous;
+} fragment_index;
+
+static void
+fragment_index_free(fragment_head *fd_head)
+{
+	if (fd_head->frag_index) {
+		wmem_tree_destroy(fd_head->frag_index->by_offset, FALSE, FALSE);
+		g_slice_free(fragment_index, fd_head->frag_index);
+		fd_head->frag_index = NULL;
+	}
+}
+
 /*
  * For a fragment hash table entry, free the associated fragments.
  * The entry value (fd_chain) is freed herein and the entry is freed
@@ -351,6 +385,7 @@ free_all_fragments(gpointer key_arg _U_, gpointer value, gpointer user_data _U_)
 
 		if(fd_head->tvb_data && !(fd_head->flags&FD_SUBSET_TVB))
 			tvb_free(fd_head->tvb_data);
+		fragment_index_free(fd_head);
 		g_slice_free(fragment_item, fd_head);
 	}
 
@@ -410,6 +445,7 @@ free_fragments(gpointer data, gpointer user_data _U_)
 
 	if (fd_head->tvb_data)
 		tvb_free(fd_head->tvb_data);
+	fragment_index_free(fd_head);
 	g_slice_free(fragment_item, fd_head);
 }
 
@@ -630,6 +666,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		g_slice_free(fragment_item, fd);
 		fd=tmp_fd;
 	}
+	fragment_index_free(fd_head);
 	g_slice_free(fragment_head, fd_head);
 	g_hash_table_remove(table->fragment_table, key);
 
@@ -893,11 +930,84 @@ fragment_reassembled_single(reassembly_table *table, fragment_head *fd_head,
 	fd_head->reas_in_layer_num = pinfo->curr_layer_num;
 }
 
+/* Where the fragment ends, for the purpose of finding gaps. */
+static inline guint32
+fragment_index_end(const fragment_head *fd_head, const fragment_item *fd)
+{
+	if (fd_head->flags & FD_BLOCKSEQUENCE)
+		return fd->offset + 1;
+	return fd->offset + fd->len;
+}
+
+static fragment_index *
+fragment_index_get(fragment_head *fd_head)
+{
+	fragment_index *frag_index = fd_head->frag_index;
+	fragment_item *fd_i;
+	guint32 end;
+
+	if (frag_index != NULL)
+		return frag_index;
+
+	frag_index = g_slice_new(fragment_index);
+	frag_index->by_offset = wmem_tree_new(NULL);
+	frag_index->contiguous = 0;
+	for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next) {
+		wmem_tree_insert32(frag_index->by_offset, fd_i->offset, fd_i);
+		end = fragment_index_end(fd_head, fd_i);
+		if (fd_i->offset <= frag_index->contiguous && end > frag_index->contiguous)
+			frag_index->contiguous = end;
+	}
+	fd_head->frag_index = frag_index;
+
+	return frag_index;
+}
+
+/*
+ * Add a fragment to the sorted list, after any fragments with the same
+ * offset, and extend the contiguous part of the PDU.
+ */
+static void
+fragment_index_link(fragment_head *fd_head, fragment_item *fd)
+{
+	fragment_index *frag_index = fragment_index_get(fd_head);
+	fragment_item *fd_i;
+	guint32 end;
+
+	fd_i = (fragment_item *)wmem_tree_lookup32_le(frag_index->by_offset, fd->offset);
+	if (fd_i == NULL)
+		fd_i = fd_head;
+	fd->next = fd_i->next;
+	fd_i->next = fd;
+	wmem_tree_insert32(frag_index->by_offset, fd->offset, fd);
+
+	end = fragment_index_end(fd_head, fd);
+	if (fd->offset <= frag_index->contiguous && end > frag_index->contiguous) {
+		/*
+		 * The fragments that might now join the contiguous part
+		 * follow the last one that starts within it; each of them
+		 * is looked at here only once.
+		 */
+		fd_i = (fragment_item *)wmem_tree_lookup32_le(frag_index->by_offset, frag_index->contiguous);
+		frag_index->contiguous = end;
+		for (fd_i = fd_i->next; fd_i && fd_i->offset <= frag_index->contiguous; fd_i = fd_i->next) {
+			end = fragment_index_end(fd_head, fd_i);
+			if (end > frag_index->contiguous)
+				frag_index->contiguous = end;
+		}
+	}
+}
+
 static void
 LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
 {
 	fragment_item *fd_i;
 
+	if (fd_head->frag_index) {
+		fragment_index_link(fd_head, fd);
+		return;
+	}
+
 	/* add fragment to list, keep list sorted */
 	for(fd_i= fd_head; fd_i->next;fd_i=fd_i->next) {
 		if (fd->offset < fd_i->next->offset )
@@ -914,6 +1024,7 @@ MERGE_FRAG(fragment_head *fd_head, fragment_item *fd)
 
 	if (fd == NULL) return;
 
+	fragment_index_free(fd_head);
 	for(fd_i = fd_head; fd_i->next; fd_i=fd_i->next) {
 		if (fd->offset < fd_i->next->offset) {
 			tmp = fd_i->next;
@@ -923,6 +1034,65 @@ MERGE_FRAG(fragment_head *fd_head, fragment_item *fd)
 	}
 	fd_i->next = fd;
 }
+/*
+ * A part of a PDU being put together: the bytes of the PDU starting
+ * at "offset" are those of "tvb".
+ */
+typedef struct {
+	guint32 offset;
+	tvbuff_t *tvb;
+} fragment_piece;
+
+/*
+ * Check whether the first "len" bytes of "tvb" are the same as the
+ * bytes at "offset" in the pieces of the PDU put together so far,
+ * which cover it from the start without gaps.
+ */
+static gboolean
+fragment_pieces_equal(const fragment_piece *pieces, const guint n_pieces,
+		      const guint32 offset, tvbuff_t *tvb, const guint32 len)
+{
+	guint lo = 0, hi = n_pieces, mid;
+	guint32 pos = 0, piece_offset, chunk;
+
+	/* Find the piece the range starts in. */
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (pieces[mid].offset <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	for (; lo < n_pieces && pos < len; lo++) {
+		piece_offset = offset + pos - pieces[lo].offset;
+		chunk = MIN(len - pos, tvb_captured_length(pieces[lo].tvb) - piece_offset);
+		if (memcmp(tvb_get_ptr(pieces[lo].tvb, piece_offset, chunk),
+			   tvb_get_ptr(tvb, pos, chunk), chunk) != 0)
+			return FALSE;
+		pos += chunk;
+	}
+	return TRUE;
+}
+
+/*
+ * The reassembled data of a PDU that's being extended is made of
+ * the data of its fragments, and the new reassembled data would be
+ * made of that in turn; have the fragments refer to a flat copy of
+ * it instead, so that it doesn't nest any deeper with every extension.
+ * The current frame may still refer to the old reassembled data, so
+ * that's freed along with the frame.
+ */
+static void
+fragment_flatten_reassembled(fragment_head *fd_head, tvbuff_t *tvb)
+{
+	tvbuff_t *old_tvb_data = fd_head->tvb_data;
+
+	if (old_tvb_data == NULL)
+		return;
+	fd_head->tvb_data = tvb_clone(old_tvb_data);
+	tvb_add_to_chain(tvb, old_tvb_data);
+}
+
 /*
  * This function adds a new fragment to the fragment hash table.
  * If this is the first fragment seen for this datagram, a new entry
@@ -951,9 +1121,11 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 {
 	fragment_item *fd;
 	fragment_item *fd_i;
-	guint32 max, dfpos, fraglen;
+	guint32 dfpos, fraglen;
 	tvbuff_t *old_tvb_data;
-	guint8 *data;
+	tvbuff_t *reassembled;
+	fragment_piece *pieces;
+	guint n_pieces;
 
 	/* create new fd describing this fragment */
 	fd = g_slice_new(fragment_item);
@@ -964,6 +1136,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->fragment_nr_offset = 0; /* will only be used with sequence */
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
+	fd->frag_index = NULL;
 	fd->error = NULL;
 
 	/*
@@ -984,8 +1157,10 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			if (fd_head->flags & FD_PARTIAL_REASSEMBLY) {
 				/*
 				 * Yes.  Set flag in already empty fds &
-				 * point old fds to malloc'ed data.
+				 * point old fds to a copy of the
+				 * reassembled data.
 				 */
+				fragment_flatten_reassembled(fd_head, tvb);
 				for(fd_i=fd_head->next; fd_i; fd_i=fd_i->next){
 					if( !fd_i->tvb_data ) {
 						fd_i->tvb_data = tvb_new_subset_remaining(fd_head->tvb_data, fd_i->offset);
@@ -1107,7 +1282,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 		THROW(BoundsError);
 	}
 	fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
-	LINK_FRAG(fd_head,fd);
+	fragment_index_link(fd_head,fd);
 
 
 	if( !(fd_head->flags & FD_DATALEN_SET) ){
@@ -1120,23 +1295,10 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 	/*
 	 * Check if we have received the entire fragment.
-	 * This is easy since the list is sorted and the head is faked.
-	 *
-	 * First, we compute the amount of contiguous data that's
-	 * available.  (The check for fd_i->offset <= max rules out
-	 * fragments that don't start before or at the end of the
-	 * previous fragment, i.e. fragments that have a gap between
-	 * them and the previous fragment.)
+	 * The index keeps track of the amount of contiguous data
+	 * that's available from the start.
 	 */
-	max = 0;
-	for (fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-		if ( ((fd_i->offset)<=max) &&
-			((fd_i->offset+fd_i->len)>max) ){
-			max = fd_i->offset+fd_i->len;
-		}
-	}
-
-	if (max < (fd_head->datalen)) {
+	if (fd_head->frag_index->contiguous < fd_head->datalen) {
 		/*
 		 * The amount of contiguous data we have is less than the
 		 * amount of data we're trying to reassemble, so we haven't
@@ -1148,17 +1310,30 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	/* we have received an entire packet, defragment it and
 	 * free all fragments
 	 */
+	fragment_index_free(fd_head);
+
+	/*
+	 * The reassembled data is a composite of the parts of the
+	 * fragments' data that end up in it; the composite takes over
+	 * that data.
+	 */
+	n_pieces = 0;
+	for (fd_i=fd_head;fd_i;fd_i=fd_i->next)
+		n_pieces++;
+	pieces = g_new(fragment_piece, n_pieces);
+	n_pieces = 0;
+	reassembled = tvb_new_composite();
+
 	/* store old data just in case */
 	old_tvb_data=fd_head->tvb_data;
-	data = (guint8 *) g_malloc(fd_head->datalen);
-	fd_head->tvb_data = tvb_new_real_data(data, fd_head->datalen, fd_head->datalen);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
 
 	/* add all data fragments */
 	for (dfpos=0,fd_i=fd_head;fd_i;fd_i=fd_i->next) {
 		if (fd_i->len) {
+			gboolean used = FALSE;
+
 			/*
-			 * The loop above that calculates max also
+			 * The contiguity check above also
 			 * ensures that the only gaps that exist here
 			 * are ones where a fragment starts past the
 			 * end of the reassembled datagram, and there's
@@ -1172,7 +1347,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			 *
 			 * Note that the "overlap" compare must only be
 			 * done for fragments with (offset+len) <= fd_head->datalen
-			 * and thus within the newly g_malloc'd buffer.
+			 * and thus within the reassembled data.
 			 */
 			if (fd_i->offset + fd_i->len > dfpos) {
 				if (fd_i->offset >= fd_head->datalen) {
@@ -1200,15 +1375,15 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 					 * already rejected fragments that
 					 * start past the end of the
 					 * reassembled datagram, and
-					 * the loop that calculated max
-					 * should have ruled out gaps,
+					 * the contiguity check should
+					 * have ruled out gaps,
 					 * but could fd_i->offset +
 					 * fd_i->len overflow?
 					 */
 					fd_head->error = "dfpos < offset";
 				} else if (dfpos - fd_i->offset > fd_i->len)
 					fd_head->error = "dfpos - offset > len";
-				else if (!fd_head->tvb_data)
+				else if (!fd_i->tvb_data)
 					fd_head->error = "no data";
 				else {
 					fraglen = fd_i->len;
@@ -1224,7 +1399,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 						 * added to the reassembly.
 						 *
 						 * Mark it as such, and only
-						 * copy from it what fits in
+						 * use from it what fits in
 						 * the packet.
 						 */
 						fd_i->flags    |= FD_TOOLONGFRAGMENT;
@@ -1236,10 +1411,8 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 						fd_i->flags    |= FD_OVERLAP;
 						fd_head->flags |= FD_OVERLAP;
-						if ( memcmp(data + fd_i->offset,
-								tvb_get_ptr(fd_i->tvb_data, 0, cmp_len),
-								cmp_len)
-								 ) {
+						if (!fragment_pieces_equal(pieces, n_pieces,
+								fd_i->offset, fd_i->tvb_data, cmp_len)) {
 							fd_i->flags    |= FD_OVERLAPCONFLICT;
 							fd_head->flags |= FD_OVERLAPCONFLICT;
 						}
@@ -1250,9 +1423,19 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 						 */
 						fd_head->error = "fraglen < dfpos - offset";
 					} else {
-						memcpy(data+dfpos,
-							tvb_get_ptr(fd_i->tvb_data, (dfpos-fd_i->offset), fraglen-(dfpos-fd_i->offset)),
-							fraglen-(dfpos-fd_i->offset));
+						guint32 skip = dfpos - fd_i->offset;
+						guint32 piece_len = fraglen - skip;
+
+						if (piece_len != 0) {
+							if (skip == 0 && piece_len == tvb_captured_length(fd_i->tvb_data))
+								pieces[n_pieces].tvb = fd_i->tvb_data;
+							else
+								pieces[n_pieces].tvb = tvb_new_subset_length(fd_i->tvb_data, skip, piece_len);
+							pieces[n_pieces].offset = dfpos;
+							tvb_composite_append(reassembled, pieces[n_pieces].tvb);
+							n_pieces++;
+							used = TRUE;
+						}
 						dfpos=MAX(dfpos, (fd_i->offset + fraglen));
 					}
 				}
@@ -1265,15 +1448,28 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 			if (fd_i->flags & FD_SUBSET_TVB)
 				fd_i->flags &= ~FD_SUBSET_TVB;
+			else if (fd_i->tvb_data && used)
+				tvb_add_to_chain(reassembled, fd_i->tvb_data);
 			else if (fd_i->tvb_data)
 				tvb_free(fd_i->tvb_data);
 
 			fd_i->tvb_data=NULL;
 		}
 	}
+	g_free(pieces);
 
+	if (n_pieces != 0) {
+		tvb_composite_finalize_unchained(reassembled);
+	} else {
+		/* Nothing to put together. */
+		tvb_free(reassembled);
+		reassembled = tvb_new_real_data(NULL, 0, 0);
+	}
+	/* fragments that were extended refer to the old data */
 	if (old_tvb_data)
-		tvb_add_to_chain(tvb, old_tvb_data);
+		tvb_add_to_chain(reassembled, old_tvb_data);
+	fd_head->tvb_data = reassembled;
+
 	/* mark this packet as defragmented.
 	   allows us to skip any trailing fragments */
 	fd_head->flags |= FD_DEFRAGMENTED;
@@ -1580,32 +1776,31 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 {
 	fragment_item *fd_i = NULL;
 	fragment_item *last_fd = NULL;
-	guint32  dfpos = 0, size = 0;
+	guint32  size = 0;
 	tvbuff_t *old_tvb_data = NULL;
-	guint8 *data;
+	tvbuff_t *reassembled;
 
-	for(fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-		if(!last_fd || last_fd->offset!=fd_i->offset){
-			size+=fd_i->len;
-		}
-		last_fd=fd_i;
-	}
+	fragment_index_free(fd_head);
 
 	/* store old data in case the fd_i->data pointers refer to it */
 	old_tvb_data=fd_head->tvb_data;
-	data = (guint8 *) g_malloc(size);
-	fd_head->tvb_data = tvb_new_real_data(data, size, size);
-	tvb_set_free_cb(fd_head->tvb_data, g_free);
-	fd_head->len = size;		/* record size for caller	*/
+
+	/*
+	 * The reassembled data is a composite of the fragments' data,
+	 * which it takes over.
+	 */
+	reassembled = tvb_new_composite();
 
 	/* add all data fragments */
-	last_fd=NULL;
 	for (fd_i=fd_head->next; fd_i; fd_i=fd_i->next) {
 		if (fd_i->len) {
 			if(!last_fd || last_fd->offset != fd_i->offset) {
 				/* First fragment or in-sequence fragment */
-				memcpy(data+dfpos, tvb_get_ptr(fd_i->tvb_data, 0, fd_i->len), fd_i->len);
-				dfpos += fd_i->len;
+				if (tvb_captured_length(fd_i->tvb_data) == fd_i->len)
+					tvb_composite_append(reassembled, fd_i->tvb_data);
+				else
+					tvb_composite_append(reassembled, tvb_new_subset_length(fd_i->tvb_data, 0, fd_i->len));
+				size += fd_i->len;
 			} else {
 				/* duplicate/retransmission/overlap */
 				fd_i->flags    |= FD_OVERLAP;
@@ -1620,16 +1815,32 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 		last_fd=fd_i;
 	}
 
-	/* we have defragmented the pdu, now free all fragments*/
+	/* we have defragmented the pdu, now hand the data of the
+	 * fragments that went into it over to it, and free the rest */
+	last_fd=NULL;
 	for (fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
 		if (fd_i->flags & FD_SUBSET_TVB)
 			fd_i->flags &= ~FD_SUBSET_TVB;
+		else if (fd_i->tvb_data && fd_i->len && (!last_fd || last_fd->offset != fd_i->offset))
+			tvb_add_to_chain(reassembled, fd_i->tvb_data);
 		else if (fd_i->tvb_data)
 			tvb_free(fd_i->tvb_data);
+		last_fd=fd_i;
 		fd_i->tvb_data=NULL;
 	}
+
+	if (size != 0) {
+		tvb_composite_finalize_unchained(reassembled);
+	} else {
+		/* Nothing to put together. */
+		tvb_free(reassembled);
+		reassembled = tvb_new_real_data(NULL, 0, 0);
+	}
+	/* fragments that were extended refer to the old data */
 	if (old_tvb_data)
-		tvb_free(old_tvb_data);
+		tvb_add_to_chain(reassembled, old_tvb_data);
+	fd_head->tvb_data = reassembled;
+	fd_head->len = size;		/* record size for caller	*/
 
 	/* mark this packet as defragmented.
 	 * allows us to skip any trailing fragments.
@@ -1669,12 +1880,14 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			frag_number_work = frag_number - fd_head->fragment_nr_offset;
 
 	/* if the partial reassembly flag has been set, and we are extending
-	 * the pdu, un-reassemble the pdu. This means pointing old fds to malloc'ed data.
+	 * the pdu, un-reassemble the pdu. This means pointing old fds to a copy
+	 * of the reassembled data.
 	 */
 	if(fd_head->flags & FD_DEFRAGMENTED && frag_number_work >= fd_head->datalen &&
 		fd_head->flags & FD_PARTIAL_REASSEMBLY){
 		guint32 lastdfpos = 0;
 		dfpos = 0;
+		fragment_flatten_reassembled(fd_head, tvb);
 		for(fd_i=fd_head->next; fd_i; fd_i=fd_i->next){
 			if( !fd_i->tvb_data ) {
 				if( fd_i->flags & FD_OVERLAP ) {
@@ -1706,6 +1919,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->offset = frag_number_work;
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
+	fd->frag_index = NULL;
 	fd->error = NULL;
 
 	/* fd_head->frame is the maximum of the frame numbers of all the
@@ -1842,7 +2056,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 		fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
 	}
-	LINK_FRAG(fd_head,fd);
+	fragment_index_link(fd_head,fd);
 
 
 	if( !(fd_head->flags & FD_DATALEN_SET) ){
@@ -1855,15 +2069,9 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 
 	/* check if we have received the entire fragment
-	 * this is easy since the list is sorted and the head is faked.
-	 * common case the whole list is scanned.
+	 * the index keeps track of the first missing sequence number.
 	 */
-	max = 0;
-	for(fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-	  if ( fd_i->offset==max ){
-		max++;
-	  }
-	}
+	max = fd_head->frag_index->contiguous;
 	/* max will now be datalen+1 if all fragments have been seen */
 
 	if (max <= fd_head->datalen) {
@@ -2160,6 +2368,8 @@ fragment_add_seq_single_move(reassembly_table *table, const packet_info *pinfo,
 		/* Don't take a reassembly starting with a First fragment. */
 		fd = new_fh->next;
 		if (fd && fd->offset != 0) {
+			fragment_index_free(fh);
+			fragment_index_free(new_fh);
 			prev_fd->next = fd;
 			for (; fd; fd=fd->next) {
 				fd->offset += offset;
@@ -2238,6 +2448,7 @@ fragment_add_seq_single_work(reassembly_table *table, tvbuff_t *tvb,
 						new_fh->frame = fd->frame;
 					}
 				}
+				fragment_index_free(new_fh);
 				prev_fd->next = NULL;
 				break;
 			}
@@ -2320,6 +2531,7 @@ fragment_add_seq_single_work(reassembly_table *table, tvbuff_t *tvb,
 		 * looped around on the sequence numbers. It can also happen
 		 * if bit errors mess up Last or First. */
 		if (fd != NULL) {
+			fragment_index_free(fh);
 			prev_fd->next = NULL;
 			fh->frame = 0;
 			for (prev_fd=fh->next; prev_fd; prev_fd=prev_fd->next) {
@@ -2463,6 +2675,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 		fd_head->reas_in_layer_num = 0;
 		fd_head->flags = FD_BLOCKSEQUENCE|FD_DATALEN_SET;
 		fd_head->tvb_data = NULL;
+		fd_head->frag_index = NULL;
 		fd_head->error = NULL;
 
 		insert_fd_head(table, fd_head, pinfo, id, data);
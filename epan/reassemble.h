@@ -85,7 +85,16 @@ typedef struct _fragment_item {
 	guint32 flags;			/**< XXX - do some of these apply only to reassembly
 					 * heads and others only to fragments within
 					 * a reassembly? */
-	tvbuff_t *tvb_data;
+	tvbuff_t *tvb_data;		/**< In a fragment, its data, until the PDU is
+					 * defragmented. In the first item of the list,
+					 * the reassembled PDU once FD_DEFRAGMENTED is
+					 * set, normally a composite tvbuff over the
+					 * data of the fragments rather than a copy. */
+	struct _fragment_index *frag_index; /**< Only in the first item of the list,
+					 * while fragments are being added: finds the
+					 * place of a fragment in the list, and how much
+					 * of the PDU is there, without walking it.
+					 * Private to reassemble.c. */
 	/**
 	 * Null if the reassembly had no error; non-null if it had
 	 * an error, in which case it's the string for the error.
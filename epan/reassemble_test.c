@@ -2,7 +2,7 @@
  * Standalone program to test functionality of reassemble.h API
  *
  * These aren't particularly complete - they just test a few corners of
- * functionality which I was interested in. In particular, they only test the
+ * functionality which I was interested in. In particular, they mostly test the
  * fragment_add_seq_* (ie, FD_BLOCKSEQUENCE) family of routines. However,
  * hopefully they will inspire people to write additional tests, and provide a
  * useful basis on which to do so.
@@ -1523,6 +1523,299 @@ test_missing_data_fragment_add_seq_next_3(void)
 #endif
 
 
+/**********************************************************************************
+ *
+ * fragment_add (byte offsets)
+ *
+ *********************************************************************************/
+
+/* Simple test case for fragment_add.
+ * Adds three fragments out of order and checks that they are reassembled
+ * correctly.
+ *
+ *   frame  frag_offset  len  more  tvb_offset
+ *     1         0        50   T       10
+ *     2       110        60   F       15
+ *     3        50        60   T       60
+ */
+static void
+test_simple_fragment_add(void)
+{
+    fragment_head *fd_head, *fdh0;
+
+    printf("Starting test test_simple_fragment_add\n");
+
+    pinfo.num = 1;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                         0, 50, TRUE);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 2;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 15, &pinfo, 12, NULL,
+                         110, 60, FALSE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 3;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 60, &pinfo, 12, NULL,
+                         50, 60, TRUE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+
+    /* check the contents of the structure */
+    ASSERT_EQ(3,fd_head->frame);  /* max frame number of fragment in assembly */
+    ASSERT_EQ(0,fd_head->offset); /* unused */
+    ASSERT_EQ(170,fd_head->datalen); /* total length of the datagram */
+    ASSERT_EQ(3,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT_NE_POINTER(NULL,fd_head->tvb_data);
+    ASSERT_EQ(170,tvb_captured_length(fd_head->tvb_data));
+    ASSERT_NE_POINTER(NULL,fd_head->next);
+
+    /* the fragments are kept in order of their offsets */
+    ASSERT_EQ(1,fd_head->next->frame);
+    ASSERT_EQ(0,fd_head->next->offset);
+    ASSERT_EQ(50,fd_head->next->len);
+    ASSERT_EQ(0,fd_head->next->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->tvb_data);
+    ASSERT_NE_POINTER(NULL,fd_head->next->next);
+
+    ASSERT_EQ(3,fd_head->next->next->frame);
+    ASSERT_EQ(50,fd_head->next->next->offset);
+    ASSERT_EQ(60,fd_head->next->next->len);
+    ASSERT_EQ(0,fd_head->next->next->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->next->tvb_data);
+    ASSERT_NE_POINTER(NULL,fd_head->next->next->next);
+
+    ASSERT_EQ(2,fd_head->next->next->next->frame);
+    ASSERT_EQ(110,fd_head->next->next->next->offset);
+    ASSERT_EQ(60,fd_head->next->next->next->len);
+    ASSERT_EQ(0,fd_head->next->next->next->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->next->next->tvb_data);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->next->next->next);
+
+    /* test the actual reassembly */
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+10,50));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,50,data+60,60));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,110,data+15,60));
+
+    /* revisiting any of the packets gives the same reassembly */
+    fdh0 = fd_head;
+    pinfo.fd->flags.visited = 1;
+    pinfo.num = 1;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                         0, 50, TRUE);
+    ASSERT_EQ_POINTER(fdh0,fd_head);
+
+    pinfo.num = 3;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 60, &pinfo, 12, NULL,
+                         50, 60, TRUE);
+    ASSERT_EQ_POINTER(fdh0,fd_head);
+}
+
+/* Overlapping fragments for fragment_add.
+ *
+ * Datagram 12 has a fragment that overlaps the first one with the same data,
+ * datagram 13 the same fragment but with different data.
+ *
+ *   frame  id  frag_offset  len  more  tvb_offset
+ *     1    12       0        60   T       10
+ *     2    12     110        60   F      120
+ *     3    12      50        60   T       60
+ *     4    13       0        60   T       10
+ *     5    13     110        60   F      120
+ *     6    13      50        60   T       61
+ */
+static void
+test_fragment_add_overlap(void)
+{
+    fragment_head *fd_head;
+
+    printf("Starting test test_fragment_add_overlap\n");
+
+    pinfo.num = 1;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                         0, 60, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 2;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 120, &pinfo, 12, NULL,
+                         110, 60, FALSE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 3;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 60, &pinfo, 12, NULL,
+                         50, 60, TRUE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+
+    ASSERT_EQ(170,fd_head->datalen);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET|FD_OVERLAP,fd_head->flags);
+    ASSERT_EQ(0,fd_head->next->flags);
+    ASSERT_EQ(50,fd_head->next->next->offset);
+    ASSERT_EQ(FD_OVERLAP,fd_head->next->next->flags);
+    ASSERT_EQ(0,fd_head->next->next->next->flags);
+    ASSERT_EQ(170,tvb_captured_length(fd_head->tvb_data));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+10,170));
+
+    /* the same again, but the overlapping data differs */
+    pinfo.num = 4;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 10, &pinfo, 13, NULL,
+                         0, 60, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 5;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 120, &pinfo, 13, NULL,
+                         110, 60, FALSE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 6;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 61, &pinfo, 13, NULL,
+                         50, 60, TRUE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+
+    ASSERT_EQ(170,fd_head->datalen);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET|FD_OVERLAP|FD_OVERLAPCONFLICT,fd_head->flags);
+    ASSERT_EQ(FD_OVERLAP|FD_OVERLAPCONFLICT,fd_head->next->next->flags);
+
+    /* the data of the first fragment wins */
+    ASSERT_EQ(170,tvb_captured_length(fd_head->tvb_data));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+10,60));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,60,data+71,50));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,110,data+120,60));
+}
+
+/* tvb_get_ptr() of a range spanning fragments of a reassembled datagram
+ * copies only that range: the datagram isn't put in one piece, so ranges
+ * within a fragment still point at the fragment's data.
+ *
+ *   frame  frag_offset  len  more  tvb_offset
+ *     1         0        50   T       10
+ *     2        50        60   F       60
+ */
+static void
+test_fragment_add_get_ptr_across_fragments(void)
+{
+    fragment_head *fd_head;
+    const guint8 *ptr;
+
+    printf("Starting test test_fragment_add_get_ptr_across_fragments\n");
+
+    pinfo.num = 1;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                         0, 50, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 2;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 60, &pinfo, 12, NULL,
+                         50, 60, FALSE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(110,tvb_captured_length(fd_head->tvb_data));
+
+    ptr = tvb_get_ptr(fd_head->tvb_data,0,10);
+    ASSERT(!memcmp(ptr,data+10,10));
+
+    /* 5 bytes from each fragment */
+    ASSERT(!memcmp(tvb_get_ptr(fd_head->tvb_data,45,10),data+55,10));
+
+    ASSERT_EQ_POINTER(ptr,tvb_get_ptr(fd_head->tvb_data,0,10));
+    ASSERT(!memcmp(tvb_get_ptr(fd_head->tvb_data,100,10),data+110,10));
+}
+
+/* Lots of small fragments for fragment_add, the last one first.
+ */
+#define N_SMALL_FRAGS   64
+#define SMALL_FRAG_LEN  (DATA_LEN/N_SMALL_FRAGS)
+
+static void
+test_fragment_add_many_reversed(void)
+{
+    fragment_head *fd_head = NULL;
+    fragment_item *fd;
+    int i;
+
+    printf("Starting test test_fragment_add_many_reversed\n");
+
+    for (i = N_SMALL_FRAGS-1; i >= 0; i--) {
+        pinfo.num = N_SMALL_FRAGS - i;
+        fd_head=fragment_add(&test_reassembly_table, tvb, i*SMALL_FRAG_LEN, &pinfo, 14, NULL,
+                             i*SMALL_FRAG_LEN, SMALL_FRAG_LEN, i != N_SMALL_FRAGS-1);
+        if (i != 0)
+            ASSERT_EQ_POINTER(NULL,fd_head);
+    }
+    ASSERT_NE_POINTER(NULL,fd_head);
+
+    ASSERT_EQ(N_SMALL_FRAGS,fd_head->frame);
+    ASSERT_EQ(DATA_LEN,fd_head->datalen);
+    ASSERT_EQ(N_SMALL_FRAGS,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+
+    for (i = 0, fd = fd_head->next; fd; i++, fd = fd->next) {
+        ASSERT_EQ(N_SMALL_FRAGS - i,fd->frame);
+        ASSERT_EQ(i*SMALL_FRAG_LEN,fd->offset);
+        ASSERT_EQ(SMALL_FRAG_LEN,fd->len);
+        ASSERT_EQ(0,fd->flags);
+        ASSERT_EQ_POINTER(NULL,fd->tvb_data);
+    }
+    ASSERT_EQ(N_SMALL_FRAGS,i);
+
+    ASSERT_EQ(DATA_LEN,tvb_captured_length(fd_head->tvb_data));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,DATA_LEN));
+    ASSERT_EQ(0x42,tvb_get_guint8(fd_head->tvb_data,0x42));
+}
+
+/* fragment_set_partial_reassembly for fragment_add: a reassembled datagram
+ * is extended by another fragment.
+ *
+ *   frame  frag_offset  len  more  tvb_offset
+ *     1         0        50   F        0
+ *     2        50        40   F      100
+ */
+static void
+test_fragment_add_partial_reassembly(void)
+{
+    fragment_head *fd_head;
+
+    printf("Starting test test_fragment_add_partial_reassembly\n");
+
+    pinfo.num = 1;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 0, &pinfo, 12, NULL,
+                         0, 50, FALSE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(50,fd_head->datalen);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,50));
+
+    /* we want more data */
+    fragment_set_partial_reassembly(&test_reassembly_table, &pinfo, 12, NULL);
+
+    pinfo.num = 2;
+    fd_head=fragment_add(&test_reassembly_table, tvb, 100, &pinfo, 12, NULL,
+                         50, 40, FALSE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+
+    ASSERT_EQ(2,fd_head->frame);
+    ASSERT_EQ(90,fd_head->datalen);
+    ASSERT_EQ(2,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+
+    ASSERT_EQ(1,fd_head->next->frame);
+    ASSERT_EQ(0,fd_head->next->offset);
+    ASSERT_EQ(50,fd_head->next->len);
+    ASSERT_EQ(0,fd_head->next->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->tvb_data);
+
+    ASSERT_EQ(2,fd_head->next->next->frame);
+    ASSERT_EQ(50,fd_head->next->next->offset);
+    ASSERT_EQ(40,fd_head->next->next->len);
+    ASSERT_EQ(0,fd_head->next->next->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->next->tvb_data);
+    ASSERT_EQ_POINTER(NULL,fd_head->next->next->next);
+
+    ASSERT_EQ(90,tvb_captured_length(fd_head->tvb_data));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data,50));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,50,data+100,40));
+}
+
+
 /**********************************************************************************
  *
  * main
@@ -1547,6 +1840,11 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_seq_802_11_0,
         test_fragment_add_seq_802_11_1,
         test_simple_fragment_add_seq_next,
+        test_simple_fragment_add,                  /* byte offsets      */
+        test_fragment_add_overlap,
+        test_fragment_add_many_reversed,
+        test_fragment_add_get_ptr_across_fragments,
+        test_fragment_add_partial_reassembly,
 #if 0
         test_missing_data_fragment_add_seq_next,
         test_missing_data_fragment_add_seq_next_2,
@@ -838,6 +838,34 @@ tvb_get_ptr(tvbuff_t *tvb, const gint offset, const gint length)
 	return ensure_contiguous(tvb, offset, length);
 }
 
+void
+tvb_region_init(tvb_region_t *region, tvbuff_t *tvb, const gint offset, const gint length)
+{
+	guint abs_offset = 0, abs_length = 0;
+
+	DISSECTOR_ASSERT(tvb && tvb->initialized);
+	DISSECTOR_ASSERT(length >= 0);
+
+	region->tvb    = tvb;
+	region->offset = offset;
+	region->length = 0;
+	region->data   = NULL;
+
+	/*
+	 * Only regions of real data get the fast path; getting a pointer
+	 * into a composite tvbuff can mean copying all of it, and the
+	 * accessors are as good as the region then. Negative offsets
+	 * are left to the accessors, too.
+	 */
+	if (offset < 0 || !tvb->real_data)
+		return;
+	if (check_offset_length_no_exception(tvb, offset, length, &abs_offset, &abs_length) != 0)
+		return;
+
+	region->length = abs_length;
+	region->data   = tvb->real_data + abs_offset;
+}
+
 /* ---------------- */
 guint8
 tvb_get_guint8(tvbuff_t *tvb, const gint offset)
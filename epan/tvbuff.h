@@ -39,6 +39,7 @@
 #include <epan/ipv6.h>
 
 #include <wsutil/nstime.h>
+#include <wsutil/pint.h>
 #include "wsutil/ws_mempbrk.h"
 
 #ifdef __cplusplus
@@ -220,6 +221,11 @@ WS_DLL_PUBLIC tvbuff_t *tvb_new_composite(void);
  * occur, data access can finally happen after this finalization. */
 WS_DLL_PUBLIC void tvb_composite_finalize(tvbuff_t *tvb);
 
+/** Like tvb_composite_finalize(), but doesn't chain the composite tvbuff
+ * to its first member; the caller is responsible for freeing the members,
+ * for example by chaining them to the composite tvbuff. */
+extern void tvb_composite_finalize_unchained(tvbuff_t *tvb);
+
 
 /* Get amount of captured data in the buffer (which is *NOT* necessarily the
  * length of the packet). You probably want tvb_reported_length instead. */
@@ -347,6 +353,111 @@ WS_DLL_PUBLIC gdouble tvb_get_ieee_double(tvbuff_t *tvb, const gint offset, cons
 #error "Unsupported byte order"
 #endif
 
+/************** REGIONS ****************/
+/*
+ * A region is a range of a tvbuff, typically a fixed-size header, whose
+ * bounds are checked once, by tvb_region_init(), rather than by each
+ * accessor. The tvb_region_get_* accessors take the same offsets as the
+ * tvb_get_* ones, and return the same values; reading data within a
+ * region that was all there takes neither a function call nor any
+ * exception handling.
+ *
+ * Reading outside the region, or from a region that wasn't all there
+ * (say, because of the snapshot length), falls back to the tvb_get_*
+ * accessor, so exceptions are thrown exactly where they would have been
+ * without the region; there's no need to check anything beforehand.
+ */
+typedef struct tvb_region {
+	tvbuff_t     *tvb;
+	gint          offset;	/* start of the region in tvb */
+	guint         length;	/* 0 if the data wasn't all there */
+	const guint8 *data;	/* the data at offset, if it was */
+} tvb_region_t;
+
+/** Sets up a region for the given range of tvb. Never throws an
+ * exception; length can't be -1. */
+WS_DLL_PUBLIC void tvb_region_init(tvb_region_t *region, tvbuff_t *tvb,
+    const gint offset, const gint length);
+
+static inline gboolean
+tvb_region_contains(const tvb_region_t *region, const gint offset, const guint length)
+{
+	return region->length >= length &&
+	    (guint)(offset - region->offset) <= region->length - length;
+}
+
+static inline guint8
+tvb_region_get_guint8(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 1)))
+		return region->data[offset - region->offset];
+	return tvb_get_guint8(region->tvb, offset);
+}
+
+static inline guint16
+tvb_region_get_ntohs(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 2)))
+		return pntoh16(region->data + (offset - region->offset));
+	return tvb_get_ntohs(region->tvb, offset);
+}
+
+static inline guint32
+tvb_region_get_ntoh24(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 3)))
+		return pntoh24(region->data + (offset - region->offset));
+	return tvb_get_ntoh24(region->tvb, offset);
+}
+
+static inline guint32
+tvb_region_get_ntohl(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 4)))
+		return pntoh32(region->data + (offset - region->offset));
+	return tvb_get_ntohl(region->tvb, offset);
+}
+
+static inline guint64
+tvb_region_get_ntoh64(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 8)))
+		return pntoh64(region->data + (offset - region->offset));
+	return tvb_get_ntoh64(region->tvb, offset);
+}
+
+static inline guint16
+tvb_region_get_letohs(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 2)))
+		return pletoh16(region->data + (offset - region->offset));
+	return tvb_get_letohs(region->tvb, offset);
+}
+
+static inline guint32
+tvb_region_get_letoh24(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 3)))
+		return pletoh24(region->data + (offset - region->offset));
+	return tvb_get_letoh24(region->tvb, offset);
+}
+
+static inline guint32
+tvb_region_get_letohl(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 4)))
+		return pletoh32(region->data + (offset - region->offset));
+	return tvb_get_letohl(region->tvb, offset);
+}
+
+static inline guint64
+tvb_region_get_letoh64(const tvb_region_t *region, const gint offset)
+{
+	if (G_LIKELY(tvb_region_contains(region, offset, 8)))
+		return pletoh64(region->data + (offset - region->offset));
+	return tvb_get_letoh64(region->tvb, offset);
+}
+
 
 /* Fetch a time value from an ASCII-style string in the tvb.
  *
@@ -867,6 +978,9 @@ WS_DLL_PUBLIC gint tvb_find_tvb(tvbuff_t *haystack_tvb, tvbuff_t *needle_tvb,
  * Uncompresses a zlib compressed packet inside a tvbuff at offset with
  * length comprlen.  Returns an uncompressed tvbuffer if uncompression
  * succeeded or NULL if uncompression failed.
+ *
+ * The uncompressed data isn't kept; it's uncompressed again, a chunk at a
+ * time, as it's accessed.
  */
 WS_DLL_PUBLIC tvbuff_t *tvb_uncompress(tvbuff_t *tvb, const int offset,
     int comprlen);
@@ -29,13 +29,26 @@
 
 typedef struct {
 	GSList		*tvbs;
-
-	/* Used for quick testing to see if this
-	 * is the tvbuff that a COMPOSITE is
-	 * interested in. */
+	GSList		*tvbs_tail;
+
+	/* Filled in when the composite is finalized: the members
+	 * in an array, along with the range of offsets each of them
+	 * covers, so that the member holding an offset can be found
+	 * with a binary search. */
+	guint		num_members;
+	tvbuff_t	**members;
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* The member that satisfied the last lookup; accesses tend
+	 * to be sequential, so it's tried first. */
+	guint		last_member;
+
+	/* Copies of ranges spanning members that tvb_get_ptr() has been
+	 * asked for; they stay around as long as the tvbuff does, as the
+	 * pointers to them may still be in use. */
+	GSList		*spans;
+
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -49,9 +62,15 @@ composite_free(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
+	GSList *span;
 
 	g_slist_free(composite->tvbs);
 
+	for (span = composite->spans; span != NULL; span = g_slist_next(span))
+		g_free(span->data);
+	g_slist_free(composite->spans);
+
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
 	if (tvb->real_data) {
@@ -66,57 +85,96 @@ static guint
 composite_offset(const tvbuff_t *tvb, const guint counter)
 {
 	const struct tvb_composite *composite_tvb = (const struct tvb_composite *) tvb;
-	const tvbuff_t *member = (const tvbuff_t *)composite_tvb->composite.tvbs->data;
+	const tvbuff_t *member = composite_tvb->composite.members[0];
 
 	return tvb_offset_from_real_beginning_counter(member, counter);
 }
 
+/*
+ * Returns the index of the member that holds abs_offset, or num_members
+ * if abs_offset is at (or past) the end of the composite.
+ */
+static guint
+composite_find_member(tvb_comp_t *composite, const guint abs_offset)
+{
+	guint i = composite->last_member;
+	guint low, high, mid;
+
+	/* The last member we used, or the one after it? */
+	if (abs_offset >= composite->start_offsets[i]) {
+		if (abs_offset <= composite->end_offsets[i])
+			return i;
+		if (i + 1 < composite->num_members && abs_offset <= composite->end_offsets[i + 1]) {
+			composite->last_member = i + 1;
+			return i + 1;
+		}
+	}
+
+	/* Find the first member that ends at or after abs_offset. */
+	low = 0;
+	high = composite->num_members;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (composite->end_offsets[mid] < abs_offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low < composite->num_members)
+		composite->last_member = low;
+	return low;
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
+	if (abs_length <= member_tvb->length - member_offset) {
 		/*
 		 * The range is, in fact, contiguous within member_tvb.
 		 */
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
+	else if (abs_offset != 0 || abs_length != tvb->length) {
+		/*
+		 * The range spans members; copy just that range into a
+		 * piece of its own, rather than the whole tvbuff, as the
+		 * members stay around anyway.
+		 */
+		void *span = g_malloc(abs_length);
+		tvb_memcpy(tvb, span, abs_offset, abs_length);
+		composite->spans = g_slist_prepend(composite->spans, span);
+		return (const guint8 *)span;
+	}
 	else {
 		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
 		void *real_data = g_malloc(tvb->length);
 		tvb_memcpy(tvb, real_data, 0, tvb->length);
 		tvb->real_data = (const guint8 *)real_data;
-		return tvb->real_data + abs_offset;
+		return tvb->real_data;
 	}
 
 	DISSECTOR_ASSERT_NOT_REACHED();
@@ -128,63 +186,53 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
+	if (abs_length <= member_tvb->length - member_offset) {
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
 	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
-		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
 
-		/* composite_memcpy() can't handle a member_length of zero. */
-		DISSECTOR_ASSERT(member_length > 0);
+	/* The requested data is non-contiguous inside
+	 * the member tvb. We have to memcpy() the part that's in the member tvb,
+	 * then iterate across the following member tvb's, copying their portions
+	 * until we have copied all data.
+	 */
+	while (abs_length > 0) {
+		/* the length was checked against the composite's, so
+		 * we can't run out of members */
+		DISSECTOR_ASSERT(i < composite->num_members);
+		member_tvb = composite->members[i];
+		member_length = MIN(member_tvb->length - member_offset, abs_length);
 
 		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
+		target		+= member_length;
 		abs_length	-= member_length;
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
-
-		return target;
+		member_offset = 0;
+		i++;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return _target;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -215,8 +263,13 @@ tvb_new_composite(void)
 	tvb_comp_t *composite = &composite_tvb->composite;
 
 	composite->tvbs		 = NULL;
+	composite->tvbs_tail	 = NULL;
+	composite->num_members	 = 0;
+	composite->members	 = NULL;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
+	composite->last_member	 = 0;
+	composite->spans	 = NULL;
 
 	return tvb;
 }
@@ -235,8 +288,16 @@ tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
 	 */
 	DISSECTOR_ASSERT(member->length);
 
-	composite       = &composite_tvb->composite;
-	composite->tvbs = g_slist_append(composite->tvbs, member);
+	composite = &composite_tvb->composite;
+	/* Keep track of the tail, as the members are usually added
+	 * one by one */
+	if (composite->tvbs_tail) {
+		composite->tvbs_tail = g_slist_append(composite->tvbs_tail, member);
+		composite->tvbs_tail = composite->tvbs_tail->next;
+	} else {
+		composite->tvbs = g_slist_append(composite->tvbs, member);
+		composite->tvbs_tail = composite->tvbs;
+	}
 }
 
 void
@@ -255,10 +316,12 @@ tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
 
 	composite       = &composite_tvb->composite;
 	composite->tvbs = g_slist_prepend(composite->tvbs, member);
+	if (!composite->tvbs_tail)
+		composite->tvbs_tail = composite->tvbs;
 }
 
-void
-tvb_composite_finalize(tvbuff_t *tvb)
+static void
+composite_finalize(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	GSList	   *slist;
@@ -281,12 +344,15 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->num_members = num_members;
+	composite->members = g_new(tvbuff_t *, num_members);
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
 	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
 		DISSECTOR_ASSERT((guint) i < num_members);
 		member_tvb = (tvbuff_t *)slist->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
@@ -296,11 +362,25 @@ tvb_composite_finalize(tvbuff_t *tvb)
 
 	DISSECTOR_ASSERT(composite->tvbs);
 
-	tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb); /* chain composite tvb to first member */
 	tvb->initialized = TRUE;
 	tvb->ds_tvb = tvb;
 }
 
+void
+tvb_composite_finalize(tvbuff_t *tvb)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+
+	composite_finalize(tvb);
+	tvb_add_to_chain((tvbuff_t *)composite_tvb->composite.tvbs->data, tvb); /* chain composite tvb to first member */
+}
+
+void
+tvb_composite_finalize_unchained(tvbuff_t *tvb)
+{
+	composite_finalize(tvb);
+}
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
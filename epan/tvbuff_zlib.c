@@ -33,35 +33,327 @@
 #endif
 
 #include "tvbuff.h"
+#include "tvbuff-int.h"
+#include "proto.h"	/* XXX - only used for DISSECTOR_ASSERT, probably a new header file? */
+#include "exceptions.h"
 #ifdef TVB_Z_DEBUG
 #include <wsutil/ws_printf.h> /* ws_debug_printf */
 #endif
 
 #ifdef HAVE_ZLIB
 /*
- * Uncompresses a zlib compressed packet inside a message of tvb at offset with
- * length comprlen.  Returns an uncompressed tvbuffer if uncompression
- * succeeded or NULL if uncompression failed.
+ * The uncompressed data isn't kept in one piece; it's uncompressed a
+ * chunk at a time, when something in that chunk is accessed.
+ *
+ * To find out how long the uncompressed data is, it's uncompressed
+ * once when the tvbuff is created, without keeping the output. Every
+ * TVB_Z_CHECKPOINT_INTERVAL bytes the state of the stream is saved,
+ * so that getting at data further on doesn't require uncompressing
+ * everything in front of it again.
  */
-#define TVB_Z_MIN_BUFSIZ 32768
-#define TVB_Z_MAX_BUFSIZ 1048576 * 10
+#define TVB_Z_CHUNK_SIZE		65536
+#define TVB_Z_CHECKPOINT_INTERVAL	(64 * TVB_Z_CHUNK_SIZE)
 /* #define TVB_Z_DEBUG 1 */
 #undef TVB_Z_DEBUG
 
+struct tvb_zlib {
+	struct tvbuff tvb;
+
+	/* The compressed data, and where the stream starts in it
+	 * (past a gzip header, if any) */
+	guint8		*compr;
+	guint8		*next_in;
+	guint		avail_in;
+	gint		wbits;
+
+	/* The chunks of uncompressed data that have been asked for;
+	 * they stay around as long as the tvbuff does, as
+	 * tvb_get_ptr() may have handed out pointers into them. */
+	guint8		**chunks;
+	guint		num_chunks;
+
+	/* Copies of ranges spanning chunks that tvb_get_ptr() has been
+	 * asked for; like the chunks, they stay around as long as the
+	 * tvbuff does. */
+	GSList		*spans;
+
+	/* The stream that's used to uncompress chunks, and the offset
+	 * in the uncompressed data that it has got to */
+	z_streamp	strm;
+	guint		strm_offset;
+
+	/* The stream state at every TVB_Z_CHECKPOINT_INTERVAL bytes */
+	z_streamp	*checkpoints;
+	guint		num_checkpoints;
+};
+
+static void
+zlib_free_streams(struct tvb_zlib *zlib_tvb)
+{
+	guint i;
+
+	if (zlib_tvb->strm) {
+		inflateEnd(zlib_tvb->strm);
+		g_free(zlib_tvb->strm);
+		zlib_tvb->strm = NULL;
+	}
+	for (i = 0; i < zlib_tvb->num_checkpoints; i++) {
+		inflateEnd(zlib_tvb->checkpoints[i]);
+		g_free(zlib_tvb->checkpoints[i]);
+	}
+	g_free(zlib_tvb->checkpoints);
+	zlib_tvb->checkpoints = NULL;
+	zlib_tvb->num_checkpoints = 0;
+}
+
+static void
+zlib_free(tvbuff_t *tvb)
+{
+	struct tvb_zlib *zlib_tvb = (struct tvb_zlib *) tvb;
+	GSList *span;
+	guint i;
+
+	for (i = 0; i < zlib_tvb->num_chunks; i++)
+		g_free(zlib_tvb->chunks[i]);
+	g_free(zlib_tvb->chunks);
+	for (span = zlib_tvb->spans; span != NULL; span = g_slist_next(span))
+		g_free(span->data);
+	g_slist_free(zlib_tvb->spans);
+
+	zlib_free_streams(zlib_tvb);
+
+	wmem_free(NULL, zlib_tvb->compr);
+
+	if (tvb->real_data) {
+		/*
+		 * XXX - do this with a union?
+		 */
+		g_free((gpointer)tvb->real_data);
+	}
+}
+
+static guint
+zlib_offset(const tvbuff_t *tvb _U_, const guint counter)
+{
+	return counter;
+}
+
+/*
+ * Gets the stream to offset TVB_Z_CHECKPOINT_INTERVAL * checkpoint in
+ * the uncompressed data.
+ */
+static void
+zlib_stream_restart(struct tvb_zlib *zlib_tvb, guint checkpoint)
+{
+	gint err;
+
+	if (zlib_tvb->strm)
+		inflateEnd(zlib_tvb->strm);
+	else
+		zlib_tvb->strm = g_new0(z_stream, 1);
+
+	if (checkpoint == 0) {
+		memset(zlib_tvb->strm, 0, sizeof(z_stream));
+		zlib_tvb->strm->next_in  = zlib_tvb->next_in;
+		zlib_tvb->strm->avail_in = zlib_tvb->avail_in;
+		err = inflateInit2(zlib_tvb->strm, zlib_tvb->wbits);
+	} else {
+		err = inflateCopy(zlib_tvb->strm, zlib_tvb->checkpoints[checkpoint - 1]);
+	}
+	if (err != Z_OK) {
+		/* Out of memory; the stream is no use to anyone. */
+		g_free(zlib_tvb->strm);
+		zlib_tvb->strm = NULL;
+		THROW(OutOfMemoryError);
+	}
+	zlib_tvb->strm_offset = checkpoint * TVB_Z_CHECKPOINT_INTERVAL;
+}
+
+/*
+ * Uncompresses the next len bytes of the stream into target.
+ */
+static void
+zlib_stream_read(struct tvb_zlib *zlib_tvb, guint8 *target, guint len)
+{
+	z_streamp strm = zlib_tvb->strm;
+
+	strm->next_out  = target;
+	strm->avail_out = len;
+	while (strm->avail_out > 0) {
+		if (inflate(strm, Z_SYNC_FLUSH) != Z_OK)
+			break;
+	}
+
+	/*
+	 * We only ever ask for data that was there when the length was
+	 * determined, so the stream can't end or fail in front of it.
+	 */
+	if (strm->avail_out != 0) {
+		/* Don't carry on from wherever the stream got to. */
+		zlib_tvb->strm_offset = G_MAXUINT;
+		DISSECTOR_ASSERT_NOT_REACHED();
+	}
+	zlib_tvb->strm_offset += len;
+}
+
+static const guint8 *
+zlib_get_chunk(struct tvb_zlib *zlib_tvb, guint chunk)
+{
+	guint   chunk_offset, chunk_len, checkpoint;
+	guint8 *data;
+
+	if (zlib_tvb->chunks[chunk])
+		return zlib_tvb->chunks[chunk];
+
+	chunk_offset = chunk * TVB_Z_CHUNK_SIZE;
+	chunk_len = MIN(TVB_Z_CHUNK_SIZE, zlib_tvb->tvb.length - chunk_offset);
+
+	/*
+	 * Carry on with the stream if it isn't past the chunk, and
+	 * no checkpoint gets us any closer to it; otherwise start
+	 * over from the closest checkpoint.
+	 */
+	checkpoint = MIN(chunk_offset / TVB_Z_CHECKPOINT_INTERVAL, zlib_tvb->num_checkpoints);
+	if (!zlib_tvb->strm || zlib_tvb->strm_offset > chunk_offset ||
+	    zlib_tvb->strm_offset < checkpoint * TVB_Z_CHECKPOINT_INTERVAL)
+		zlib_stream_restart(zlib_tvb, checkpoint);
+
+	data = (guint8 *)g_malloc(chunk_len);
+
+	/* skip what's in front of the chunk */
+	while (zlib_tvb->strm_offset < chunk_offset)
+		zlib_stream_read(zlib_tvb, data, MIN(chunk_len, chunk_offset - zlib_tvb->strm_offset));
+
+	zlib_stream_read(zlib_tvb, data, chunk_len);
+	zlib_tvb->chunks[chunk] = data;
+
+	return data;
+}
+
+static void *
+zlib_memcpy(tvbuff_t *tvb, void *_target, guint abs_offset, guint abs_length)
+{
+	struct tvb_zlib *zlib_tvb = (struct tvb_zlib *) tvb;
+	guint8 *target = (guint8 *) _target;
+	guint   chunk_offset, len;
+
+	while (abs_length > 0) {
+		chunk_offset = abs_offset % TVB_Z_CHUNK_SIZE;
+		len = MIN(TVB_Z_CHUNK_SIZE - chunk_offset, abs_length);
+
+		memcpy(target, zlib_get_chunk(zlib_tvb, abs_offset / TVB_Z_CHUNK_SIZE) + chunk_offset, len);
+		target     += len;
+		abs_offset += len;
+		abs_length -= len;
+	}
+
+	return _target;
+}
+
+static const guint8*
+zlib_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
+{
+	struct tvb_zlib *zlib_tvb = (struct tvb_zlib *) tvb;
+	guint first_chunk, last_chunk;
+	void *span, *real_data;
+
+	if (abs_length == 0)
+		return "";
+
+	first_chunk = abs_offset / TVB_Z_CHUNK_SIZE;
+	last_chunk = (abs_offset + abs_length - 1) / TVB_Z_CHUNK_SIZE;
+
+	if (first_chunk == last_chunk)
+		return zlib_get_chunk(zlib_tvb, first_chunk) + abs_offset % TVB_Z_CHUNK_SIZE;
+
+	if (abs_offset != 0 || abs_length != tvb->length) {
+		/*
+		 * The range spans chunks; copy just that range into a
+		 * piece of its own.
+		 */
+		span = g_malloc(abs_length);
+		zlib_memcpy(tvb, span, abs_offset, abs_length);
+		zlib_tvb->spans = g_slist_prepend(zlib_tvb->spans, span);
+		return (const guint8 *)span;
+	}
+
+	/*
+	 * The caller wants all of the data in one piece, so keep it
+	 * that way; the chunks that have been handed out stay as
+	 * they are.
+	 *
+	 * Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer
+	 */
+	real_data = g_malloc(tvb->length);
+	zlib_memcpy(tvb, real_data, 0, tvb->length);
+	tvb->real_data = (const guint8 *)real_data;
+
+	/* Everything is read from real_data from now on. */
+	zlib_free_streams(zlib_tvb);
+
+	return tvb->real_data;
+}
+
+static gint
+zlib_find_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, guint8 needle)
+{
+	struct tvb_zlib *zlib_tvb = (struct tvb_zlib *) tvb;
+	const guint8 *chunk, *result;
+	guint chunk_offset, len;
+
+	while (limit > 0) {
+		chunk_offset = abs_offset % TVB_Z_CHUNK_SIZE;
+		len = MIN(TVB_Z_CHUNK_SIZE - chunk_offset, limit);
+
+		chunk = zlib_get_chunk(zlib_tvb, abs_offset / TVB_Z_CHUNK_SIZE);
+		result = (const guint8 *)memchr(chunk + chunk_offset, needle, len);
+		if (result != NULL)
+			return (gint) (abs_offset + (result - (chunk + chunk_offset)));
+
+		abs_offset += len;
+		limit      -= len;
+	}
+
+	return -1;
+}
+
+static const struct tvb_ops tvb_zlib_ops = {
+	sizeof(struct tvb_zlib), /* size */
+
+	zlib_free,            /* free */
+	zlib_offset,          /* offset */
+	zlib_get_ptr,         /* get_ptr */
+	zlib_memcpy,          /* memcpy */
+	zlib_find_guint8,     /* find_guint8 */
+	NULL,                 /* pbrk_guint8 */
+	NULL,                 /* clone */
+};
+
+/*
+ * Uncompresses a zlib compressed packet inside a message of tvb at offset with
+ * length comprlen.  Returns an uncompressed tvbuffer if uncompression
+ * succeeded or NULL if uncompression failed.
+ *
+ * The data is only uncompressed to find out how long it is and to set up
+ * checkpoints; it's uncompressed again as it's accessed.
+ */
 tvbuff_t *
 tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 {
 	gint       err;
 	guint      bytes_out      = 0;
 	guint8    *compr;
-	guint8    *uncompr        = NULL;
 	tvbuff_t  *uncompr_tvb    = NULL;
+	struct tvb_zlib *zlib_tvb;
 	z_streamp  strm;
+	z_streamp *checkpoints    = NULL;
+	guint      num_checkpoints = 0;
 	Bytef     *strmbuf;
 	guint      inits_done     = 0;
 	gint       wbits          = MAX_WBITS;
 	guint8    *next;
-	guint      bufsiz;
+	gboolean   got_data       = FALSE;
+	guint      i;
 #ifdef TVB_Z_DEBUG
 	guint      inflate_passes = 0;
 	guint      bytes_in       = tvb_captured_length_remaining(tvb, offset);
@@ -76,26 +368,16 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 		return NULL;
 	}
 
-	/*
-	 * Assume that the uncompressed data is at least twice as big as
-	 * the compressed size.
-	 */
-	bufsiz = tvb_captured_length_remaining(tvb, offset) * 2;
-	bufsiz = CLAMP(bufsiz, TVB_Z_MIN_BUFSIZ, TVB_Z_MAX_BUFSIZ);
-
-#ifdef TVB_Z_DEBUG
-	ws_debug_printf("bufsiz: %u bytes\n", bufsiz);
-#endif
-
 	next = compr;
 
 	strm            = g_new0(z_stream, 1);
 	strm->next_in   = next;
 	strm->avail_in  = comprlen;
 
-	strmbuf         = (Bytef *)g_malloc0(bufsiz);
+	/* The output only needs to go somewhere while we count it. */
+	strmbuf         = (Bytef *)g_malloc(TVB_Z_CHUNK_SIZE);
 	strm->next_out  = strmbuf;
-	strm->avail_out = bufsiz;
+	strm->avail_out = TVB_Z_CHUNK_SIZE;
 
 	err = inflateInit2(strm, wbits);
 	inits_done = 1;
@@ -108,68 +390,57 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 	}
 
 	while (1) {
-		memset(strmbuf, '\0', bufsiz);
 		strm->next_out  = strmbuf;
-		strm->avail_out = bufsiz;
+		strm->avail_out = TVB_Z_CHUNK_SIZE;
 
 		err = inflate(strm, Z_SYNC_FLUSH);
 
 		if (err == Z_OK || err == Z_STREAM_END) {
-			guint bytes_pass = bufsiz - strm->avail_out;
+			guint bytes_pass = TVB_Z_CHUNK_SIZE - strm->avail_out;
 
 #ifdef TVB_Z_DEBUG
 			++inflate_passes;
 #endif
 
-			if (uncompr == NULL) {
-				/*
-				 * This is ugly workaround for bug #6480
-				 * (https://bugs.wireshark.org/bugzilla/show_bug.cgi?id=6480)
-				 *
-				 * g_memdup(..., 0) returns NULL (g_malloc(0) also)
-				 * when uncompr is NULL logic below doesn't create tvb
-				 * which is later interpreted as decompression failed.
-				 */
-				uncompr = (guint8 *)((bytes_pass || err != Z_STREAM_END) ?
-						g_memdup(strmbuf, bytes_pass) :
-						g_strdup(""));
-			} else {
-				guint8 *new_data = (guint8 *)g_malloc0(bytes_out + bytes_pass);
-
-				memcpy(new_data, uncompr, bytes_out);
-				memcpy(new_data + bytes_out, strmbuf, bytes_pass);
-
-				g_free(uncompr);
-				uncompr = new_data;
-			}
+			/*
+			 * This is ugly workaround for bug #6480
+			 * (https://bugs.wireshark.org/bugzilla/show_bug.cgi?id=6480)
+			 *
+			 * A pass that produced nothing doesn't count as
+			 * having uncompressed anything, unless the stream
+			 * ended there, in which case the result is
+			 * empty rather than a failure.
+			 */
+			if (bytes_pass || err == Z_STREAM_END)
+				got_data = TRUE;
 
 			bytes_out += bytes_pass;
 
 			if (err == Z_STREAM_END) {
-				inflateEnd(strm);
-				g_free(strm);
-				g_free(strmbuf);
 				break;
 			}
+
+			if (bytes_out == (num_checkpoints + 1) * TVB_Z_CHECKPOINT_INTERVAL) {
+				z_streamp checkpoint = g_new0(z_stream, 1);
+
+				if (inflateCopy(checkpoint, strm) != Z_OK) {
+					g_free(checkpoint);
+				} else {
+					checkpoints = (z_streamp *)g_realloc(checkpoints,
+							(num_checkpoints + 1) * sizeof(z_streamp));
+					checkpoints[num_checkpoints++] = checkpoint;
+				}
+			}
 		} else if (err == Z_BUF_ERROR) {
 			/*
 			 * It's possible that not enough frames were captured
 			 * to decompress this fully, so return what we've done
 			 * so far, if any.
 			 */
-			inflateEnd(strm);
-			g_free(strm);
-			g_free(strmbuf);
-
-			if (uncompr != NULL) {
-				break;
-			} else {
-				wmem_free(NULL, compr);
-				return NULL;
-			}
+			break;
 
 		} else if (err == Z_DATA_ERROR && inits_done == 1
-			&& uncompr == NULL && comprlen >= 2 &&
+			&& !got_data && comprlen >= 2 &&
 			(*compr  == 0x1f) && (*(compr + 1) == 0x8b)) {
 			/*
 			 * inflate() is supposed to handle both gzip and deflate
@@ -192,11 +463,7 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 			   need at least Z_DEFLATED, 1 byte flags, 4
 			   bytes MTIME, 1 byte XFL, 1 byte OS */
 			if (comprlen < 10 || *c != Z_DEFLATED) {
-				inflateEnd(strm);
-				g_free(strm);
-				wmem_free(NULL, compr);
-				g_free(strmbuf);
-				return NULL;
+				break;
 			}
 
 			c++;
@@ -251,11 +518,7 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 
 
 			if (c - compr > comprlen) {
-				inflateEnd(strm);
-				g_free(strm);
-				wmem_free(NULL, compr);
-				g_free(strmbuf);
-				return NULL;
+				break;
 			}
 			/* Drop gzip header */
 			comprlen -= (int) (c - compr);
@@ -268,7 +531,7 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 			inflateEnd(strm);
 			inflateInit2(strm, wbits);
 			inits_done++;
-		} else if (err == Z_DATA_ERROR && uncompr == NULL &&
+		} else if (err == Z_DATA_ERROR && !got_data &&
 			inits_done <= 3) {
 
 			/*
@@ -286,46 +549,62 @@ tvb_uncompress(tvbuff_t *tvb, const int offset, int comprlen)
 			strm->avail_in  = comprlen;
 
 			inflateEnd(strm);
-			memset(strmbuf, '\0', bufsiz);
-			strm->next_out  = strmbuf;
-			strm->avail_out = bufsiz;
 
 			err = inflateInit2(strm, wbits);
 
 			inits_done++;
 
 			if (err != Z_OK) {
-				g_free(strm);
-				g_free(strmbuf);
-				wmem_free(NULL, compr);
-				g_free(uncompr);
-
-				return NULL;
+				break;
 			}
 		} else {
-			inflateEnd(strm);
-			g_free(strm);
-			g_free(strmbuf);
-
-			if (uncompr == NULL) {
-				wmem_free(NULL, compr);
-				return NULL;
-			}
-
 			break;
 		}
 	}
 
+	inflateEnd(strm);
+	g_free(strm);
+	g_free(strmbuf);
+
 #ifdef TVB_Z_DEBUG
 	ws_debug_printf("inflate() total passes: %u\n", inflate_passes);
 	ws_debug_printf("bytes  in: %u\nbytes out: %u\n\n", bytes_in, bytes_out);
 #endif
 
-	if (uncompr != NULL) {
-		uncompr_tvb =  tvb_new_real_data((guint8*) uncompr, bytes_out, bytes_out);
-		tvb_set_free_cb(uncompr_tvb, g_free);
+	if (!got_data) {
+		for (i = 0; i < num_checkpoints; i++) {
+			inflateEnd(checkpoints[i]);
+			g_free(checkpoints[i]);
+		}
+		g_free(checkpoints);
+		wmem_free(NULL, compr);
+		return NULL;
 	}
-	wmem_free(NULL, compr);
+
+	uncompr_tvb = tvb_new(&tvb_zlib_ops);
+	zlib_tvb = (struct tvb_zlib *) uncompr_tvb;
+
+	zlib_tvb->compr           = compr;
+	zlib_tvb->next_in         = next;
+	zlib_tvb->avail_in        = comprlen;
+	zlib_tvb->wbits           = wbits;
+	zlib_tvb->num_chunks      = (bytes_out + TVB_Z_CHUNK_SIZE - 1) / TVB_Z_CHUNK_SIZE;
+	zlib_tvb->chunks          = g_new0(guint8 *, zlib_tvb->num_chunks);
+	zlib_tvb->spans           = NULL;
+	zlib_tvb->strm            = NULL;
+	zlib_tvb->strm_offset     = 0;
+	zlib_tvb->checkpoints     = checkpoints;
+	zlib_tvb->num_checkpoints = num_checkpoints;
+
+	uncompr_tvb->length          = bytes_out;
+	uncompr_tvb->reported_length = bytes_out;
+	uncompr_tvb->initialized     = TRUE;
+	/*
+	 * This is the top-level tvbuff for this data source,
+	 * so its data source tvbuff is itself.
+	 */
+	uncompr_tvb->ds_tvb = uncompr_tvb;
+
 	return uncompr_tvb;
 }
 #else
@@ -341,7 +620,7 @@ tvb_child_uncompress(tvbuff_t *parent, tvbuff_t *tvb, const int offset, int comp
 {
 	tvbuff_t *new_tvb = tvb_uncompress(tvb, offset, comprlen);
 	if (new_tvb)
-		tvb_set_child_real_data_tvbuff (parent, new_tvb);
+		tvb_add_to_chain(parent, new_tvb);
 	return new_tvb;
 }
 
@@ -719,6 +719,189 @@ try_bytesprefix_to_str(const guint8 *haystack, const size_t haystack_len, const
     return NULL;
 }
 
+/* INDEXES FOR THE STRINGS OF REGISTERED FIELDS */
+
+/* proto.c builds these when a field with a plain value_string or
+ * range_string is first formatted, so that formatting the field doesn't need
+ * a linear search of a big table. An index must find the same entry as
+ * the linear search would, so duplicate values resolve to the first
+ * entry, and range_strings with overlapping ranges aren't indexed. */
+
+static gint
+_value_string_index_compare(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const value_string *vs = (const value_string *)user_data;
+    guint pos_a = *(const guint *)a;
+    guint pos_b = *(const guint *)b;
+
+    if (vs[pos_a].value != vs[pos_b].value)
+        return vs[pos_a].value < vs[pos_b].value ? -1 : 1;
+    /* Equal values stay in table order, the first one is the match */
+    return pos_a < pos_b ? -1 : (pos_a > pos_b);
+}
+
+/* Returns a value_string_ext for vs using an index or a binary search,
+ * or NULL if vs has fewer than min_entries entries. If the values of vs
+ * aren't in ascending order, or have duplicates, the value_string_ext
+ * refers to a sorted copy of vs. Free it with value_string_index_free(). */
+value_string_ext *
+value_string_index_new(const value_string *vs, guint min_entries, const gchar *vs_name)
+{
+    value_string_ext *vse;
+    value_string     *sorted;
+    guint            *pos;
+    guint             num_entries, num_sorted;
+    guint             i;
+
+    for (num_entries = 0; vs[num_entries].strptr; num_entries++)
+        ;
+    if (num_entries == 0 || num_entries < min_entries)
+        return NULL;
+
+    for (i = 1; i < num_entries; i++) {
+        if (vs[i].value <= vs[i-1].value)
+            break;
+    }
+
+    if (i == num_entries) {
+        vse = g_new(value_string_ext, 1);
+        vse->_vs_p = vs;
+    } else {
+        pos = g_new(guint, num_entries);
+        for (i = 0; i < num_entries; i++)
+            pos[i] = i;
+        g_qsort_with_data(pos, num_entries, sizeof(guint), _value_string_index_compare, (gpointer)vs);
+
+        /* The copy lives in the same block as the value_string_ext */
+        vse    = (value_string_ext *)g_malloc(sizeof(value_string_ext) + (num_entries + 1) * sizeof(value_string));
+        sorted = (value_string *)(vse + 1);
+        num_sorted = 0;
+        for (i = 0; i < num_entries; i++) {
+            if (num_sorted > 0 && sorted[num_sorted-1].value == vs[pos[i]].value)
+                continue;
+            sorted[num_sorted++] = vs[pos[i]];
+        }
+        sorted[num_sorted].value  = 0;
+        sorted[num_sorted].strptr = NULL;
+        num_entries = num_sorted;
+        vse->_vs_p  = sorted;
+        g_free(pos);
+    }
+
+    vse->_vs_num_entries = num_entries;
+    vse->_vs_first_value = vse->_vs_p[0].value;
+    /* The name is copied: the field it came from may be deregistered
+     * while other fields still use the index */
+    vse->_vs_name        = g_strdup(vs_name);
+    if (vse->_vs_p[num_entries-1].value - vse->_vs_first_value == num_entries - 1)
+        vse->_vs_match2 = _try_val_to_str_index;
+    else
+        vse->_vs_match2 = _try_val_to_str_bsearch;
+
+    return vse;
+}
+
+void
+value_string_index_free(value_string_ext *vse)
+{
+    g_free((gchar *)vse->_vs_name);
+    g_free(vse);
+}
+
+struct _range_string_index {
+    guint               num_entries;
+    const range_string *rs_p;  /* sorted by value_min, without overlaps */
+};
+
+static gint
+_range_string_index_compare(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const range_string *rs = (const range_string *)user_data;
+    guint32 min_a = rs[*(const guint *)a].value_min;
+    guint32 min_b = rs[*(const guint *)b].value_min;
+
+    return min_a < min_b ? -1 : (min_a > min_b);
+}
+
+/* Returns an index for a binary search of rs, or NULL if rs has fewer
+ * than min_entries entries or some of its ranges overlap. Free it with
+ * range_string_index_free(). */
+range_string_index *
+range_string_index_new(const range_string *rs, guint min_entries)
+{
+    range_string_index *rsi;
+    range_string       *sorted;
+    guint              *pos;
+    guint               num_entries, num_sorted;
+    guint               i;
+
+    for (num_entries = 0; rs[num_entries].strptr; num_entries++)
+        ;
+    if (num_entries == 0 || num_entries < min_entries)
+        return NULL;
+
+    pos = g_new(guint, num_entries);
+    num_sorted = 0;
+    for (i = 0; i < num_entries; i++) {
+        /* An empty range never matches */
+        if (rs[i].value_min <= rs[i].value_max)
+            pos[num_sorted++] = i;
+    }
+    g_qsort_with_data(pos, num_sorted, sizeof(guint), _range_string_index_compare, (gpointer)rs);
+
+    for (i = 1; i < num_sorted; i++) {
+        if (rs[pos[i]].value_min <= rs[pos[i-1]].value_max) {
+            g_free(pos);
+            return NULL;
+        }
+    }
+
+    rsi    = (range_string_index *)g_malloc(sizeof(range_string_index) + num_sorted * sizeof(range_string));
+    sorted = (range_string *)(rsi + 1);
+    for (i = 0; i < num_sorted; i++)
+        sorted[i] = rs[pos[i]];
+    rsi->num_entries = num_sorted;
+    rsi->rs_p        = sorted;
+    g_free(pos);
+
+    return rsi;
+}
+
+void
+range_string_index_free(range_string_index *rsi)
+{
+    g_free(rsi);
+}
+
+/* Like try_rval_to_str, using an index built by range_string_index_new() */
+const gchar *
+try_rval_to_str_indexed(const guint32 val, const range_string_index *rsi)
+{
+    const range_string *rs_p = rsi->rs_p;
+    guint low, i, max;
+
+    /* Find the last range starting at or below val */
+    for (low = 0, max = rsi->num_entries; low < max; ) {
+        i = (low + max) / 2;
+        if (val < rs_p[i].value_min)
+            max = i;
+        else
+            low = i + 1;
+    }
+    if (low > 0 && val <= rs_p[low-1].value_max)
+        return rs_p[low-1].strptr;
+    return NULL;
+}
+
+/* Like try_rval64_to_str, using an index built by range_string_index_new() */
+const gchar *
+try_rval64_to_str_indexed(const guint64 val, const range_string_index *rsi)
+{
+    if (val > G_MAXUINT32)
+        return NULL;
+    return try_rval_to_str_indexed((guint32)val, rsi);
+}
+
 /* MISC */
 
 /* Functions for use by proto_registrar_dump_values(), see proto.c */
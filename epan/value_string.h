@@ -310,6 +310,34 @@ WS_DLL_LOCAL
 const gchar *
 value_string_ext_match_type_str(const value_string_ext *vse);
 
+/* Indexes for the strings of registered fields, see proto.c */
+
+WS_DLL_LOCAL
+value_string_ext *
+value_string_index_new(const value_string *vs, guint min_entries, const gchar *vs_name);
+
+WS_DLL_LOCAL
+void
+value_string_index_free(value_string_ext *vse);
+
+typedef struct _range_string_index range_string_index;
+
+WS_DLL_LOCAL
+range_string_index *
+range_string_index_new(const range_string *rs, guint min_entries);
+
+WS_DLL_LOCAL
+void
+range_string_index_free(range_string_index *rsi);
+
+WS_DLL_LOCAL
+const gchar *
+try_rval_to_str_indexed(const guint32 val, const range_string_index *rsi);
+
+WS_DLL_LOCAL
+const gchar *
+try_rval64_to_str_indexed(const guint64 val, const range_string_index *rsi);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
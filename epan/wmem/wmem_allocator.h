@@ -27,6 +27,8 @@
 #include <glib.h>
 #include <string.h>
 
+#include "wmem_core.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -53,8 +55,40 @@ struct _wmem_allocator_t {
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
     gboolean                     in_scope;
+
+    /* Usage statistics; the block counts are kept by the allocator
+     * implementations, using the functions below */
+    wmem_allocator_stats_t       stats;
 };
 
+static inline void
+wmem_stats_new_block(wmem_allocator_stats_t *stats)
+{
+    stats->block_count++;
+    if (stats->block_count > stats->peak_block_count) {
+        stats->peak_block_count = stats->block_count;
+    }
+}
+
+static inline void
+wmem_stats_free_block(wmem_allocator_stats_t *stats)
+{
+    stats->block_count--;
+}
+
+static inline void
+wmem_stats_new_jumbo(wmem_allocator_stats_t *stats)
+{
+    stats->jumbo_count++;
+    stats->jumbo_allocs++;
+}
+
+static inline void
+wmem_stats_free_jumbo(wmem_allocator_stats_t *stats)
+{
+    stats->jumbo_count--;
+}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
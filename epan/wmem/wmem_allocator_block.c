@@ -211,6 +211,7 @@ typedef struct _wmem_block_allocator_t {
     wmem_block_hdr_t   *block_list;
     wmem_block_chunk_t *master_head;
     wmem_block_chunk_t *recycler_head;
+    wmem_allocator_stats_t *stats;
 } wmem_block_allocator_t;
 
 /* DEBUG AND TEST */
@@ -776,6 +777,7 @@ wmem_block_new_block(wmem_block_allocator_t *allocator)
     /* allocate the new block and add it to the block list */
     block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
     wmem_block_add_to_block_list(allocator, block);
+    wmem_stats_new_block(allocator->stats);
 
     /* initialize it */
     wmem_block_init_block(allocator, block);
@@ -797,6 +799,7 @@ wmem_block_alloc_jumbo(wmem_block_allocator_t *allocator, const size_t size)
 
     /* add it to the block list */
     wmem_block_add_to_block_list(allocator, block);
+    wmem_stats_new_jumbo(allocator->stats);
 
     /* the new block contains a single jumbo chunk */
     chunk = WMEM_BLOCK_TO_CHUNK(block);
@@ -822,6 +825,7 @@ wmem_block_free_jumbo(wmem_block_allocator_t *allocator,
     wmem_block_remove_from_block_list(allocator, block);
 
     wmem_free(NULL, block);
+    wmem_stats_free_jumbo(allocator->stats);
 }
 
 /* Reallocs special 'jumbo' blocks of sizes that won't fit normally. */
@@ -1032,6 +1036,7 @@ wmem_block_free_all(void *private_data)
             wmem_block_remove_from_block_list(allocator, cur);
             cur = cur->next;
             wmem_free(NULL, WMEM_CHUNK_TO_BLOCK(chunk));
+            wmem_stats_free_jumbo(allocator->stats);
         }
         else {
             wmem_block_init_block(allocator, cur);
@@ -1080,6 +1085,7 @@ wmem_block_gc(void *private_data)
                 allocator->master_head = free_chunk->next;
             }
             wmem_free(NULL, cur);
+            wmem_stats_free_block(allocator->stats);
         }
         else {
             /* part of this block is used, so add it to the new block list */
@@ -1121,6 +1127,7 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     block_allocator->block_list    = NULL;
     block_allocator->master_head   = NULL;
     block_allocator->recycler_head = NULL;
+    block_allocator->stats         = &allocator->stats;
 }
 
 /*
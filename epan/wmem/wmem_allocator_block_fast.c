@@ -75,6 +75,7 @@ typedef struct _wmem_block_fast_jumbo {
 typedef struct {
     wmem_block_fast_hdr_t   *block_list;
     wmem_block_fast_jumbo_t *jumbo_list;
+    wmem_allocator_stats_t  *stats;
 } wmem_block_fast_allocator_t;
 
 /* Creates a new block, and initializes it. */
@@ -90,6 +91,7 @@ wmem_block_fast_new_block(wmem_block_fast_allocator_t *allocator)
     block->next = allocator->block_list;
 
     allocator->block_list = block;
+    wmem_stats_new_block(allocator->stats);
 }
 
 /* API */
@@ -111,6 +113,7 @@ wmem_block_fast_alloc(void *private_data, const size_t size)
         block->next = allocator->jumbo_list;
         block->prev = NULL;
         allocator->jumbo_list = block;
+        wmem_stats_new_jumbo(allocator->stats);
 
         chunk = ((wmem_block_fast_chunk_t*)((guint8*)(block) + WMEM_JUMBO_HEADER_SIZE));
         chunk->len = JUMBO_MAGIC;
@@ -203,6 +206,7 @@ wmem_block_fast_free_all(void *private_data)
     while (cur) {
         nxt  = cur->next;
         wmem_free(NULL, cur);
+        wmem_stats_free_block(allocator->stats);
         cur = nxt;
     }
 
@@ -211,6 +215,7 @@ wmem_block_fast_free_all(void *private_data)
     while (cur_jum) {
         nxt_jum  = cur_jum->next;
         wmem_free(NULL, cur_jum);
+        wmem_stats_free_jumbo(allocator->stats);
         cur_jum = nxt_jum;
     }
     allocator->jumbo_list = NULL;
@@ -229,7 +234,10 @@ wmem_block_fast_allocator_cleanup(void *private_data)
 
     /* wmem guarantees that free_all() is called directly before this, so
      * simply free the first block */
-    wmem_free(NULL, allocator->block_list);
+    if (allocator->block_list) {
+        wmem_free(NULL, allocator->block_list);
+        wmem_stats_free_block(allocator->stats);
+    }
 
     /* then just free the allocator structs */
     wmem_free(NULL, private_data);
@@ -254,6 +262,7 @@ wmem_block_fast_allocator_init(wmem_allocator_t *allocator)
 
     block_allocator->block_list = NULL;
     block_allocator->jumbo_list = NULL;
+    block_allocator->stats      = &allocator->stats;
 }
 
 /*
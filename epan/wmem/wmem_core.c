@@ -55,6 +55,12 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    allocator->stats.alloc_count++;
+    allocator->stats.bytes_requested += size;
+    if (allocator->stats.bytes_requested > allocator->stats.peak_bytes_requested) {
+        allocator->stats.peak_bytes_requested = allocator->stats.bytes_requested;
+    }
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -86,6 +92,8 @@ wmem_free(wmem_allocator_t *allocator, void *ptr)
         return;
     }
 
+    allocator->stats.free_count++;
+
     allocator->wfree(allocator->private_data, ptr);
 }
 
@@ -107,6 +115,12 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     g_assert(allocator->in_scope);
 
+    allocator->stats.realloc_count++;
+    allocator->stats.bytes_requested += size;
+    if (allocator->stats.bytes_requested > allocator->stats.peak_bytes_requested) {
+        allocator->stats.peak_bytes_requested = allocator->stats.bytes_requested;
+    }
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -116,6 +130,9 @@ wmem_free_all_real(wmem_allocator_t *allocator, gboolean final)
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
     allocator->free_all(allocator->private_data);
+
+    allocator->stats.free_all_count++;
+    allocator->stats.bytes_requested = 0;
 }
 
 void
@@ -139,6 +156,12 @@ wmem_destroy_allocator(wmem_allocator_t *allocator)
     wmem_free(NULL, allocator);
 }
 
+void
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats)
+{
+    *stats = allocator->stats;
+}
+
 wmem_allocator_t *
 wmem_allocator_new(const wmem_allocator_type_t type)
 {
@@ -156,6 +179,7 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = TRUE;
+    memset(&allocator->stats, 0, sizeof(allocator->stats));
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
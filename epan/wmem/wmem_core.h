@@ -72,6 +72,28 @@ typedef enum _wmem_allocator_type_t {
                 the next free_all is always just around the corner. */
 } wmem_allocator_type_t;
 
+/** Usage statistics of an allocation pool, see wmem_allocator_get_stats().
+ * The block counts are only kept by the block allocators; the others get
+ * memory from the system for each allocation. */
+typedef struct _wmem_allocator_stats_t {
+    guint64 alloc_count;      /**< Number of allocations */
+    guint64 realloc_count;    /**< Number of reallocations */
+    guint64 free_count;       /**< Number of explicit frees */
+    guint64 free_all_count;   /**< Number of times the pool was emptied */
+    guint64 bytes_requested;  /**< Total of the sizes asked for by
+                allocations and reallocations since the pool was last
+                emptied. This is not the memory in use: frees aren't taken
+                off, since the size of what's freed isn't known, and a
+                reallocation counts its whole new size. The memory held is
+                given by the block and jumbo counts. */
+    guint64 peak_bytes_requested; /**< The highest bytes_requested has been */
+    guint   block_count;      /**< Blocks currently held */
+    guint   peak_block_count; /**< The most blocks held at any time */
+    guint   jumbo_count;      /**< Allocations too large for a block, that
+                currently have memory of their own */
+    guint64 jumbo_allocs;     /**< Number of allocations too large for a block */
+} wmem_allocator_stats_t;
+
 /** Allocate the requested amount of memory in the given pool.
  *
  * @param allocator The allocator object to use to allocate the memory.
@@ -206,6 +228,16 @@ WS_DLL_PUBLIC
 wmem_allocator_t *
 wmem_allocator_new(const wmem_allocator_type_t type);
 
+/** Get the usage statistics of an allocator. Allocators aren't thread-safe,
+ * so this should be called from the thread that uses the allocator.
+ *
+ * @param allocator The allocator to get the statistics of.
+ * @param stats Filled in with the statistics.
+ */
+WS_DLL_PUBLIC
+void
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats);
+
 /** Initialize the wmem subsystem. This must be called before any other wmem
  * function, usually at the very beginning of your program.
  */
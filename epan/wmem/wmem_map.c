@@ -31,6 +31,7 @@
 #include "wmem_user_cb.h"
 
 static guint32 x; /* Used for universal integer hashing (see the HASH macro) */
+static guint64 x64; /* Same for the inline keys of open maps (see wmem_map_open_home) */
 
 /* Used for the wmem_strong_hash() function */
 static guint32 preseed;
@@ -43,6 +44,9 @@ wmem_init_hashing(void)
     if G_UNLIKELY(x == 0)
         x = 1;
 
+    /* multiply-shift hashing wants an odd multiplier */
+    x64 = ((guint64)g_random_int() << 32) | g_random_int() | 1;
+
     preseed  = g_random_int();
     postseed = g_random_int();
 }
@@ -53,6 +57,15 @@ typedef struct _wmem_map_item_t {
     struct _wmem_map_item_t *next;
 } wmem_map_item_t;
 
+/* A slot of an open map. 'hv' is what the slot is hashed and compared by:
+ * the key itself for WMEM_MAP_KEY_DIRECT, the 64-bit value it points to for
+ * WMEM_MAP_KEY_INT64 and the result of hash_func for WMEM_MAP_KEY_GENERIC. */
+typedef struct _wmem_map_slot_t {
+    const void *key;
+    void *value;
+    guint64 hv;
+} wmem_map_slot_t;
+
 struct _wmem_map_t {
     guint count; /* number of items stored */
 
@@ -64,6 +77,16 @@ struct _wmem_map_t {
 
     wmem_map_item_t **table;
 
+    /* Open maps have these instead of the table. They use linear probing
+     * with Robin Hood displacement: dists[i] is one more than how far the
+     * slot is from its home bucket (0 for an empty slot), so most probes
+     * only look at the dists array and keys are only compared for slots
+     * with the same home bucket as the key searched for. */
+    gboolean             open;
+    wmem_map_key_type_t  key_type;
+    wmem_map_slot_t     *slots;
+    guint8              *dists;
+
     GHashFunc  hash_func;
     GEqualFunc eql_func;
 
@@ -88,6 +111,13 @@ struct _wmem_map_t {
 #define HASH(MAP, KEY) \
     ((guint32)(((MAP)->hash_func(KEY) * x) >> (32 - (MAP)->capacity)))
 
+/* The most the open map's load factor gets to is 7/8. */
+#define OPEN_MAP_FULL(MAP) ((MAP)->count >= CAPACITY(MAP) - CAPACITY(MAP) / 8)
+
+/* dists[] saturates at this value; the real distance of those (rare) slots
+ * is worked out from their hash value. */
+#define OPEN_MAP_MAX_DIST 0xff
+
 static void
 wmem_map_init_table(wmem_map_t *map)
 {
@@ -110,6 +140,9 @@ wmem_map_new(wmem_allocator_t *allocator,
     map->allocator = allocator;
     map->count = 0;
     map->table = NULL;
+    map->open  = FALSE;
+    map->slots = NULL;
+    map->dists = NULL;
 
     return map;
 }
@@ -122,6 +155,8 @@ wmem_map_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
 
     map->count = 0;
     map->table = NULL;
+    map->slots = NULL;
+    map->dists = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(map->master, map->master_cb_id);
@@ -156,6 +191,9 @@ wmem_map_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
     map->allocator = slave;
     map->count = 0;
     map->table = NULL;
+    map->open  = FALSE;
+    map->slots = NULL;
+    map->dists = NULL;
 
     map->master_cb_id = wmem_register_callback(master, wmem_map_destroy_cb, map);
     map->slave_cb_id  = wmem_register_callback(slave, wmem_map_reset_cb, map);
@@ -163,6 +201,226 @@ wmem_map_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
     return map;
 }
 
+wmem_map_t *
+wmem_map_new_open(wmem_allocator_t *allocator, wmem_map_key_type_t key_type,
+        GHashFunc hash_func, GEqualFunc eql_func)
+{
+    wmem_map_t *map;
+
+    map = wmem_map_new(allocator, hash_func, eql_func);
+    map->open     = TRUE;
+    map->key_type = key_type;
+
+    return map;
+}
+
+wmem_map_t *
+wmem_map_new_open_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
+        wmem_map_key_type_t key_type, GHashFunc hash_func, GEqualFunc eql_func)
+{
+    wmem_map_t *map;
+
+    map = wmem_map_new_autoreset(master, slave, hash_func, eql_func);
+    map->open     = TRUE;
+    map->key_type = key_type;
+
+    return map;
+}
+
+static void
+wmem_map_open_init_table(wmem_map_t *map)
+{
+    map->count    = 0;
+    map->capacity = WMEM_MAP_DEFAULT_CAPACITY;
+    map->slots    = wmem_alloc_array(map->allocator, wmem_map_slot_t, CAPACITY(map));
+    map->dists    = (guint8 *)wmem_alloc0(map->allocator, CAPACITY(map));
+}
+
+static inline guint64
+wmem_map_open_hv(const wmem_map_t *map, const void *key)
+{
+    switch (map->key_type) {
+        case WMEM_MAP_KEY_DIRECT:
+            return (guint64)GPOINTER_TO_SIZE(key);
+        case WMEM_MAP_KEY_INT64:
+            return *(const guint64 *)key;
+        default:
+            return map->hash_func(key);
+    }
+}
+
+/* The home bucket of a hash value. Inline keys are hashed with 64-bit
+ * multiply-shift, the results of hash_func the same way as in chained maps. */
+static inline size_t
+wmem_map_open_home(const wmem_map_t *map, guint64 hv)
+{
+    if (map->key_type == WMEM_MAP_KEY_GENERIC) {
+        return (guint32)(((guint32)hv * x) >> (32 - map->capacity));
+    }
+    return (size_t)((hv * x64) >> (64 - map->capacity));
+}
+
+static inline gboolean
+wmem_map_open_match(const wmem_map_t *map, const wmem_map_slot_t *slot,
+        const void *key, guint64 hv)
+{
+    if (slot->hv != hv) {
+        return FALSE;
+    }
+    /* for inline keys, equal hash values are equal keys */
+    return map->key_type != WMEM_MAP_KEY_GENERIC || map->eql_func(key, slot->key);
+}
+
+/* One more than the distance of slot i from its home bucket, 0 if empty */
+static inline size_t
+wmem_map_open_dist(const wmem_map_t *map, size_t i)
+{
+    size_t d = map->dists[i];
+
+    if (G_UNLIKELY(d == OPEN_MAP_MAX_DIST)) {
+        d = ((i - wmem_map_open_home(map, map->slots[i].hv)) & (CAPACITY(map) - 1)) + 1;
+    }
+    return d;
+}
+
+static inline void
+wmem_map_open_set_dist(wmem_map_t *map, size_t i, size_t d)
+{
+    map->dists[i] = (guint8)MIN(d, OPEN_MAP_MAX_DIST);
+}
+
+/* Looks for the key, returns its slot or -1 */
+static gssize
+wmem_map_open_find(const wmem_map_t *map, const void *key)
+{
+    size_t   mask = CAPACITY(map) - 1;
+    guint64  hv   = wmem_map_open_hv(map, key);
+    size_t   i    = wmem_map_open_home(map, hv);
+    size_t   d, cur;
+
+    for (d = 1; ; d++) {
+        cur = map->dists[i];
+        if (cur == OPEN_MAP_MAX_DIST) {
+            cur = wmem_map_open_dist(map, i);
+        }
+        /* Robin Hood: the key would have displaced any slot closer to its
+         * home than the key would be here, so it isn't in the map */
+        if (cur < d) {
+            return -1;
+        }
+        if (cur == d && wmem_map_open_match(map, &map->slots[i], key, hv)) {
+            return (gssize)i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/* Puts a slot known not to be in the map in, there must be room for it */
+static void
+wmem_map_open_place(wmem_map_t *map, wmem_map_slot_t slot)
+{
+    size_t          mask = CAPACITY(map) - 1;
+    size_t          i    = wmem_map_open_home(map, slot.hv);
+    size_t          d, cur;
+    wmem_map_slot_t tmp;
+
+    for (d = 1; ; d++) {
+        cur = wmem_map_open_dist(map, i);
+        if (cur == 0) {
+            map->slots[i] = slot;
+            wmem_map_open_set_dist(map, i, d);
+            return;
+        }
+        if (cur < d) {
+            /* take the slot of the richer entry and carry on with it */
+            tmp           = map->slots[i];
+            map->slots[i] = slot;
+            wmem_map_open_set_dist(map, i, d);
+            slot          = tmp;
+            d             = cur;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static void
+wmem_map_open_grow(wmem_map_t *map)
+{
+    wmem_map_slot_t *old_slots;
+    guint8          *old_dists;
+    size_t           old_cap, i;
+
+    old_slots = map->slots;
+    old_dists = map->dists;
+    old_cap   = CAPACITY(map);
+
+    map->capacity++;
+    map->slots = wmem_alloc_array(map->allocator, wmem_map_slot_t, CAPACITY(map));
+    map->dists = (guint8 *)wmem_alloc0(map->allocator, CAPACITY(map));
+
+    for (i = 0; i < old_cap; i++) {
+        if (old_dists[i]) {
+            wmem_map_open_place(map, old_slots[i]);
+        }
+    }
+
+    wmem_free(map->allocator, old_slots);
+    wmem_free(map->allocator, old_dists);
+}
+
+static void *
+wmem_map_open_insert(wmem_map_t *map, const void *key, void *value)
+{
+    wmem_map_slot_t slot;
+    gssize          i;
+    void           *old_val;
+
+    if (map->slots == NULL) {
+        wmem_map_open_init_table(map);
+    }
+
+    i = wmem_map_open_find(map, key);
+    if (i >= 0) {
+        old_val = map->slots[i].value;
+        map->slots[i].value = value;
+        return old_val;
+    }
+
+    if (OPEN_MAP_FULL(map)) {
+        wmem_map_open_grow(map);
+    }
+
+    slot.key   = key;
+    slot.value = value;
+    slot.hv    = wmem_map_open_hv(map, key);
+    wmem_map_open_place(map, slot);
+    map->count++;
+
+    return NULL;
+}
+
+/* Takes slot i out, moving the entries after it one back (backward shift
+ * deletion, no tombstones needed) */
+static void
+wmem_map_open_delete(wmem_map_t *map, size_t i)
+{
+    size_t mask = CAPACITY(map) - 1;
+    size_t j, cur;
+
+    for (;;) {
+        j   = (i + 1) & mask;
+        cur = wmem_map_open_dist(map, j);
+        if (cur <= 1) {
+            break;
+        }
+        map->slots[i] = map->slots[j];
+        wmem_map_open_set_dist(map, i, cur - 1);
+        i = j;
+    }
+    map->dists[i] = 0;
+    map->count--;
+}
+
 static inline void
 wmem_map_grow(wmem_map_t *map)
 {
@@ -201,6 +459,10 @@ wmem_map_insert(wmem_map_t *map, const void *key, void *value)
     wmem_map_item_t **item;
     void *old_val;
 
+    if (map->open) {
+        return wmem_map_open_insert(map, key, value);
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         wmem_map_init_table(map);
@@ -242,6 +504,15 @@ void *
 wmem_map_lookup(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t *item;
+    gssize i;
+
+    if (map->open) {
+        if (map->slots == NULL) {
+            return NULL;
+        }
+        i = wmem_map_open_find(map, key);
+        return i >= 0 ? map->slots[i].value : NULL;
+    }
 
     /* Make sure we have a table */
     if (map->table == NULL) {
@@ -267,6 +538,20 @@ wmem_map_remove(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t **item, *tmp;
     void *value;
+    gssize i;
+
+    if (map->open) {
+        if (map->slots == NULL) {
+            return NULL;
+        }
+        i = wmem_map_open_find(map, key);
+        if (i < 0) {
+            return NULL;
+        }
+        value = map->slots[i].value;
+        wmem_map_open_delete(map, i);
+        return value;
+    }
 
     /* Make sure we have a table */
     if (map->table == NULL) {
@@ -298,6 +583,19 @@ gboolean
 wmem_map_steal(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t **item, *tmp;
+    gssize i;
+
+    if (map->open) {
+        if (map->slots == NULL) {
+            return FALSE;
+        }
+        i = wmem_map_open_find(map, key);
+        if (i < 0) {
+            return FALSE;
+        }
+        wmem_map_open_delete(map, i);
+        return TRUE;
+    }
 
     /* Make sure we have a table */
     if (map->table == NULL) {
@@ -330,7 +628,16 @@ wmem_map_get_keys(wmem_allocator_t *list_allocator, wmem_map_t *map)
     wmem_map_item_t *cur;
     wmem_list_t* list = wmem_list_new(list_allocator);
 
-    if (map->table != NULL) {
+    if (map->open && map->slots != NULL) {
+        capacity = CAPACITY(map);
+
+        for (i=0; i<capacity; i++) {
+            if (map->dists[i]) {
+                wmem_list_prepend(list, (void*)map->slots[i].key);
+            }
+        }
+    }
+    else if (map->table != NULL) {
         capacity = CAPACITY(map);
 
         /* copy all the elements into the list over from table */
@@ -352,6 +659,18 @@ wmem_map_foreach(wmem_map_t *map, GHFunc foreach_func, gpointer user_data)
     wmem_map_item_t *cur;
     unsigned i;
 
+    if (map->open) {
+        if (map->slots == NULL) {
+            return;
+        }
+        for (i = 0; i < CAPACITY(map); i++) {
+            if (map->dists[i]) {
+                foreach_func((gpointer)map->slots[i].key, map->slots[i].value, user_data);
+            }
+        }
+        return;
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return;
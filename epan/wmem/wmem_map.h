@@ -88,6 +88,48 @@ wmem_map_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
         GHashFunc hash_func, GEqualFunc eql_func)
 G_GNUC_MALLOC;
 
+/** How an open map (see wmem_map_new_open()) compares and hashes its keys. */
+typedef enum _wmem_map_key_type_t {
+    WMEM_MAP_KEY_GENERIC, /**< With the hash_func and eql_func given */
+    WMEM_MAP_KEY_DIRECT,  /**< By the key pointer itself, like g_direct_hash
+                               and g_direct_equal; for GUINT_TO_POINTER()
+                               integer keys */
+    WMEM_MAP_KEY_INT64    /**< By the guint64 the key points to, like
+                               g_int64_hash and g_int64_equal */
+} wmem_map_key_type_t;
+
+/** Creates a map that keeps its items in one open-addressed table instead
+ * of chaining them, which makes lookups cheaper and inserts allocation-free
+ * except when the table grows. Otherwise it is used like any other map, with
+ * the same wmem_map_* functions.
+ *
+ * For WMEM_MAP_KEY_DIRECT and WMEM_MAP_KEY_INT64 the key is stored in the
+ * table and compared inline, without calling hash_func and eql_func, which
+ * can be NULL. The map hashes those keys itself in a way that's fine for
+ * untrusted data. An INT64 key must still stay valid as long as it's in the
+ * map, since wmem_map_foreach() and wmem_map_get_keys() hand it out.
+ *
+ * @param allocator The allocator scope with which to create the map.
+ * @param key_type  How the keys are compared.
+ * @param hash_func The hash function used to place inserted keys.
+ * @param eql_func  The equality function used to compare inserted keys.
+ * @return The newly-allocated map.
+ */
+WS_DLL_PUBLIC
+wmem_map_t *
+wmem_map_new_open(wmem_allocator_t *allocator, wmem_map_key_type_t key_type,
+        GHashFunc hash_func, GEqualFunc eql_func)
+G_GNUC_MALLOC;
+
+/** Like wmem_map_new_autoreset(), for an open map as created by
+ * wmem_map_new_open().
+ */
+WS_DLL_PUBLIC
+wmem_map_t *
+wmem_map_new_open_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
+        wmem_map_key_type_t key_type, GHashFunc hash_func, GEqualFunc eql_func)
+G_GNUC_MALLOC;
+
 /** Inserts a value into the map.
  *
  * @param map The map to insert into.
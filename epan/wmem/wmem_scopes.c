@@ -47,39 +47,71 @@
  * perfect, but it should stop most of the bad behaviour that emem permitted.
  */
 
-/* TODO: Make these thread-local */
 static wmem_allocator_t *packet_scope = NULL;
 static wmem_allocator_t *file_scope   = NULL;
 static wmem_allocator_t *epan_scope   = NULL;
 
+/* Threads other than the main one can have a packet scope of their own, see
+ * wmem_init_thread_scopes(). As long as none does, the thread-local lookup
+ * is skipped. */
+#if GLIB_CHECK_VERSION(2,32,0)
+static GPrivate thread_packet_scope_key = G_PRIVATE_INIT(NULL);
+#define THREAD_PACKET_SCOPE_KEY (&thread_packet_scope_key)
+#else
+static GPrivate *thread_packet_scope_key = NULL;
+#define THREAD_PACKET_SCOPE_KEY (thread_packet_scope_key)
+#endif
+static volatile gint thread_scope_count = 0;
+
+static inline wmem_allocator_t *
+current_packet_scope(void)
+{
+    wmem_allocator_t *scope;
+
+    if (g_atomic_int_get(&thread_scope_count) != 0) {
+        scope = (wmem_allocator_t *)g_private_get(THREAD_PACKET_SCOPE_KEY);
+        if (scope) {
+            return scope;
+        }
+    }
+
+    return packet_scope;
+}
+
 /* Packet Scope */
 
 wmem_allocator_t *
 wmem_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *scope = current_packet_scope();
 
-    return packet_scope;
+    g_assert(scope);
+
+    return scope;
 }
 
 void
 wmem_enter_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *scope = current_packet_scope();
+
+    g_assert(scope);
     g_assert(file_scope->in_scope);
-    g_assert(!packet_scope->in_scope);
+    g_assert(!scope->in_scope);
 
-    packet_scope->in_scope = TRUE;
+    scope->in_scope = TRUE;
 }
 
 void
 wmem_leave_packet_scope(void)
 {
-    g_assert(packet_scope);
-    g_assert(packet_scope->in_scope);
+    wmem_allocator_t *scope = current_packet_scope();
 
-    wmem_free_all(packet_scope);
-    packet_scope->in_scope = FALSE;
+    g_assert(scope);
+    g_assert(scope->in_scope);
+
+    wmem_free_all(scope);
+    scope->in_scope = FALSE;
 }
 
 /* File Scope */
@@ -106,14 +138,14 @@ wmem_leave_file_scope(void)
 {
     g_assert(file_scope);
     g_assert(file_scope->in_scope);
-    g_assert(!packet_scope->in_scope);
+    g_assert(!current_packet_scope()->in_scope);
 
     wmem_free_all(file_scope);
     file_scope->in_scope = FALSE;
 
     /* this seems like a good time to do garbage collection */
     wmem_gc(file_scope);
-    wmem_gc(packet_scope);
+    wmem_gc(current_packet_scope());
 }
 
 /* Epan Scope */
@@ -126,6 +158,38 @@ wmem_epan_scope(void)
     return epan_scope;
 }
 
+/* Thread Scopes */
+
+void
+wmem_init_thread_scopes(void)
+{
+    wmem_allocator_t *scope;
+
+    g_assert(packet_scope);
+    g_assert(g_private_get(THREAD_PACKET_SCOPE_KEY) == NULL);
+
+    scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+    scope->in_scope = FALSE;
+
+    g_private_set(THREAD_PACKET_SCOPE_KEY, scope);
+    g_atomic_int_inc(&thread_scope_count);
+}
+
+void
+wmem_cleanup_thread_scopes(void)
+{
+    wmem_allocator_t *scope;
+
+    scope = (wmem_allocator_t *)g_private_get(THREAD_PACKET_SCOPE_KEY);
+    g_assert(scope);
+    g_assert(scope->in_scope == FALSE);
+
+    g_private_set(THREAD_PACKET_SCOPE_KEY, NULL);
+    g_atomic_int_add(&thread_scope_count, -1);
+
+    wmem_destroy_allocator(scope);
+}
+
 /* Scope Management */
 
 void
@@ -135,6 +199,12 @@ wmem_init_scopes(void)
     g_assert(file_scope   == NULL);
     g_assert(epan_scope   == NULL);
 
+#if !GLIB_CHECK_VERSION(2,32,0)
+    if (thread_packet_scope_key == NULL) {
+        thread_packet_scope_key = g_private_new(NULL);
+    }
+#endif
+
     packet_scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
     file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
     epan_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
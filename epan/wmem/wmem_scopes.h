@@ -64,6 +64,25 @@ WS_DLL_LOCAL
 void
 wmem_leave_file_scope(void);
 
+/* Thread Scopes */
+
+/** Gives the calling thread a packet scope of its own, which
+ * wmem_packet_scope() returns in that thread from then on. Threads
+ * that dissect packets next to each other don't have to lock around
+ * packet-scoped allocations that way. The file and epan scopes are still
+ * shared by all threads.
+ */
+WS_DLL_PUBLIC
+void
+wmem_init_thread_scopes(void);
+
+/** Destroys the calling thread's own packet scope. Must be called before
+ * the thread exits, outside of the packet scope.
+ */
+WS_DLL_PUBLIC
+void
+wmem_cleanup_thread_scopes(void);
+
 /* Scope Management */
 
 WS_DLL_LOCAL
@@ -55,6 +55,7 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator->type = type;
     allocator->callbacks = NULL;
     allocator->in_scope = TRUE;
+    memset(&allocator->stats, 0, sizeof(allocator->stats));
 
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -206,6 +207,89 @@ wmem_test_allocator_callbacks(void)
     g_assert(cb_called_count == 3);
 }
 
+static void
+wmem_test_allocator_stats_type(wmem_allocator_type_t type)
+{
+    wmem_allocator_t       *allocator;
+    wmem_allocator_stats_t  stats;
+    void                   *ptr;
+    int                     i;
+
+    allocator = wmem_allocator_force_new(type);
+
+    for (i = 0; i < 100; i++) {
+        wmem_alloc(allocator, 100);
+    }
+    ptr = wmem_alloc(allocator, 50);
+    ptr = wmem_realloc(allocator, ptr, 200);
+    wmem_free(allocator, ptr);
+    /* nothing is allocated for these */
+    wmem_alloc(allocator, 0);
+    wmem_free(allocator, NULL);
+
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.alloc_count == 101);
+    g_assert(stats.realloc_count == 1);
+    g_assert(stats.free_count == 1);
+    g_assert(stats.free_all_count == 0);
+    /* the sizes asked for add up; the realloc and free take nothing off */
+    g_assert(stats.bytes_requested == 100*100 + 50 + 200);
+    g_assert(stats.peak_bytes_requested == stats.bytes_requested);
+    g_assert(stats.block_count == 1);
+    g_assert(stats.jumbo_count == 0);
+
+    /* too big for a block */
+    wmem_alloc(allocator, 16*1024*1024);
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.jumbo_count == 1);
+    g_assert(stats.jumbo_allocs == 1);
+
+    wmem_free_all(allocator);
+    wmem_gc(allocator);
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.free_all_count == 1);
+    g_assert(stats.bytes_requested == 0);
+    g_assert(stats.peak_bytes_requested == 100*100 + 50 + 200 + 16*1024*1024);
+    g_assert(stats.jumbo_count == 0);
+    g_assert(stats.jumbo_allocs == 1);
+    g_assert(stats.block_count <= 1);
+    g_assert(stats.peak_block_count >= 1);
+
+    wmem_destroy_allocator(allocator);
+}
+
+static void
+wmem_test_allocator_stats(void)
+{
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_BLOCK);
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_BLOCK_FAST);
+}
+
+static void
+wmem_test_thread_scopes(void)
+{
+    wmem_allocator_t *packet_scope, *thread_scope;
+
+    packet_scope = wmem_packet_scope();
+
+    wmem_init_thread_scopes();
+    thread_scope = wmem_packet_scope();
+    g_assert(thread_scope != packet_scope);
+    g_assert(!thread_scope->in_scope);
+
+    wmem_enter_file_scope();
+    wmem_enter_packet_scope();
+    g_assert(thread_scope->in_scope);
+    g_assert(!packet_scope->in_scope);
+    wmem_strdup(wmem_packet_scope(), STRING_80);
+    wmem_leave_packet_scope();
+    g_assert(!thread_scope->in_scope);
+    wmem_leave_file_scope();
+
+    wmem_cleanup_thread_scopes();
+    g_assert(wmem_packet_scope() == packet_scope);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         guint len)
@@ -961,6 +1045,93 @@ wmem_test_map(void)
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_map_open(void)
+{
+    wmem_allocator_t   *allocator, *extra_allocator;
+    wmem_map_t       *map;
+    gchar            *str_key;
+    guint64          *int64_keys;
+    unsigned int      i;
+    void             *ret;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    /* insertion, lookup and removal of inline integer keys */
+    map = wmem_map_new_open(allocator, WMEM_MAP_KEY_DIRECT, NULL, NULL);
+    g_assert(map);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(777777));
+        g_assert(ret == NULL);
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(777777));
+    }
+    g_assert(wmem_map_size(map) == CONTAINER_ITERS);
+    /* remove every other key, the rest must still be found after the
+     * entries behind them moved back */
+    for (i=0; i<CONTAINER_ITERS; i+=2) {
+        ret = wmem_map_remove(map, GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(i));
+        ret = wmem_map_remove(map, GINT_TO_POINTER(i));
+        g_assert(ret == NULL);
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_lookup(map, GINT_TO_POINTER(i));
+        g_assert(ret == ((i & 1) ? GINT_TO_POINTER(i) : NULL));
+    }
+    for (i=1; i<CONTAINER_ITERS; i+=2) {
+        g_assert(wmem_map_steal(map, GINT_TO_POINTER(i)));
+        g_assert(!wmem_map_steal(map, GINT_TO_POINTER(i)));
+    }
+    g_assert(wmem_map_size(map) == 0);
+    wmem_free_all(allocator);
+
+    /* 64-bit keys, compared by value rather than by pointer */
+    map = wmem_map_new_open(allocator, WMEM_MAP_KEY_INT64, NULL, NULL);
+    int64_keys = wmem_alloc_array(allocator, guint64, CONTAINER_ITERS * 2);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        int64_keys[i] = G_GUINT64_CONSTANT(0x100000000) * i + i;
+        int64_keys[i + CONTAINER_ITERS] = int64_keys[i];
+        wmem_map_insert(map, &int64_keys[i], GINT_TO_POINTER(i));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_lookup(map, &int64_keys[i + CONTAINER_ITERS]);
+        g_assert(ret == GINT_TO_POINTER(i));
+    }
+    wmem_free_all(allocator);
+
+    /* test auto-reset functionality */
+    map = wmem_map_new_open_autoreset(allocator, extra_allocator,
+            WMEM_MAP_KEY_DIRECT, NULL, NULL);
+    g_assert(map);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(i));
+        g_assert(ret == NULL);
+    }
+    wmem_free_all(extra_allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_map_lookup(map, GINT_TO_POINTER(i)) == NULL);
+    }
+    g_assert(wmem_map_size(map) == 0);
+    wmem_free_all(allocator);
+
+    /* string keys and for-each */
+    map = wmem_map_new_open(allocator, WMEM_MAP_KEY_GENERIC, wmem_str_hash, g_str_equal);
+    g_assert(map);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        str_key = wmem_test_rand_string(allocator, 1, 64);
+        wmem_map_insert(map, str_key, GINT_TO_POINTER(2));
+        ret = wmem_map_lookup(map, str_key);
+        g_assert(ret == GINT_TO_POINTER(2));
+    }
+    wmem_map_foreach(map, check_val_map, GINT_TO_POINTER(2));
+
+    wmem_destroy_allocator(extra_allocator);
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_queue(void)
 {
@@ -1273,6 +1444,122 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+static gboolean
+wmem_test_btree_order_cb(const void *key, void *value _U_, void *userdata)
+{
+    guint32 *last = (guint32 *)userdata;
+
+    g_assert(GPOINTER_TO_UINT(key) > *last || cb_called_count == 0);
+    *last = GPOINTER_TO_UINT(key);
+    cb_called_count++;
+
+    return FALSE;
+}
+
+static void
+wmem_test_btree(void)
+{
+    wmem_allocator_t   *allocator, *extra_allocator;
+    wmem_tree_t        *tree;
+    guint32             i, last;
+    wmem_tree_key_t     keys[2];
+    guint32             key[2];
+
+    allocator       = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    tree = wmem_tree_new_btree(allocator);
+    g_assert(tree);
+    g_assert(wmem_tree_is_empty(tree));
+    g_assert(wmem_tree_lookup32_le(tree, 0) == NULL);
+
+    /* ascending keys, spaced out so that lookup32_le falls between them */
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, i*4) == NULL);
+        if (i > 0) {
+            g_assert(wmem_tree_lookup32_le(tree, i*4) == GINT_TO_POINTER(i-1));
+        }
+        wmem_tree_insert32(tree, i*4, GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32(tree, i*4) == GINT_TO_POINTER(i));
+        g_assert(!wmem_tree_is_empty(tree));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    /* fill the gaps in descending order */
+    for (i=CONTAINER_ITERS; i>0; i--) {
+        wmem_tree_insert32(tree, i*4-2, GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS*2);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, i*4) == GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32_le(tree, i*4+1) == GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32_le(tree, i*4+3) == GINT_TO_POINTER(i+1));
+    }
+    g_assert(wmem_tree_remove32(tree, 8) == GINT_TO_POINTER(2));
+    g_assert(wmem_tree_lookup32(tree, 8) == NULL);
+    wmem_tree_insert32(tree, 0xffffffff, GINT_TO_POINTER(1));
+    g_assert(wmem_tree_lookup32_le(tree, 0xfffffffe) == GINT_TO_POINTER(CONTAINER_ITERS));
+
+    cb_called_count = 0;
+    last = 0;
+    wmem_tree_foreach(tree, wmem_test_btree_order_cb, &last);
+    g_assert(cb_called_count == CONTAINER_ITERS*2 + 1);
+    wmem_free_all(allocator);
+
+    tree = wmem_tree_new_btree(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        guint32 rand_int = g_test_rand_int();
+        wmem_tree_insert32(tree, rand_int, GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32(tree, rand_int) == GINT_TO_POINTER(i));
+    }
+    cb_called_count = 0;
+    last = 0;
+    wmem_tree_foreach(tree, wmem_test_btree_order_cb, &last);
+    g_assert(cb_called_count == wmem_tree_count(tree));
+    wmem_free_all(allocator);
+
+    /* test auto-reset functionality */
+    tree = wmem_tree_new_btree_autoreset(allocator, extra_allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        wmem_tree_insert32(tree, i, GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    wmem_free_all(extra_allocator);
+    g_assert(wmem_tree_is_empty(tree));
+    g_assert(wmem_tree_lookup32_le(tree, CONTAINER_ITERS) == NULL);
+    wmem_free_all(allocator);
+
+    /* test array keys, with red/black subtrees under the B+tree */
+    tree = wmem_tree_new_btree(allocator);
+    keys[0].length = 2;
+    keys[0].key    = key;
+    keys[1].length = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key[0] = i % 7;
+        key[1] = i * 4;
+        wmem_tree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key[0] = i % 7;
+        key[1] = i * 4;
+        g_assert(wmem_tree_lookup32_array(tree, keys) == GINT_TO_POINTER(i));
+        key[1] = i * 4 + 3;
+        g_assert(wmem_tree_lookup32_array_le(tree, keys) == GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    wmem_free_all(allocator);
+
+    /* destroying frees it all, for trees in the NULL scope */
+    tree = wmem_tree_new_btree(NULL);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key[0] = i % 7;
+        key[1] = i;
+        wmem_tree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+    }
+    wmem_tree_destroy(tree, FALSE, FALSE);
+
+    wmem_destroy_allocator(extra_allocator);
+    wmem_destroy_allocator(allocator);
+}
 
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
@@ -1390,6 +1677,8 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/stats",     wmem_test_allocator_stats);
+    g_test_add_func("/wmem/scopes/thread",       wmem_test_thread_scopes);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
@@ -1401,10 +1690,12 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
     g_test_add_func("/wmem/datastruct/list",   wmem_test_list);
     g_test_add_func("/wmem/datastruct/map",    wmem_test_map);
+    g_test_add_func("/wmem/datastruct/map_open", wmem_test_map_open);
     g_test_add_func("/wmem/datastruct/queue",  wmem_test_queue);
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    g_test_add_func("/wmem/datastruct/btree",  wmem_test_btree);
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
     ret = g_test_run();
@@ -56,6 +56,23 @@ typedef struct _wmem_tree_node_t wmem_tree_node_t;
 
 typedef struct _wmem_itree_node_t wmem_itree_node_t;
 
+/* Keys per B+tree node, so that the keys of a node fill a cache line */
+#define WMEM_BTREE_ORDER 16
+
+/* A node of a B+tree (see wmem_tree_new_btree). Leaves hold the keys and
+ * their data; in inner nodes keys[i] is the smallest key under children[i].
+ * Nodes are never emptied, since removing a key only sets its data to NULL. */
+typedef struct _wmem_btree_node_t {
+    guint32 keys[WMEM_BTREE_ORDER];
+    union {
+        void                       *data[WMEM_BTREE_ORDER];
+        struct _wmem_btree_node_t  *children[WMEM_BTREE_ORDER];
+    } u;
+    guint16 count;      /* keys used */
+    guint16 is_leaf;
+    guint32 subtrees;   /* leaves: bit i is set if data[i] is a subtree */
+} wmem_btree_node_t;
+
 struct _wmem_tree_t {
     wmem_allocator_t *master;
     wmem_allocator_t *allocator;
@@ -63,6 +80,12 @@ struct _wmem_tree_t {
     guint             master_cb_id;
     guint             slave_cb_id;
 
+    /* B+trees only: the root and the rightmost leaf, which appends and
+     * lookups of the latest keys go to directly */
+    gboolean           is_btree;
+    wmem_btree_node_t *btree_root;
+    wmem_btree_node_t *btree_last;
+
     void (*post_rotation_cb)(wmem_tree_node_t *);
 };
 
@@ -225,6 +225,8 @@ wmem_tree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
     wmem_tree_t *tree = (wmem_tree_t *)user_data;
 
     tree->root = NULL;
+    tree->btree_root = NULL;
+    tree->btree_last = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(tree->master, tree->master_cb_id);
@@ -262,6 +264,48 @@ wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
     return tree;
 }
 
+wmem_tree_t *
+wmem_tree_new_btree(wmem_allocator_t *allocator)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new(allocator);
+    tree->is_btree = TRUE;
+
+    return tree;
+}
+
+wmem_tree_t *
+wmem_tree_new_btree_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new_autoreset(master, slave);
+    tree->is_btree = TRUE;
+
+    return tree;
+}
+
+static void
+free_btree_node(wmem_allocator_t *allocator, wmem_btree_node_t *node, gboolean free_keys, gboolean free_values)
+{
+    guint i;
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            free_btree_node(allocator, node->u.children[i], free_keys, free_values);
+        }
+        else if (node->subtrees & (1U << i)) {
+            wmem_tree_destroy((wmem_tree_t *)node->u.data[i], free_keys, free_values);
+        }
+        else if (free_values) {
+            wmem_free(allocator, node->u.data[i]);
+        }
+    }
+
+    wmem_free(allocator, node);
+}
+
 static void
 free_tree_node(wmem_allocator_t *allocator, wmem_tree_node_t* node, gboolean free_keys, gboolean free_values)
 {
@@ -296,6 +340,9 @@ void
 wmem_tree_destroy(wmem_tree_t *tree, gboolean free_keys, gboolean free_values)
 {
     free_tree_node(tree->allocator, tree->root, free_keys, free_values);
+    if (tree->btree_root) {
+        free_btree_node(tree->allocator, tree->btree_root, free_keys, free_values);
+    }
     wmem_unregister_callback(tree->master, tree->master_cb_id);
     wmem_unregister_callback(tree->allocator, tree->slave_cb_id);
     wmem_free(tree->master, tree);
@@ -304,7 +351,7 @@ wmem_tree_destroy(wmem_tree_t *tree, gboolean free_keys, gboolean free_values)
 gboolean
 wmem_tree_is_empty(wmem_tree_t *tree)
 {
-    return tree->root == NULL;
+    return tree->root == NULL && tree->btree_root == NULL;
 }
 
 static gboolean
@@ -352,6 +399,253 @@ create_node(wmem_allocator_t *allocator, wmem_tree_node_t *parent, const void *k
 
 #define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
 
+/* Index of the last key in the node that is <= key, -1 if there is none */
+static inline int
+btree_find_le(const wmem_btree_node_t *node, guint32 key)
+{
+    int lo = 0, hi = node->count, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (node->keys[mid] <= key) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo - 1;
+}
+
+/* The leaf the key belongs in, or NULL if the tree is empty or all its keys
+ * are bigger. Keys from the last leaf on, which is where lookups of recently
+ * inserted keys go, don't need to walk down the tree. */
+static wmem_btree_node_t *
+btree_find_leaf(const wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *node = tree->btree_last;
+    int                i;
+
+    if (node == NULL) {
+        return NULL;
+    }
+    if (key >= node->keys[0]) {
+        return node;
+    }
+
+    node = tree->btree_root;
+    while (!node->is_leaf) {
+        i = btree_find_le(node, key);
+        if (i < 0) {
+            return NULL;
+        }
+        node = node->u.children[i];
+    }
+
+    return node;
+}
+
+static void *
+btree_lookup32(const wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    int                i;
+
+    if (leaf == NULL) {
+        return NULL;
+    }
+    i = btree_find_le(leaf, key);
+    return (i >= 0 && leaf->keys[i] == key) ? leaf->u.data[i] : NULL;
+}
+
+static void *
+btree_lookup32_le(const wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    int                i;
+
+    if (leaf == NULL) {
+        return NULL;
+    }
+    i = btree_find_le(leaf, key);
+    return i >= 0 ? leaf->u.data[i] : NULL;
+}
+
+static wmem_btree_node_t *
+btree_new_node(wmem_tree_t *tree, gboolean is_leaf)
+{
+    wmem_btree_node_t *node;
+
+    node = wmem_new(tree->allocator, wmem_btree_node_t);
+    node->count    = 0;
+    node->is_leaf  = is_leaf;
+    node->subtrees = 0;
+
+    return node;
+}
+
+/* Puts a key and its data or child at pos of a node that isn't full */
+static void
+btree_node_insert_at(wmem_btree_node_t *node, guint pos, guint32 key,
+        void *ptr, gboolean is_subtree)
+{
+    guint32 below;
+
+    memmove(&node->keys[pos + 1], &node->keys[pos],
+            (node->count - pos) * sizeof(node->keys[0]));
+    memmove(&node->u.data[pos + 1], &node->u.data[pos],
+            (node->count - pos) * sizeof(node->u.data[0]));
+    node->keys[pos] = key;
+
+    if (node->is_leaf) {
+        node->u.data[pos] = ptr;
+        below = node->subtrees & ((1U << pos) - 1);
+        node->subtrees = below | ((node->subtrees & ~below) << 1) |
+            ((is_subtree ? 1U : 0U) << pos);
+    }
+    else {
+        node->u.children[pos] = (wmem_btree_node_t *)ptr;
+    }
+
+    node->count++;
+}
+
+/* Puts a key and its data or child at pos, splitting the node in two if it
+ * is full. Returns the new right sibling then, NULL otherwise. Splitting the
+ * rightmost node to append to it leaves it full and starts the sibling with
+ * just the new key, so that nodes filled in ascending order stay full. */
+static wmem_btree_node_t *
+btree_node_add(wmem_tree_t *tree, wmem_btree_node_t *node, guint pos,
+        guint32 key, void *ptr, gboolean is_subtree, gboolean rightmost)
+{
+    wmem_btree_node_t *sibling;
+    guint              half;
+
+    if (node->count < WMEM_BTREE_ORDER) {
+        btree_node_insert_at(node, pos, key, ptr, is_subtree);
+        return NULL;
+    }
+
+    half = (rightmost && pos == node->count) ? WMEM_BTREE_ORDER : WMEM_BTREE_ORDER / 2;
+
+    sibling = btree_new_node(tree, node->is_leaf);
+    sibling->count = node->count - half;
+    memcpy(sibling->keys, &node->keys[half], sibling->count * sizeof(node->keys[0]));
+    memcpy(sibling->u.data, &node->u.data[half], sibling->count * sizeof(node->u.data[0]));
+    if (node->is_leaf) {
+        sibling->subtrees = node->subtrees >> half;
+        node->subtrees &= (1U << half) - 1;
+    }
+    node->count = half;
+
+    if (pos <= half && half < WMEM_BTREE_ORDER) {
+        btree_node_insert_at(node, pos, key, ptr, is_subtree);
+    }
+    else {
+        btree_node_insert_at(sibling, pos - half, key, ptr, is_subtree);
+    }
+
+    if (node == tree->btree_last) {
+        tree->btree_last = sibling;
+    }
+
+    return sibling;
+}
+
+typedef struct {
+    guint32    key;
+    void    *(*func)(void*);
+    void      *data;
+    gboolean   is_subtree;
+    gboolean   replace;
+    void      *result;  /* the data at the key once done */
+} btree_insert_t;
+
+/* Inserts into the subtree under node, returns node's new right sibling if
+ * it had to be split */
+static wmem_btree_node_t *
+btree_insert_node(wmem_tree_t *tree, wmem_btree_node_t *node,
+        btree_insert_t *ins, gboolean rightmost)
+{
+    wmem_btree_node_t *split;
+    int                pos;
+
+    pos = btree_find_le(node, ins->key);
+
+    if (node->is_leaf) {
+        if (pos >= 0 && node->keys[pos] == ins->key) {
+            if (ins->replace) {
+                node->u.data[pos] = CREATE_DATA(ins->func, ins->data);
+                if (ins->is_subtree) {
+                    node->subtrees |= 1U << pos;
+                }
+                else {
+                    node->subtrees &= ~(1U << pos);
+                }
+            }
+            ins->result = node->u.data[pos];
+            return NULL;
+        }
+
+        ins->result = CREATE_DATA(ins->func, ins->data);
+        return btree_node_add(tree, node, pos + 1, ins->key, ins->result,
+                ins->is_subtree, rightmost);
+    }
+
+    if (pos < 0) {
+        /* smaller than every key in the tree, this is the leftmost path */
+        pos = 0;
+        node->keys[0] = ins->key;
+    }
+
+    split = btree_insert_node(tree, node->u.children[pos], ins,
+            rightmost && pos == node->count - 1);
+    if (split == NULL) {
+        return NULL;
+    }
+
+    return btree_node_add(tree, node, pos + 1, split->keys[0], split, FALSE,
+            rightmost);
+}
+
+static void *
+btree_lookup_or_insert32(wmem_tree_t *tree, guint32 key,
+        void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
+{
+    wmem_btree_node_t *last = tree->btree_last;
+    wmem_btree_node_t *split, *root;
+    btree_insert_t     ins;
+
+    if (tree->btree_root == NULL) {
+        tree->btree_root = tree->btree_last = btree_new_node(tree, TRUE);
+    }
+    else if (last->count < WMEM_BTREE_ORDER && key > last->keys[last->count - 1]) {
+        /* A new biggest key that fits in the last leaf. Keys in inner nodes
+         * are the smallest of their subtree, so none of them change. */
+        data = CREATE_DATA(func, data);
+        btree_node_insert_at(last, last->count, key, data, is_subtree);
+        return data;
+    }
+
+    ins.key        = key;
+    ins.func       = func;
+    ins.data       = data;
+    ins.is_subtree = is_subtree;
+    ins.replace    = replace;
+    ins.result     = NULL;
+
+    split = btree_insert_node(tree, tree->btree_root, &ins, TRUE);
+    if (split) {
+        root = btree_new_node(tree, FALSE);
+        btree_node_insert_at(root, 0, tree->btree_root->keys[0], tree->btree_root, FALSE);
+        btree_node_insert_at(root, 1, split->keys[0], split, FALSE);
+        tree->btree_root = root;
+    }
+
+    return ins.result;
+}
+
 
 /**
  * return inserted node
@@ -419,7 +713,13 @@ static void *
 lookup_or_insert32(wmem_tree_t *tree, guint32 key,
         void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
 {
-    wmem_tree_node_t *node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
+    wmem_tree_node_t *node;
+
+    if (tree->is_btree) {
+        return btree_lookup_or_insert32(tree, key, func, data, is_subtree, replace);
+    }
+
+    node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
     return node->data;
 }
 
@@ -456,6 +756,9 @@ wmem_tree_insert(wmem_tree_t *tree, const void *key, void *data, compare_func cm
     wmem_tree_node_t *node = tree->root;
     wmem_tree_node_t *new_node = NULL;
 
+    /* only 32-bit keys are supported by B+trees */
+    g_assert(!tree->is_btree);
+
     /* is this the first node ?*/
     if (!node) {
         tree->root = create_node(tree->allocator, node, key,
@@ -513,6 +816,10 @@ wmem_tree_lookup32(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->is_btree) {
+        return btree_lookup32(tree, key);
+    }
+
     while (node) {
         if (key == GPOINTER_TO_UINT(node->key)) {
             return node->data;
@@ -533,6 +840,10 @@ wmem_tree_lookup32_le(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->is_btree) {
+        return btree_lookup32_le(tree, key);
+    }
+
     while (node) {
         if (key == GPOINTER_TO_UINT(node->key)) {
             return node->data;
@@ -623,6 +934,8 @@ wmem_tree_lookup_string(wmem_tree_t* tree, const gchar* k, guint32 flags)
 {
     compare_func cmp;
 
+    g_assert(!tree->is_btree);
+
     if (flags & WMEM_TREE_STRING_NOCASE) {
         cmp = (compare_func)g_ascii_strcasecmp;
     } else {
@@ -758,10 +1071,38 @@ wmem_tree_foreach_nodes(wmem_tree_node_t* node, wmem_foreach_func callback,
     return FALSE;
 }
 
+static gboolean
+wmem_btree_foreach_nodes(wmem_btree_node_t *node, wmem_foreach_func callback,
+        void *user_data)
+{
+    guint i;
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            if (wmem_btree_foreach_nodes(node->u.children[i], callback, user_data)) {
+                return TRUE;
+            }
+        }
+        else if (node->subtrees & (1U << i)) {
+            if (wmem_tree_foreach((wmem_tree_t *)node->u.data[i], callback, user_data)) {
+                return TRUE;
+            }
+        }
+        else if (callback(GUINT_TO_POINTER(node->keys[i]), node->u.data[i], user_data)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 gboolean
 wmem_tree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
         void *user_data)
 {
+    if (tree->btree_root)
+        return wmem_btree_foreach_nodes(tree->btree_root, callback, user_data);
+
     if(!tree->root)
         return FALSE;
 
@@ -814,12 +1155,56 @@ wmem_tree_print_nodes(const char *prefix, wmem_tree_node_t *node, guint32 level,
 }
 
 
+static void
+wmem_btree_print_nodes(wmem_btree_node_t *node, guint32 level,
+    wmem_printer_func key_printer, wmem_printer_func data_printer)
+{
+    gboolean is_subtree;
+    guint    i;
+
+    wmem_print_indent(level);
+    ws_debug_printf("%s:%p count:%u\n", node->is_leaf?"LEAF":"NODE", (void *)node, node->count);
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            wmem_btree_print_nodes(node->u.children[i], level+1, key_printer, data_printer);
+            continue;
+        }
+
+        is_subtree = (node->subtrees & (1U << i)) != 0;
+        wmem_print_indent(level+1);
+        ws_debug_printf("key:%u %s:%p\n", node->keys[i],
+                is_subtree?"tree":"data", node->u.data[i]);
+        if (key_printer) {
+            wmem_print_indent(level+1);
+            key_printer(GUINT_TO_POINTER(node->keys[i]));
+            ws_debug_printf("\n");
+        }
+        if (data_printer && !is_subtree) {
+            wmem_print_indent(level+1);
+            data_printer(node->u.data[i]);
+            ws_debug_printf("\n");
+        }
+        if (is_subtree)
+            wmem_print_subtree((wmem_tree_t *)node->u.data[i], level+2, key_printer, data_printer);
+    }
+}
+
 static void
 wmem_print_subtree(wmem_tree_t *tree, guint32 level, wmem_printer_func key_printer, wmem_printer_func data_printer)
 {
     if (!tree)
         return;
 
+    if (tree->is_btree) {
+        wmem_print_indent(level);
+        ws_debug_printf("WMEM B+tree:%p root:%p\n", (void *)tree, (void *)tree->btree_root);
+        if (tree->btree_root) {
+            wmem_btree_print_nodes(tree->btree_root, level, key_printer, data_printer);
+        }
+        return;
+    }
+
     wmem_print_indent(level);
 
     ws_debug_printf("WMEM tree:%p root:%p\n", (void *)tree, (void *)tree->root);
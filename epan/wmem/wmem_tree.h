@@ -72,6 +72,33 @@ wmem_tree_t *
 wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
 G_GNUC_MALLOC;
 
+/** Creates a tree that is a B+tree rather than a red/black tree. Its nodes
+ * hold many keys each, so lookups go through a few cache-friendly levels
+ * instead of one node per level, and keys inserted in ascending order (frame
+ * numbers, sequence numbers) are appended to the last leaf directly. Worth it
+ * for trees that get large; a small tree takes more memory than a red/black
+ * one.
+ *
+ * Only guint32 keys are supported: the wmem_tree_*32 and wmem_tree_*32_array
+ * functions, plus wmem_tree_foreach(), wmem_tree_count() and friends. Using
+ * string keys with it is a bug. With array keys only the first key is kept
+ * in the B+tree; the subtrees for the keys after it are red/black trees, as
+ * they usually hold few nodes. Keys aren't pointers, so the free_keys
+ * argument of wmem_tree_destroy() doesn't apply to the B+tree itself.
+ */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_btree(wmem_allocator_t *allocator)
+G_GNUC_MALLOC;
+
+/** Like wmem_tree_new_autoreset(), for a B+tree as created by
+ * wmem_tree_new_btree().
+ */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_btree_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
+G_GNUC_MALLOC;
+
 /** Cleanup memory used by tree.  Intended for NULL scope allocated trees */
 WS_DLL_PUBLIC
 void
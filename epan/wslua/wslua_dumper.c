@@ -218,7 +218,7 @@ WSLUA_CONSTRUCTOR Dumper_new(lua_State* L) {
     int err = 0;
     const char* filename = cross_plat_fname(fname);
 
-    d = wtap_dump_open(filename, filetype, encap, 0, FALSE, &err);
+    d = wtap_dump_open(filename, filetype, encap, 0, WTAP_UNCOMPRESSED, &err);
 
     if (! d ) {
         /* WSLUA_ERROR("Error while opening file for writing"); */
@@ -375,7 +375,7 @@ WSLUA_METHOD Dumper_new_for_current(lua_State* L) {
 
     encap = lua_pinfo->pkt_encap;
 
-    d = wtap_dump_open(filename, filetype, encap, 0, FALSE, &err);
+    d = wtap_dump_open(filename, filetype, encap, 0, WTAP_UNCOMPRESSED, &err);
 
     if (! d ) {
         switch (err) {
@@ -442,7 +442,7 @@ WSLUA_METHOD Dumper_dump_current(lua_State* L) {
     if (lua_pinfo->fd->flags.has_user_comment)
         pkthdr.opt_comment = wmem_strdup(wmem_packet_scope(), epan_get_user_comment(lua_pinfo->epan, lua_pinfo->fd));
     else if (lua_pinfo->fd->flags.has_phdr_comment)
-        pkthdr.opt_comment = wmem_strdup(wmem_packet_scope(), lua_pinfo->phdr->opt_comment);
+        pkthdr.opt_comment = wmem_strdup(wmem_packet_scope(), wtap_phdr_get_comment(lua_pinfo->phdr));
 
     data = (const guchar *)tvb_memdup(wmem_packet_scope(),tvb,0,pkthdr.caplen);
 
@@ -180,6 +180,13 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
                     lua_pushstring(L, fi->ws_fi->rep->representation);
                     return 1;
                 }
+                if (fi->ws_fi->length > 0 && fi->ws_fi->affix) {
+                    gchar label_str[ITEM_LABEL_LENGTH];
+
+                    proto_item_fill_label(fi->ws_fi, label_str);
+                    lua_pushstring(L, label_str);
+                    return 1;
+                }
                 return 0;
         case FT_BYTES:
         case FT_UINT_BYTES:
@@ -371,7 +371,7 @@ static struct extcap_dumper extcap_dumper_open(char *fifo, int encap) {
         exit(EXIT_CODE_UNKNOWN_ENCAPSULATION_WIRETAP);
     }
 
-    extcap_dumper.dumper.wtap = wtap_dump_open(fifo, WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC, encap_ext, PACKET_LENGTH, FALSE, &err);
+    extcap_dumper.dumper.wtap = wtap_dump_open(fifo, WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC, encap_ext, PACKET_LENGTH, WTAP_UNCOMPRESSED, &err);
     if (!extcap_dumper.dumper.wtap) {
         g_warning("Cannot save dump file");
         exit(EXIT_CODE_CANNOT_SAVE_WIRETAP_DUMP);
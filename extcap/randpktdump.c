@@ -43,7 +43,12 @@ enum {
 	OPT_COUNT,
 	OPT_RANDOM_TYPE,
 	OPT_ALL_RANDOM,
-	OPT_TYPE
+	OPT_TYPE,
+	OPT_FLOWS,
+	OPT_SEED,
+	OPT_LOSS,
+	OPT_REORDER,
+	OPT_RATE
 };
 
 static struct option longopts[] = {
@@ -55,6 +60,11 @@ static struct option longopts[] = {
 	{ "random-type",			required_argument, 	NULL, OPT_RANDOM_TYPE},
 	{ "all-random",				required_argument,	NULL, OPT_ALL_RANDOM},
 	{ "type",					required_argument,	NULL, OPT_TYPE},
+	{ "flows",					required_argument,	NULL, OPT_FLOWS},
+	{ "seed",					required_argument,	NULL, OPT_SEED},
+	{ "loss",					required_argument,	NULL, OPT_LOSS},
+	{ "reorder",				required_argument,	NULL, OPT_REORDER},
+	{ "rate",					required_argument,	NULL, OPT_RATE},
     { 0, 0, 0, 0 }
 };
 
@@ -121,6 +131,23 @@ static int list_config(char *interface)
 	g_strfreev(longname_list);
 	inc++;
 
+	printf("arg {number=%u}{call=--flows}{display=Concurrent flows}"
+		"{type=unsigned}{range=0,100000}{default=0}"
+		"{tooltip=Generate this many concurrent TCP/HTTP, DNS, fragmented UDP and RTP flows instead of random packets (0 to disable)}\n",
+		inc++);
+	printf("arg {number=%u}{call=--seed}{display=Seed}"
+		"{type=unsigned}{default=0}{tooltip=Seed for the flows; the same seed gives the same packets}\n",
+		inc++);
+	printf("arg {number=%u}{call=--loss}{display=Loss (%%)}"
+		"{type=double}{default=0}{tooltip=Percentage of data packets lost in the flows}\n",
+		inc++);
+	printf("arg {number=%u}{call=--reorder}{display=Reorder (%%)}"
+		"{type=double}{default=0}{tooltip=Percentage of data packets reordered in the flows}\n",
+		inc++);
+	printf("arg {number=%u}{call=--rate}{display=Packet rate}"
+		"{type=unsigned}{default=0}{tooltip=Packets per second to generate the flows at (0 for as fast as possible)}\n",
+		inc++);
+
 	return EXIT_SUCCESS;
 }
 
@@ -135,6 +162,10 @@ int main(int argc, char *argv[])
 	char* type = NULL;
 	int produce_type = -1;
 	randpkt_example	*example;
+	randpkt_flow_params flow_params;
+	randpkt_flows *flows;
+	guint32 rate = 0;
+	gchar *end;
 	wtap_dumper* savedump;
 	int i;
 	int ret = EXIT_FAILURE;
@@ -170,6 +201,11 @@ int main(int argc, char *argv[])
 	extcap_help_add_option(extcap_conf, "--random-type", "one random type is chosen for all packets");
 	extcap_help_add_option(extcap_conf, "--all-random", "a random type is chosen for each packet");
 	extcap_help_add_option(extcap_conf, "--type <type>", "the packet type");
+	extcap_help_add_option(extcap_conf, "--flows <num>", "generate this many concurrent stateful flows instead");
+	extcap_help_add_option(extcap_conf, "--seed <num>", "seed for the flows");
+	extcap_help_add_option(extcap_conf, "--loss <percent>", "percentage of data packets lost in the flows");
+	extcap_help_add_option(extcap_conf, "--reorder <percent>", "percentage of data packets reordered in the flows");
+	extcap_help_add_option(extcap_conf, "--rate <pps>", "packets per second to generate the flows at");
 
 	if (argc == 1) {
 		help(extcap_conf);
@@ -183,6 +219,8 @@ int main(int argc, char *argv[])
 	for (i = 0; i < argc; i++)
 		g_debug("%s ", argv[i]);
 
+	memset(&flow_params, 0, sizeof flow_params);
+
 	while ((result = getopt_long(argc, argv, ":", longopts, &option_idx)) != -1) {
 		switch (result) {
 		case OPT_VERSION:
@@ -227,6 +265,43 @@ int main(int argc, char *argv[])
 			type = g_strdup(optarg);
 			break;
 
+		case OPT_FLOWS:
+			if (!ws_strtou32(optarg, NULL, &flow_params.flows)) {
+				g_warning("Invalid number of flows: %s", optarg);
+				goto end;
+			}
+			break;
+
+		case OPT_SEED:
+			if (!ws_strtou32(optarg, NULL, &flow_params.seed)) {
+				g_warning("Invalid seed: %s", optarg);
+				goto end;
+			}
+			break;
+
+		case OPT_LOSS:
+		case OPT_REORDER:
+			{
+				double percent = g_ascii_strtod(optarg, &end);
+
+				if (end == optarg || *end != '\0' || percent < 0.0 || percent > 100.0) {
+					g_warning("Invalid percentage: %s", optarg);
+					goto end;
+				}
+				if (result == OPT_LOSS)
+					flow_params.loss = percent / 100.0;
+				else
+					flow_params.reorder = percent / 100.0;
+			}
+			break;
+
+		case OPT_RATE:
+			if (!ws_strtou32(optarg, NULL, &rate)) {
+				g_warning("Invalid packet rate: %s", optarg);
+				goto end;
+			}
+			break;
+
 		case ':':
 			/* missing option argument */
 			g_warning("Option '%s' requires an argument", argv[optind - 1]);
@@ -284,7 +359,20 @@ int main(int argc, char *argv[])
 			goto end;
 		}
 
-		if (!all_random) {
+		if (flow_params.flows > 0) {
+			g_debug("Generating %u flows", flow_params.flows);
+
+			flow_params.max_bytes = maxbytes;
+			flows = randpkt_flows_new(&flow_params, extcap_conf->fifo);
+			if (!flows)
+				goto end;
+			if (!randpkt_flows_loop(flows, count, rate)) {
+				randpkt_flows_close(flows);
+				goto end;
+			}
+			if (!randpkt_flows_close(flows))
+				goto end;
+		} else if (!all_random) {
 			produce_type = randpkt_parse_type(type);
 
 			example = randpkt_find_example(produce_type);
@@ -295,6 +295,7 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   wtap  *wth;
   gchar *err_info;
 
+  wtap_set_fast_seek_index(prefs.gui_fast_seek_index);
   wth = wtap_open_offline(fname, type, err, &err_info, TRUE);
   if (wth == NULL)
     goto fail;
@@ -1249,7 +1250,7 @@ read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
     fdata = frame_data_sequence_add(cf->frames, &fdlocal);
 
     cf->count++;
-    if (phdr->opt_comment != NULL)
+    if (fdlocal.flags.has_phdr_comment)
       cf->packet_comment_count++;
     cf->f_datalen = offset + fdlocal.cap_len;
 
@@ -3901,6 +3902,7 @@ cf_get_comment(capture_file *cf, const frame_data *fd)
     if (!cf_read_record_r(cf, fd, &phdr, &buf))
       { /* XXX, what we can do here? */ }
 
+    wtap_phdr_decode_options(&phdr);
     comment = phdr.opt_comment;
     wtap_phdr_cleanup(&phdr);
     ws_buffer_free(&buf);
@@ -4058,7 +4060,7 @@ save_record(capture_file *cf, frame_data *fdata,
   if (fdata->flags.has_user_comment)
     pkt_comment = cf_get_user_packet_comment(cf, fdata);
   else
-    pkt_comment = phdr->opt_comment;
+    pkt_comment = wtap_phdr_get_comment(phdr);
 
   /* init the wtap header for saving */
   /* TODO: reuse phdr */
@@ -4604,10 +4606,12 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
          from which we're reading the packets that we're writing!) */
       fname_new = g_strdup_printf("%s~", fname);
       pdh = wtap_dump_open_ng(fname_new, save_format, encap, cf->snap,
-                              compressed, shb_hdrs, idb_inf, nrb_hdrs, &err);
+                              compressed ? WTAP_GZIP_COMPRESSED : WTAP_UNCOMPRESSED,
+                              shb_hdrs, idb_inf, nrb_hdrs, &err);
     } else {
       pdh = wtap_dump_open_ng(fname, save_format, encap, cf->snap,
-                              compressed, shb_hdrs, idb_inf, nrb_hdrs, &err);
+                              compressed ? WTAP_GZIP_COMPRESSED : WTAP_UNCOMPRESSED,
+                              shb_hdrs, idb_inf, nrb_hdrs, &err);
     }
     g_free(idb_inf);
     idb_inf = NULL;
@@ -4836,10 +4840,12 @@ cf_export_specified_packets(capture_file *cf, const char *fname,
        from which we're reading the packets that we're writing!) */
     fname_new = g_strdup_printf("%s~", fname);
     pdh = wtap_dump_open_ng(fname_new, save_format, encap, cf->snap,
-                            compressed, shb_hdrs, idb_inf, nrb_hdrs, &err);
+                            compressed ? WTAP_GZIP_COMPRESSED : WTAP_UNCOMPRESSED,
+                            shb_hdrs, idb_inf, nrb_hdrs, &err);
   } else {
     pdh = wtap_dump_open_ng(fname, save_format, encap, cf->snap,
-                            compressed, shb_hdrs, idb_inf, nrb_hdrs, &err);
+                            compressed ? WTAP_GZIP_COMPRESSED : WTAP_UNCOMPRESSED,
+                            shb_hdrs, idb_inf, nrb_hdrs, &err);
   }
   g_free(idb_inf);
   idb_inf = NULL;
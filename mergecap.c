@@ -63,6 +63,9 @@
 #include <wsutil/unicode-utils.h>
 #endif /* _WIN32 */
 
+/* Smallest per-file read buffer worth asking for */
+#define MERGE_MIN_READ_BUFFER_SIZE (64 * 1024)
+
 /*
  * Show the usage
  */
@@ -81,6 +84,8 @@ print_usage(FILE *output)
   fprintf(output, "                    an empty \"-F\" option will list the file types.\n");
   fprintf(output, "  -I <IDB merge mode> set the merge mode for Interface Description Blocks; default is 'all'.\n");
   fprintf(output, "                    an empty \"-I\" option will list the merge modes.\n");
+  fprintf(output, "  --compress <type> compress the output file with <type>.\n");
+  fprintf(output, "                    an empty \"--compress\" option will list the compression types.\n");
   fprintf(output, "\n");
   fprintf(output, "Miscellaneous:\n");
   fprintf(output, "  -h                display this help and exit.\n");
@@ -162,6 +167,21 @@ list_capture_types(void) {
   g_free(captypes);
 }
 
+static void
+list_compression_types(void) {
+  GSList *list, *elem;
+
+  fprintf(stderr, "mergecap: The available compression types for the \"--compress\" flag are:\n");
+  list = wtap_get_all_compression_type_names_list();
+  for (elem = list; elem != NULL; elem = g_slist_next(elem)) {
+    const char *name = (const char *)elem->data;
+
+    fprintf(stderr, "    %s - %s\n", name,
+            wtap_compression_type_description(wtap_name_to_compression_type(name)));
+  }
+  g_slist_free(list);
+}
+
 static void
 list_idb_merge_modes(void) {
   int i;
@@ -248,12 +268,14 @@ main(int argc, char *argv[])
   static const struct option long_options[] = {
       {"help", no_argument, NULL, 'h'},
       {"version", no_argument, NULL, 'V'},
+      {"compress", required_argument, NULL, 0x8100},
       {0, 0, 0, 0 }
   };
   gboolean            do_append          = FALSE;
   gboolean            verbose            = FALSE;
   int                 in_file_count      = 0;
   guint32             snaplen            = 0;
+  wtap_compression_type compression_type = WTAP_UNCOMPRESSED;
 #ifdef PCAP_NG_DEFAULT
   int                 file_type          = WTAP_FILE_TYPE_SUBTYPE_PCAPNG; /* default to pcap format */
 #else
@@ -386,6 +408,23 @@ main(int argc, char *argv[])
       out_filename = optarg;
       break;
 
+    case 0x8100:
+      compression_type = wtap_name_to_compression_type(optarg);
+      if (compression_type == WTAP_UNKNOWN_COMPRESSION) {
+        fprintf(stderr, "mergecap: \"%s\" isn't a valid compression type\n",
+                optarg);
+        list_compression_types();
+        status = MERGE_ERR_INVALID_OPTION;
+        goto clean_exit;
+      }
+      if (!wtap_can_write_compression_type(compression_type)) {
+        fprintf(stderr, "mergecap: Writing %s compressed files isn't supported by this build\n",
+                wtap_compression_type_name(compression_type));
+        status = MERGE_ERR_INVALID_OPTION;
+        goto clean_exit;
+      }
+      break;
+
     case '?':              /* Bad options if GNU getopt */
       switch(optopt) {
       case'F':
@@ -394,6 +433,9 @@ main(int argc, char *argv[])
       case'I':
         list_idb_merge_modes();
         break;
+      case 0x8100:
+        list_compression_types();
+        break;
       default:
         print_usage(stderr);
       }
@@ -421,6 +463,15 @@ main(int argc, char *argv[])
     return 1;
   }
 
+  /*
+   * We read files straight through, so read them in large chunks; but
+   * all of them are open at once, so share one large buffer's worth of
+   * memory between them, and don't bother once that leaves each file
+   * too little to make a difference.
+   */
+  if (WTAP_SEQUENTIAL_READ_BUFFER_SIZE / in_file_count >= MERGE_MIN_READ_BUFFER_SIZE)
+    wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE / in_file_count);
+
   /* setting IDB merge mode must use PCAPNG output */
   if (mode != IDB_MERGE_MODE_MAX && file_type != WTAP_FILE_TYPE_SUBTYPE_PCAPNG) {
     fprintf(stderr, "The IDB merge mode can only be used with PCAPNG output format\n");
@@ -440,13 +491,14 @@ main(int argc, char *argv[])
     status = merge_files_to_stdout(file_type,
                                    (const char *const *) &argv[optind],
                                    in_file_count, do_append, mode, snaplen,
-                                   "mergecap", verbose ? &cb : NULL,
+                                   compression_type, "mergecap", verbose ? &cb : NULL,
                                    &err, &err_info, &err_fileno);
   } else {
     /* merge the files to the outfile */
     status = merge_files(out_filename, file_type,
                          (const char *const *) &argv[optind], in_file_count,
-                         do_append, mode, snaplen, "mergecap", verbose ? &cb : NULL,
+                         do_append, mode, snaplen, compression_type,
+                         "mergecap", verbose ? &cb : NULL,
                          &err, &err_info, &err_fileno);
   }
 
@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/unicode-utils.h>
@@ -52,6 +53,7 @@
 #define INVALID_OPTION 1
 #define INVALID_TYPE 2
 #define CLOSE_ERROR 2
+#define WRITE_ERROR 2
 
 /*
  * General errors and warnings are reported with an console message
@@ -75,6 +77,21 @@ failure_message_cont(const char *msg_format, va_list ap)
 	fprintf(stderr, "\n");
 }
 
+/* Parse a percentage, allowing fractions, into a fraction of 1 */
+static double
+get_percentage(const char *string, const char *name)
+{
+	double	number;
+	char	*end;
+
+	number = g_ascii_strtod(string, &end);
+	if (end == string || *end != '\0' || number < 0.0 || number > 100.0) {
+		cmdarg_err("The specified %s \"%s\" isn't a percentage between 0 and 100", name, string);
+		exit(1);
+	}
+	return number / 100.0;
+}
+
 /* Print usage statement and exit program */
 static void
 usage(gboolean is_error)
@@ -92,9 +109,16 @@ usage(gboolean is_error)
 	}
 
 	fprintf(output, "Usage: randpkt [-b maxbytes] [-c count] [-t type] [-r] filename\n");
+	fprintf(output, "       randpkt -F flows [-b maxbytes] [-c count] [-s seed] [-l loss] [-o reorder] filename\n");
 	fprintf(output, "Default max bytes (per packet) is 5000\n");
 	fprintf(output, "Default count is 1000.\n");
 	fprintf(output, "-r: random packet type selection\n");
+	fprintf(output, "-F: generate this many concurrent TCP/HTTP, DNS, fragmented UDP and RTP\n");
+	fprintf(output, "    flows instead of random packets; max bytes limits HTTP bodies and\n");
+	fprintf(output, "    UDP datagrams\n");
+	fprintf(output, "-s: seed for -F; the same seed gives the same file\n");
+	fprintf(output, "-l: percentage of data packets lost in -F flows\n");
+	fprintf(output, "-o: percentage of data packets reordered in -F flows\n");
 	fprintf(output, "\n");
 	fprintf(output, "Types:\n");
 
@@ -125,6 +149,8 @@ main(int argc, char **argv)
 	int 			allrandom = FALSE;
 	wtap_dumper		*savedump;
 	int 			 ret = EXIT_SUCCESS;
+	randpkt_flow_params	flow_params;
+	randpkt_flows		*flows;
 	static const struct option long_options[] = {
 		{"help", no_argument, NULL, 'h'},
 		{0, 0, 0, 0 }
@@ -174,7 +200,10 @@ main(int argc, char **argv)
 	register_all_wiretap_modules();
 #endif
 
-	while ((opt = getopt_long(argc, argv, "b:c:ht:r", long_options, NULL)) != -1) {
+	memset(&flow_params, 0, sizeof flow_params);
+	flow_params.seed = g_random_int();
+
+	while ((opt = getopt_long(argc, argv, "b:c:F:hl:o:rs:t:", long_options, NULL)) != -1) {
 		switch (opt) {
 			case 'b':	/* max bytes */
 				produce_max_bytes = get_positive_int(optarg, "max bytes");
@@ -202,6 +231,22 @@ main(int argc, char **argv)
 				allrandom = TRUE;
 				break;
 
+			case 'F':	/* concurrent flows */
+				flow_params.flows = get_positive_int(optarg, "flow count");
+				break;
+
+			case 's':	/* seed */
+				flow_params.seed = get_guint32(optarg, "seed");
+				break;
+
+			case 'l':	/* loss */
+				flow_params.loss = get_percentage(optarg, "loss");
+				break;
+
+			case 'o':	/* reorder */
+				flow_params.reorder = get_percentage(optarg, "reorder");
+				break;
+
 			default:
 				usage(TRUE);
 				ret = INVALID_OPTION;
@@ -220,6 +265,26 @@ main(int argc, char **argv)
 		goto clean_exit;
 	}
 
+	if (flow_params.flows > 0) {
+		if (type || allrandom) {
+			fprintf(stderr, "Can't set type or random mode with flows\n");
+			ret = INVALID_TYPE;
+			goto clean_exit;
+		}
+
+		flow_params.max_bytes = produce_max_bytes;
+		flows = randpkt_flows_new(&flow_params, produce_filename);
+		if (!flows) {
+			ret = WRITE_ERROR;
+			goto clean_exit;
+		}
+		if (!randpkt_flows_loop(flows, produce_count, 0))
+			ret = WRITE_ERROR;
+		if (!randpkt_flows_close(flows) && ret == EXIT_SUCCESS)
+			ret = CLOSE_ERROR;
+		goto clean_exit;
+	}
+
 	if (!allrandom) {
 		produce_type = randpkt_parse_type(type);
 		g_free(type);
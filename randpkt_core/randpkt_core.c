@@ -719,11 +719,11 @@ int randpkt_example_init(randpkt_example* example, char* produce_filename, int p
 	if (strcmp(produce_filename, "-") == 0) {
 		/* Write to the standard output. */
 		example->dump = wtap_dump_open_stdout(WTAP_FILE_TYPE_SUBTYPE_PCAP,
-			example->sample_wtap_encap, produce_max_bytes, FALSE /* compressed */, &err);
+			example->sample_wtap_encap, produce_max_bytes, WTAP_UNCOMPRESSED, &err);
 		example->filename = "the standard output";
 	} else {
 		example->dump = wtap_dump_open(produce_filename, WTAP_FILE_TYPE_SUBTYPE_PCAP,
-			example->sample_wtap_encap, produce_max_bytes, FALSE /* compressed */, &err);
+			example->sample_wtap_encap, produce_max_bytes, WTAP_UNCOMPRESSED, &err);
 		example->filename = produce_filename;
 	}
 	if (!example->dump) {
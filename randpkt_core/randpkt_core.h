@@ -63,6 +63,26 @@ void randpkt_loop(randpkt_example* example, guint64 produce_count);
 /* Close the current example */
 gboolean randpkt_example_close(randpkt_example* example);
 
+/* Parameters of the stateful traffic generator */
+typedef struct {
+	guint		flows;		/* number of flows in progress at any time */
+	guint		max_bytes;	/* largest HTTP body or fragmented UDP datagram */
+	double		loss;		/* fraction of data packets lost, 0.0 - 1.0 */
+	double		reorder;	/* fraction of data packets delivered out of order */
+	guint32		seed;		/* the same seed always gives the same packets */
+} randpkt_flow_params;
+
+typedef struct _randpkt_flows randpkt_flows;
+
+/* Open the output file and start the flows; returns NULL on error */
+randpkt_flows* randpkt_flows_new(const randpkt_flow_params* params, const char* produce_filename);
+
+/* Write produce_count packets; if rate is not 0, at most rate packets per second */
+gboolean randpkt_flows_loop(randpkt_flows* flows, guint64 produce_count, guint rate);
+
+/* Close the output file and free the flows */
+gboolean randpkt_flows_close(randpkt_flows* flows);
+
 #endif
 
 /*
@@ -0,0 +1,750 @@
+/*
+ * randpkt_flows.c
+ * ---------
+ * Creates traces of synthetic but well-formed traffic: TCP connections
+ * carrying HTTP, DNS lookups, fragmented UDP datagrams and RTP streams,
+ * with a number of flows in progress at the same time. Useful for
+ * benchmarking the stateful parts of a sniffer (conversations,
+ * reassembly, stream analysis) rather than its robustness.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <config.h>
+
+#include "randpkt_core.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Packets are stamped with a synthetic clock, not the wall clock, so that
+ * a given seed always produces the same file. It starts at
+ * 2017-01-01 00:00:00 UTC.
+ */
+#define FLOW_CLOCK_BASE		1483228800
+
+#define ETH_HDR_LEN		14
+#define IP_HDR_LEN		20
+#define TCP_HDR_LEN		20
+#define UDP_HDR_LEN		8
+#define RTP_HDR_LEN		12
+
+#define FLOW_MTU		1500
+#define FLOW_MSS		(FLOW_MTU - IP_HDR_LEN - TCP_HDR_LEN)
+#define FLOW_MAX_DATAGRAM	(65535 - IP_HDR_LEN - UDP_HDR_LEN)
+
+#define RTP_PAYLOAD_LEN		160		/* 20 ms of G.711 */
+#define RTP_INTERVAL		20000		/* usec */
+#define RTP_BATCH		10
+
+#define TH_FIN	0x01
+#define TH_SYN	0x02
+#define TH_PSH	0x08
+#define TH_ACK	0x10
+
+/* Flows are numbered from client to server and back */
+#define C2S	0
+#define S2C	1
+
+typedef enum {
+	FLOW_HTTP,
+	FLOW_DNS,
+	FLOW_IP_FRAGMENTS,
+	FLOW_RTP
+} flow_kind;
+
+typedef struct {
+	guint64		ts;		/* usec since FLOW_CLOCK_BASE */
+	guint32		delay;		/* usec after the flow's previous packet */
+	gboolean	perturbable;	/* may be lost or reordered */
+	guint		len;
+	guint8		*data;
+} flow_packet;
+
+typedef struct {
+	flow_kind	kind;
+	guint		step;		/* position in the flow's script */
+	guint		remaining;	/* requests, datagrams or RTP packets still to send */
+	guint32		addr[2];
+	guint16		port[2];
+	guint32		seq[2];		/* TCP: next sequence number of each side */
+	guint16		ip_id[2];
+	guint32		rtt;		/* usec */
+	guint16		rtp_seq;
+	guint32		rtp_ts;
+	guint32		rtp_ssrc;
+	guint64		clock;		/* time of the last packet queued */
+	GQueue		packets;	/* flow_packet's waiting to be written */
+} synth_flow;
+
+struct _randpkt_flows {
+	randpkt_flow_params	params;
+	GRand			*rand;
+	wtap_dumper		*dump;
+	const char		*filename;
+	synth_flow		*flows;
+	synth_flow		**heap;		/* by time of the next packet */
+	guint32			next_client;
+	guint32			next_server;
+};
+
+static guint16
+flow_checksum(guint32 sum, const guint8 *p, guint len)
+{
+	while (len > 1) {
+		sum += (p[0] << 8) | p[1];
+		p += 2;
+		len -= 2;
+	}
+	if (len)
+		sum += p[0] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (guint16)~sum;
+}
+
+static void
+put_be16(guint8 *p, guint16 v)
+{
+	p[0] = (guint8)(v >> 8);
+	p[1] = (guint8)v;
+}
+
+static void
+put_be32(guint8 *p, guint32 v)
+{
+	p[0] = (guint8)(v >> 24);
+	p[1] = (guint8)(v >> 16);
+	p[2] = (guint8)(v >> 8);
+	p[3] = (guint8)v;
+}
+
+/*
+ * Start a packet from one side of the flow to the other: Ethernet and
+ * IPv4 headers followed by room for ip_payload_len bytes.
+ */
+static flow_packet *
+flow_packet_new(synth_flow *flow, int dir, guint8 proto, guint ip_payload_len,
+    guint16 ip_id, guint16 frag, guint32 delay)
+{
+	flow_packet *pkt;
+	guint8 *eth, *ip;
+
+	pkt = g_new0(flow_packet, 1);
+	pkt->len = ETH_HDR_LEN + IP_HDR_LEN + ip_payload_len;
+	pkt->data = (guint8 *)g_malloc0(pkt->len);
+	pkt->delay = delay;
+
+	/* Locally administered MAC addresses derived from the IP addresses */
+	eth = pkt->data;
+	eth[0] = 0x02;
+	put_be32(&eth[2], flow->addr[!dir]);
+	eth[6] = 0x02;
+	put_be32(&eth[8], flow->addr[dir]);
+	put_be16(&eth[12], 0x0800);
+
+	ip = eth + ETH_HDR_LEN;
+	ip[0] = 0x45;
+	put_be16(&ip[2], (guint16)(IP_HDR_LEN + ip_payload_len));
+	put_be16(&ip[4], ip_id);
+	put_be16(&ip[6], frag);
+	ip[8] = 64;
+	ip[9] = proto;
+	put_be32(&ip[12], flow->addr[dir]);
+	put_be32(&ip[16], flow->addr[!dir]);
+	put_be16(&ip[10], flow_checksum(0, ip, IP_HDR_LEN));
+
+	return pkt;
+}
+
+static void
+flow_packet_free(flow_packet *pkt)
+{
+	g_free(pkt->data);
+	g_free(pkt);
+}
+
+/* Fill in the TCP or UDP checksum of a packet that is not a fragment */
+static void
+set_l4_checksum(flow_packet *pkt, guint8 proto, guint csum_offset)
+{
+	guint8 *ip = pkt->data + ETH_HDR_LEN;
+	guint l4_len = pkt->len - ETH_HDR_LEN - IP_HDR_LEN;
+	guint32 sum;
+	guint16 csum;
+
+	sum = ((ip[12] << 8) | ip[13]) + ((ip[14] << 8) | ip[15]) +
+		((ip[16] << 8) | ip[17]) + ((ip[18] << 8) | ip[19]) +
+		proto + l4_len;
+	csum = flow_checksum(sum, ip + IP_HDR_LEN, l4_len);
+	if (csum == 0 && proto == 17)
+		csum = 0xffff;
+	put_be16(ip + IP_HDR_LEN + csum_offset, csum);
+}
+
+static flow_packet *
+tcp_packet(synth_flow *flow, int dir, guint8 flags, const guint8 *payload,
+    guint len, guint32 delay)
+{
+	flow_packet *pkt;
+	guint8 *tcp;
+
+	pkt = flow_packet_new(flow, dir, 6, TCP_HDR_LEN + len, flow->ip_id[dir]++, 0x4000, delay);
+	tcp = pkt->data + ETH_HDR_LEN + IP_HDR_LEN;
+	put_be16(&tcp[0], flow->port[dir]);
+	put_be16(&tcp[2], flow->port[!dir]);
+	put_be32(&tcp[4], flow->seq[dir]);
+	if (flags & TH_ACK)
+		put_be32(&tcp[8], flow->seq[!dir]);
+	tcp[12] = (TCP_HDR_LEN / 4) << 4;
+	tcp[13] = flags;
+	put_be16(&tcp[14], 65535);
+	if (len)
+		memcpy(&tcp[TCP_HDR_LEN], payload, len);
+	set_l4_checksum(pkt, 6, 16);
+
+	flow->seq[dir] += len;
+	if (flags & (TH_SYN|TH_FIN))
+		flow->seq[dir]++;
+	pkt->perturbable = (len > 0);
+	return pkt;
+}
+
+static flow_packet *
+udp_packet(synth_flow *flow, int dir, const guint8 *payload, guint len,
+    guint32 delay)
+{
+	flow_packet *pkt;
+	guint8 *udp;
+
+	pkt = flow_packet_new(flow, dir, 17, UDP_HDR_LEN + len, flow->ip_id[dir]++, 0x4000, delay);
+	udp = pkt->data + ETH_HDR_LEN + IP_HDR_LEN;
+	put_be16(&udp[0], flow->port[dir]);
+	put_be16(&udp[2], flow->port[!dir]);
+	put_be16(&udp[4], (guint16)(UDP_HDR_LEN + len));
+	memcpy(&udp[UDP_HDR_LEN], payload, len);
+	set_l4_checksum(pkt, 17, 6);
+	return pkt;
+}
+
+/* Time for a packet to cross the network, with some jitter */
+static guint32
+one_way_delay(randpkt_flows *flows, const synth_flow *flow)
+{
+	return flow->rtt / 2 + g_rand_int_range(flows->rand, 0, flow->rtt / 10 + 1);
+}
+
+/* Time between back-to-back packets from the same side */
+static guint32
+burst_delay(randpkt_flows *flows, guint len)
+{
+	/* Roughly the serialization delay at 100 Mbit/s */
+	return len / 12 + g_rand_int_range(flows->rand, 1, 20);
+}
+
+static void
+random_fill(randpkt_flows *flows, guint8 *p, guint len, gboolean text)
+{
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		if (text)
+			p[i] = (guint8)g_rand_int_range(flows->rand, 'a', 'z' + 1);
+		else
+			p[i] = (guint8)g_rand_int_range(flows->rand, 0, 0x100);
+	}
+}
+
+/*
+ * Queue a batch of packets on a flow. Packets that may be lost are
+ * either dropped or, for TCP, retransmitted a few packets later;
+ * packets that may be reordered swap places with the next one. The
+ * delays stay with the positions, so time keeps going forward.
+ */
+static void
+queue_batch(randpkt_flows *flows, synth_flow *flow, GPtrArray *batch,
+    gboolean retransmit)
+{
+	flow_packet *pkt;
+	guint32 *delays;
+	guint i, j;
+
+	delays = g_new(guint32, batch->len);
+	for (i = 0; i < batch->len; i++)
+		delays[i] = ((flow_packet *)g_ptr_array_index(batch, i))->delay;
+
+	for (i = 0; i < batch->len; i++) {
+		pkt = (flow_packet *)g_ptr_array_index(batch, i);
+		if (!pkt->perturbable)
+			continue;
+		if (flows->params.loss > 0.0 && g_rand_double(flows->rand) < flows->params.loss) {
+			if (!retransmit) {
+				/* Leave a gap where the packet would have been */
+				if (i + 1 < batch->len)
+					delays[i + 1] += delays[i];
+				memmove(&delays[i], &delays[i + 1], (batch->len - i - 1) * sizeof delays[0]);
+				g_ptr_array_remove_index(batch, i);
+				flow_packet_free(pkt);
+				i--;
+				continue;
+			}
+			/* The retransmission shows up after the next few packets */
+			j = MIN(i + 3, batch->len - 1);
+			if (j > i) {
+				memmove(&batch->pdata[i], &batch->pdata[i + 1], (j - i) * sizeof(gpointer));
+				batch->pdata[j] = pkt;
+				pkt->perturbable = FALSE;
+				i--;
+				continue;
+			}
+		}
+		if (flows->params.reorder > 0.0 && i + 1 < batch->len &&
+		    g_rand_double(flows->rand) < flows->params.reorder) {
+			batch->pdata[i] = batch->pdata[i + 1];
+			batch->pdata[i + 1] = pkt;
+			pkt->perturbable = FALSE;
+			i++;
+		}
+	}
+
+	for (i = 0; i < batch->len; i++) {
+		pkt = (flow_packet *)g_ptr_array_index(batch, i);
+		flow->clock += delays[i];
+		pkt->ts = flow->clock;
+		g_queue_push_tail(&flow->packets, pkt);
+	}
+	g_free(delays);
+}
+
+static void
+http_step(randpkt_flows *flows, synth_flow *flow, GPtrArray *batch)
+{
+	GString *msg;
+	guint body_len, off, len, segments;
+
+	switch (flow->step) {
+
+	case 0:
+		/* Three-way handshake */
+		g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_SYN, NULL, 0, 0));
+		g_ptr_array_add(batch, tcp_packet(flow, S2C, TH_SYN|TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+		g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+		flow->step++;
+		break;
+
+	case 1:
+		/* One request and its response */
+		msg = g_string_new(NULL);
+		g_string_printf(msg,
+			"GET /%08x HTTP/1.1\r\n"
+			"Host: %u.%u.%u.%u\r\n"
+			"User-Agent: randpkt\r\n"
+			"Accept: */*\r\n"
+			"\r\n",
+			g_rand_int(flows->rand),
+			flow->addr[S2C] >> 24, (flow->addr[S2C] >> 16) & 0xff,
+			(flow->addr[S2C] >> 8) & 0xff, flow->addr[S2C] & 0xff);
+		g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_PSH|TH_ACK,
+			(guint8 *)msg->str, (guint)msg->len, 1000));
+		g_ptr_array_add(batch, tcp_packet(flow, S2C, TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+
+		body_len = g_rand_int_range(flows->rand, 0, flows->params.max_bytes + 1);
+		g_string_printf(msg,
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Type: text/plain\r\n"
+			"Content-Length: %u\r\n"
+			"\r\n",
+			body_len);
+		off = (guint)msg->len;
+		g_string_set_size(msg, off + body_len);
+		random_fill(flows, (guint8 *)msg->str + off, body_len, TRUE);
+
+		segments = 0;
+		for (off = 0; off < msg->len; off += len) {
+			len = MIN(FLOW_MSS, (guint)msg->len - off);
+			g_ptr_array_add(batch, tcp_packet(flow, S2C,
+				off + len == msg->len ? TH_PSH|TH_ACK : TH_ACK,
+				(guint8 *)msg->str + off, len,
+				off == 0 ? 2000 : burst_delay(flows, len)));
+			/* Delayed ACKs */
+			if (++segments % 2 == 0 || off + len == msg->len)
+				g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+		}
+		g_string_free(msg, TRUE);
+
+		if (--flow->remaining == 0)
+			flow->step++;
+		break;
+
+	case 2:
+		/* Close */
+		g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_FIN|TH_ACK, NULL, 0, 0));
+		g_ptr_array_add(batch, tcp_packet(flow, S2C, TH_FIN|TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+		g_ptr_array_add(batch, tcp_packet(flow, C2S, TH_ACK, NULL, 0, one_way_delay(flows, flow)));
+		flow->step++;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void
+dns_step(randpkt_flows *flows, synth_flow *flow, GPtrArray *batch)
+{
+	guint8 msg[512];
+	guint len, answers, i;
+	guint16 id;
+	flow_packet *pkt;
+
+	if (flow->step++ != 0)
+		return;
+
+	id = (guint16)g_rand_int(flows->rand);
+	memset(msg, 0, sizeof msg);
+	put_be16(&msg[0], id);
+	put_be16(&msg[2], 0x0100);		/* standard query, recursion desired */
+	put_be16(&msg[4], 1);
+	len = 12;
+	len += g_snprintf((char *)&msg[len], 32, "%chost%05u%cexample%ccom",
+		9, g_rand_int_range(flows->rand, 0, 100000), 7, 3) + 1;
+	put_be16(&msg[len], 1);			/* A */
+	put_be16(&msg[len + 2], 1);		/* IN */
+	len += 4;
+	g_ptr_array_add(batch, udp_packet(flow, C2S, msg, len, 0));
+
+	put_be16(&msg[2], 0x8180);		/* response, no error */
+	answers = g_rand_int_range(flows->rand, 1, 5);
+	put_be16(&msg[6], answers);
+	for (i = 0; i < answers; i++) {
+		put_be16(&msg[len], 0xc00c);	/* the name in the question */
+		put_be16(&msg[len + 2], 1);
+		put_be16(&msg[len + 4], 1);
+		put_be32(&msg[len + 6], g_rand_int_range(flows->rand, 60, 86400));
+		put_be16(&msg[len + 10], 4);
+		put_be32(&msg[len + 12], g_rand_int(flows->rand));
+		len += 16;
+	}
+	pkt = udp_packet(flow, S2C, msg, len, one_way_delay(flows, flow));
+	pkt->perturbable = TRUE;
+	g_ptr_array_add(batch, pkt);
+}
+
+static void
+ip_fragments_step(randpkt_flows *flows, synth_flow *flow, GPtrArray *batch)
+{
+	flow_packet *pkt;
+	guint8 *datagram;
+	guint datagram_len, off, len;
+	guint16 id;
+
+	if (flow->remaining == 0)
+		return;
+	flow->remaining--;
+
+	/* A UDP datagram too big for one Ethernet frame */
+	datagram_len = UDP_HDR_LEN + FLOW_MSS +
+		g_rand_int_range(flows->rand, 1, flows->params.max_bytes + 2);
+	datagram_len = MIN(datagram_len, UDP_HDR_LEN + FLOW_MAX_DATAGRAM);
+	datagram = (guint8 *)g_malloc(datagram_len);
+	random_fill(flows, datagram + UDP_HDR_LEN, datagram_len - UDP_HDR_LEN, FALSE);
+
+	/* Build it unfragmented to get the checksum right */
+	pkt = udp_packet(flow, C2S, datagram + UDP_HDR_LEN, datagram_len - UDP_HDR_LEN, 0);
+	memcpy(datagram, pkt->data + ETH_HDR_LEN + IP_HDR_LEN, datagram_len);
+	flow_packet_free(pkt);
+	id = flow->ip_id[C2S] - 1;
+
+	for (off = 0; off < datagram_len; off += len) {
+		len = MIN((FLOW_MTU - IP_HDR_LEN) & ~7U, datagram_len - off);
+		pkt = flow_packet_new(flow, C2S, 17, len, id,
+			(guint16)((off + len < datagram_len ? 0x2000 : 0) | (off / 8)),
+			off == 0 ? 5000 : burst_delay(flows, len));
+		memcpy(pkt->data + ETH_HDR_LEN + IP_HDR_LEN, datagram + off, len);
+		pkt->perturbable = TRUE;
+		g_ptr_array_add(batch, pkt);
+	}
+	g_free(datagram);
+}
+
+static void
+rtp_step(randpkt_flows *flows, synth_flow *flow, GPtrArray *batch)
+{
+	guint8 msg[RTP_HDR_LEN + RTP_PAYLOAD_LEN];
+	flow_packet *pkt;
+	guint i;
+
+	for (i = 0; i < RTP_BATCH && flow->remaining > 0; i++, flow->remaining--) {
+		msg[0] = 0x80;				/* version 2 */
+		msg[1] = (flow->step++ == 0) ? 0x80 : 0x00;	/* marker on the first, PCMU */
+		put_be16(&msg[2], flow->rtp_seq++);
+		put_be32(&msg[4], flow->rtp_ts);
+		put_be32(&msg[8], flow->rtp_ssrc);
+		flow->rtp_ts += RTP_PAYLOAD_LEN;
+		random_fill(flows, &msg[RTP_HDR_LEN], RTP_PAYLOAD_LEN, FALSE);
+		pkt = udp_packet(flow, C2S, msg, sizeof msg,
+			RTP_INTERVAL - 500 + g_rand_int_range(flows->rand, 0, 1001));
+		pkt->perturbable = TRUE;
+		g_ptr_array_add(batch, pkt);
+	}
+}
+
+/* Turn a flow slot into a new flow starting at the given time */
+static void
+flow_start(randpkt_flows *flows, synth_flow *flow, guint64 clock)
+{
+	guint kind;
+
+	memset(flow, 0, sizeof *flow);
+	g_queue_init(&flow->packets);
+	flow->clock = clock;
+
+	/* Clients and servers come from the 198.18.0.0/15 benchmarking range */
+	flow->addr[C2S] = 0xc6120000 | (++flows->next_client & 0xffff);
+	flow->addr[S2C] = 0xc6130000 | (flows->next_server++ % 0xfffe + 1);
+	flow->port[C2S] = (guint16)g_rand_int_range(flows->rand, 49152, 65536);
+	flow->seq[C2S] = g_rand_int(flows->rand);
+	flow->seq[S2C] = g_rand_int(flows->rand);
+	flow->ip_id[C2S] = (guint16)g_rand_int(flows->rand);
+	flow->ip_id[S2C] = (guint16)g_rand_int(flows->rand);
+	flow->rtt = g_rand_int_range(flows->rand, 1000, 150000);
+
+	kind = g_rand_int_range(flows->rand, 0, 100);
+	if (kind < 45) {
+		flow->kind = FLOW_HTTP;
+		flow->port[S2C] = 80;
+		flow->remaining = g_rand_int_range(flows->rand, 1, 4);
+	} else if (kind < 75) {
+		flow->kind = FLOW_DNS;
+		flow->port[S2C] = 53;
+	} else if (kind < 90) {
+		flow->kind = FLOW_IP_FRAGMENTS;
+		flow->port[S2C] = 7;
+		flow->remaining = g_rand_int_range(flows->rand, 1, 5);
+	} else {
+		flow->kind = FLOW_RTP;
+		flow->port[C2S] = (guint16)(flow->port[C2S] & ~1);
+		flow->port[S2C] = (guint16)(g_rand_int_range(flows->rand, 8192, 16384) * 2);
+		flow->remaining = g_rand_int_range(flows->rand, 50, 250);
+		flow->rtp_seq = (guint16)g_rand_int(flows->rand);
+		flow->rtp_ts = g_rand_int(flows->rand);
+		flow->rtp_ssrc = g_rand_int(flows->rand);
+	}
+}
+
+/*
+ * Queue the flow's next exchange. When the flow is finished, the slot
+ * starts a new one after a short pause, so that the number of flows in
+ * progress stays the same.
+ */
+static void
+flow_refill(randpkt_flows *flows, synth_flow *flow)
+{
+	GPtrArray *batch = g_ptr_array_new();
+
+	while (g_queue_is_empty(&flow->packets)) {
+		switch (flow->kind) {
+		case FLOW_HTTP:
+			http_step(flows, flow, batch);
+			break;
+		case FLOW_DNS:
+			dns_step(flows, flow, batch);
+			break;
+		case FLOW_IP_FRAGMENTS:
+			ip_fragments_step(flows, flow, batch);
+			break;
+		case FLOW_RTP:
+			rtp_step(flows, flow, batch);
+			break;
+		}
+		if (batch->len == 0) {
+			flow_start(flows, flow, flow->clock + g_rand_int_range(flows->rand, 0, 100000));
+			continue;
+		}
+		queue_batch(flows, flow, batch, flow->kind == FLOW_HTTP);
+		g_ptr_array_set_size(batch, 0);
+	}
+	g_ptr_array_free(batch, TRUE);
+}
+
+static guint64
+flow_next_ts(synth_flow *flow)
+{
+	return ((flow_packet *)g_queue_peek_head(&flow->packets))->ts;
+}
+
+static void
+heap_sift_down(randpkt_flows *flows, guint i)
+{
+	synth_flow **heap = flows->heap;
+	guint n = flows->params.flows;
+	guint child;
+	synth_flow *tmp;
+
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && flow_next_ts(heap[child + 1]) < flow_next_ts(heap[child]))
+			child++;
+		if (flow_next_ts(heap[i]) <= flow_next_ts(heap[child]))
+			break;
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+
+randpkt_flows* randpkt_flows_new(const randpkt_flow_params* params, const char* produce_filename)
+{
+	randpkt_flows *flows;
+	guint i;
+	int err;
+
+	wtap_init();
+
+	flows = g_new0(randpkt_flows, 1);
+	flows->params = *params;
+	if (flows->params.flows == 0)
+		flows->params.flows = 1;
+	flows->rand = g_rand_new_with_seed(params->seed);
+
+	if (strcmp(produce_filename, "-") == 0) {
+		flows->dump = wtap_dump_open_stdout(WTAP_FILE_TYPE_SUBTYPE_PCAP,
+			WTAP_ENCAP_ETHERNET, 65535, WTAP_UNCOMPRESSED, &err);
+		flows->filename = "the standard output";
+	} else {
+		flows->dump = wtap_dump_open(produce_filename, WTAP_FILE_TYPE_SUBTYPE_PCAP,
+			WTAP_ENCAP_ETHERNET, 65535, WTAP_UNCOMPRESSED, &err);
+		flows->filename = produce_filename;
+	}
+	if (!flows->dump) {
+		fprintf(stderr, "randpkt: Error writing to %s: %s\n", flows->filename,
+			wtap_strerror(err));
+		g_rand_free(flows->rand);
+		g_free(flows);
+		return NULL;
+	}
+
+	/* Stagger the start of the flows over the first second */
+	flows->flows = g_new0(synth_flow, flows->params.flows);
+	flows->heap = g_new(synth_flow *, flows->params.flows);
+	for (i = 0; i < flows->params.flows; i++) {
+		flow_start(flows, &flows->flows[i], g_rand_int_range(flows->rand, 0, 1000000));
+		flow_refill(flows, &flows->flows[i]);
+		flows->heap[i] = &flows->flows[i];
+	}
+	for (i = flows->params.flows / 2; i-- > 0; )
+		heap_sift_down(flows, i);
+
+	return flows;
+}
+
+gboolean randpkt_flows_loop(randpkt_flows* flows, guint64 produce_count, guint rate)
+{
+	struct wtap_pkthdr pkthdr;
+	synth_flow *flow;
+	flow_packet *pkt;
+	GTimer *timer = NULL;
+	gdouble ahead;
+	guint64 i;
+	int err;
+	gchar *err_info;
+	gboolean ok = TRUE;
+
+	memset(&pkthdr, 0, sizeof pkthdr);
+	pkthdr.rec_type = REC_TYPE_PACKET;
+	pkthdr.presence_flags = WTAP_HAS_TS;
+	pkthdr.pkt_encap = WTAP_ENCAP_ETHERNET;
+
+	if (rate > 0)
+		timer = g_timer_new();
+
+	for (i = 0; i < produce_count; i++) {
+		flow = flows->heap[0];
+		pkt = (flow_packet *)g_queue_pop_head(&flow->packets);
+
+		pkthdr.ts.secs = FLOW_CLOCK_BASE + (time_t)(pkt->ts / 1000000);
+		pkthdr.ts.nsecs = (int)(pkt->ts % 1000000) * 1000;
+		pkthdr.caplen = pkt->len;
+		pkthdr.len = pkt->len;
+		if (!wtap_dump(flows->dump, &pkthdr, pkt->data, &err, &err_info)) {
+			fprintf(stderr, "randpkt: Error writing to %s: %s\n",
+				flows->filename, wtap_strerror(err));
+			g_free(err_info);
+			flow_packet_free(pkt);
+			ok = FALSE;
+			break;
+		}
+		flow_packet_free(pkt);
+
+		if (g_queue_is_empty(&flow->packets))
+			flow_refill(flows, flow);
+		heap_sift_down(flows, 0);
+
+		if (timer != NULL) {
+			/* Hold back to the requested packet rate */
+			ahead = (gdouble)(i + 1) / rate - g_timer_elapsed(timer, NULL);
+			if (ahead > 0.001) {
+				wtap_dump_flush(flows->dump);
+				g_usleep((gulong)(ahead * G_USEC_PER_SEC));
+			}
+		}
+	}
+
+	if (timer != NULL)
+		g_timer_destroy(timer);
+	return ok;
+}
+
+gboolean randpkt_flows_close(randpkt_flows* flows)
+{
+	flow_packet *pkt;
+	guint i;
+	int err;
+	gboolean ok = TRUE;
+
+	if (!wtap_dump_close(flows->dump, &err)) {
+		fprintf(stderr, "Error writing to %s: %s\n",
+			flows->filename, wtap_strerror(err));
+		ok = FALSE;
+	}
+
+	for (i = 0; i < flows->params.flows; i++) {
+		while ((pkt = (flow_packet *)g_queue_pop_head(&flows->flows[i].packets)) != NULL)
+			flow_packet_free(pkt);
+	}
+	g_free(flows->heap);
+	g_free(flows->flows);
+	g_rand_free(flows->rand);
+	g_free(flows);
+
+	return ok;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
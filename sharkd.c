@@ -179,6 +179,10 @@ main(int argc, char *argv[])
 
   wtap_init();
 
+  /* Read large chunks on the pass that loads a file; packets picked
+     out afterwards come through the random stream in small reads. */
+  wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE);
+
 #ifdef HAVE_PLUGINS
   /* Register all the plugin types we have. */
   epan_register_plugin_types(); /* Types known to libwireshark */
@@ -352,12 +356,14 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
 
 
 static int
-load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
+load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count,
+              const nstime_t *range_start, const nstime_t *range_stop)
 {
   int          err;
   gchar       *err_info = NULL;
   gint64       data_offset;
   epan_dissect_t *edt = NULL;
+  gboolean     ret;
 
   {
     /* Allocate a frame_data_sequence for all the frames. */
@@ -384,7 +390,16 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
       edt = epan_dissect_new(cf->epan, create_proto_tree, FALSE);
     }
 
-    while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+    /* If we were given a time range, skip directly to its start. */
+    if (range_start != NULL && !nstime_is_unset(range_start))
+      ret = wtap_seek_time(cf->wth, range_start, &err, &err_info, &data_offset);
+    else
+      ret = wtap_read(cf->wth, &err, &err_info, &data_offset);
+    for (; ret; ret = wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+      if (range_stop != NULL && !nstime_is_unset(range_stop) &&
+          (wtap_phdr(cf->wth)->presence_flags & WTAP_HAS_TS) &&
+          nstime_cmp(&wtap_phdr(cf->wth)->ts, range_stop) >= 0)
+        break;
       if (process_packet_first_pass(cf, edt, data_offset, wtap_phdr(cf->wth),
                          wtap_buf_ptr(cf->wth))) {
         /* Stop reading if we have the maximum number of packets;
@@ -461,6 +476,7 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   gchar *err_info;
   char   err_msg[2048+1];
 
+  wtap_set_fast_seek_index(prefs.gui_fast_seek_index);
   wth = wtap_open_offline(fname, type, err, &err_info, TRUE);
   if (wth == NULL)
     goto fail;
@@ -695,9 +711,9 @@ sharkd_cf_open(const char *fname, unsigned int type, gboolean is_tempfile, int *
 }
 
 int
-sharkd_load_cap_file(void)
+sharkd_load_cap_file(const nstime_t *range_start, const nstime_t *range_stop)
 {
-  return load_cap_file(&cfile, 0, 0);
+  return load_cap_file(&cfile, 0, 0, range_start, range_stop);
 }
 
 int
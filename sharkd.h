@@ -29,7 +29,7 @@
 
 /* sharkd.c */
 cf_status_t sharkd_cf_open(const char *fname, unsigned int type, gboolean is_tempfile, int *err);
-int sharkd_load_cap_file(void);
+int sharkd_load_cap_file(const nstime_t *range_start, const nstime_t *range_stop);
 int sharkd_retap(void);
 int sharkd_filter(const char *dftext, guint8 **result);
 int sharkd_dissect_columns(int framenum, column_info *cinfo, gboolean dissect_color);
@@ -517,6 +517,9 @@ sharkd_session_process_info(void)
  *
  * Input:
  *   (m) file - file to be loaded
+ *   (o) time_range - only load packets from start to stop, given as "start,stop";
+ *                    either may be empty, times are "YYYY-MM-DD hh:mm:ss[.frac]"
+ *                    or seconds since the Epoch
  *
  * Output object with attributes:
  *   (m) err - error code
@@ -525,6 +528,8 @@ static void
 sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 {
 	const char *tok_file = json_find_attr(buf, tokens, count, "file");
+	const char *tok_time_range = json_find_attr(buf, tokens, count, "time_range");
+	nstime_t range_start, range_stop;
 	int err = 0;
 
 	fprintf(stderr, "load: filename=%s\n", tok_file);
@@ -532,6 +537,20 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 	if (!tok_file)
 		return;
 
+	if (tok_time_range)
+	{
+		if (!nstime_range_from_str(&range_start, &range_stop, tok_time_range))
+		{
+			printf("{\"err\":%d}\n", EINVAL);
+			return;
+		}
+	}
+	else
+	{
+		nstime_set_unset(&range_start);
+		nstime_set_unset(&range_stop);
+	}
+
 	if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, FALSE, &err) != CF_OK)
 	{
 		printf("{\"err\":%d}\n", err);
@@ -540,7 +559,7 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 	TRY
 	{
-		err = sharkd_load_cap_file();
+		err = sharkd_load_cap_file(&range_start, &range_stop);
 	}
 	CATCH(OutOfMemoryError)
 	{
@@ -552,6 +571,21 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 	printf("{\"err\":%d}\n", err);
 }
 
+static void
+sharkd_session_print_wmem_stats(const char *name, wmem_allocator_t *allocator)
+{
+	wmem_allocator_stats_t stats;
+
+	wmem_allocator_get_stats(allocator, &stats);
+
+	printf("\"%s\":{", name);
+	printf("\"allocs\":%" G_GINT64_MODIFIER "u", stats.alloc_count);
+	printf(",\"requested\":%" G_GINT64_MODIFIER "u", stats.bytes_requested);
+	printf(",\"peak_requested\":%" G_GINT64_MODIFIER "u", stats.peak_bytes_requested);
+	printf(",\"blocks\":%u", stats.block_count);
+	printf("}");
+}
+
 /**
  * sharkd_session_process_status()
  *
@@ -559,12 +593,26 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
  *
  * Output object with attributes:
  *   (m) frames  - count of currently loaded frames
+ *   (m) wmem    - object with memory statistics of the epan, file and packet scopes, each with attributes:
+ *                  (m) allocs         - number of allocations
+ *                  (m) requested      - total size asked for by allocations and reallocations since
+ *                                       the scope was last emptied; frees aren't taken off
+ *                  (m) peak_requested - the highest requested has been since the scope was created
+ *                  (m) blocks         - number of blocks currently held
  */
 static void
 sharkd_session_process_status(void)
 {
 	printf("{\"frames\":%u", cfile.count);
 
+	printf(",\"wmem\":{");
+	sharkd_session_print_wmem_stats("epan", wmem_epan_scope());
+	printf(",");
+	sharkd_session_print_wmem_stats("file", wmem_file_scope());
+	printf(",");
+	sharkd_session_print_wmem_stats("packet", wmem_packet_scope());
+	printf("}");
+
 	printf("}\n");
 }
 
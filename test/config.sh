@@ -69,6 +69,7 @@ TSHARK=$WS_BIN_PATH/tshark
 RAWSHARK=$WS_BIN_PATH/rawshark
 CAPINFOS=$WS_BIN_PATH/capinfos
 MERGECAP=$WS_BIN_PATH/mergecap
+EDITCAP=$WS_BIN_PATH/editcap
 TEXT2PCAP=$WS_BIN_PATH/text2pcap
 DUMPCAP=$WS_BIN_PATH/dumpcap
 
@@ -123,6 +123,258 @@ ff_step_nsec_pcapng_direct() {
 	test_step_ok
 }
 
+# Write a compressed copy with tshark --compress and read it back
+ff_compressed_round_trip() {
+	if ! $TSHARK --compress 2>&1 | grep -q "^    $1 - " ; then
+		test_step_skipped
+		return
+	fi
+	$TSHARK -r "${CAPTURE_DIR}dhcp.pcap" --compress $1 -w ./ff-ts-compressed.$1 > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Writing a $1 compressed file failed"
+		return
+	fi
+	$TSHARK $TS_FF_ARGS -r ./ff-ts-compressed.$1 > ./ff-ts-compressed-$1.txt 2> /dev/null
+	diff -u $FF_BASELINE ./ff-ts-compressed-$1.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of microsecond pcap direct read vs $1 compressed pcap read differ"
+		cat $DIFF_OUT
+		return
+	fi
+	test_step_ok
+}
+
+ff_step_zstd_round_trip() {
+	ff_compressed_round_trip zstd
+}
+
+ff_step_lz4_round_trip() {
+	ff_compressed_round_trip lz4
+}
+
+# Read with a time range that starts before the first packet; the whole
+# file should be read.
+ff_time_range_whole_file() {
+	$TSHARK $TS_FF_ARGS --time-range "0," -r "$1" > ./ff-ts-time-range.txt 2> /dev/null
+	diff -u $FF_BASELINE ./ff-ts-time-range.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of microsecond pcap direct read vs $1 time range read differ"
+		cat $DIFF_OUT
+		return 1
+	fi
+	return 0
+}
+
+# Time stamps within the time series files made by ff_make_time_series;
+# one is between two packets, the other one is that of a packet.
+FF_TIME_SERIES_MID_1=1102274484.35
+FF_TIME_SERIES_MID_2=1102274884.387484
+
+# Make a pcap and a pcap-ng file with 4096 packets in time order, large
+# enough for a time range read to bisect the pcap file rather than read
+# it from the start.  Each round appends a copy of the file so far,
+# shifted in time to come after it.
+ff_make_time_series() {
+	cp "${CAPTURE_DIR}dhcp.pcap" ./ff-ts-time-series.pcap
+	for SHIFT in 1 2 4 8 16 32 64 128 256 512 ; do
+		$EDITCAP -t $SHIFT ./ff-ts-time-series.pcap ./ff-ts-time-series-shifted.pcap > /dev/null 2>&1 &&
+		$MERGECAP -a -F pcap -w ./ff-ts-time-series-tmp.pcap ./ff-ts-time-series.pcap ./ff-ts-time-series-shifted.pcap > /dev/null 2>&1
+		RETURNVALUE=$?
+		if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+			test_step_failed "Making the time series file failed"
+			return 1
+		fi
+		mv ./ff-ts-time-series-tmp.pcap ./ff-ts-time-series.pcap
+	done
+	rm -f ./ff-ts-time-series-shifted.pcap
+	$EDITCAP -F pcapng ./ff-ts-time-series.pcap ./ff-ts-time-series.pcapng > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Making the pcap-ng time series file failed"
+		return 1
+	fi
+	return 0
+}
+
+# Read file $1 with the time range "$2,$3", and compare the packets read
+# with the ones a display filter on their time stamps lets through.
+ff_time_range_compare() {
+	TIME_FILTER="frame"
+	if [ -n "$2" ] ; then
+		TIME_FILTER="$TIME_FILTER && frame.time_epoch >= $2"
+	fi
+	if [ -n "$3" ] ; then
+		TIME_FILTER="$TIME_FILTER && frame.time_epoch < $3"
+	fi
+	$TSHARK -Tfields -e frame.time_epoch -e frame.len -Y "$TIME_FILTER" -r "$1" > ./ff-ts-time-filter.txt 2> /dev/null
+	$TSHARK -Tfields -e frame.time_epoch -e frame.len --time-range "$2,$3" -r "$1" > ./ff-ts-time-range.txt 2> /dev/null
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Reading $1 with the time range \"$2,$3\" failed"
+		return 1
+	fi
+	if [ ! -s ./ff-ts-time-filter.txt ] ; then
+		test_step_failed "No packets of $1 in the time range \"$2,$3\""
+		return 1
+	fi
+	diff -u ./ff-ts-time-filter.txt ./ff-ts-time-range.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of $1 read with a display filter vs time range \"$2,$3\" read differ"
+		cat $DIFF_OUT
+		return 1
+	fi
+	return 0
+}
+
+# Read the time series file with time ranges that start or stop in the
+# middle of it.
+ff_time_range_mid_file() {
+	ff_time_range_compare "$1" $FF_TIME_SERIES_MID_1 "" &&
+	ff_time_range_compare "$1" "" $FF_TIME_SERIES_MID_1 &&
+	ff_time_range_compare "$1" $FF_TIME_SERIES_MID_1 $FF_TIME_SERIES_MID_2 &&
+	ff_time_range_compare "$1" $FF_TIME_SERIES_MID_2 ""
+}
+
+ff_step_time_range_pcap() {
+	ff_time_range_whole_file "${CAPTURE_DIR}dhcp.pcap" || return
+	ff_make_time_series || return
+	ff_time_range_mid_file ./ff-ts-time-series.pcap || return
+	test_step_ok
+}
+
+ff_step_time_range_pcapng() {
+	ff_time_range_whole_file "${CAPTURE_DIR}dhcp.pcapng" || return
+	ff_make_time_series || return
+	ff_time_range_mid_file ./ff-ts-time-series.pcapng || return
+	test_step_ok
+}
+
+# Reset the dissection session after every packet; frame numbers and
+# time stamps must come out as in a normal read.
+ff_step_reset_session() {
+	$TSHARK $TS_FF_ARGS --reset-session packets:1 --reset-session duration:1 -r "${CAPTURE_DIR}dhcp.pcap" > ./ff-ts-reset-session.txt 2> /dev/null
+	diff -u $FF_BASELINE ./ff-ts-reset-session.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of microsecond pcap direct read vs read with session resets differ"
+		cat $DIFF_OUT
+		return
+	fi
+	test_step_ok
+}
+
+# Write a pcap-ng file with a frame index and read it back, both from the
+# start and through a time range.
+ff_step_frame_index() {
+	$EDITCAP -F pcapng --frame-index 1 "${CAPTURE_DIR}dhcp.pcap" ./ff-ts-frame-index.pcapng > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Writing a pcap-ng file with a frame index failed"
+		return
+	fi
+	$TSHARK $TS_FF_ARGS -r ./ff-ts-frame-index.pcapng > ./ff-ts-frame-index.txt 2> /dev/null
+	diff -u $FF_BASELINE ./ff-ts-frame-index.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of microsecond pcap direct read vs indexed pcap-ng read differ"
+		cat $DIFF_OUT
+		return
+	fi
+	ff_time_range_whole_file ./ff-ts-frame-index.pcapng || return
+
+	# Jump through an index with an entry for every packet.
+	ff_make_time_series || return
+	$EDITCAP --frame-index 1 ./ff-ts-time-series.pcapng ./ff-ts-frame-index-1.pcapng > /dev/null 2>&1 &&
+	$EDITCAP -t 1024 --frame-index 1 ./ff-ts-time-series.pcapng ./ff-ts-frame-index-2.pcapng > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Writing a pcap-ng time series file with a frame index failed"
+		return
+	fi
+	ff_time_range_mid_file ./ff-ts-frame-index-1.pcapng || return
+
+	# Two sections, and an index that only fits the second one; reading
+	# into the second section must process its SHB and IDB.
+	cat ./ff-ts-frame-index-1.pcapng ./ff-ts-frame-index-2.pcapng > ./ff-ts-frame-index-12.pcapng
+	ff_time_range_mid_file ./ff-ts-frame-index-12.pcapng || return
+	ff_time_range_compare ./ff-ts-frame-index-12.pcapng 1102275508.35 "" || return
+	test_step_ok
+}
+
+ff_step_packet_comments() {
+	$EDITCAP -a "2:ff packet comment" "${CAPTURE_DIR}dhcp.pcapng" ./ff-ts-comment-1.pcapng > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Adding a packet comment failed"
+		return
+	fi
+	# Copying a pcap-ng file carries the comment over without decoding it.
+	$EDITCAP ./ff-ts-comment-1.pcapng ./ff-ts-comment-2.pcapng > /dev/null 2>&1
+	COMMENT_COUNT=`$TSHARK -r ./ff-ts-comment-2.pcapng -Y 'frame.comment == "ff packet comment"' 2> /dev/null | wc -l | tr -d ' '`
+	if [ "$COMMENT_COUNT" != "1" ]; then
+		test_step_failed "Expected 1 commented packet, got $COMMENT_COUNT"
+		return
+	fi
+	$TSHARK $TS_FF_ARGS -r ./ff-ts-comment-2.pcapng > ./ff-ts-comment.txt 2> /dev/null
+	diff -u $FF_BASELINE ./ff-ts-comment.txt > $DIFF_OUT 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Output of microsecond pcap direct read vs commented pcap-ng read differ"
+		cat $DIFF_OUT
+		return
+	fi
+	test_step_ok
+}
+
+# Write a file large enough to fill the buffers of the asynchronous
+# writer several times with editcap and tshark, which write
+# asynchronously, and compare them with the same file written
+# synchronously by mergecap.
+ff_step_async_write() {
+	cp "${CAPTURE_DIR}dhcp.pcap" ./ff-ts-async-in.pcap
+	# 4 packets doubled 14 times, about 20 MB
+	for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 ; do
+		$MERGECAP -a -F pcap -w ./ff-ts-async-tmp.pcap ./ff-ts-async-in.pcap ./ff-ts-async-in.pcap > /dev/null 2>&1
+		RETURNVALUE=$?
+		if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+			test_step_failed "Writing the input file failed"
+			return
+		fi
+		mv ./ff-ts-async-tmp.pcap ./ff-ts-async-in.pcap
+	done
+	$MERGECAP -F pcap -w ./ff-ts-async-sync.pcap ./ff-ts-async-in.pcap > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Synchronous write failed"
+		return
+	fi
+	$EDITCAP -F pcap ./ff-ts-async-in.pcap ./ff-ts-async-editcap.pcap > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Asynchronous write by editcap failed"
+		return
+	fi
+	if ! cmp -s ./ff-ts-async-sync.pcap ./ff-ts-async-editcap.pcap ; then
+		test_step_failed "Synchronous write vs asynchronous write by editcap differ"
+		return
+	fi
+	$TSHARK -F pcap -r ./ff-ts-async-in.pcap -w ./ff-ts-async-tshark.pcap > /dev/null 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_failed "Asynchronous write by tshark failed"
+		return
+	fi
+	if ! cmp -s ./ff-ts-async-sync.pcap ./ff-ts-async-tshark.pcap ; then
+		test_step_failed "Synchronous write vs asynchronous write by tshark differ"
+		return
+	fi
+	test_step_ok
+}
+
 tshark_ff_suite() {
 	# Microsecond pcap direct read is used as the baseline.
 	test_step_add "Microsecond pcap via stdin" ff_step_usec_pcap_stdin
@@ -132,10 +384,23 @@ tshark_ff_suite() {
 	test_step_add "Microsecond pcap-ng direct read" ff_step_usec_pcapng_direct
 	test_step_add "Nanosecond pcap-ng via stdin" ff_step_nsec_pcapng_stdin
 	test_step_add "Nanosecond pcap-ng direct read" ff_step_nsec_pcapng_direct
+	test_step_add "zstd compressed write and read" ff_step_zstd_round_trip
+	test_step_add "lz4 compressed write and read" ff_step_lz4_round_trip
+	test_step_add "pcap time range read" ff_step_time_range_pcap
+	test_step_add "pcap-ng time range read" ff_step_time_range_pcapng
+	test_step_add "Read with session resets" ff_step_reset_session
+	test_step_add "pcap-ng frame index write and read" ff_step_frame_index
+	test_step_add "pcap-ng packet comments read and copied" ff_step_packet_comments
+	test_step_add "Asynchronous write" ff_step_async_write
 }
 
 ff_cleanup_step() {
 	rm -f ./ff-ts-*.txt
+	rm -f ./ff-ts-compressed.*
+	rm -f ./ff-ts-frame-index*.pcapng
+	rm -f ./ff-ts-time-series*
+	rm -f ./ff-ts-comment-*.pcapng
+	rm -f ./ff-ts-async-*.pcap
 	rm -f $DIFF_OUT
 }
 
@@ -312,11 +312,44 @@ text2pcap_step_hash_at_eol() {
 	test_step_ok
 }
 
+# The threaded tokenizer must produce the same file as the flex scanner
+text2pcap_step_threaded() {
+	for capture in dhcp.pcap dns+icmp.pcapng.gz wpa-Induction.pcap.gz text2pcap_hash_eol.txt ; do
+		case "$capture" in
+			*.txt)
+				cp "${CAPTURE_DIR}$capture" testin.txt
+				;;
+			*)
+				text2pcap_generate_input "${CAPTURE_DIR}$capture"
+				;;
+		esac
+		$TEXT2PCAP -q -t "%Y-%m-%d %H:%M:%S." testin.txt testout.pcap > testout.txt 2>&1
+		if [ $? -ne 0 ]; then
+			cat ./testout.txt
+			test_step_failed "text2pcap failed on $capture"
+			return
+		fi
+		$TEXT2PCAP -q -j 4 -t "%Y-%m-%d %H:%M:%S." testin.txt testout-threaded.pcap > testout.txt 2>&1
+		if [ $? -ne 0 ]; then
+			cat ./testout.txt
+			test_step_failed "text2pcap -j 4 failed on $capture"
+			return
+		fi
+		cmp -s testout.pcap testout-threaded.pcap
+		if [ $? -ne 0 ]; then
+			test_step_failed "text2pcap -j 4 output differs for $capture"
+			return
+		fi
+	done
+	test_step_ok
+}
+
 text2pcap_cleanup_step() {
 	rm -f ./testin.txt
 	rm -f ./testout.txt
 	rm -f ./capinfo_testout.txt
 	rm -f ./testout.pcap
+	rm -f ./testout-threaded.pcap
 }
 
 text2pcap_suite() {
@@ -344,6 +377,7 @@ text2pcap_suite() {
 	test_step_add "testing with packet-h2-14_headers.pcapng" text2pcap_packet_h2_14_headers_pcapng_test
 	test_step_add "testing with sip.pcapng" text2pcap_sip_pcapng_test
 	test_step_add "hash sign at the end of the line" text2pcap_step_hash_at_eol
+	test_step_add "threaded tokenizer output matches the scanner" text2pcap_step_threaded
 }
 
 #
@@ -68,6 +68,12 @@ check_dut() {
 	fi
 }
 
+unittests_step_dissector_table_test() {
+	check_dut dissector_table_test || return
+	ARGS=
+	unittests_step_test
+}
+
 unittests_step_exntest() {
 	check_dut exntest || return
 	ARGS=
@@ -117,6 +123,7 @@ unittests_cleanup_step() {
 unittests_suite() {
 	test_step_set_pre unittests_cleanup_step
 	test_step_set_post unittests_cleanup_step
+	test_step_add "dissector_table_test" unittests_step_dissector_table_test
 	test_step_add "exntest" unittests_step_exntest
 	test_step_add "oids_test" unittests_step_oids_test
 	test_step_add "reassemble_test" unittests_step_reassemble_test
@@ -236,6 +236,9 @@ static struct tm timecode_default;
 
 static guint8* pkt_lnstart;
 
+/* Number of threads tokenizing the input, 0 to use the flex scanner */
+static guint num_parse_threads = 0;
+
 /* Input file */
 static char *input_filename;
 static FILE       *input_file  = NULL;
@@ -431,6 +434,28 @@ parse_num(const char *str, int offset, guint32* num)
     return EXIT_SUCCESS;
 }
 
+/* Value of each hex digit, -1 for anything else */
+static const gint8 hex_nibble[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+#define IS_HEX_DIGIT(c) (hex_nibble[(guchar)(c)] >= 0)
+
 /*----------------------------------------------------------------------
  * Write this byte into current packet
  */
@@ -439,7 +464,14 @@ write_byte(const char *str)
 {
     guint32 num;
 
-    if (parse_num(str, FALSE, &num) != EXIT_SUCCESS)
+    /*
+     * Byte tokens are two hex digits followed by a separator, so decode
+     * them directly rather than going through strtoul().
+     */
+    if (str != NULL && IS_HEX_DIGIT(str[0]) && IS_HEX_DIGIT(str[1]) &&
+        !IS_HEX_DIGIT(str[2])) {
+        num = (hex_nibble[(guchar)str[0]] << 4) | hex_nibble[(guchar)str[1]];
+    } else if (parse_num(str, FALSE, &num) != EXIT_SUCCESS)
         return EXIT_FAILURE;
 
     packet_buf[curr_offset] = (guint8) num;
@@ -1450,6 +1482,8 @@ print_usage (FILE *output)
             "  -d                     show detailed debug of parser states.\n"
             "  -q                     generate no output at all (automatically disables -d).\n"
             "  -n                     use PCAP-NG instead of PCAP as output format.\n"
+            "  -j <threads>           tokenize the input with the given number of threads;\n"
+            "                         useful for very large hex dumps.\n"
             "",
             WTAP_MAX_PACKET_SIZE);
 }
@@ -1493,7 +1527,7 @@ parse_options (int argc, char *argv[])
     g_string_free(runtime_info_str, TRUE);
 
     /* Scan CLI parameters */
-    while ((c = getopt_long(argc, argv, "aDdhqe:i:l:m:no:u:s:S:t:T:v4:6:", long_options, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "aDdhqe:i:j:l:m:no:u:s:S:t:T:v4:6:", long_options, NULL)) != -1) {
         switch (c) {
         case 'h':
             printf("Text2pcap (Wireshark) %s\n"
@@ -1509,6 +1543,14 @@ parse_options (int argc, char *argv[])
         case 'l': pcap_link_type = (guint32)strtol(optarg, NULL, 0); break;
         case 'm': max_offset = (guint32)strtol(optarg, NULL, 0); break;
         case 'n': use_pcapng = TRUE; break;
+        case 'j':
+            num_parse_threads = (guint)strtol(optarg, &p, 10);
+            if (p == optarg || *p != '\0' || num_parse_threads < 1 || num_parse_threads > 64) {
+                fprintf(stderr, "Bad argument for '-j': %s\n", optarg);
+                print_usage(stderr);
+                return EXIT_FAILURE;
+            }
+            break;
         case 'o':
             if (optarg[0] != 'h' && optarg[0] != 'o' && optarg[0] != 'd') {
                 fprintf(stderr, "Bad argument for '-o': %s\n", optarg);
@@ -1870,6 +1912,286 @@ parse_options (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+/*--- Parallel tokenizer -------------------------------------------------------*/
+
+/*
+ * With -j the input is cut into blocks of whole lines, which worker
+ * threads split into tokens.  The main thread then hands the tokens of
+ * each block to parse_token() in input order, so the state machine sees
+ * exactly the token stream the flex scanner would have produced.
+ *
+ * tokenize_block() implements the rules in text2pcap-scanner.l by hand
+ * (longest match, earliest rule on a tie, '^' meaning "just after a
+ * newline"); keep the two in sync.
+ */
+
+#define PARSE_BLOCK_SIZE    (1024 * 1024)
+
+typedef struct {
+    token_t  token;
+    gint32   str_offset;    /* offset of the token text in strs, or -1 */
+} block_token_t;
+
+typedef struct {
+    char    *data;          /* input lines */
+    gsize    data_len;
+    char    *strs;          /* NUL-terminated token texts */
+    GArray  *tokens;        /* block_token_t's */
+} input_block_t;
+
+typedef struct {
+    GThread     *tid;
+    GAsyncQueue *pending_q; /* blocks to tokenize */
+    GAsyncQueue *done_q;    /* tokenized blocks, in the order they were queued */
+} parse_worker_t;
+
+/* Queued to a worker to make it exit */
+static input_block_t end_of_blocks;
+
+static void
+add_block_token(input_block_t *block, token_t token, const char *str,
+                gsize len, gsize *strs_len)
+{
+    block_token_t t;
+
+    t.token = token;
+    if (str != NULL) {
+        t.str_offset = (gint32)*strs_len;
+        memcpy(block->strs + *strs_len, str, len);
+        block->strs[*strs_len + len] = '\0';
+        *strs_len += len + 1;
+    } else {
+        t.str_offset = -1;
+    }
+    g_array_append_val(block->tokens, t);
+}
+
+static void
+tokenize_block(input_block_t *block)
+{
+    const char *s   = block->data;
+    gsize       len = block->data_len;
+    gsize       strs_len = 0;
+    gsize       p = 0, h, n, end, text_end;
+    const char *nl;
+    char        c;
+
+    /* Every token text is a distinct, non-empty part of the input */
+    block->strs   = (char *)g_malloc(2 * len + 1);
+    block->tokens = g_array_sized_new(FALSE, FALSE, sizeof(block_token_t),
+                                      (guint)(len / 3) + 1);
+
+    while (p < len) {
+        c = s[p];
+
+        /* {directive} and {comment}, which run up to the next newline */
+        if ((p == 0 || s[p - 1] == '\n') && (c == '#' || c == ' ' || c == '\t')) {
+            for (n = p; n < len && (s[n] == ' ' || s[n] == '\t'); n++)
+                ;
+            if (n < len && s[n] == '#' &&
+                (nl = (const char *)memchr(s + n, '\n', len - n)) != NULL) {
+                end = (gsize)(nl - s) + 1;
+                if (n == p && end - p > 10 && memcmp(s + p, "#TEXT2PCAP", 10) == 0)
+                    add_block_token(block, T_DIRECTIVE, s + p, end - p, &strs_len);
+                add_block_token(block, T_EOL, NULL, 0, &strs_len);
+                p = end;
+                continue;
+            }
+        }
+
+        /* {eol} */
+        if (c == '\n' || (c == '\r' && p + 1 < len && s[p + 1] == '\n')) {
+            p += (c == '\r') ? 2 : 1;
+            if (p < len && s[p] == '\r')
+                p++;
+            add_block_token(block, T_EOL, NULL, 0, &strs_len);
+            continue;
+        }
+
+        /* [ \t] */
+        if (c == ' ' || c == '\t') {
+            p++;
+            continue;
+        }
+
+        for (text_end = p; text_end < len && s[text_end] != ' ' &&
+             s[text_end] != '\t' && s[text_end] != '\n'; text_end++)
+            ;
+
+        /* {byte}, {byte_eol}, {offset}, {offset_eol} and {mailfwd}{offset} */
+        h = (c == '>') ? p + 1 : p;
+        for (n = h; n < len && IS_HEX_DIGIT(s[n]); n++)
+            ;
+        if (n > h) {
+            gboolean eol = FALSE;
+
+            end = 0;
+            if (n < len && (s[n] == ':' || s[n] == ' ' || s[n] == '\t')) {
+                end = n + 1;
+            } else if (c != '>' && n < len && s[n] == '\n') {
+                end = n + 1;
+                eol = TRUE;
+            } else if (c != '>' && n + 1 < len && s[n] == '\r' && s[n + 1] == '\n') {
+                end = n + 2;
+                eol = TRUE;
+            }
+            /* These rules come before {text}, so they win a tie */
+            if (end != 0 && end >= text_end) {
+                add_block_token(block,
+                                (c != '>' && n - h == 2 && s[n] != ':') ? T_BYTE : T_OFFSET,
+                                s + h, end - h, &strs_len);
+                if (eol)
+                    add_block_token(block, T_EOL, NULL, 0, &strs_len);
+                p = end;
+                continue;
+            }
+        }
+
+        /* {text} */
+        add_block_token(block, T_TEXT, s + p, text_end - p, &strs_len);
+        p = text_end;
+    }
+}
+
+static gpointer
+parse_worker_thread(gpointer data)
+{
+    parse_worker_t *worker = (parse_worker_t *)data;
+    input_block_t  *block;
+
+    while ((block = (input_block_t *)g_async_queue_pop(worker->pending_q)) != &end_of_blocks) {
+        tokenize_block(block);
+        g_async_queue_push(worker->done_q, block);
+    }
+    return NULL;
+}
+
+/*
+ * Read the next block of input.  A block ends after a newline, but not
+ * between "\n" and "\r", which the scanner matches as a single {eol}; no
+ * token can then span two blocks.  Returns NULL at the end of the input.
+ */
+static input_block_t *
+read_input_block(FILE *fh, GByteArray *pending, gboolean *at_eof)
+{
+    input_block_t *block;
+    guint          split = 0;
+    guint          old_len, i;
+    size_t         nread;
+
+    for (;;) {
+        if (!*at_eof) {
+            old_len = pending->len;
+            g_byte_array_set_size(pending, old_len + PARSE_BLOCK_SIZE);
+            nread = fread(pending->data + old_len, 1, PARSE_BLOCK_SIZE, fh);
+            g_byte_array_set_size(pending, old_len + (guint)nread);
+            if (nread < PARSE_BLOCK_SIZE)
+                *at_eof = TRUE;
+        }
+        if (*at_eof) {
+            split = pending->len;
+            break;
+        }
+        for (i = pending->len - 1; i > 0; i--) {
+            if (pending->data[i - 1] == '\n' && pending->data[i] != '\r') {
+                split = i;
+                break;
+            }
+        }
+        if (split != 0)
+            break;
+    }
+    if (split == 0)
+        return NULL;
+
+    block = g_new0(input_block_t, 1);
+    block->data = (char *)g_memdup(pending->data, split);
+    block->data_len = split;
+    g_byte_array_remove_range(pending, 0, split);
+    return block;
+}
+
+static void
+free_input_block(input_block_t *block)
+{
+    g_free(block->data);
+    g_free(block->strs);
+    if (block->tokens != NULL)
+        g_array_free(block->tokens, TRUE);
+    g_free(block);
+}
+
+/*----------------------------------------------------------------------
+ * Tokenize the input with worker threads and parse the tokens in order;
+ * the counterpart of text2pcap_lex()
+ */
+static int
+parse_input_threaded(FILE *fh, guint num_threads)
+{
+    parse_worker_t *workers;
+    GByteArray     *pending;
+    gboolean        at_eof = FALSE;
+    guint64         blocks_queued = 0;
+    guint64         blocks_parsed = 0;
+    input_block_t  *block;
+    block_token_t  *t;
+    guint           i;
+    int             ret = EXIT_SUCCESS;
+
+    workers = g_new0(parse_worker_t, num_threads);
+    for (i = 0; i < num_threads; i++) {
+        workers[i].pending_q = g_async_queue_new();
+        workers[i].done_q = g_async_queue_new();
+#if GLIB_CHECK_VERSION(2,31,0)
+        workers[i].tid = g_thread_new("text2pcap tokenizer", parse_worker_thread, &workers[i]);
+#else
+        workers[i].tid = g_thread_create(parse_worker_thread, &workers[i], TRUE, NULL);
+#endif
+    }
+    pending = g_byte_array_new();
+
+    for (;;) {
+        /*
+         * Blocks are handed out round-robin, so each worker's done queue
+         * gives its blocks back in input order.  Keep two blocks per
+         * worker in flight to bound memory use.
+         */
+        while (ret == EXIT_SUCCESS && !at_eof &&
+               blocks_queued - blocks_parsed < 2 * num_threads) {
+            block = read_input_block(fh, pending, &at_eof);
+            if (block == NULL)
+                break;
+            g_async_queue_push(workers[blocks_queued % num_threads].pending_q, block);
+            blocks_queued++;
+        }
+        if (blocks_parsed == blocks_queued)
+            break;
+
+        block = (input_block_t *)g_async_queue_pop(workers[blocks_parsed % num_threads].done_q);
+        blocks_parsed++;
+        for (i = 0; ret == EXIT_SUCCESS && i < block->tokens->len; i++) {
+            t = &g_array_index(block->tokens, block_token_t, i);
+            ret = parse_token(t->token, t->str_offset < 0 ? NULL : block->strs + t->str_offset);
+        }
+        free_input_block(block);
+    }
+
+    if (ret == EXIT_SUCCESS && ferror(fh)) {
+        fprintf(stderr, "FATAL ERROR: error reading input file: %s\n", g_strerror(errno));
+        ret = EXIT_FAILURE;
+    }
+
+    for (i = 0; i < num_threads; i++) {
+        g_async_queue_push(workers[i].pending_q, &end_of_blocks);
+        g_thread_join(workers[i].tid);
+        g_async_queue_unref(workers[i].pending_q);
+        g_async_queue_unref(workers[i].done_q);
+    }
+    g_free(workers);
+    g_byte_array_free(pending, TRUE);
+    return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -1910,8 +2232,16 @@ main(int argc, char *argv[])
     }
     curr_offset = header_length;
 
-    text2pcap_in = input_file;
-    if (text2pcap_lex() == EXIT_SUCCESS) {
+    if (num_parse_threads > 0) {
+#if !GLIB_CHECK_VERSION(2,31,0)
+        g_thread_init(NULL);
+#endif
+        ret = parse_input_threaded(input_file, num_parse_threads);
+    } else {
+        text2pcap_in = input_file;
+        ret = text2pcap_lex();
+    }
+    if (ret == EXIT_SUCCESS) {
         if (write_current_packet(FALSE) != EXIT_SUCCESS)
             ret = EXIT_FAILURE;
     } else {
@@ -162,6 +162,27 @@ static frame_data prev_cap_frame;
 
 static gboolean perform_two_pass_analysis;
 
+static wtap_compression_type out_compression_type = WTAP_UNCOMPRESSED;
+
+static gboolean check_time_range = FALSE;
+static nstime_t time_range_start;
+static nstime_t time_range_stop;
+
+/*
+ * Start a new dissection session after this many packets, or after
+ * this many seconds' worth of packets, have been dissected in the
+ * current one, so that the state dissectors keep for the duration of
+ * a session doesn't grow without bound.  0 means "never".
+ */
+static guint32 session_reset_packets = 0;
+static guint32 session_reset_duration = 0;
+static guint32 session_packet_count;
+static nstime_t session_start_ts;
+
+#define LONGOPT_COMPRESS 5002
+#define LONGOPT_TIME_RANGE 5003
+#define LONGOPT_RESET_SESSION 5004
+
 /*
  * The way the packet decode is to be written.
  */
@@ -291,6 +312,21 @@ list_capture_types(void) {
   g_free(captypes);
 }
 
+static void
+list_compression_types(void) {
+  GSList *list, *elem;
+
+  fprintf(stderr, "tshark: The available compression types for the \"--compress\" flag are:\n");
+  list = wtap_get_all_compression_type_names_list();
+  for (elem = list; elem != NULL; elem = g_slist_next(elem)) {
+    const char *name = (const char *)elem->data;
+
+    fprintf(stderr, "    %s - %s\n", name,
+            wtap_compression_type_description(wtap_name_to_compression_type(name)));
+  }
+  g_slist_free(list);
+}
+
 static void
 list_read_capture_types(void) {
   int                 i;
@@ -354,6 +390,9 @@ print_usage(FILE *output)
   /*fprintf(output, "\n");*/
   fprintf(output, "Input file:\n");
   fprintf(output, "  -r <infile>              set the filename to read from (- to read from stdin)\n");
+  fprintf(output, "  --time-range <start>,<stop>\n");
+  fprintf(output, "                           only read packets from <start> up to <stop>, skipping\n");
+  fprintf(output, "                           directly to <start>; either may be omitted\n");
 
   fprintf(output, "\n");
   fprintf(output, "Processing:\n");
@@ -375,6 +414,9 @@ print_usage(FILE *output)
   fprintf(output, "                           enable dissection of heuristic protocol\n");
   fprintf(output, "  --disable-heuristic <short_name>\n");
   fprintf(output, "                           disable dissection of heuristic protocol\n");
+  fprintf(output, "  --reset-session packets:NUM|duration:NUM\n");
+  fprintf(output, "                           discard the dissection state after NUM packets or\n");
+  fprintf(output, "                           NUM secs of traffic (requires one-pass analysis)\n");
 
   /*fprintf(output, "\n");*/
   fprintf(output, "Output:\n");
@@ -423,6 +465,8 @@ print_usage(FILE *output)
   fprintf(output, "                           output file (only for pcapng)\n");
   fprintf(output, "  --export-objects <protocol>,<destdir> save exported objects for a protocol to\n");
   fprintf(output, "                           a directory named \"destdir\"\n");
+  fprintf(output, "  --compress <type>        compress the output file with <type> when reading\n");
+  fprintf(output, "                           with -r; an empty \"--compress\" lists the types\n");
 
   fprintf(output, "\n");
   fprintf(output, "Miscellaneous:\n");
@@ -656,6 +700,9 @@ main(int argc, char *argv[])
     LONGOPT_CAPTURE_COMMON
     LONGOPT_DISSECT_COMMON
     {"export-objects", required_argument, NULL, LONGOPT_EXPORT_OBJECTS},
+    {"compress", required_argument, NULL, LONGOPT_COMPRESS},
+    {"time-range", required_argument, NULL, LONGOPT_TIME_RANGE},
+    {"reset-session", required_argument, NULL, LONGOPT_RESET_SESSION},
     {0, 0, 0, 0 }
   };
   gboolean             arg_error = FALSE;
@@ -895,6 +942,9 @@ main(int argc, char *argv[])
 
   wtap_init();
 
+  /* We read files straight through, so read them in large chunks. */
+  wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE);
+
 #ifdef HAVE_PLUGINS
   /* Register all the plugin types we have. */
   epan_register_plugin_types(); /* Types known to libwireshark */
@@ -1392,12 +1442,49 @@ main(int argc, char *argv[])
         goto clean_exit;
       }
       break;
+    case LONGOPT_COMPRESS:   /* --compress */
+      out_compression_type = wtap_name_to_compression_type(optarg);
+      if (out_compression_type == WTAP_UNKNOWN_COMPRESSION) {
+        cmdarg_err("\"%s\" isn't a valid compression type", optarg);
+        list_compression_types();
+        exit_status = INVALID_OPTION;
+        goto clean_exit;
+      }
+      if (!wtap_can_write_compression_type(out_compression_type)) {
+        cmdarg_err("Writing %s compressed files isn't supported by this build",
+                   wtap_compression_type_name(out_compression_type));
+        exit_status = INVALID_OPTION;
+        goto clean_exit;
+      }
+      break;
+    case LONGOPT_TIME_RANGE:   /* --time-range */
+      if (!nstime_range_from_str(&time_range_start, &time_range_stop, optarg)) {
+        cmdarg_err("\"%s\" isn't a valid time range", optarg);
+        exit_status = INVALID_OPTION;
+        goto clean_exit;
+      }
+      check_time_range = TRUE;
+      break;
+    case LONGOPT_RESET_SESSION:   /* --reset-session */
+      if (strncmp(optarg, "packets:", 8) == 0) {
+        session_reset_packets = get_positive_int(optarg + 8, "session reset packet count");
+      } else if (strncmp(optarg, "duration:", 9) == 0) {
+        session_reset_duration = get_positive_int(optarg + 9, "session reset duration");
+      } else {
+        cmdarg_err("\"%s\" isn't a valid session reset criterion", optarg);
+        exit_status = INVALID_OPTION;
+        goto clean_exit;
+      }
+      break;
     default:
     case '?':        /* Bad flag - print usage message */
       switch(optopt) {
       case 'F':
         list_capture_types();
         break;
+      case LONGOPT_COMPRESS:
+        list_compression_types();
+        break;
       default:
         print_usage(stderr);
       }
@@ -1530,6 +1617,13 @@ main(int argc, char *argv[])
     goto clean_exit;
   }
 
+  if ((session_reset_packets != 0 || session_reset_duration != 0) && perform_two_pass_analysis) {
+    /* The second pass needs the state built up by the first one. */
+    cmdarg_err("--reset-session can't be used with -2.");
+    exit_status = INVALID_OPTION;
+    goto clean_exit;
+  }
+
 #ifdef HAVE_LIBPCAP
   if (list_link_layer_types) {
     /* We're supposed to list the link-layer types for an interface;
@@ -1665,6 +1759,16 @@ main(int argc, char *argv[])
           exit_status = INVALID_OPTION;
           goto clean_exit;
         }
+        if (out_compression_type != WTAP_UNCOMPRESSED) {
+          cmdarg_err("Compressed output isn't supported when capturing and saving the captured packets.");
+          exit_status = INVALID_OPTION;
+          goto clean_exit;
+        }
+        if (check_time_range) {
+          cmdarg_err("A time range isn't supported when capturing and saving the captured packets.");
+          exit_status = INVALID_OPTION;
+          goto clean_exit;
+        }
         if (dfilter != NULL) {
           cmdarg_err("Display filters aren't supported when capturing and saving the captured packets.");
           exit_status = INVALID_OPTION;
@@ -2281,9 +2385,55 @@ tshark_epan_new(capture_file *cf)
   epan->get_interface_description = cap_file_get_interface_description;
   epan->get_user_comment = NULL;
 
+  session_packet_count = 0;
+  nstime_set_unset(&session_start_ts);
+
   return epan;
 }
 
+/*
+ * Account for a packet dissected in the current session and decide
+ * whether it's time to start a new one.
+ */
+static gboolean
+session_reset_due(const struct wtap_pkthdr *whdr)
+{
+  if (session_reset_packets == 0 && session_reset_duration == 0)
+    return FALSE;
+
+  session_packet_count++;
+  if (session_reset_packets != 0 && session_packet_count >= session_reset_packets)
+    return TRUE;
+
+  if (session_reset_duration != 0 && (whdr->presence_flags & WTAP_HAS_TS)) {
+    if (nstime_is_unset(&session_start_ts))
+      session_start_ts = whdr->ts;
+    else if (whdr->ts.secs - session_start_ts.secs >= (time_t)session_reset_duration)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/*
+ * Throw away the dissection session, and with it everything the
+ * dissectors have allocated in file scope - conversations, reassembly
+ * tables, request/response tracking and the like - and start a new one.
+ * Tap listeners are left alone, so statistics keep accumulating; frame
+ * numbers keep counting up.
+ */
+static epan_dissect_t *
+reset_epan_session(capture_file *cf, epan_dissect_t *edt,
+                   gboolean create_proto_tree, gboolean proto_tree_visible)
+{
+  tshark_debug("tshark: resetting the dissection session after frame %u", cf->count);
+
+  epan_dissect_free(edt);
+  epan_free(cf->epan);
+  cf->epan = tshark_epan_new(cf);
+
+  return epan_dissect_new(cf->epan, create_proto_tree, proto_tree_visible);
+}
+
 #ifdef HAVE_LIBPCAP
 static gboolean
 capture(void)
@@ -2603,6 +2753,9 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
         ret = process_packet(cf, edt, data_offset, wtap_phdr(cf->wth),
                              wtap_buf_ptr(cf->wth),
                              tap_flags);
+        if (session_reset_due(wtap_phdr(cf->wth)))
+          edt = reset_epan_session(cf, edt, create_proto_tree,
+                                   print_packet_info && print_details);
       }
       if (ret != FALSE) {
         /* packet successfully read and gone through the "Read Filter" */
@@ -2955,6 +3108,34 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fd
   return passed || fdata->flags.dependent_of_displayed;
 }
 
+/*
+ * Read the next record from the file; if a time range was specified,
+ * the first read skips directly to the start of the range, and we
+ * report an EOF at the first record at or after the end of the range.
+ */
+static gboolean
+read_next_record(wtap *wth, gboolean *first_record, int *err, gchar **err_info,
+                 gint64 *data_offset)
+{
+  struct wtap_pkthdr *whdr;
+  gboolean ret;
+
+  if (*first_record && check_time_range && !nstime_is_unset(&time_range_start))
+    ret = wtap_seek_time(wth, &time_range_start, err, err_info, data_offset);
+  else
+    ret = wtap_read(wth, err, err_info, data_offset);
+  *first_record = FALSE;
+  if (!ret)
+    return FALSE;
+
+  whdr = wtap_phdr(wth);
+  if (check_time_range && !nstime_is_unset(&time_range_stop) &&
+      (whdr->presence_flags & WTAP_HAS_TS) &&
+      nstime_cmp(&whdr->ts, &time_range_stop) >= 0)
+    return FALSE;
+  return TRUE;
+}
+
 static int
 load_cap_file(capture_file *cf, char *save_file, int out_file_type,
     gboolean out_file_name_res, int max_packet_count, gint64 max_byte_count)
@@ -2966,6 +3147,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
   int          err;
   gchar       *err_info = NULL;
   gint64       data_offset;
+  gboolean     first_record = TRUE;
   char        *save_file_string = NULL;
   gboolean     filtering_tap_listeners;
   guint        tap_flags;
@@ -3016,10 +3198,10 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         if (strcmp(save_file, "-") == 0) {
           /* Write to the standard output. */
           pdh = wtap_dump_open_stdout(out_file_type, linktype,
-              snapshot_length, FALSE /* compressed */, &err);
+              snapshot_length, out_compression_type, &err);
         } else {
           pdh = wtap_dump_open(save_file, out_file_type, linktype,
-              snapshot_length, FALSE /* compressed */, &err);
+              snapshot_length, out_compression_type, &err);
         }
     }
     else {
@@ -3027,10 +3209,10 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         if (strcmp(save_file, "-") == 0) {
           /* Write to the standard output. */
           pdh = wtap_dump_open_stdout_ng(out_file_type, linktype,
-              snapshot_length, FALSE /* compressed */, shb_hdrs, idb_inf, nrb_hdrs, &err);
+              snapshot_length, out_compression_type, shb_hdrs, idb_inf, nrb_hdrs, &err);
         } else {
           pdh = wtap_dump_open_ng(save_file, out_file_type, linktype,
-              snapshot_length, FALSE /* compressed */, shb_hdrs, idb_inf, nrb_hdrs, &err);
+              snapshot_length, out_compression_type, shb_hdrs, idb_inf, nrb_hdrs, &err);
         }
     }
 
@@ -3068,6 +3250,9 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       }
       goto out;
     }
+
+    /* Don't let slow output storage hold up dissection. */
+    wtap_dump_set_async(pdh);
   } else {
     if (print_packet_info) {
       if (!write_preamble(cf)) {
@@ -3119,7 +3304,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
     }
 
     tshark_debug("tshark: reading records for first pass");
-    while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+    while (read_next_record(cf->wth, &first_record, &err, &err_info, &data_offset)) {
       if (process_packet_first_pass(cf, edt, data_offset, wtap_phdr(cf->wth),
                          wtap_buf_ptr(cf->wth))) {
         /* Stop reading if we have the maximum number of packets;
@@ -3287,13 +3472,13 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
   }
   else {
     /* !perform_two_pass_analysis */
+    gboolean create_proto_tree = FALSE;
+
     framenum = 0;
 
     tshark_debug("tshark: perform one pass analysis, do_dissection=%s", do_dissection ? "TRUE" : "FALSE");
 
     if (do_dissection) {
-      gboolean create_proto_tree;
-
       /*
        * Determine whether we need to create a protocol tree.
        * We do if:
@@ -3327,7 +3512,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
     }
 
-    while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+    while (read_next_record(cf->wth, &first_record, &err, &err_info, &data_offset)) {
       framenum++;
 
       tshark_debug("tshark: processing packet #%d", framenum);
@@ -3417,6 +3602,10 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         err = 0; /* This is not an error */
         break;
       }
+
+      if (edt && session_reset_due(wtap_phdr(cf->wth)))
+        edt = reset_epan_session(cf, edt, create_proto_tree,
+                                 print_packet_info && print_details);
     }
 
     if (edt) {
@@ -0,0 +1,161 @@
+/* tap-heurstat.c
+ * Heuristic dissector statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The counters live in the heuristic dissector entries themselves; the
+ * tap listener is only there to have them reset at the start and
+ * printed at the end.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+
+void register_tap_listener_heurstat(void);
+
+static void
+heurstat_reset(void *tapdata _U_)
+{
+    heur_dissector_reset_statistics();
+}
+
+static void
+heurstat_add_list_name(const char *table_name, struct heur_dissector_list *table _U_, gpointer user_data)
+{
+    GSList **names = (GSList **)user_data;
+
+    *names = g_slist_insert_sorted(*names, (gpointer)table_name, (GCompareFunc)strcmp);
+}
+
+static void
+heurstat_add_entry(const gchar *table_name _U_, heur_dtbl_entry_t *hdtbl_entry, gpointer user_data)
+{
+    GSList **entries = (GSList **)user_data;
+
+    if (hdtbl_entry->tries != 0 || hdtbl_entry->skipped != 0)
+        *entries = g_slist_prepend(*entries, hdtbl_entry);
+}
+
+/* Most called first */
+static gint
+heurstat_compare_tries(gconstpointer a, gconstpointer b)
+{
+    const heur_dtbl_entry_t *hdtbl_entry_a = (const heur_dtbl_entry_t *)a;
+    const heur_dtbl_entry_t *hdtbl_entry_b = (const heur_dtbl_entry_t *)b;
+
+    if (hdtbl_entry_a->tries > hdtbl_entry_b->tries)
+        return -1;
+    if (hdtbl_entry_a->tries < hdtbl_entry_b->tries)
+        return 1;
+    return strcmp(hdtbl_entry_a->short_name, hdtbl_entry_b->short_name);
+}
+
+static void
+heurstat_draw(void *tapdata _U_)
+{
+    GSList *names = NULL;
+    GSList *name;
+    GSList *entries;
+    GSList *entry;
+    heur_dtbl_entry_t *hdtbl_entry;
+
+    dissector_all_heur_tables_foreach_table(heurstat_add_list_name, &names, NULL);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("Heuristic Dissector Statistics:\n");
+    printf("%-24s %12s %12s %12s %8s\n", "Heuristic", "Called", "Accepted", "Skipped", "Hit %");
+
+    for (name = names; name != NULL; name = g_slist_next(name)) {
+        entries = NULL;
+        heur_dissector_table_foreach((const char *)name->data, heurstat_add_entry, &entries);
+        if (entries == NULL)
+            continue;
+        entries = g_slist_sort(entries, heurstat_compare_tries);
+
+        printf("%s:\n", (const char *)name->data);
+        for (entry = entries; entry != NULL; entry = g_slist_next(entry)) {
+            hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
+            printf("  %-22s %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u %7.2f%%\n",
+                   hdtbl_entry->short_name, hdtbl_entry->tries, hdtbl_entry->hits, hdtbl_entry->skipped,
+                   hdtbl_entry->tries ? 100.0 * (double)hdtbl_entry->hits / (double)hdtbl_entry->tries : 0.0);
+        }
+        g_slist_free(entries);
+    }
+    printf("===================================================================\n");
+
+    g_slist_free(names);
+}
+
+static void
+heurstat_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, "heur,stat") != 0) {
+        fprintf(stderr, "tshark: invalid \"-z heur,stat\" argument\n");
+        exit(1);
+    }
+
+    error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING,
+                                         heurstat_reset, NULL, heurstat_draw);
+    if (error_string) {
+        fprintf(stderr, "tshark: Couldn't register heur,stat tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui heurstat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "heur,stat",
+    heurstat_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_heurstat(void)
+{
+    register_stat_tap_ui(&heurstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,119 @@
+/* tap-wmemstat.c
+ * wmem memory usage statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The counters are kept by the wmem allocators themselves; the tap
+ * listener is only there to have them printed at the end.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/wmem/wmem.h>
+
+void register_tap_listener_wmemstat(void);
+
+static void
+wmemstat_print_scope(const char *name, wmem_allocator_t *allocator)
+{
+    wmem_allocator_stats_t stats;
+
+    wmem_allocator_get_stats(allocator, &stats);
+
+    printf("%s:\n", name);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Allocations", stats.alloc_count);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Reallocations", stats.realloc_count);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Frees", stats.free_count);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Free alls", stats.free_all_count);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Bytes requested", stats.bytes_requested);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Peak bytes requested", stats.peak_bytes_requested);
+    printf("  %-22s %12u\n", "Blocks", stats.block_count);
+    printf("  %-22s %12u\n", "Peak blocks", stats.peak_block_count);
+    printf("  %-22s %12u\n", "Jumbo blocks", stats.jumbo_count);
+    printf("  %-22s %12" G_GINT64_MODIFIER "u\n", "Jumbo allocations", stats.jumbo_allocs);
+}
+
+static void
+wmemstat_draw(void *tapdata _U_)
+{
+    printf("\n");
+    printf("===================================================================\n");
+    printf("wmem Statistics:\n");
+    wmemstat_print_scope("epan scope", wmem_epan_scope());
+    wmemstat_print_scope("file scope", wmem_file_scope());
+    wmemstat_print_scope("packet scope", wmem_packet_scope());
+    printf("===================================================================\n");
+}
+
+static void
+wmemstat_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, "wmem") != 0) {
+        fprintf(stderr, "tshark: invalid \"-z wmem\" argument\n");
+        exit(1);
+    }
+
+    error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING,
+                                         NULL, NULL, wmemstat_draw);
+    if (error_string) {
+        fprintf(stderr, "tshark: Couldn't register wmem tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui wmemstat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "wmem",
+    wmemstat_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_wmemstat(void)
+{
+    register_stat_tap_ui(&wmemstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
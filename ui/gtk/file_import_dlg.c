@@ -512,7 +512,7 @@ file_import_open(text_import_info_t *info)
     info->wdh = wtap_dump_open_tempfile_ng(&tmpname, "import",
                                            WTAP_FILE_TYPE_SUBTYPE_PCAPNG,
                                            info->encapsulation,
-                                           info->max_frame_length, FALSE,
+                                           info->max_frame_length, WTAP_UNCOMPRESSED,
                                            shb_hdrs, idb_inf, NULL, &err);
     capfile_name = g_strdup(tmpname);
     if (info->wdh == NULL) {
@@ -1989,6 +1989,9 @@ void MainWindow::actionEditCopyTriggered(MainWindow::CopySelected selection_type
         if (finfo_selected && finfo_selected->rep
                 && strlen (finfo_selected->rep->representation) > 0) {
             clip.append(finfo_selected->rep->representation);
+        } else if (finfo_selected && finfo_selected->affix) {
+            proto_item_fill_label(finfo_selected, label_str);
+            clip.append(label_str);
         }
         break;
     case CopySelectedFieldName:
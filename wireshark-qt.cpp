@@ -577,6 +577,10 @@ int main(int argc, char *qt_argv[])
 
     wtap_init();
 
+    /* Read large chunks on the pass that loads a file; packets picked
+       out afterwards come through the random stream in small reads. */
+    wtap_set_sequential_read_buffer_size(WTAP_SEQUENTIAL_READ_BUFFER_SIZE);
+
 #ifdef HAVE_PLUGINS
     /* Register all the plugin types we have. */
     epan_register_plugin_types(); /* Types known to libwireshark */
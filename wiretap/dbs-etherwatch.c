@@ -98,26 +98,18 @@ static guint parse_hex_dump(char* dump, guint8 *buf, char seperator, char end);
 static gint64 dbs_etherwatch_seek_next_packet(wtap *wth, int *err,
                                               gchar **err_info)
 {
-    int byte;
-    unsigned int level = 0;
     gint64 cur_off;
 
-    while ((byte = file_getc(wth->fh)) != EOF) {
-        if (byte == dbs_etherwatch_rec_magic[level]) {
-            level++;
-            if (level >= DBS_ETHERWATCH_REC_MAGIC_SIZE) {
-                /* note: we're leaving file pointer right after the magic characters */
-                cur_off = file_tell(wth->fh);
-                if (cur_off == -1) {
-                    /* Error. */
-                    *err = file_error(wth->fh, err_info);
-                    return -1;
-                }
-                return cur_off + 1;
-            }
-        } else {
-            level = 0;
+    if (file_skip_past(wth->fh, dbs_etherwatch_rec_magic,
+                       DBS_ETHERWATCH_REC_MAGIC_SIZE)) {
+        /* note: we're leaving file pointer right after the magic characters */
+        cur_off = file_tell(wth->fh);
+        if (cur_off == -1) {
+            /* Error. */
+            *err = file_error(wth->fh, err_info);
+            return -1;
         }
+        return cur_off + 1;
     }
     /* EOF or error. */
     *err = file_error(wth->fh, err_info);
@@ -708,6 +708,30 @@ heuristic_uses_extension(unsigned int i, const char *extension)
 	return FALSE;	/* it's not one of them */
 }
 
+/*
+ * If TRUE, the fast seek points of files opened for random access are
+ * saved to, and loaded from, a sidecar file next to the capture file.
+ */
+static gboolean fast_seek_index_enabled = FALSE;
+
+void
+wtap_set_fast_seek_index(gboolean enable)
+{
+	fast_seek_index_enabled = enable;
+}
+
+/*
+ * Size of the buffers for the sequential stream of files opened from
+ * now on, or 0 to read it like the random stream.
+ */
+static guint sequential_read_buffer_size = 0;
+
+void
+wtap_set_sequential_read_buffer_size(guint size)
+{
+	sequential_read_buffer_size = size;
+}
+
 /* Opens a file and prepares a wtap struct.
    If "do_random" is TRUE, it opens the file twice; the second open
    allows the application to do random-access I/O without moving
@@ -826,6 +850,16 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 		}
 	}
 
+	/*
+	 * Only regular files get the big buffers; reading a pipe would
+	 * wait until a whole buffer's worth of data had arrived.
+	 */
+	if (sequential_read_buffer_size != 0 && S_ISREG(statb.st_mode)) {
+		/* If we can't get the big buffers, the small ones will do */
+		file_set_read_policy(wth->fh, FILE_READ_SEQUENTIAL,
+		    sequential_read_buffer_size);
+	}
+
 	if (do_random) {
 		if (!(wth->random_fh = file_open(filename))) {
 			*err = errno;
@@ -833,11 +867,13 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 			g_free(wth);
 			return NULL;
 		}
+		file_set_read_policy(wth->random_fh, FILE_READ_RANDOM, 0);
 	} else
 		wth->random_fh = NULL;
 
 	/* initialization */
 	wth->file_encap = WTAP_ENCAP_UNKNOWN;
+	wth->subtype_seek_time = NULL;
 	wth->subtype_sequential_close = NULL;
 	wth->subtype_close = NULL;
 	wth->file_tsprec = WTAP_TSPREC_USEC;
@@ -858,6 +894,20 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 
 		file_set_random_access(wth->fh, FALSE, wth->fast_seek);
 		file_set_random_access(wth->random_fh, TRUE, wth->fast_seek);
+
+		if (fast_seek_index_enabled) {
+			gchar *index_path = g_strdup_printf("%s" WTAP_FAST_SEEK_INDEX_SUFFIX, filename);
+
+			/*
+			 * If there's a valid index for this file, use it;
+			 * otherwise, remember where to save the one built
+			 * by the sequential pass.
+			 */
+			if (file_fast_seek_index_read(wth->random_fh, wth->fast_seek, index_path))
+				g_free(index_path);
+			else
+				wth->fast_seek_index_path = index_path;
+		}
 	}
 
 	/* 'type' is 1 greater than the array index */
@@ -2113,7 +2163,7 @@ wtap_dump_can_open(int file_type_subtype)
 	return TRUE;
 }
 
-#ifdef HAVE_ZLIB
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD) || defined(HAVE_LZ4)
 gboolean
 wtap_dump_can_compress(int file_type_subtype)
 {
@@ -2161,17 +2211,17 @@ wtap_dump_supports_comment_types(int file_type_subtype, guint32 comment_types)
 	return FALSE;
 }
 
-static gboolean wtap_dump_open_check(int file_type_subtype, int encap, gboolean comressed, int *err);
+static gboolean wtap_dump_open_check(int file_type_subtype, int encap, wtap_compression_type compression_type, int *err);
 static wtap_dumper* wtap_dump_alloc_wdh(int file_type_subtype, int encap, int snaplen,
-					gboolean compressed, int *err);
-static gboolean wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, gboolean compressed, int *err);
+					wtap_compression_type compression_type, int *err);
+static gboolean wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, wtap_compression_type compression_type, int *err);
 
 static WFILE_T wtap_dump_file_open(wtap_dumper *wdh, const char *filename);
 static WFILE_T wtap_dump_file_fdopen(wtap_dumper *wdh, int fd);
 static int wtap_dump_file_close(wtap_dumper *wdh);
 
 static wtap_dumper *
-wtap_dump_init_dumper(int file_type_subtype, int encap, int snaplen, gboolean compressed,
+wtap_dump_init_dumper(int file_type_subtype, int encap, int snaplen, wtap_compression_type compression_type,
                       GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
                       GArray* nrb_hdrs, int *err)
 {
@@ -2181,11 +2231,11 @@ wtap_dump_init_dumper(int file_type_subtype, int encap, int snaplen, gboolean co
 
 	/* Check whether we can open a capture file with that file type
 	   and that encapsulation. */
-	if (!wtap_dump_open_check(file_type_subtype, encap, compressed, err))
+	if (!wtap_dump_open_check(file_type_subtype, encap, compression_type, err))
 		return NULL;
 
 	/* Allocate a data structure for the output stream. */
-	wdh = wtap_dump_alloc_wdh(file_type_subtype, encap, snaplen, compressed, err);
+	wdh = wtap_dump_alloc_wdh(file_type_subtype, encap, snaplen, compression_type, err);
 	if (wdh == NULL)
 		return NULL;	/* couldn't allocate it */
 
@@ -2229,21 +2279,21 @@ wtap_dump_init_dumper(int file_type_subtype, int encap, int snaplen, gboolean co
 
 wtap_dumper *
 wtap_dump_open(const char *filename, int file_type_subtype, int encap,
-	       int snaplen, gboolean compressed, int *err)
+	       int snaplen, wtap_compression_type compression_type, int *err)
 {
-	return wtap_dump_open_ng(filename, file_type_subtype, encap,snaplen, compressed, NULL, NULL, NULL, err);
+	return wtap_dump_open_ng(filename, file_type_subtype, encap,snaplen, compression_type, NULL, NULL, NULL, err);
 }
 
 wtap_dumper *
 wtap_dump_open_ng(const char *filename, int file_type_subtype, int encap,
-		  int snaplen, gboolean compressed, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
+		  int snaplen, wtap_compression_type compression_type, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
 		  GArray* nrb_hdrs, int *err)
 {
 	wtap_dumper *wdh;
 	WFILE_T fh;
 
 	/* Allocate and initialize a data structure for the output stream. */
-	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compressed,
+	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compression_type,
 	    shb_hdrs, idb_inf, nrb_hdrs, err);
 	if (wdh == NULL)
 		return NULL;
@@ -2259,7 +2309,7 @@ wtap_dump_open_ng(const char *filename, int file_type_subtype, int encap,
 	}
 	wdh->fh = fh;
 
-	if (!wtap_dump_open_finish(wdh, file_type_subtype, compressed, err)) {
+	if (!wtap_dump_open_finish(wdh, file_type_subtype, compression_type, err)) {
 		/* Get rid of the file we created; we couldn't finish
 		   opening it. */
 		wtap_dump_file_close(wdh);
@@ -2273,15 +2323,15 @@ wtap_dump_open_ng(const char *filename, int file_type_subtype, int encap,
 wtap_dumper *
 wtap_dump_open_tempfile(char **filenamep, const char *pfx,
 			int file_type_subtype, int encap,
-			int snaplen, gboolean compressed, int *err)
+			int snaplen, wtap_compression_type compression_type, int *err)
 {
-	return wtap_dump_open_tempfile_ng(filenamep, pfx, file_type_subtype, encap,snaplen, compressed, NULL, NULL, NULL, err);
+	return wtap_dump_open_tempfile_ng(filenamep, pfx, file_type_subtype, encap,snaplen, compression_type, NULL, NULL, NULL, err);
 }
 
 wtap_dumper *
 wtap_dump_open_tempfile_ng(char **filenamep, const char *pfx,
 			   int file_type_subtype, int encap,
-			   int snaplen, gboolean compressed,
+			   int snaplen, wtap_compression_type compression_type,
 			   GArray* shb_hdrs,
 			   wtapng_iface_descriptions_t *idb_inf,
 			   GArray* nrb_hdrs, int *err)
@@ -2295,7 +2345,7 @@ wtap_dump_open_tempfile_ng(char **filenamep, const char *pfx,
 	*filenamep = NULL;
 
 	/* Allocate and initialize a data structure for the output stream. */
-	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compressed,
+	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compression_type,
 	    shb_hdrs, idb_inf, nrb_hdrs, err);
 	if (wdh == NULL)
 		return NULL;
@@ -2321,7 +2371,7 @@ wtap_dump_open_tempfile_ng(char **filenamep, const char *pfx,
 	}
 	wdh->fh = fh;
 
-	if (!wtap_dump_open_finish(wdh, file_type_subtype, compressed, err)) {
+	if (!wtap_dump_open_finish(wdh, file_type_subtype, compression_type, err)) {
 		/* Get rid of the file we created; we couldn't finish
 		   opening it. */
 		wtap_dump_file_close(wdh);
@@ -2334,21 +2384,21 @@ wtap_dump_open_tempfile_ng(char **filenamep, const char *pfx,
 
 wtap_dumper *
 wtap_dump_fdopen(int fd, int file_type_subtype, int encap, int snaplen,
-		 gboolean compressed, int *err)
+		 wtap_compression_type compression_type, int *err)
 {
-	return wtap_dump_fdopen_ng(fd, file_type_subtype, encap, snaplen, compressed, NULL, NULL, NULL, err);
+	return wtap_dump_fdopen_ng(fd, file_type_subtype, encap, snaplen, compression_type, NULL, NULL, NULL, err);
 }
 
 wtap_dumper *
 wtap_dump_fdopen_ng(int fd, int file_type_subtype, int encap, int snaplen,
-		    gboolean compressed, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
+		    wtap_compression_type compression_type, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
 		    GArray* nrb_hdrs, int *err)
 {
 	wtap_dumper *wdh;
 	WFILE_T fh;
 
 	/* Allocate and initialize a data structure for the output stream. */
-	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compressed,
+	wdh = wtap_dump_init_dumper(file_type_subtype, encap, snaplen, compression_type,
 	    shb_hdrs, idb_inf, nrb_hdrs, err);
 	if (wdh == NULL)
 		return NULL;
@@ -2364,7 +2414,7 @@ wtap_dump_fdopen_ng(int fd, int file_type_subtype, int encap, int snaplen,
 	}
 	wdh->fh = fh;
 
-	if (!wtap_dump_open_finish(wdh, file_type_subtype, compressed, err)) {
+	if (!wtap_dump_open_finish(wdh, file_type_subtype, compression_type, err)) {
 		wtap_dump_file_close(wdh);
 		g_free(wdh);
 		return NULL;
@@ -2374,14 +2424,14 @@ wtap_dump_fdopen_ng(int fd, int file_type_subtype, int encap, int snaplen,
 
 wtap_dumper *
 wtap_dump_open_stdout(int file_type_subtype, int encap, int snaplen,
-		      gboolean compressed, int *err)
+		      wtap_compression_type compression_type, int *err)
 {
-	return wtap_dump_open_stdout_ng(file_type_subtype, encap, snaplen, compressed, NULL, NULL, NULL, err);
+	return wtap_dump_open_stdout_ng(file_type_subtype, encap, snaplen, compression_type, NULL, NULL, NULL, err);
 }
 
 wtap_dumper *
 wtap_dump_open_stdout_ng(int file_type_subtype, int encap, int snaplen,
-			 gboolean compressed, GArray* shb_hdrs,
+			 wtap_compression_type compression_type, GArray* shb_hdrs,
 			 wtapng_iface_descriptions_t *idb_inf,
 			 GArray* nrb_hdrs, int *err)
 {
@@ -2416,7 +2466,7 @@ wtap_dump_open_stdout_ng(int file_type_subtype, int encap, int snaplen,
 #endif
 
 	wdh = wtap_dump_fdopen_ng(new_fd, file_type_subtype, encap, snaplen,
-	    compressed, shb_hdrs, idb_inf, nrb_hdrs, err);
+	    compression_type, shb_hdrs, idb_inf, nrb_hdrs, err);
 	if (wdh == NULL) {
 		/* Failed; close the new FD */
 		ws_close(new_fd);
@@ -2426,7 +2476,7 @@ wtap_dump_open_stdout_ng(int file_type_subtype, int encap, int snaplen,
 }
 
 static gboolean
-wtap_dump_open_check(int file_type_subtype, int encap, gboolean compressed, int *err)
+wtap_dump_open_check(int file_type_subtype, int encap, wtap_compression_type compression_type, int *err)
 {
 	if (!wtap_dump_can_open(file_type_subtype)) {
 		/* Invalid type, or type we don't know how to write. */
@@ -2450,7 +2500,9 @@ wtap_dump_open_check(int file_type_subtype, int encap, gboolean compressed, int
 		return FALSE;
 
 	/* if compression is wanted, do we support this for this file_type_subtype? */
-	if(compressed && !wtap_dump_can_compress(file_type_subtype)) {
+	if (compression_type != WTAP_UNCOMPRESSED &&
+	    (!wtap_dump_can_compress(file_type_subtype) ||
+	     !wtap_can_write_compression_type(compression_type))) {
 		*err = WTAP_ERR_COMPRESSION_NOT_SUPPORTED;
 		return FALSE;
 	}
@@ -2460,7 +2512,7 @@ wtap_dump_open_check(int file_type_subtype, int encap, gboolean compressed, int
 }
 
 static wtap_dumper *
-wtap_dump_alloc_wdh(int file_type_subtype, int encap, int snaplen, gboolean compressed, int *err)
+wtap_dump_alloc_wdh(int file_type_subtype, int encap, int snaplen, wtap_compression_type compression_type, int *err)
 {
 	wtap_dumper *wdh;
 
@@ -2473,20 +2525,20 @@ wtap_dump_alloc_wdh(int file_type_subtype, int encap, int snaplen, gboolean comp
 	wdh->file_type_subtype = file_type_subtype;
 	wdh->snaplen = snaplen;
 	wdh->encap = encap;
-	wdh->compressed = compressed;
+	wdh->compression_type = compression_type;
 	wdh->wslua_data = NULL;
 	return wdh;
 }
 
 static gboolean
-wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, gboolean compressed, int *err)
+wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, wtap_compression_type compression_type, int *err)
 {
 	int fd;
 	gboolean cant_seek;
 
 	/* Can we do a seek on the file descriptor?
 	   If not, note that fact. */
-	if(compressed) {
+	if (compression_type != WTAP_UNCOMPRESSED) {
 		cant_seek = TRUE;
 	} else {
 		fd = ws_fileno((FILE *)wdh->fh);
@@ -2528,16 +2580,247 @@ wtap_dump(wtap_dumper *wdh, const struct wtap_pkthdr *phdr,
 	return (wdh->subtype_write)(wdh, phdr, pd, err, err_info);
 }
 
+static gboolean wtap_dump_file_write_direct(wtap_dumper *wdh, const void *buf,
+    size_t bufsize, int *err);
+
+#if GLIB_CHECK_VERSION(2,32,0)
+/*
+ * Size of each of the two buffers of an asynchronous dumper.
+ */
+#define WTAP_DUMP_ASYNC_BUFSIZE	(4 * 1024 * 1024)
+
+/*
+ * State for a dumper whose output is written by a background thread.
+ *
+ * The caller copies data into buf[fill].  When that buffer is full,
+ * it's handed to the writer thread, and the caller goes on filling the
+ * other one.  While a buffer is in flight, only the writer thread
+ * touches wdh->fh.
+ */
+struct wtap_dump_async {
+	GThread		*thread;
+	GMutex		mutex;
+	GCond		cond;
+	guint8		*buf[2];
+	size_t		len[2];
+	int		fill;	/* buffer being filled by the caller */
+	gboolean	busy;	/* the other buffer is being written */
+	gboolean	quit;	/* writer thread should exit */
+	volatile gint	err;	/* first error seen by the writer thread */
+};
+
+static gpointer
+wtap_dump_async_thread(gpointer data)
+{
+	wtap_dumper *wdh = (wtap_dumper *)data;
+	struct wtap_dump_async *async = wdh->async;
+	int idx;
+	int err;
+
+	g_mutex_lock(&async->mutex);
+	for (;;) {
+		while (!async->busy && !async->quit)
+			g_cond_wait(&async->cond, &async->mutex);
+		if (!async->busy)
+			break;
+		idx = 1 - async->fill;
+		g_mutex_unlock(&async->mutex);
+
+		/*
+		 * Once something has failed, drop everything after it;
+		 * the error is reported to the caller.
+		 */
+		if (g_atomic_int_get(&async->err) == 0 &&
+		    !wtap_dump_file_write_direct(wdh, async->buf[idx],
+		        async->len[idx], &err))
+			g_atomic_int_set(&async->err, err);
+
+		g_mutex_lock(&async->mutex);
+		async->len[idx] = 0;
+		async->busy = FALSE;
+		g_cond_broadcast(&async->cond);
+	}
+	g_mutex_unlock(&async->mutex);
+	return NULL;
+}
+
+/*
+ * Wait until the writer thread is idle, then hand it the buffer being
+ * filled, if there's anything in it.
+ */
+static gboolean
+wtap_dump_async_submit(struct wtap_dump_async *async, int *err)
+{
+	g_mutex_lock(&async->mutex);
+	while (async->busy)
+		g_cond_wait(&async->cond, &async->mutex);
+	if (g_atomic_int_get(&async->err) != 0) {
+		*err = g_atomic_int_get(&async->err);
+		g_mutex_unlock(&async->mutex);
+		return FALSE;
+	}
+	if (async->len[async->fill] != 0) {
+		async->busy = TRUE;
+		async->fill = 1 - async->fill;
+		g_cond_broadcast(&async->cond);
+	}
+	g_mutex_unlock(&async->mutex);
+	return TRUE;
+}
+
+/*
+ * Write out everything that's been buffered and wait for it, so that
+ * the caller can use wdh->fh directly.
+ */
+static gboolean
+wtap_dump_async_drain(struct wtap_dump_async *async, int *err)
+{
+	if (!wtap_dump_async_submit(async, err))
+		return FALSE;
+	g_mutex_lock(&async->mutex);
+	while (async->busy)
+		g_cond_wait(&async->cond, &async->mutex);
+	g_mutex_unlock(&async->mutex);
+	if (g_atomic_int_get(&async->err) != 0) {
+		*err = g_atomic_int_get(&async->err);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+wtap_dump_async_write(struct wtap_dump_async *async, const void *buf,
+    size_t bufsize, int *err)
+{
+	const guint8 *p = (const guint8 *)buf;
+	size_t chunk;
+
+	/* Report an earlier failure of the writer thread. */
+	if (g_atomic_int_get(&async->err) != 0) {
+		*err = g_atomic_int_get(&async->err);
+		return FALSE;
+	}
+
+	while (bufsize != 0) {
+		chunk = WTAP_DUMP_ASYNC_BUFSIZE - async->len[async->fill];
+		if (chunk > bufsize)
+			chunk = bufsize;
+		memcpy(async->buf[async->fill] + async->len[async->fill], p, chunk);
+		async->len[async->fill] += chunk;
+		p += chunk;
+		bufsize -= chunk;
+		if (async->len[async->fill] == WTAP_DUMP_ASYNC_BUFSIZE) {
+			if (!wtap_dump_async_submit(async, err))
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static void
+wtap_dump_async_free(struct wtap_dump_async *async)
+{
+	g_mutex_clear(&async->mutex);
+	g_cond_clear(&async->cond);
+	g_free(async->buf[0]);
+	g_free(async->buf[1]);
+	g_free(async);
+}
+
+/*
+ * Write out what's left, stop the writer thread and go back to
+ * writing synchronously.
+ */
+static gboolean
+wtap_dump_async_stop(wtap_dumper *wdh, int *err)
+{
+	struct wtap_dump_async *async = wdh->async;
+	gboolean ret;
+
+	ret = wtap_dump_async_drain(async, err);
+
+	g_mutex_lock(&async->mutex);
+	async->quit = TRUE;
+	g_cond_broadcast(&async->cond);
+	g_mutex_unlock(&async->mutex);
+	g_thread_join(async->thread);
+
+	wtap_dump_async_free(async);
+	wdh->async = NULL;
+	return ret;
+}
+#endif /* GLIB_CHECK_VERSION(2,32,0) */
+
+gboolean
+wtap_dump_set_async(wtap_dumper *wdh)
+{
+#if GLIB_CHECK_VERSION(2,32,0)
+	struct wtap_dump_async *async;
+
+	if (wdh->async != NULL)
+		return TRUE;
+
+	async = g_new0(struct wtap_dump_async, 1);
+	g_mutex_init(&async->mutex);
+	g_cond_init(&async->cond);
+	async->buf[0] = (guint8 *)g_malloc(WTAP_DUMP_ASYNC_BUFSIZE);
+	async->buf[1] = (guint8 *)g_malloc(WTAP_DUMP_ASYNC_BUFSIZE);
+
+	wdh->async = async;
+	async->thread = g_thread_try_new("wtap_dump writer",
+	    wtap_dump_async_thread, wdh, NULL);
+	if (async->thread == NULL) {
+		wdh->async = NULL;
+		wtap_dump_async_free(async);
+		return FALSE;
+	}
+	return TRUE;
+#else
+	(void)wdh;
+	return FALSE;
+#endif
+}
+
+gboolean
+wtap_dump_set_frame_index(wtap_dumper *wdh, guint32 packets, guint32 msecs)
+{
+	if (wdh->file_type_subtype != WTAP_FILE_TYPE_SUBTYPE_PCAPNG)
+		return FALSE;
+	if (packets == 0 && msecs == 0)
+		return FALSE;
+	pcapng_dump_set_frame_index(wdh, packets, msecs);
+	return TRUE;
+}
+
 void
 wtap_dump_flush(wtap_dumper *wdh)
 {
+#if GLIB_CHECK_VERSION(2,32,0)
+	int err;
+
+	/*
+	 * If this fails, the error is kept and reported by the next
+	 * write or by the close.
+	 */
+	if (wdh->async != NULL && !wtap_dump_async_drain(wdh->async, &err))
+		return;
+#endif
+
+	switch (wdh->compression_type) {
 #ifdef HAVE_ZLIB
-	if(wdh->compressed) {
+	case WTAP_GZIP_COMPRESSED:
 		gzwfile_flush((GZWFILE_T)wdh->fh);
-	} else
+		break;
 #endif
-	{
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+	case WTAP_ZSTD_COMPRESSED:
+	case WTAP_LZ4_COMPRESSED:
+		framewfile_flush((FRAMEWFILE_T)wdh->fh);
+		break;
+#endif
+	default:
 		fflush((FILE *)wdh->fh);
+		break;
 	}
 }
 
@@ -2551,6 +2834,17 @@ wtap_dump_close(wtap_dumper *wdh, int *err)
 		if (!(wdh->subtype_finish)(wdh, err))
 			ret = FALSE;
 	}
+#if GLIB_CHECK_VERSION(2,32,0)
+	if (wdh->async != NULL) {
+		int async_err;
+
+		if (!wtap_dump_async_stop(wdh, &async_err)) {
+			if (ret && err != NULL)
+				*err = async_err;
+			ret = FALSE;
+		}
+	}
+#endif
 	errno = WTAP_ERR_CANT_CLOSE;
 	if (wtap_dump_file_close(wdh) == EOF) {
 		if (ret) {
@@ -2592,51 +2886,62 @@ wtap_dump_set_addrinfo_list(wtap_dumper *wdh, addrinfo_lists_t *addrinfo_lists)
 }
 
 /* internally open a file for writing (compressed or not) */
-#ifdef HAVE_ZLIB
 static WFILE_T
 wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 {
-	if(wdh->compressed) {
+	switch (wdh->compression_type) {
+#ifdef HAVE_ZLIB
+	case WTAP_GZIP_COMPRESSED:
 		return gzwfile_open(filename);
-	} else {
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+	case WTAP_ZSTD_COMPRESSED:
+	case WTAP_LZ4_COMPRESSED:
+		return framewfile_open(filename, wdh->compression_type);
+#endif
+	default:
 		return ws_fopen(filename, "wb");
 	}
 }
-#else
-static WFILE_T
-wtap_dump_file_open(wtap_dumper *wdh _U_, const char *filename)
-{
-	return ws_fopen(filename, "wb");
-}
-#endif
 
 /* internally open a file for writing (compressed or not) */
-#ifdef HAVE_ZLIB
 static WFILE_T
 wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 {
-	if(wdh->compressed) {
+	switch (wdh->compression_type) {
+#ifdef HAVE_ZLIB
+	case WTAP_GZIP_COMPRESSED:
 		return gzwfile_fdopen(fd);
-	} else {
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+	case WTAP_ZSTD_COMPRESSED:
+	case WTAP_LZ4_COMPRESSED:
+		return framewfile_fdopen(fd, wdh->compression_type);
+#endif
+	default:
 		return ws_fdopen(fd, "wb");
 	}
 }
-#else
-static WFILE_T
-wtap_dump_file_fdopen(wtap_dumper *wdh _U_, int fd)
-{
-	return ws_fdopen(fd, "wb");
-}
-#endif
 
 /* internally writing raw bytes (compressed or not) */
 gboolean
 wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err)
+{
+#if GLIB_CHECK_VERSION(2,32,0)
+	if (wdh->async != NULL)
+		return wtap_dump_async_write(wdh->async, buf, bufsize, err);
+#endif
+	return wtap_dump_file_write_direct(wdh, buf, bufsize, err);
+}
+
+/* write raw bytes to the file (compressed or not), bypassing any background writer */
+static gboolean
+wtap_dump_file_write_direct(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err)
 {
 	size_t nwritten;
 
 #ifdef HAVE_ZLIB
-	if (wdh->compressed) {
+	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
 		nwritten = gzwfile_write((GZWFILE_T)wdh->fh, buf, (unsigned int) bufsize);
 		/*
 		 * gzwfile_write() returns 0 on error.
@@ -2646,6 +2951,19 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 			return FALSE;
 		}
 	} else
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+	if (wdh->compression_type == WTAP_ZSTD_COMPRESSED ||
+	    wdh->compression_type == WTAP_LZ4_COMPRESSED) {
+		nwritten = framewfile_write((FRAMEWFILE_T)wdh->fh, buf, (unsigned int) bufsize);
+		/*
+		 * framewfile_write() returns 0 on error.
+		 */
+		if (nwritten == 0) {
+			*err = framewfile_geterr((FRAMEWFILE_T)wdh->fh);
+			return FALSE;
+		}
+	} else
 #endif
 	{
 		errno = WTAP_ERR_CANT_WRITE;
@@ -2669,23 +2987,33 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 static int
 wtap_dump_file_close(wtap_dumper *wdh)
 {
+	switch (wdh->compression_type) {
 #ifdef HAVE_ZLIB
-	if(wdh->compressed)
+	case WTAP_GZIP_COMPRESSED:
 		return gzwfile_close((GZWFILE_T)wdh->fh);
-	else
 #endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+	case WTAP_ZSTD_COMPRESSED:
+	case WTAP_LZ4_COMPRESSED:
+		return framewfile_close((FRAMEWFILE_T)wdh->fh);
+#endif
+	default:
 		return fclose((FILE *)wdh->fh);
+	}
 }
 
 gint64
 wtap_dump_file_seek(wtap_dumper *wdh, gint64 offset, int whence, int *err)
 {
-#ifdef HAVE_ZLIB
-	if(wdh->compressed) {
+#if GLIB_CHECK_VERSION(2,32,0)
+	/* Get everything written so far into the file before moving. */
+	if (wdh->async != NULL && !wtap_dump_async_drain(wdh->async, err))
+		return -1;
+#endif
+	if (wdh->compression_type != WTAP_UNCOMPRESSED) {
 		*err = WTAP_ERR_CANT_SEEK_COMPRESSED;
 		return -1;
 	} else
-#endif
 	{
 		if (-1 == fseek((FILE *)wdh->fh, (long)offset, whence)) {
 			*err = errno;
@@ -2701,12 +3029,15 @@ gint64
 wtap_dump_file_tell(wtap_dumper *wdh, int *err)
 {
 	gint64 rval;
-#ifdef HAVE_ZLIB
-	if(wdh->compressed) {
+
+#if GLIB_CHECK_VERSION(2,32,0)
+	if (wdh->async != NULL && !wtap_dump_async_drain(wdh->async, err))
+		return -1;
+#endif
+	if (wdh->compression_type != WTAP_UNCOMPRESSED) {
 		*err = WTAP_ERR_CANT_SEEK_COMPRESSED;
 		return -1;
 	} else
-#endif
 	{
 		if (-1 == (rval = ftell((FILE *)wdh->fh))) {
 			*err = errno;
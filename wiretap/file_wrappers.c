@@ -52,9 +52,22 @@
 #include <zlib.h>
 #endif /* HAVE_ZLIB */
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#include <lz4frame.h>
+#endif /* HAVE_LZ4 */
+
 /*
  * See RFC 1952 for a description of the gzip file format.
  *
+ * See RFC 8478 for a description of the Zstandard file format, and
+ * https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md for
+ * a description of the LZ4 frame format.
+ *
  * Some other compressed file formats we might want to support:
  *
  *      XZ format: http://tukaani.org/xz/
@@ -71,23 +84,138 @@
 const char *compressed_file_extension_table[] = {
 #ifdef HAVE_ZLIB
     "gz",
+#endif
+#ifdef HAVE_ZSTD
+    "zst",
+#endif
+#ifdef HAVE_LZ4
+    "lz4",
 #endif
     NULL
 };
 
+/*
+ * Compression types we can write, with their names and extensions.
+ */
+static const struct compression_type {
+    wtap_compression_type type;
+    const char *extension;
+    const char *name;
+    const char *description;
+} compression_types[] = {
+#ifdef HAVE_ZLIB
+    { WTAP_GZIP_COMPRESSED, "gz", "gzip", "gzip compressed" },
+#endif
+#ifdef HAVE_ZSTD
+    { WTAP_ZSTD_COMPRESSED, "zst", "zstd", "zstd compressed (seekable)" },
+#endif
+#ifdef HAVE_LZ4
+    { WTAP_LZ4_COMPRESSED, "lz4", "lz4", "lz4 compressed" },
+#endif
+    { WTAP_UNCOMPRESSED, NULL, "none", "uncompressed" }
+};
+
+wtap_compression_type
+wtap_name_to_compression_type(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < G_N_ELEMENTS(compression_types); i++) {
+        if (g_ascii_strcasecmp(name, compression_types[i].name) == 0)
+            return compression_types[i].type;
+    }
+    return WTAP_UNKNOWN_COMPRESSION;
+}
+
+const char *
+wtap_compression_type_name(wtap_compression_type compression_type)
+{
+    size_t i;
+
+    for (i = 0; i < G_N_ELEMENTS(compression_types); i++) {
+        if (compression_types[i].type == compression_type)
+            return compression_types[i].name;
+    }
+    return NULL;
+}
+
+const char *
+wtap_compression_type_description(wtap_compression_type compression_type)
+{
+    size_t i;
+
+    for (i = 0; i < G_N_ELEMENTS(compression_types); i++) {
+        if (compression_types[i].type == compression_type)
+            return compression_types[i].description;
+    }
+    return NULL;
+}
+
+const char *
+wtap_compression_type_extension(wtap_compression_type compression_type)
+{
+    size_t i;
+
+    for (i = 0; i < G_N_ELEMENTS(compression_types); i++) {
+        if (compression_types[i].type == compression_type)
+            return compression_types[i].extension;
+    }
+    return NULL;
+}
+
+gboolean
+wtap_can_write_compression_type(wtap_compression_type compression_type)
+{
+    return wtap_compression_type_name(compression_type) != NULL;
+}
+
+GSList *
+wtap_get_all_compression_type_names_list(void)
+{
+    GSList *names = NULL;
+    size_t i;
+
+    for (i = 0; i < G_N_ELEMENTS(compression_types); i++)
+        names = g_slist_append(names, (gpointer)compression_types[i].name);
+    return names;
+}
+
 /* #define GZBUFSIZE 8192 */
 #define GZBUFSIZE 4096
 
+/* Default and largest buffer sizes for FILE_READ_SEQUENTIAL */
+#define SEQUENTIAL_BUFSIZE      (1024 * 1024)
+#define SEQUENTIAL_BUFSIZE_MAX  (64 * 1024 * 1024)
+
+/* How far ahead of a FILE_READ_SEQUENTIAL reader, in buffers, to ask the
+   OS to read */
+#define SEQUENTIAL_READAHEAD_BUFFERS 4
+
 /* values for wtap_reader compression */
 typedef enum {
     UNKNOWN,       /* unknown - look for a gzip header */
     UNCOMPRESSED,  /* uncompressed - copy input directly */
 #ifdef HAVE_ZLIB
     ZLIB,          /* decompress a zlib stream */
-    GZIP_AFTER_HEADER
+    GZIP_AFTER_HEADER,
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD,          /* decompress a zstd frame */
+#endif
+#ifdef HAVE_LZ4
+    LZ4,           /* decompress an lz4 frame */
 #endif
 } compression_t;
 
+/*
+ * Magic numbers of zstd and lz4 frames, and of the skippable frames
+ * shared by both formats, as they appear (little-endian) in the file.
+ */
+#define ZSTD_FRAME_MAGIC        0xFD2FB528U
+#define LZ4_FRAME_MAGIC         0x184D2204U
+#define SKIPPABLE_FRAME_MAGIC   0x184D2A50U
+#define SKIPPABLE_FRAME_MASK    0xFFFFFFF0U
+
 struct wtap_reader {
     int fd;                    /* file descriptor */
     gint64 raw_pos;            /* current position in file (just to not call lseek()) */
@@ -116,17 +244,55 @@ struct wtap_reader {
     /* zlib inflate stream */
     z_stream strm;             /* stream structure in-place (not a pointer) */
     gboolean dont_check_crc;   /* TRUE if we aren't supposed to check the CRC */
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zstd_dctx;   /* zstd decompression stream, or NULL */
+#endif
+#ifdef HAVE_LZ4
+    LZ4F_dctx *lz4_dctx;       /* lz4 frame decompression context, or NULL */
 #endif
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+    /* read policy */
+    file_read_policy_e read_policy;
+    guint readahead;           /* bytes to have the OS read ahead of raw_pos, or 0 */
+    gint64 readahead_pos;      /* end of the range last handed to the OS to read ahead */
 };
 
+#ifdef HAVE_POSIX_FADVISE
+/* Keep the OS reading ahead of a sequential reader, so that on a
+   high-latency file system the next buffer is usually already on its
+   way by the time we ask for it; POSIX_FADV_WILLNEED starts the reads
+   without blocking, so we don't need a thread of our own for this. */
+static void
+raw_readahead(FILE_T state, unsigned int count)
+{
+    gint64 end = state->raw_pos + count;
+    gint64 ahead = state->readahead_pos - end;
+    gint64 from;
+
+    /* Only ask again once we've used up half of the range, or if we've
+       seeked out of it. */
+    if (ahead >= (gint64)(state->readahead / 2) && ahead <= (gint64)state->readahead)
+        return;
+    from = (ahead > 0 && ahead <= (gint64)state->readahead) ? state->readahead_pos : end;
+    state->readahead_pos = end + state->readahead;
+    (void)posix_fadvise(state->fd, (off_t)from, (off_t)(state->readahead_pos - from),
+                        POSIX_FADV_WILLNEED);
+}
+#endif
+
 static int     /* gz_load */
 raw_read(FILE_T state, unsigned char *buf, unsigned int count, guint *have)
 {
     ssize_t ret;
 
+#ifdef HAVE_POSIX_FADVISE
+    if (state->readahead != 0)
+        raw_readahead(state, count);
+#endif
+
     *have = 0;
     do {
         ret = ws_read(state->fd, buf + *have, count - *have);
@@ -158,6 +324,54 @@ fill_in_buffer(FILE_T state)
     return 0;
 }
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+/* Make sure at least n bytes are available at next_in, unless the end
+   of the file comes first; n must not be larger than the input buffer.
+   Return -1 on error, 0 otherwise. */
+static int
+fill_in_buffer_min(FILE_T state, guint n)
+{
+    guint got;
+
+    while (state->avail_in < n && !state->eof) {
+        if (state->err)
+            return -1;
+        if (state->avail_in != 0)
+            memmove(state->in, state->next_in, state->avail_in);
+        state->next_in = state->in;
+        if (raw_read(state, state->in + state->avail_in,
+                     state->size - state->avail_in, &got) == -1)
+            return -1;
+        state->avail_in += got;
+    }
+    return 0;
+}
+
+/* Skip n bytes of input.  Return -1 on error or premature EOF, 0
+   otherwise. */
+static int
+raw_skip(FILE_T state, guint32 n)
+{
+    guint chunk;
+
+    while (n != 0) {
+        if (state->avail_in == 0 && fill_in_buffer(state) == -1)
+            return -1;
+        if (state->avail_in == 0) {
+            /* EOF */
+            state->err = WTAP_ERR_SHORT_READ;
+            state->err_info = NULL;
+            return -1;
+        }
+        chunk = state->avail_in > n ? n : state->avail_in;
+        state->avail_in -= chunk;
+        state->next_in += chunk;
+        n -= chunk;
+    }
+    return 0;
+}
+#endif
+
 #define ZLIB_WINSIZE 32768
 
 struct fast_seek_point {
@@ -231,6 +445,23 @@ fast_seek_header(FILE_T file, gint64 in_pos, gint64 out_pos,
     }
 }
 
+/* Is this seek point at the start of a frame that can be decompressed
+   independently of what precedes it? */
+static gboolean
+fast_seek_is_frame_start(compression_t compression)
+{
+#ifdef HAVE_ZSTD
+    if (compression == ZSTD)
+        return TRUE;
+#endif
+#ifdef HAVE_LZ4
+    if (compression == LZ4)
+        return TRUE;
+#endif
+    (void)compression;
+    return FALSE;
+}
+
 static void
 fast_seek_reset(
 #ifdef HAVE_ZLIB
@@ -560,6 +791,179 @@ DIAG_ON(cast-qual)
 }
 #endif
 
+#ifdef HAVE_ZSTD
+static void
+zstd_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    ZSTD_outBuffer output;
+    ZSTD_inBuffer input;
+    size_t ret, prev_pos;
+
+    output.dst = buf;
+    output.size = count;
+    output.pos = 0;
+
+    /* fill output buffer up to end of zstd frame or error */
+    do {
+        /* get more input for ZSTD_decompressStream() */
+        if (state->avail_in == 0 && fill_in_buffer(state) == -1)
+            break;
+
+        input.src = state->next_in;
+        input.size = state->avail_in;
+        input.pos = 0;
+        prev_pos = output.pos;
+        ret = ZSTD_decompressStream(state->zstd_dctx, &output, &input);
+        state->next_in += input.pos;
+        state->avail_in -= (guint)input.pos;
+        if (ZSTD_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = ZSTD_getErrorName(ret);
+            break;
+        }
+        if (ret == 0) {
+            /* end of frame; look for another one, once have is 0 */
+            state->compression = UNKNOWN;
+            break;
+        }
+        if (state->eof && state->avail_in == 0 && input.pos == 0 &&
+            output.pos == prev_pos) {
+            /* EOF in the middle of a frame */
+            state->err = WTAP_ERR_SHORT_READ;
+            state->err_info = NULL;
+            break;
+        }
+    } while (output.pos < output.size);
+
+    state->next = buf;
+    state->have = (guint)output.pos;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static void
+lz4_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    size_t ret, src_size, dst_size;
+    guint have = 0;
+
+    /* fill output buffer up to end of lz4 frame or error */
+    do {
+        /* get more input for LZ4F_decompress() */
+        if (state->avail_in == 0 && fill_in_buffer(state) == -1)
+            break;
+
+        src_size = state->avail_in;
+        dst_size = count - have;
+        ret = LZ4F_decompress(state->lz4_dctx, buf + have, &dst_size,
+                              state->next_in, &src_size, NULL);
+        state->next_in += src_size;
+        state->avail_in -= (guint)src_size;
+        have += (guint)dst_size;
+        if (LZ4F_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = LZ4F_getErrorName(ret);
+            break;
+        }
+        if (ret == 0) {
+            /* end of frame; look for another one, once have is 0 */
+            state->compression = UNKNOWN;
+            break;
+        }
+        if (state->eof && state->avail_in == 0 && src_size == 0 &&
+            dst_size == 0) {
+            /* EOF in the middle of a frame */
+            state->err = WTAP_ERR_SHORT_READ;
+            state->err_info = NULL;
+            break;
+        }
+    } while (have < count);
+
+    state->next = buf;
+    state->have = have;
+}
+#endif
+
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+/* Look for a zstd or lz4 frame, or a skippable frame following one, at
+   the current input position.  Return 1 if one was found and set up for
+   decompression or skipped, 0 if not, and -1 on error. */
+static int
+frame_head(FILE_T state)
+{
+    guint32 magic, skip;
+
+    if (fill_in_buffer_min(state, 8) == -1)
+        return -1;
+    if (state->avail_in < 4)
+        return 0;
+
+    magic = pletoh32(state->next_in);
+#ifdef HAVE_ZSTD
+    if (magic == ZSTD_FRAME_MAGIC) {
+        if (state->zstd_dctx == NULL) {
+            state->zstd_dctx = ZSTD_createDStream();
+            if (state->zstd_dctx == NULL) {
+                state->err = ENOMEM;
+                state->err_info = NULL;
+                return -1;
+            }
+        }
+        ZSTD_initDStream(state->zstd_dctx);
+        if (state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->avail_in, state->pos, ZSTD);
+        state->compression = ZSTD;
+        state->is_compressed = TRUE;
+        return 1;
+    }
+#endif
+#ifdef HAVE_LZ4
+    if (magic == LZ4_FRAME_MAGIC) {
+#if LZ4_VERSION_NUMBER >= 10800
+        if (state->lz4_dctx != NULL)
+            LZ4F_resetDecompressionContext(state->lz4_dctx);
+#else
+        /* No way to reset the context after an interrupted frame;
+           start over with a new one. */
+        if (state->lz4_dctx != NULL) {
+            LZ4F_freeDecompressionContext(state->lz4_dctx);
+            state->lz4_dctx = NULL;
+        }
+#endif
+        if (state->lz4_dctx == NULL &&
+            LZ4F_isError(LZ4F_createDecompressionContext(&state->lz4_dctx, LZ4F_VERSION))) {
+            state->lz4_dctx = NULL;
+            state->err = ENOMEM;
+            state->err_info = NULL;
+            return -1;
+        }
+        if (state->fast_seek)
+            fast_seek_header(state, state->raw_pos - state->avail_in, state->pos, LZ4);
+        state->compression = LZ4;
+        state->is_compressed = TRUE;
+        return 1;
+    }
+#endif
+    if (state->is_compressed &&
+        (magic & SKIPPABLE_FRAME_MASK) == SKIPPABLE_FRAME_MAGIC) {
+        /* Skippable frame, such as a seek table, after compressed
+           frames; it contributes no data. */
+        if (state->avail_in < 8) {
+            state->err = WTAP_ERR_SHORT_READ;
+            state->err_info = NULL;
+            return -1;
+        }
+        skip = pletoh32(state->next_in + 4);
+        state->next_in += 8;
+        state->avail_in -= 8;
+        if (raw_skip(state, skip) == -1)
+            return -1;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 static int
 gz_head(FILE_T state)
 {
@@ -571,6 +975,24 @@ gz_head(FILE_T state)
             return 0;
     }
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    /* look for zstd or lz4 frames */
+    switch (frame_head(state)) {
+
+    case -1:
+        return -1;
+
+    case 1:
+        /* Either set up to decompress a frame, or skipped a frame
+           and need to look at what follows it. */
+        if (state->compression == UNKNOWN)
+            return gz_head(state);
+        return 0;
+    }
+    if (state->avail_in == 0)
+        return 0;
+#endif
+
     /* look for the gzip magic header bytes 31 and 139 */
 #ifdef HAVE_ZLIB
     if (state->next_in[0] == 31) {
@@ -709,6 +1131,23 @@ fill_out_buffer(FILE_T state)
     else if (state->compression == ZLIB) {      /* decompress */
         zlib_read(state, state->out, state->size << 1);
     }
+#endif
+#ifdef HAVE_ZSTD
+    else if (state->compression == ZSTD) {      /* decompress */
+        zstd_read(state, state->out, state->size << 1);
+    }
+#endif
+#ifdef HAVE_LZ4
+    else if (state->compression == LZ4) {       /* decompress */
+        lz4_read(state, state->out, state->size << 1);
+    }
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    /* A frame can end without delivering anything more; callers take
+       an empty buffer to mean EOF, so go on to the next frame. */
+    if (state->have == 0 && state->compression == UNKNOWN && !state->err &&
+        !(state->eof && state->avail_in == 0))
+        return fill_out_buffer(state);
 #endif
     return 0;
 }
@@ -782,6 +1221,15 @@ file_fdopen(int fd)
 
     state->fast_seek_cur = NULL;
     state->fast_seek = NULL;
+    state->read_policy = FILE_READ_DEFAULT;
+    state->readahead = 0;
+    state->readahead_pos = 0;
+#ifdef HAVE_ZSTD
+    state->zstd_dctx = NULL;
+#endif
+#ifdef HAVE_LZ4
+    state->lz4_dctx = NULL;
+#endif
 
     /* open the file with the appropriate mode (or just use fd) */
     state->fd = fd;
@@ -898,86 +1346,517 @@ file_open(const char *path)
     return ft;
 }
 
-void
-file_set_random_access(FILE_T stream, gboolean random_flag _U_, GPtrArray *seek)
-{
-    stream->fast_seek = seek;
-}
-
-gint64
-file_seek(FILE_T file, gint64 offset, int whence, int *err)
-{
-    struct fast_seek_point *here;
-    guint n;
+#ifdef HAVE_ZSTD
+/*
+ * zstd "seekable format", as written by zstd's contrib/seekable_format
+ * and by framewfile_close(): a skippable frame at the end of the file
+ * holding the compressed and decompressed size of every frame, and
+ * ending with a 9-byte footer.
+ */
+#define ZSTD_SEEKABLE_SKIPPABLE_MAGIC   0x184D2A5EU
+#define ZSTD_SEEKABLE_FOOTER_MAGIC      0x8F92EAB1U
+#define ZSTD_SEEKABLE_FOOTER_SIZE       9
+#define ZSTD_SEEKABLE_CHECKSUM_FLAG     0x80
 
-    if (whence != SEEK_SET && whence != SEEK_CUR && whence != SEEK_END) {
-        g_assert_not_reached();
 /*
- *err = EINVAL;
- return -1;
-*/
-    }
+ * If this is a seekable zstd file, add a fast seek point for the start
+ * of every frame from its seek table, so random access works without
+ * decompressing the file first.
+ */
+static void
+zstd_seek_table_load(FILE_T stream, GPtrArray *seek)
+{
+    ws_statb64 statb;
+    guint8 buf[ZSTD_SEEKABLE_FOOTER_SIZE];
+    guint8 *table = NULL;
+    guint32 nframes, entry_size, i;
+    gint64 table_size, c_off, d_off;
+    struct fast_seek_point *val;
+
+    if (ws_fstat64(stream->fd, &statb) == -1 ||
+        statb.st_size < 4 + 8 + ZSTD_SEEKABLE_FOOTER_SIZE)
+        return;
 
-    /* Normalize offset to a SEEK_CUR specification */
-    if (whence == SEEK_END) {
-        /* Try skip until end-of-file */
-        if (gz_skip(file, G_MAXINT64) == -1) {
-            *err = file->err;
-            return -1;
-        }
-        if (offset == 0) {
-            /* We are done */
-            return file->pos;
-        }
-    } else if (whence == SEEK_SET)
-        offset -= file->pos;
-    else if (file->seek_pending)
-        offset += file->skip;
-    file->seek_pending = FALSE;
+    /* is this a zstd file at all? */
+    if (ws_lseek64(stream->fd, stream->start, SEEK_SET) == -1 ||
+        ws_read(stream->fd, buf, 4) != 4 || pletoh32(buf) != ZSTD_FRAME_MAGIC)
+        goto done;
+
+    /* look for the seek table footer */
+    if (ws_lseek64(stream->fd, -ZSTD_SEEKABLE_FOOTER_SIZE, SEEK_END) == -1 ||
+        ws_read(stream->fd, buf, ZSTD_SEEKABLE_FOOTER_SIZE) != ZSTD_SEEKABLE_FOOTER_SIZE ||
+        pletoh32(&buf[5]) != ZSTD_SEEKABLE_FOOTER_MAGIC)
+        goto done;
+    nframes = pletoh32(&buf[0]);
+    entry_size = (buf[4] & ZSTD_SEEKABLE_CHECKSUM_FLAG) ? 12 : 8;
+    table_size = (gint64)nframes * entry_size;
+    if (nframes == 0 ||
+        table_size + 8 + ZSTD_SEEKABLE_FOOTER_SIZE > statb.st_size - stream->start)
+        goto done;
+
+    /* read the skippable frame header and the entries */
+    table = (guint8 *)g_try_malloc((gsize)table_size + 8);
+    if (table == NULL ||
+        ws_lseek64(stream->fd, -(table_size + 8 + ZSTD_SEEKABLE_FOOTER_SIZE), SEEK_END) == -1 ||
+        ws_read(stream->fd, table, (unsigned int)table_size + 8) != table_size + 8 ||
+        pletoh32(&table[0]) != ZSTD_SEEKABLE_SKIPPABLE_MAGIC ||
+        pletoh32(&table[4]) != table_size + ZSTD_SEEKABLE_FOOTER_SIZE)
+        goto done;
 
     /*
-     * Are we seeking backwards and, if so, do we have data in the buffer?
+     * Every frame holds at least a frame header and some data; a table
+     * with an empty frame in it would have two seek points at the same
+     * offset, so don't trust it.
      */
-    if (offset < 0 && file->next) {
-        /*
-         * Yes.
-         *
-         * This is guaranteed to fit in an unsigned int.
-         * To squelch compiler warnings, we cast the
-         * result.
-         */
-        guint had = (unsigned)(file->next - file->out);
+    for (i = 0; i < nframes; i++) {
+        const guint8 *entry = &table[8 + i * entry_size];
 
-        /*
-         * Do we have enough data before the current position in
-         * the buffer that we can seek backwards within the buffer?
-         */
-        if (-offset <= had) {
-            /*
-             * Yes.
-             *
-             * Offset is negative, so -offset is
-             * non-negative, and -offset is
-             * <= an unsigned and thus fits in an
-             * unsigned.  Get that value and
-             * adjust appropriately.
-             *
-             * (Casting offset to unsigned makes
-             * it positive, which is not what we
-             * would want, so we cast -offset
-             * instead.)
-             */
-            guint adjustment = (unsigned)(-offset);
-            file->have += adjustment;
-            file->next -= adjustment;
-            file->pos -= adjustment;
-            return file->pos;
-        }
+        if (pletoh32(&entry[0]) == 0 || pletoh32(&entry[4]) == 0)
+            goto done;
     }
 
-    /*
-     * No.  Do we have "fast seek" data for the location to which we
-     * will be seeking?
+    c_off = stream->start;
+    d_off = 0;
+    for (i = 0; i < nframes; i++) {
+        const guint8 *entry = &table[8 + i * entry_size];
+
+        val = g_new(struct fast_seek_point, 1);
+        val->in = c_off;
+        val->out = d_off;
+        val->compression = ZSTD;
+        g_ptr_array_add(seek, val);
+
+        c_off += pletoh32(&entry[0]);
+        d_off += pletoh32(&entry[4]);
+    }
+
+done:
+    g_free(table);
+    /* put the file back where we found it */
+    ws_lseek64(stream->fd, stream->raw_pos, SEEK_SET);
+}
+#endif
+
+#ifdef HAVE_POSIX_FADVISE
+static void
+file_advise_read_policy(FILE_T stream)
+{
+    switch (stream->read_policy) {
+
+    case FILE_READ_SEQUENTIAL:
+        (void)posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        break;
+
+    case FILE_READ_RANDOM:
+        (void)posix_fadvise(stream->fd, 0, 0, POSIX_FADV_RANDOM);
+        break;
+
+    default:
+        break;
+    }
+}
+#endif
+
+/*
+ * Set how a stream will be read; must be called before anything has
+ * been read from it.
+ *
+ * FILE_READ_SEQUENTIAL replaces the GZBUFSIZE or st_blksize sized
+ * buffers with buffer_size byte ones (SEQUENTIAL_BUFSIZE if 0), tells
+ * the OS that the file will be read sequentially and keeps it reading
+ * ahead of us.  FILE_READ_RANDOM keeps the small buffers, as reads of
+ * single records shouldn't drag in megabytes around them, and tells the
+ * OS not to read ahead.
+ *
+ * Returns FALSE if the new buffers couldn't be allocated, in which case
+ * the stream is left as it was.
+ */
+gboolean
+file_set_read_policy(FILE_T stream, file_read_policy_e policy, guint buffer_size)
+{
+    unsigned char *in, *out;
+
+    g_assert(stream->pos == 0 && stream->have == 0 && stream->avail_in == 0);
+
+    if (policy == FILE_READ_SEQUENTIAL) {
+        if (buffer_size == 0)
+            buffer_size = SEQUENTIAL_BUFSIZE;
+        else if (buffer_size > SEQUENTIAL_BUFSIZE_MAX)
+            buffer_size = SEQUENTIAL_BUFSIZE_MAX;
+        if (buffer_size > stream->size) {
+            in = (unsigned char *)g_try_malloc((gsize)buffer_size);
+            out = (unsigned char *)g_try_malloc(((gsize)buffer_size) << 1);
+            if (in == NULL || out == NULL) {
+                g_free(out);
+                g_free(in);
+                return FALSE;
+            }
+            g_free(stream->out);
+            g_free(stream->in);
+            stream->in = in;
+            stream->out = out;
+            stream->size = buffer_size;
+        }
+        stream->readahead = stream->size * SEQUENTIAL_READAHEAD_BUFFERS;
+    } else {
+        stream->readahead = 0;
+    }
+    stream->readahead_pos = 0;
+    stream->read_policy = policy;
+#ifdef HAVE_POSIX_FADVISE
+    file_advise_read_policy(stream);
+#endif
+    return TRUE;
+}
+
+void
+file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek)
+{
+    stream->fast_seek = seek;
+#ifdef HAVE_ZSTD
+    if (random_flag && seek != NULL && seek->len == 0)
+        zstd_seek_table_load(stream, seek);
+#else
+    (void)random_flag;
+#endif
+}
+
+/*
+ * Fast seek index sidecar files.
+ *
+ * Building the fast seek points for a compressed file requires
+ * decompressing all of it; to avoid doing that every time the file is
+ * opened, the points, including the 32K inflate windows, can be saved
+ * to a sidecar file and loaded again on the next open.
+ *
+ * The sidecar file starts with a header:
+ *
+ *      magic           8 bytes ("WSFSIDX\0")
+ *      version         4 bytes
+ *      point count     4 bytes
+ *      capture size    8 bytes (size of the capture file it indexes)
+ *      capture mtime   8 bytes (modification time of that file)
+ *
+ * followed by one record per seek point:
+ *
+ *      out             8 bytes
+ *      in              8 bytes
+ *      compression     1 byte
+ *      bits            1 byte
+ *      reserved        2 bytes
+ *      adler           4 bytes
+ *      total_out       4 bytes
+ *      window          32768 bytes, present only for FSIDX_ZLIB points
+ *
+ * All integers are big-endian.  The index is only used if the size
+ * and modification time of the capture file still match.
+ */
+static const guint8 fsidx_magic[8] = { 'W', 'S', 'F', 'S', 'I', 'D', 'X', '\0' };
+#define FSIDX_VERSION           1
+#define FSIDX_HDR_SIZE          32
+#define FSIDX_REC_SIZE          28
+
+/* on-disk compression codes */
+#define FSIDX_UNCOMPRESSED      0
+#define FSIDX_ZLIB              1
+#define FSIDX_GZIP_AFTER_HEADER 2
+#define FSIDX_ZSTD              3
+#define FSIDX_LZ4               4
+
+gboolean
+file_fast_seek_index_read(FILE_T stream, GPtrArray *seek, const char *path)
+{
+    FILE *fp;
+    ws_statb64 statb, idx_statb;
+    guint8 hdr[FSIDX_HDR_SIZE];
+    guint8 rec[FSIDX_REC_SIZE];
+    guint32 count, i;
+    struct fast_seek_point *val;
+    GPtrArray *points;
+
+    if (seek == NULL || seek->len != 0)
+        return FALSE;
+    if (ws_fstat64(stream->fd, &statb) == -1)
+        return FALSE;
+
+    fp = ws_fopen(path, "rb");
+    if (fp == NULL)
+        return FALSE;
+
+    if (fread(hdr, 1, sizeof hdr, fp) != sizeof hdr ||
+        memcmp(hdr, fsidx_magic, sizeof fsidx_magic) != 0 ||
+        pntoh32(&hdr[8]) != FSIDX_VERSION ||
+        pntoh64(&hdr[16]) != (guint64)statb.st_size ||
+        (gint64)pntoh64(&hdr[24]) != (gint64)statb.st_mtime) {
+        /* Not an index, or an index of some other version of the file */
+        fclose(fp);
+        return FALSE;
+    }
+    count = pntoh32(&hdr[12]);
+
+    /*
+     * Every point takes at least a record; don't trust a count that
+     * the index file is too small to hold.
+     */
+    if (ws_fstat64(ws_fileno(fp), &idx_statb) == -1 ||
+        idx_statb.st_size < FSIDX_HDR_SIZE ||
+        count > (guint64)(idx_statb.st_size - FSIDX_HDR_SIZE) / FSIDX_REC_SIZE) {
+        fclose(fp);
+        return FALSE;
+    }
+
+    /*
+     * Read into a scratch array, so that a truncated or corrupt index
+     * leaves the caller's array empty.
+     */
+    points = g_ptr_array_sized_new(count);
+    for (i = 0; i < count; i++) {
+        if (fread(rec, 1, sizeof rec, fp) != sizeof rec)
+            goto fail;
+
+        val = g_new(struct fast_seek_point, 1);
+        g_ptr_array_add(points, val);
+        val->out = (gint64)pntoh64(&rec[0]);
+        val->in = (gint64)pntoh64(&rec[8]);
+
+        /* points must be in increasing order for fast_seek_find() */
+        if (i != 0 && val->out <= ((struct fast_seek_point *)points->pdata[i - 1])->out)
+            goto fail;
+
+        switch (rec[16]) {
+
+        case FSIDX_UNCOMPRESSED:
+            val->compression = UNCOMPRESSED;
+            break;
+
+#ifdef HAVE_ZLIB
+        case FSIDX_ZLIB:
+            val->compression = ZLIB;
+#ifdef HAVE_INFLATEPRIME
+            val->data.zlib.bits = rec[17];
+#else
+            if (rec[17] != 0)
+                goto fail;
+#endif
+            val->data.zlib.adler = pntoh32(&rec[20]);
+            val->data.zlib.total_out = pntoh32(&rec[24]);
+            if (fread(val->data.zlib.window, 1, ZLIB_WINSIZE, fp) != ZLIB_WINSIZE)
+                goto fail;
+            break;
+
+        case FSIDX_GZIP_AFTER_HEADER:
+            val->compression = GZIP_AFTER_HEADER;
+            break;
+#endif
+
+#ifdef HAVE_ZSTD
+        case FSIDX_ZSTD:
+            val->compression = ZSTD;
+            break;
+#endif
+
+#ifdef HAVE_LZ4
+        case FSIDX_LZ4:
+            val->compression = LZ4;
+            break;
+#endif
+
+        default:
+            goto fail;
+        }
+    }
+    fclose(fp);
+
+    for (i = 0; i < points->len; i++)
+        g_ptr_array_add(seek, points->pdata[i]);
+    g_ptr_array_free(points, TRUE);
+    return TRUE;
+
+fail:
+    fclose(fp);
+    for (i = 0; i < points->len; i++)
+        g_free(points->pdata[i]);
+    g_ptr_array_free(points, TRUE);
+    return FALSE;
+}
+
+gboolean
+file_fast_seek_index_write(FILE_T stream, GPtrArray *seek, const char *path)
+{
+    FILE *fp;
+    ws_statb64 statb;
+    guint8 hdr[FSIDX_HDR_SIZE];
+    guint8 rec[FSIDX_REC_SIZE];
+    gchar *tmp_path;
+    guint i;
+    gboolean ok = TRUE;
+
+    if (seek == NULL || seek->len == 0)
+        return FALSE;
+    if (ws_fstat64(stream->fd, &statb) == -1)
+        return FALSE;
+
+    /*
+     * Write to a temporary file and rename it into place, so that
+     * a concurrent reader never sees a partially-written index.
+     */
+    tmp_path = g_strdup_printf("%s.tmp", path);
+    fp = ws_fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        g_free(tmp_path);
+        return FALSE;
+    }
+
+    memcpy(hdr, fsidx_magic, sizeof fsidx_magic);
+    phton32(&hdr[8], FSIDX_VERSION);
+    phton32(&hdr[12], seek->len);
+    phton64(&hdr[16], (guint64)statb.st_size);
+    phton64(&hdr[24], (guint64)statb.st_mtime);
+    if (fwrite(hdr, 1, sizeof hdr, fp) != sizeof hdr)
+        ok = FALSE;
+
+    for (i = 0; ok && i < seek->len; i++) {
+        struct fast_seek_point *item = (struct fast_seek_point *)seek->pdata[i];
+
+        memset(rec, 0, sizeof rec);
+        phton64(&rec[0], (guint64)item->out);
+        phton64(&rec[8], (guint64)item->in);
+        switch (item->compression) {
+
+        case UNCOMPRESSED:
+            rec[16] = FSIDX_UNCOMPRESSED;
+            break;
+
+#ifdef HAVE_ZLIB
+        case ZLIB:
+            rec[16] = FSIDX_ZLIB;
+#ifdef HAVE_INFLATEPRIME
+            rec[17] = (guint8)item->data.zlib.bits;
+#endif
+            phton32(&rec[20], item->data.zlib.adler);
+            phton32(&rec[24], item->data.zlib.total_out);
+            break;
+
+        case GZIP_AFTER_HEADER:
+            rec[16] = FSIDX_GZIP_AFTER_HEADER;
+            break;
+#endif
+
+#ifdef HAVE_ZSTD
+        case ZSTD:
+            rec[16] = FSIDX_ZSTD;
+            break;
+#endif
+
+#ifdef HAVE_LZ4
+        case LZ4:
+            rec[16] = FSIDX_LZ4;
+            break;
+#endif
+
+        default:
+            ok = FALSE;
+            continue;
+        }
+        if (fwrite(rec, 1, sizeof rec, fp) != sizeof rec)
+            ok = FALSE;
+#ifdef HAVE_ZLIB
+        else if (item->compression == ZLIB &&
+                 fwrite(item->data.zlib.window, 1, ZLIB_WINSIZE, fp) != ZLIB_WINSIZE)
+            ok = FALSE;
+#endif
+    }
+
+    if (fclose(fp) != 0)
+        ok = FALSE;
+    if (ok) {
+#ifdef _WIN32
+        /* rename() doesn't replace an existing file on Windows */
+        ws_unlink(path);
+#endif
+        if (ws_rename(tmp_path, path) != 0)
+            ok = FALSE;
+    }
+    if (!ok)
+        ws_unlink(tmp_path);
+    g_free(tmp_path);
+    return ok;
+}
+
+gint64
+file_seek(FILE_T file, gint64 offset, int whence, int *err)
+{
+    struct fast_seek_point *here;
+    guint n;
+
+    if (whence != SEEK_SET && whence != SEEK_CUR && whence != SEEK_END) {
+        g_assert_not_reached();
+/*
+ *err = EINVAL;
+ return -1;
+*/
+    }
+
+    /* Normalize offset to a SEEK_CUR specification */
+    if (whence == SEEK_END) {
+        /* Try skip until end-of-file */
+        if (gz_skip(file, G_MAXINT64) == -1) {
+            *err = file->err;
+            return -1;
+        }
+        if (offset == 0) {
+            /* We are done */
+            return file->pos;
+        }
+    } else if (whence == SEEK_SET)
+        offset -= file->pos;
+    else if (file->seek_pending)
+        offset += file->skip;
+    file->seek_pending = FALSE;
+
+    /*
+     * Are we seeking backwards and, if so, do we have data in the buffer?
+     */
+    if (offset < 0 && file->next) {
+        /*
+         * Yes.
+         *
+         * This is guaranteed to fit in an unsigned int.
+         * To squelch compiler warnings, we cast the
+         * result.
+         */
+        guint had = (unsigned)(file->next - file->out);
+
+        /*
+         * Do we have enough data before the current position in
+         * the buffer that we can seek backwards within the buffer?
+         */
+        if (-offset <= had) {
+            /*
+             * Yes.
+             *
+             * Offset is negative, so -offset is
+             * non-negative, and -offset is
+             * <= an unsigned and thus fits in an
+             * unsigned.  Get that value and
+             * adjust appropriately.
+             *
+             * (Casting offset to unsigned makes
+             * it positive, which is not what we
+             * would want, so we cast -offset
+             * instead.)
+             */
+            guint adjustment = (unsigned)(-offset);
+            file->have += adjustment;
+            file->next -= adjustment;
+            file->pos -= adjustment;
+            return file->pos;
+        }
+    }
+
+    /*
+     * No.  Do we have "fast seek" data for the location to which we
+     * will be seeking?
      *
      * XXX, profile
      */
@@ -990,6 +1869,10 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
          * has been called on this file, which should never be the case
          * for a pipe.
          */
+        if (fast_seek_is_frame_start(here->compression)) {
+            off = here->in;
+            off2 = here->out;
+        } else
 #ifdef HAVE_ZLIB
         if (here->compression == ZLIB) {
 #ifdef HAVE_INFLATEPRIME
@@ -1022,6 +1905,10 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         file->err_info = NULL;
         file->avail_in = 0;
 
+        if (fast_seek_is_frame_start(here->compression)) {
+            /* we're at the frame's magic number; look for it again */
+            file->compression = UNKNOWN;
+        } else
 #ifdef HAVE_ZLIB
         if (here->compression == ZLIB) {
             z_stream *strm = &file->strm;
@@ -1307,72 +2194,160 @@ file_getc(FILE_T file)
     return ret < 1 ? -1 : buf[0];
 }
 
-char *
-file_gets(char *buf, int len, FILE_T file)
+/*
+ * Read bytes up to and including the next newline, or "len" bytes,
+ * whichever comes first; the bytes are not NUL-terminated, and may
+ * themselves include NULs.
+ *
+ * Returns the number of bytes read, 0 at end of file, or -1 on an error.
+ */
+int
+file_read_line(void *buf, unsigned int len, FILE_T file)
 {
     guint left, n;
-    char *str;
+    guint8 *str;
     unsigned char *eol;
 
-    /* check parameters */
-    if (buf == NULL || len < 1)
-        return NULL;
-
     /* check that there's no error */
     if (file->err)
-        return NULL;
+        return -1;
 
     /* process a skip request */
     if (file->seek_pending) {
         file->seek_pending = FALSE;
         if (gz_skip(file, file->skip) == -1)
-            return NULL;
+            return -1;
+    }
+
+    /* copy output bytes up to new line or len, whichever comes first */
+    str = (guint8 *)buf;
+    left = len;
+    eol = NULL;
+    while (left && eol == NULL) {
+        /* assure that something is in the output buffer */
+        if (file->have == 0) {
+            /* We have nothing in the output buffer. */
+            if (file->err) {
+                /* We have an error that may not have
+                   been reported yet; that means we
+                   can't generate any more data into
+                   the output buffer, so return an
+                   error indication. */
+                return -1;
+            }
+            if (fill_out_buffer(file) == -1)
+                return -1;              /* error */
+            if (file->have == 0)        /* end of file */
+                break;
+        }
+
+        /* look for end-of-line in current output buffer */
+        n = file->have > left ? left : file->have;
+        eol = (unsigned char *)memchr(file->next, '\n', n);
+        if (eol != NULL)
+            n = (unsigned)(eol - file->next) + 1;
+
+        /* copy through end-of-line, or remainder if not found */
+        memcpy(str, file->next, n);
+        file->have -= n;
+        file->next += n;
+        file->pos += n;
+        left -= n;
+        str += n;
     }
 
+    return (int)(len - left);
+}
+
+char *
+file_gets(char *buf, int len, FILE_T file)
+{
+    int n;
+
+    /* check parameters */
+    if (buf == NULL || len < 1)
+        return NULL;
+
     /* copy output bytes up to new line or len - 1, whichever comes first --
        append a terminating zero to the string (we don't check for a zero in
        the contents, let the user worry about that) */
-    str = buf;
-    left = (unsigned)len - 1;
-    if (left) do {
-            /* assure that something is in the output buffer */
-            if (file->have == 0) {
-                /* We have nothing in the output buffer. */
-                if (file->err) {
-                    /* We have an error that may not have
-                       been reported yet; that means we
-                       can't generate any more data into
-                       the output buffer, so return an
-                       error indication. */
-                    return NULL;
-                }
-                if (fill_out_buffer(file) == -1)
-                    return NULL;            /* error */
-                if (file->have == 0)  {     /* end of file */
-                    if (buf == str)         /* got bupkus */
-                        return NULL;
-                    break;                  /* got something -- return it */
-                }
-            }
+    n = file_read_line(buf, (unsigned)len - 1, file);
+    if (n == -1 || (n == 0 && len > 1))
+        return NULL;                    /* error, or got bupkus */
 
-            /* look for end-of-line in current output buffer */
-            n = file->have > left ? left : file->have;
-            eol = (unsigned char *)memchr(file->next, '\n', n);
-            if (eol != NULL)
-                n = (unsigned)(eol - file->next) + 1;
+    /* found end-of-line or out of space -- terminate string and return it */
+    buf[n] = 0;
+    return buf;
+}
 
-            /* copy through end-of-line, or remainder if not found */
-            memcpy(buf, file->next, n);
-            file->have -= n;
-            file->next += n;
-            file->pos += n;
-            left -= n;
-            buf += n;
-        } while (left && eol == NULL);
+/*
+ * Skip to just past the next occurrence of the "len"-byte string "str",
+ * looking for its first byte a buffer at a time rather than calling
+ * file_getc() for every byte of the file.  As with the byte-at-a-time
+ * loops this replaces, a failed partial match is not backtracked into,
+ * so "str" shouldn't have a proper prefix that's also a suffix.
+ *
+ * Returns TRUE if the string was found, and FALSE at end of file or on
+ * an error; use file_error() to tell which.
+ */
+gboolean
+file_skip_past(FILE_T file, const char *str, unsigned int len)
+{
+    guint matched = 0;
+    unsigned char *p;
+    guint n;
 
-    /* found end-of-line or out of space -- terminate string and return it */
-    buf[0] = 0;
-    return str;
+    if (len == 0)
+        return TRUE;
+
+    /* check that there's no error */
+    if (file->err)
+        return FALSE;
+
+    /* process a skip request */
+    if (file->seek_pending) {
+        file->seek_pending = FALSE;
+        if (gz_skip(file, file->skip) == -1)
+            return FALSE;
+    }
+
+    for (;;) {
+        /* assure that something is in the output buffer */
+        if (file->have == 0) {
+            if (file->err)
+                return FALSE;
+            if (fill_out_buffer(file) == -1)
+                return FALSE;           /* error */
+            if (file->have == 0)
+                return FALSE;           /* end of file */
+        }
+
+        if (matched == 0) {
+            /* look for the first byte of the string in the buffer */
+            p = (unsigned char *)memchr(file->next, (unsigned char)str[0], file->have);
+            if (p == NULL) {
+                n = file->have;
+            } else {
+                n = (unsigned)(p - file->next) + 1;
+                matched = 1;
+            }
+        } else {
+            /* match the rest a byte at a time, as it may cross buffers */
+            n = 1;
+            if (file->next[0] == (unsigned char)str[matched])
+                matched++;
+            else if (file->next[0] == (unsigned char)str[0])
+                matched = 1;
+            else
+                matched = 0;
+        }
+        file->have -= n;
+        file->next += n;
+        file->pos += n;
+
+        if (matched == len)
+            return TRUE;
+    }
 }
 
 int
@@ -1421,6 +2396,10 @@ file_fdreopen(FILE_T file, const char *path)
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return FALSE;
     file->fd = fd;
+#ifdef HAVE_POSIX_FADVISE
+    /* the advice is per open file, so give it again */
+    file_advise_read_policy(file);
+#endif
     return TRUE;
 }
 
@@ -1437,6 +2416,13 @@ file_close(FILE_T file)
         g_free(file->out);
         g_free(file->in);
     }
+#ifdef HAVE_ZSTD
+    ZSTD_freeDStream(file->zstd_dctx);
+#endif
+#ifdef HAVE_LZ4
+    if (file->lz4_dctx != NULL)
+        LZ4F_freeDecompressionContext(file->lz4_dctx);
+#endif
     g_free(file->fast_seek_cur);
     file->err = 0;
     file->err_info = NULL;
@@ -1735,6 +2721,295 @@ gzwfile_geterr(GZWFILE_T state)
 }
 #endif
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+/*
+ * Amount of uncompressed data in each zstd or lz4 frame we write.  Each
+ * frame can be decompressed on its own, so this is also the granularity
+ * of random access to the file.
+ */
+#define COMPRESS_FRAME_SIZE     (1024 * 1024)
+
+#define ZSTD_WRITE_LEVEL        3
+
+/* internal zstd/lz4 file state data structure for writing */
+struct wtap_frame_writer {
+    int fd;                 /* file descriptor */
+    wtap_compression_type type; /* WTAP_ZSTD_COMPRESSED or WTAP_LZ4_COMPRESSED */
+    unsigned char *in;      /* uncompressed data for the current frame */
+    guint have;             /* amount of data in the input buffer */
+    unsigned char *out;     /* compressed frame */
+    size_t out_size;        /* size of the output buffer */
+    int err;                /* error code */
+    GArray *frame_sizes;    /* compressed and uncompressed size of each frame (zstd) */
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *zstd_cctx;   /* zstd compression context */
+#endif
+};
+
+#ifdef HAVE_ZSTD
+static void
+put_le32(guint8 *p, guint32 v)
+{
+    p[0] = (guint8)(v >> 0);
+    p[1] = (guint8)(v >> 8);
+    p[2] = (guint8)(v >> 16);
+    p[3] = (guint8)(v >> 24);
+}
+#endif
+
+/* Write len bytes from buf to the output file.  Return -1, and set
+   state->err, on failure; return 0 on success. */
+static int
+frame_write_raw(FRAMEWFILE_T state, const void *buf, size_t len)
+{
+    ssize_t got;
+
+    got = ws_write(state->fd, buf, (unsigned int)len);
+    if (got < 0) {
+        state->err = errno;
+        return -1;
+    }
+    if ((size_t)got != len) {
+        state->err = WTAP_ERR_SHORT_WRITE;
+        return -1;
+    }
+    return 0;
+}
+
+/* Compress the input buffer into a frame and write it out.  Return -1,
+   and set state->err, on failure; return 0 on success. */
+static int
+frame_comp(FRAMEWFILE_T state)
+{
+    size_t len;
+    guint32 sizes[2];
+
+    if (state->have == 0)
+        return 0;
+
+    switch (state->type) {
+
+#ifdef HAVE_ZSTD
+    case WTAP_ZSTD_COMPRESSED:
+        len = ZSTD_compressCCtx(state->zstd_cctx, state->out, state->out_size,
+                                state->in, state->have, ZSTD_WRITE_LEVEL);
+        if (ZSTD_isError(len)) {
+            state->err = WTAP_ERR_INTERNAL;
+            return -1;
+        }
+        break;
+#endif
+
+#ifdef HAVE_LZ4
+    case WTAP_LZ4_COMPRESSED:
+    {
+        LZ4F_preferences_t prefs;
+
+        memset(&prefs, 0, sizeof prefs);
+        prefs.frameInfo.contentSize = state->have;
+        len = LZ4F_compressFrame(state->out, state->out_size,
+                                 state->in, state->have, &prefs);
+        if (LZ4F_isError(len)) {
+            state->err = WTAP_ERR_INTERNAL;
+            return -1;
+        }
+        break;
+    }
+#endif
+
+    default:
+        /* "Shouldn't happen" */
+        state->err = WTAP_ERR_INTERNAL;
+        return -1;
+    }
+
+    if (frame_write_raw(state, state->out, len) == -1)
+        return -1;
+
+    sizes[0] = (guint32)len;
+    sizes[1] = state->have;
+    g_array_append_vals(state->frame_sizes, sizes, 2);
+    state->have = 0;
+    return 0;
+}
+
+FRAMEWFILE_T
+framewfile_open(const char *path, wtap_compression_type type)
+{
+    int fd;
+    FRAMEWFILE_T state;
+    int save_errno;
+
+    fd = ws_open(path, O_BINARY|O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd == -1)
+        return NULL;
+    state = framewfile_fdopen(fd, type);
+    if (state == NULL) {
+        save_errno = errno;
+        ws_close(fd);
+        errno = save_errno;
+    }
+    return state;
+}
+
+FRAMEWFILE_T
+framewfile_fdopen(int fd, wtap_compression_type type)
+{
+    FRAMEWFILE_T state;
+
+    /* allocate wtap_frame_writer structure to return */
+    state = (FRAMEWFILE_T)g_try_malloc0(sizeof *state);
+    if (state == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    state->fd = fd;
+    state->type = type;
+
+    switch (type) {
+
+#ifdef HAVE_ZSTD
+    case WTAP_ZSTD_COMPRESSED:
+        state->zstd_cctx = ZSTD_createCCtx();
+        if (state->zstd_cctx == NULL) {
+            g_free(state);
+            errno = ENOMEM;
+            return NULL;
+        }
+        state->out_size = ZSTD_compressBound(COMPRESS_FRAME_SIZE);
+        break;
+#endif
+
+#ifdef HAVE_LZ4
+    case WTAP_LZ4_COMPRESSED:
+        state->out_size = LZ4F_compressFrameBound(COMPRESS_FRAME_SIZE, NULL);
+        break;
+#endif
+
+    default:
+        g_free(state);
+        errno = WTAP_ERR_COMPRESSION_NOT_SUPPORTED;
+        return NULL;
+    }
+
+    state->in = (unsigned char *)g_try_malloc(COMPRESS_FRAME_SIZE);
+    state->out = (unsigned char *)g_try_malloc(state->out_size);
+    if (state->in == NULL || state->out == NULL) {
+#ifdef HAVE_ZSTD
+        ZSTD_freeCCtx(state->zstd_cctx);
+#endif
+        g_free(state->out);
+        g_free(state->in);
+        g_free(state);
+        errno = ENOMEM;
+        return NULL;
+    }
+    state->frame_sizes = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+    /* return stream */
+    return state;
+}
+
+/* Write out len bytes from buf.  Return 0, and set state->err, on
+   failure or on an attempt to write 0 bytes (in which case state->err
+   is 0); return the number of bytes written on success. */
+guint
+framewfile_write(FRAMEWFILE_T state, const void *buf, guint len)
+{
+    guint put = len;
+    guint n;
+
+    /* check that there's no error */
+    if (state->err != 0)
+        return 0;
+
+    /* if len is zero, avoid unnecessary operations */
+    if (len == 0)
+        return 0;
+
+    /* copy to input buffer, compress a frame whenever it's full */
+    do {
+        n = COMPRESS_FRAME_SIZE - state->have;
+        if (n > len)
+            n = len;
+        memcpy(state->in + state->have, buf, n);
+        state->have += n;
+        buf = (const char *)buf + n;
+        len -= n;
+        if (state->have == COMPRESS_FRAME_SIZE && frame_comp(state) == -1)
+            return 0;
+    } while (len);
+
+    return put;
+}
+
+/* Flush out what we've written so far, ending the current frame early;
+   a reader at the other end of a pipe must get everything written
+   before the flush.  Frames are otherwise only ended when full.
+   Returns -1, and sets state->err, on failure; returns 0 on success. */
+int
+framewfile_flush(FRAMEWFILE_T state)
+{
+    /* check that there's no error */
+    if (state->err != 0)
+        return -1;
+
+    return frame_comp(state);
+}
+
+/* Flush out all data written, write the seek table if this is a zstd
+   file, and close the file.  Returns a Wiretap error on failure;
+   returns 0 on success. */
+int
+framewfile_close(FRAMEWFILE_T state)
+{
+    int ret = 0;
+
+    if (state->err == 0 && frame_comp(state) == -1)
+        ret = state->err;
+
+#ifdef HAVE_ZSTD
+    if (ret == 0 && state->type == WTAP_ZSTD_COMPRESSED) {
+        /*
+         * Append the seek table, in the zstd seekable format, so
+         * that readers can find every frame without decompressing
+         * the file.  Other zstd decoders skip it.
+         */
+        guint32 nframes = state->frame_sizes->len / 2;
+        gsize table_len = 8 + nframes * 8 + ZSTD_SEEKABLE_FOOTER_SIZE;
+        guint8 *table = (guint8 *)g_malloc(table_len);
+        guint32 i;
+
+        put_le32(&table[0], ZSTD_SEEKABLE_SKIPPABLE_MAGIC);
+        put_le32(&table[4], (guint32)(table_len - 8));
+        for (i = 0; i < state->frame_sizes->len; i++)
+            put_le32(&table[8 + i * 4], g_array_index(state->frame_sizes, guint32, i));
+        put_le32(&table[table_len - 9], nframes);
+        table[table_len - 5] = 0;   /* no checksums */
+        put_le32(&table[table_len - 4], ZSTD_SEEKABLE_FOOTER_MAGIC);
+        if (frame_write_raw(state, table, table_len) == -1)
+            ret = state->err;
+        g_free(table);
+    }
+    ZSTD_freeCCtx(state->zstd_cctx);
+#endif
+
+    g_array_free(state->frame_sizes, TRUE);
+    g_free(state->out);
+    g_free(state->in);
+    if (ws_close(state->fd) == -1 && ret == 0)
+        ret = errno;
+    g_free(state);
+    return ret;
+}
+
+int
+framewfile_geterr(FRAMEWFILE_T state)
+{
+    return state->err;
+}
+#endif /* HAVE_ZSTD || HAVE_LZ4 */
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
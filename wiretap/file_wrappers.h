@@ -28,7 +28,17 @@
 
 extern FILE_T file_open(const char *path);
 extern FILE_T file_fdopen(int fildes);
+/* How a stream will mostly be read; see file_set_read_policy() */
+typedef enum {
+    FILE_READ_DEFAULT,
+    FILE_READ_SEQUENTIAL,
+    FILE_READ_RANDOM
+} file_read_policy_e;
+
+extern gboolean file_set_read_policy(FILE_T stream, file_read_policy_e policy, guint buffer_size);
 extern void file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek);
+extern gboolean file_fast_seek_index_read(FILE_T stream, GPtrArray *seek, const char *path);
+extern gboolean file_fast_seek_index_write(FILE_T stream, GPtrArray *seek, const char *path);
 WS_DLL_PUBLIC gint64 file_seek(FILE_T stream, gint64 offset, int whence, int *err);
 WS_DLL_PUBLIC gint64 file_tell(FILE_T stream);
 extern gint64 file_tell_raw(FILE_T stream);
@@ -38,6 +48,8 @@ WS_DLL_PUBLIC int file_read(void *buf, unsigned int count, FILE_T file);
 WS_DLL_PUBLIC int file_peekc(FILE_T stream);
 WS_DLL_PUBLIC int file_getc(FILE_T stream);
 WS_DLL_PUBLIC char *file_gets(char *buf, int len, FILE_T stream);
+WS_DLL_PUBLIC int file_read_line(void *buf, unsigned int len, FILE_T stream);
+WS_DLL_PUBLIC gboolean file_skip_past(FILE_T stream, const char *str, unsigned int len);
 WS_DLL_PUBLIC int file_eof(FILE_T stream);
 WS_DLL_PUBLIC int file_error(FILE_T fh, gchar **err_info);
 extern void file_clearerr(FILE_T stream);
@@ -56,4 +68,15 @@ extern int gzwfile_close(GZWFILE_T state);
 extern int gzwfile_geterr(GZWFILE_T state);
 #endif /* HAVE_ZLIB */
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+typedef struct wtap_frame_writer *FRAMEWFILE_T;
+
+extern FRAMEWFILE_T framewfile_open(const char *path, wtap_compression_type type);
+extern FRAMEWFILE_T framewfile_fdopen(int fd, wtap_compression_type type);
+extern guint framewfile_write(FRAMEWFILE_T state, const void *buf, guint len);
+extern int framewfile_flush(FRAMEWFILE_T state);
+extern int framewfile_close(FRAMEWFILE_T state);
+extern int framewfile_geterr(FRAMEWFILE_T state);
+#endif /* HAVE_ZSTD || HAVE_LZ4 */
+
 #endif /* __FILE_H__ */
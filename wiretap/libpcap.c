@@ -70,6 +70,8 @@ static gboolean libpcap_dump(wtap_dumper *wdh, const struct wtap_pkthdr *phdr,
     const guint8 *pd, int *err, gchar **err_info);
 static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
     struct pcaprec_ss990915_hdr *hdr);
+static gboolean libpcap_seek_time(wtap *wth, const nstime_t *ts, int *err,
+    gchar **err_info);
 static void libpcap_close(wtap *wth);
 
 wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
@@ -270,6 +272,13 @@ wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
 	wth->subtype_read = libpcap_read;
 	wth->subtype_seek_read = libpcap_seek_read;
 	wth->subtype_close = libpcap_close;
+	if (file_encap != WTAP_ENCAP_ERF) {
+		/*
+		 * ERF records carry their time stamps in the ERF
+		 * header, which we'd have to parse to search by time.
+		 */
+		wth->subtype_seek_time = libpcap_seek_time;
+	}
 	wth->file_encap = file_encap;
 	wth->snapshot_length = hdr.snaplen;
 
@@ -734,6 +743,180 @@ libpcap_read_packet(wtap *wth, FILE_T fh, struct wtap_pkthdr *phdr,
 	return TRUE;
 }
 
+/*
+ * Time-based seeking.
+ *
+ * The records in a pcap file have no index, but they have fixed-size
+ * headers, so, if the file isn't compressed, we can do a binary search
+ * on it: pick an offset, look for something after it that looks like
+ * a run of valid record headers, and compare the time stamp of the
+ * first of them with the time we're looking for.
+ *
+ * Packet data can look like a run of record headers, so where we end
+ * up is checked by following the record headers from there through
+ * the rest of the range we were searching; if that doesn't work out,
+ * we go back to where we started and let our caller read forward from
+ * there.
+ */
+
+/*
+ * Number of consecutive plausible record headers, with non-decreasing
+ * time stamps, we require before we believe we've found a record
+ * boundary.
+ */
+#define SEEK_TIME_RESYNC_RECORDS	8
+
+/*
+ * Once the range we're searching is this small, stop bisecting and let
+ * our caller read forward.
+ */
+#define SEEK_TIME_LINEAR_RANGE		(64*1024)
+
+static void
+libpcap_hdr_to_nstime(wtap *wth, const struct pcaprec_ss990915_hdr *hdr,
+    nstime_t *ts)
+{
+	ts->secs = hdr->hdr.ts_sec;
+	if (wth->file_tsprec == WTAP_TSPREC_NSEC)
+		ts->nsecs = hdr->hdr.ts_usec;
+	else
+		ts->nsecs = hdr->hdr.ts_usec * 1000;
+}
+
+/*
+ * See whether there's a record boundary at "offset", by following the
+ * record headers starting there, for at least "min_records" records
+ * and until a record starts at or after "end", and checking that they
+ * all look valid, with time stamps in order and, if "min_ts" isn't
+ * NULL, none before *min_ts.  Records that run up to the end of the
+ * file count as valid.
+ *
+ * Returns 1 if there is one, with *ts set to the time stamp of the
+ * record at "offset", 0 if there isn't, and -1 on an I/O error.
+ */
+static int
+libpcap_check_records(wtap *wth, gint64 offset, gint64 end,
+    int min_records, gint64 file_size, const nstime_t *min_ts,
+    nstime_t *ts, int *err, gchar **err_info)
+{
+	struct pcaprec_ss990915_hdr hdr;
+	nstime_t rec_ts, prev_ts;
+	int i;
+
+	if (file_seek(wth->fh, offset, SEEK_SET, err) == -1)
+		return -1;
+	for (i = 0; i < min_records || offset < end; i++) {
+		switch (libpcap_try_header(wth, wth->fh, err, err_info, &hdr)) {
+
+		case -1:
+			if (*err != 0 && *err != WTAP_ERR_SHORT_READ)
+				return -1;
+			/*
+			 * We ran off the end of the file; that's
+			 * only OK if we got at least one record.
+			 */
+			*err = 0;
+			g_free(*err_info);
+			*err_info = NULL;
+			return i != 0;
+
+		case 0:
+			break;
+
+		default:
+			return 0;
+		}
+		libpcap_hdr_to_nstime(wth, &hdr, &rec_ts);
+		if (min_ts != NULL && nstime_cmp(&rec_ts, min_ts) < 0)
+			return 0;
+		if (i == 0)
+			*ts = rec_ts;
+		else if (nstime_cmp(&rec_ts, &prev_ts) < 0)
+			return 0;
+		prev_ts = rec_ts;
+		if (file_tell(wth->fh) + hdr.hdr.incl_len > file_size)
+			return 0;
+		if (file_seek(wth->fh, hdr.hdr.incl_len, SEEK_CUR, err) == -1)
+			return -1;
+		offset = file_tell(wth->fh);
+		if (offset == file_size)
+			return 1;
+	}
+	return 1;
+}
+
+static gboolean
+libpcap_seek_time(wtap *wth, const nstime_t *ts, int *err, gchar **err_info)
+{
+	gint64 start, lo, hi, mid, offset, file_size;
+	nstime_t lo_ts, rec_ts;
+	int ret;
+
+	if (file_iscompressed(wth->fh)) {
+		/*
+		 * Every probe would mean decompressing from the
+		 * nearest seek point; just read forward.
+		 */
+		return TRUE;
+	}
+	file_size = wtap_file_size(wth, err);
+	if (file_size == -1)
+		return FALSE;
+
+	/*
+	 * "lo" is always the offset of a record with a time stamp,
+	 * "lo_ts", before the time we're looking for (or of the current
+	 * record, with which we start); the first record at or after
+	 * that time is somewhere after "lo" and before "hi".  A record
+	 * found later in the file with a time stamp before "lo_ts" is
+	 * not a record after all.
+	 */
+	start = lo = file_tell(wth->fh);
+	hi = file_size;
+	ret = libpcap_check_records(wth, lo, 0, 1, file_size, NULL, &lo_ts,
+	    err, err_info);
+	if (ret == -1)
+		return FALSE;
+	if (ret == 1 && nstime_cmp(&lo_ts, ts) < 0) {
+		while (hi - lo > SEEK_TIME_LINEAR_RANGE) {
+			mid = lo + (hi - lo) / 2;
+			for (offset = mid; offset < hi; offset++) {
+				ret = libpcap_check_records(wth, offset, 0,
+				    SEEK_TIME_RESYNC_RECORDS, file_size,
+				    &lo_ts, &rec_ts, err, err_info);
+				if (ret == -1)
+					return FALSE;
+				if (ret == 1)
+					break;
+			}
+			if (offset < hi && nstime_cmp(&rec_ts, ts) < 0) {
+				lo = offset;
+				lo_ts = rec_ts;
+			} else
+				hi = mid;
+		}
+
+		/*
+		 * Make sure we've landed on a record boundary, by
+		 * following the records from there through the range
+		 * our caller will read; if we haven't, fall back on
+		 * reading forward from where we started.
+		 */
+		if (lo != start) {
+			ret = libpcap_check_records(wth, lo, hi, 1, file_size,
+			    &lo_ts, &rec_ts, err, err_info);
+			if (ret == -1)
+				return FALSE;
+			if (ret == 0)
+				lo = start;
+		}
+	}
+
+	if (file_seek(wth->fh, lo, SEEK_SET, err) == -1)
+		return FALSE;
+	return TRUE;
+}
+
 /* Read the header of the next packet.
 
    Return FALSE on an error, TRUE on success. */
@@ -1113,7 +1113,8 @@ merge_result
 merge_files(const gchar* out_filename, const int file_type,
             const char *const *in_filenames, const guint in_file_count,
             const gboolean do_append, const idb_merge_mode mode,
-            guint snaplen, const gchar *app_name, merge_progress_callback_t* cb,
+            guint snaplen, const wtap_compression_type compression_type,
+            const gchar *app_name, merge_progress_callback_t* cb,
             int *err, gchar **err_info, guint *err_fileno)
 {
     merge_in_file_t    *in_files = NULL;
@@ -1169,12 +1170,12 @@ merge_files(const gchar* out_filename, const int file_type,
         merge_debug("merge_files: IDB merge operation complete, got %u IDBs", idb_inf ? idb_inf->interface_data->len : 0);
 
         pdh = wtap_dump_open_ng(out_filename, file_type, frame_type, snaplen,
-                                FALSE /* compressed */, shb_hdrs, idb_inf,
+                                compression_type, shb_hdrs, idb_inf,
                                 NULL, err);
     }
     else {
         pdh = wtap_dump_open(out_filename, file_type, frame_type, snaplen,
-                             FALSE /* compressed */, err);
+                             compression_type, err);
     }
 
     if (pdh == NULL) {
@@ -1270,12 +1271,12 @@ merge_files_to_tempfile(gchar **out_filenamep, const char *pfx,
 
         pdh = wtap_dump_open_tempfile_ng(out_filenamep, pfx, file_type,
                                          frame_type, snaplen,
-                                         FALSE /* compressed */,
+                                         WTAP_UNCOMPRESSED,
                                          shb_hdrs, idb_inf, NULL, err);
     }
     else {
         pdh = wtap_dump_open_tempfile(out_filenamep, pfx, file_type, frame_type,
-                                      snaplen, FALSE /* compressed */, err);
+                                      snaplen, WTAP_UNCOMPRESSED, err);
     }
 
     if (pdh == NULL) {
@@ -1310,6 +1311,7 @@ merge_result
 merge_files_to_stdout(const int file_type, const char *const *in_filenames,
                       const guint in_file_count, const gboolean do_append,
                       const idb_merge_mode mode, guint snaplen,
+                      const wtap_compression_type compression_type,
                       const gchar *app_name, merge_progress_callback_t* cb,
                       int *err, gchar **err_info, guint *err_fileno)
 {
@@ -1365,12 +1367,12 @@ merge_files_to_stdout(const int file_type, const char *const *in_filenames,
         merge_debug("merge_files: IDB merge operation complete, got %u IDBs", idb_inf ? idb_inf->interface_data->len : 0);
 
         pdh = wtap_dump_open_stdout_ng(file_type, frame_type, snaplen,
-                                       FALSE /* compressed */, shb_hdrs,
+                                       compression_type, shb_hdrs,
                                        idb_inf, NULL, err);
     }
     else {
         pdh = wtap_dump_open_stdout(file_type, frame_type, snaplen,
-                                    FALSE /* compressed */, err);
+                                    compression_type, err);
     }
 
     if (pdh == NULL) {
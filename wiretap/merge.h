@@ -132,6 +132,7 @@ typedef struct {
  * @param do_append Whether to append by file order instead of chronological order
  * @param mode The IDB_MERGE_MODE_XXX merge mode for interface data
  * @param snaplen The snaplen to limit it to, or 0 to leave as it is in the files
+ * @param compression_type The compression to use for the output file
  * @param app_name The application name performing the merge, used in SHB info
  * @param cb The callback information to use during execution
  * @param[out] err Set to the internal WTAP_ERR_XXX error code if it failed
@@ -143,7 +144,8 @@ WS_DLL_PUBLIC merge_result
 merge_files(const gchar* out_filename, const int file_type,
             const char *const *in_filenames, const guint in_file_count,
             const gboolean do_append, const idb_merge_mode mode,
-            guint snaplen, const gchar *app_name, merge_progress_callback_t* cb,
+            guint snaplen, const wtap_compression_type compression_type,
+            const gchar *app_name, merge_progress_callback_t* cb,
             int *err, gchar **err_info, guint *err_fileno);
 
 /** Merge the given input files to a temporary file
@@ -180,6 +182,7 @@ merge_files_to_tempfile(gchar **out_filenamep, const char *pfx,
  * @param do_append Whether to append by file order instead of chronological order
  * @param mode The IDB_MERGE_MODE_XXX merge mode for interface data
  * @param snaplen The snaplen to limit it to, or 0 to leave as it is in the files
+ * @param compression_type The compression to use for the output file
  * @param app_name The application name performing the merge, used in SHB info
  * @param cb The callback information to use during execution
  * @param[out] err Set to the internal WTAP_ERR_XXX error code if it failed
@@ -191,6 +194,7 @@ WS_DLL_PUBLIC merge_result
 merge_files_to_stdout(const int file_type, const char *const *in_filenames,
                       const guint in_file_count, const gboolean do_append,
                       const idb_merge_mode mode, guint snaplen,
+                      const wtap_compression_type compression_type,
                       const gchar *app_name, merge_progress_callback_t* cb,
                       int *err, gchar **err_info, guint *err_fileno);
 
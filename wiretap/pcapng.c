@@ -53,6 +53,8 @@ pcapng_read(wtap *wth, int *err, gchar **err_info,
 static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
                  struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
+static gboolean
+pcapng_seek_time(wtap *wth, const nstime_t *ts, int *err, gchar **err_info);
 static void
 pcapng_close(wtap *wth);
 
@@ -229,6 +231,8 @@ typedef struct {
     guint16 version_major;
     guint16 version_minor;
     GArray *interfaces;          /**< Interfaces found in the capture file. */
+    GArray *frame_index;         /**< Entries of the file's trailing frame index block, or NULL */
+    gboolean frame_index_checked; /**< Set once we've looked for a frame index block */
     gint8 if_fcslen;
     wtap_new_ipv4_callback_t add_new_ipv4;
     wtap_new_ipv6_callback_t add_new_ipv6;
@@ -1010,9 +1014,8 @@ pcapng_read_if_descr_block(wtap *wth, FILE_T fh, pcapng_block_header_t *bh,
 static gboolean
 pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wtapng_block_t *wblock, int *err, gchar **err_info, gboolean enhanced)
 {
-    int bytes_read;
     guint block_read;
-    guint to_read, opt_cont_buf_len;
+    guint to_read, opt_off;
     pcapng_enhanced_packet_block_t epb;
     pcapng_packet_block_t pb;
     wtapng_packet_t packet;
@@ -1245,44 +1248,71 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
      * epb_flags      2
      * epb_hash       3
      * epb_dropcount  4
+     *
+     * The options are read in one go into ft_specific_data, and only
+     * their headers are looked at here; the flags are needed now for
+     * the FCS length, but the comment and drop count are left for
+     * pcapng_decode_packet_options() to pick up if anybody asks.
      */
     to_read = block_total_length -
         (int)sizeof(pcapng_block_header_t) -
         block_read -    /* fixed and variable part, including padding */
         (int)sizeof(bh->block_total_length);
 
-    /* Allocate enough memory to hold all options */
-    opt_cont_buf_len = to_read;
-    ws_buffer_assure_space(&wblock->packet_header->ft_specific_data, opt_cont_buf_len);
-    opt_ptr = ws_buffer_start_ptr(&wblock->packet_header->ft_specific_data);
+    ws_buffer_clean(&wblock->packet_header->ft_specific_data);
+    opt_ptr = NULL;
+    if (to_read != 0) {
+        ws_buffer_assure_space(&wblock->packet_header->ft_specific_data, to_read);
+        opt_ptr = ws_buffer_start_ptr(&wblock->packet_header->ft_specific_data);
+        if (!wtap_read_bytes(fh, opt_ptr, to_read, err, err_info)) {
+            pcapng_debug("pcapng_read_packet_block: failed to read options");
+            return FALSE;
+        }
+        ws_buffer_increase_length(&wblock->packet_header->ft_specific_data, to_read);
+        block_read += to_read;
+    }
+    opt_off = 0;
 
-    while (to_read != 0) {
-        /* read option */
-        oh = (pcapng_option_header_t *)(void *)opt_ptr;
-        option_content = opt_ptr + sizeof (pcapng_option_header_t);
-        bytes_read = pcapng_read_option(fh, pn, oh, option_content, opt_cont_buf_len, to_read, err, err_info, "packet");
-        if (bytes_read <= 0) {
-            pcapng_debug("pcapng_read_packet_block: failed to read option");
-            /* XXX - free anything? */
+    while (opt_off < to_read) {
+        /* sanity check: don't run past the end of the block */
+        if (to_read - opt_off < sizeof (pcapng_option_header_t)) {
+            *err = WTAP_ERR_BAD_FILE;
+            *err_info = g_strdup("pcapng_read_packet_block: Not enough data to read header of the packet block option");
             return FALSE;
         }
-        block_read += bytes_read;
-        to_read -= bytes_read;
+        oh = (pcapng_option_header_t *)(void *)(opt_ptr + opt_off);
+        if (pn->byte_swapped) {
+            /* leave the header in host byte order for pcapng_decode_packet_options() */
+            oh->option_code      = GUINT16_SWAP_LE_BE(oh->option_code);
+            oh->option_length    = GUINT16_SWAP_LE_BE(oh->option_length);
+        }
+        opt_off += (guint)sizeof (pcapng_option_header_t);
+        if (to_read - opt_off < oh->option_length) {
+            *err = WTAP_ERR_BAD_FILE;
+            *err_info = g_strdup_printf("pcapng_read_packet_block: Not enough data to handle option length (%d) of the packet block",
+                                        oh->option_length);
+            return FALSE;
+        }
+        option_content = opt_ptr + opt_off;
+        opt_off += oh->option_length;
+
+        /* jump over potential padding bytes at end of option */
+        if ((oh->option_length % 4) != 0)
+            opt_off += 4 - (oh->option_length % 4);
 
         /* handle option content */
         switch (oh->option_code) {
             case(OPT_EOFOPT):
-                if (to_read != 0) {
-                    pcapng_debug("pcapng_read_packet_block: %u bytes after opt_endofopt", to_read);
+                if (opt_off < to_read) {
+                    pcapng_debug("pcapng_read_packet_block: %u bytes after opt_endofopt", to_read - opt_off);
                 }
                 /* padding should be ok here, just get out of this */
-                to_read = 0;
+                opt_off = to_read;
                 break;
             case(OPT_COMMENT):
-                if (oh->option_length > 0 && oh->option_length < opt_cont_buf_len) {
-                    wblock->packet_header->presence_flags |= WTAP_HAS_COMMENTS;
-                    wblock->packet_header->opt_comment = g_strndup((char *)option_content, oh->option_length);
-                    pcapng_debug("pcapng_read_packet_block: length %u opt_comment '%s'", oh->option_length, wblock->packet_header->opt_comment);
+                if (oh->option_length > 0) {
+                    wblock->packet_header->presence_flags |= WTAP_HAS_COMMENTS|WTAP_HAS_PACKET_OPTIONS;
+                    pcapng_debug("pcapng_read_packet_block: length %u opt_comment", oh->option_length);
                 } else {
                     pcapng_debug("pcapng_read_packet_block: opt_comment length %u seems strange", oh->option_length);
                 }
@@ -1292,7 +1322,6 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
                     *err = WTAP_ERR_BAD_FILE;
                     *err_info = g_strdup_printf("pcapng_read_packet_block: packet block flags option length %u is not 4",
                                                 oh->option_length);
-                    /* XXX - free anything? */
                     return FALSE;
                 }
                 /*  Don't cast a guint8 * into a guint32 *--the
@@ -1320,21 +1349,13 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
                     *err = WTAP_ERR_BAD_FILE;
                     *err_info = g_strdup_printf("pcapng_read_packet_block: packet block drop count option length %u is not 8",
                                                 oh->option_length);
-                    /* XXX - free anything? */
                     return FALSE;
                 }
-                /*  Don't cast a guint8 * into a guint64 *--the
-                 *  guint8 * may not point to something that's
-                 *  aligned correctly.
-                 */
-                wblock->packet_header->presence_flags |= WTAP_HAS_DROP_COUNT;
-                memcpy(&wblock->packet_header->drop_count, option_content, sizeof(guint64));
+                wblock->packet_header->presence_flags |= WTAP_HAS_DROP_COUNT|WTAP_HAS_PACKET_OPTIONS;
                 if (pn->byte_swapped) {
-                    wblock->packet_header->drop_count = GUINT64_SWAP_LE_BE(wblock->packet_header->drop_count);
-                    memcpy(option_content, &wblock->packet_header->drop_count, sizeof(guint64));
+                    /* in place, for pcapng_decode_packet_options() */
+                    PBSWAP64(option_content);
                 }
-
-                pcapng_debug("pcapng_read_packet_block: drop_count %" G_GINT64_MODIFIER "u", wblock->packet_header->drop_count);
                 break;
             default:
 #ifdef HAVE_PLUGINS
@@ -1365,6 +1386,71 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
 }
 
 
+/*
+ * Find an option of a packet block that pcapng_read_packet_block()
+ * left undecoded in the packet header's ft_specific_data; the option
+ * headers, and the options we use, are already in host byte order.
+ */
+static const guint8 *
+pcapng_find_packet_option(const struct wtap_pkthdr *phdr, guint16 option_code,
+                          guint16 *option_length)
+{
+    const guint8 *opt_ptr;
+    guint opt_len, opt_off;
+    const pcapng_option_header_t *oh;
+
+    if (!(phdr->presence_flags & WTAP_HAS_PACKET_OPTIONS))
+        return NULL;
+
+    opt_ptr = phdr->ft_specific_data.data + phdr->ft_specific_data.start;
+    opt_len = (guint)(phdr->ft_specific_data.first_free - phdr->ft_specific_data.start);
+    opt_off = 0;
+    while (opt_len - opt_off >= sizeof (pcapng_option_header_t)) {
+        oh = (const pcapng_option_header_t *)(const void *)(opt_ptr + opt_off);
+        if (oh->option_code == OPT_EOFOPT)
+            break;
+        opt_off += (guint)sizeof (pcapng_option_header_t);
+        if (oh->option_code == option_code) {
+            *option_length = oh->option_length;
+            return opt_ptr + opt_off;
+        }
+        opt_off += oh->option_length;
+        if ((oh->option_length % 4) != 0)
+            opt_off += 4 - (oh->option_length % 4);
+        if (opt_off > opt_len)
+            break;
+    }
+    return NULL;
+}
+
+/*
+ * Fill in the comment and drop count of a packet header from the
+ * options pcapng_read_packet_block() left undecoded.
+ */
+void
+pcapng_decode_packet_options(struct wtap_pkthdr *phdr)
+{
+    const guint8 *option_content;
+    guint16 option_length;
+
+    if (phdr->opt_comment == NULL &&
+        (option_content = pcapng_find_packet_option(phdr, OPT_COMMENT, &option_length)) != NULL &&
+        option_length > 0) {
+        phdr->opt_comment = g_strndup((const char *)option_content, option_length);
+        pcapng_debug("pcapng_decode_packet_options: length %u opt_comment '%s'", option_length, phdr->opt_comment);
+    }
+    if ((option_content = pcapng_find_packet_option(phdr, OPT_EPB_DROPCOUNT, &option_length)) != NULL) {
+        /*  Don't cast a guint8 * into a guint64 *--the
+         *  guint8 * may not point to something that's
+         *  aligned correctly.
+         */
+        memcpy(&phdr->drop_count, option_content, sizeof(guint64));
+        pcapng_debug("pcapng_decode_packet_options: drop_count %" G_GINT64_MODIFIER "u", phdr->drop_count);
+    }
+    phdr->presence_flags &= ~WTAP_HAS_PACKET_OPTIONS;
+}
+
+
 static gboolean
 pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wtapng_block_t *wblock, int *err, gchar **err_info)
 {
@@ -2458,6 +2544,8 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
     pn.version_major = -1;
     pn.version_minor = -1;
     pn.interfaces = NULL;
+    pn.frame_index = NULL;
+    pn.frame_index_checked = FALSE;
 
     /* we don't expect any packet blocks yet */
     wblock.frame_buffer = NULL;
@@ -2516,6 +2604,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 
     wth->subtype_read = pcapng_read;
     wth->subtype_seek_read = pcapng_seek_read;
+    wth->subtype_seek_time = pcapng_seek_time;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = WTAP_FILE_TYPE_SUBTYPE_PCAPNG;
 
@@ -2565,16 +2654,83 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 }
 
 
+/*
+ * Process a block other than a packet block, read with pcapng_read_block(),
+ * that the packets following it may depend on.
+ */
+static void
+pcapng_process_block(wtap *wth, pcapng_t *pcapng, wtapng_block_t *wblock)
+{
+    wtap_block_t wtapng_if_descr;
+    wtap_block_t if_stats;
+    wtapng_if_stats_mandatory_t *if_stats_mand_block, *if_stats_mand;
+    wtapng_if_descr_mandatory_t *wtapng_if_descr_mand;
+
+    switch (wblock->type) {
+
+        case(BLOCK_TYPE_SHB):
+            pcapng_debug("pcapng_process_block: another section header block");
+            g_array_append_val(wth->shb_hdrs, wblock->block);
+            break;
+
+        case(BLOCK_TYPE_IDB):
+            /* A new interface */
+            pcapng_debug("pcapng_process_block: block type BLOCK_TYPE_IDB");
+            pcapng_process_idb(wth, pcapng, wblock);
+            wtap_block_free(wblock->block);
+            break;
+
+        case(BLOCK_TYPE_NRB):
+            /* More name resolution entries */
+            pcapng_debug("pcapng_process_block: block type BLOCK_TYPE_NRB");
+            if (wth->nrb_hdrs == NULL) {
+                wth->nrb_hdrs = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
+            }
+            g_array_append_val(wth->nrb_hdrs, wblock->block);
+            break;
+
+        case(BLOCK_TYPE_ISB):
+            /* Another interface statistics report */
+            pcapng_debug("pcapng_process_block: block type BLOCK_TYPE_ISB");
+            if_stats_mand_block = (wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(wblock->block);
+            if (wth->interface_data->len <= if_stats_mand_block->interface_id) {
+                pcapng_debug("pcapng_process_block: BLOCK_TYPE_ISB wblock.if_stats.interface_id %u >= number_of_interfaces", if_stats_mand_block->interface_id);
+            } else {
+                /* Get the interface description */
+                wtapng_if_descr = g_array_index(wth->interface_data, wtap_block_t, if_stats_mand_block->interface_id);
+                wtapng_if_descr_mand = (wtapng_if_descr_mandatory_t*)wtap_block_get_mandatory_data(wtapng_if_descr);
+                if (wtapng_if_descr_mand->num_stat_entries == 0) {
+                    /* First ISB found, no previous entry */
+                    pcapng_debug("pcapng_process_block: block type BLOCK_TYPE_ISB. First ISB found, no previous entry");
+                    wtapng_if_descr_mand->interface_statistics = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
+                }
+
+                if_stats = wtap_block_create(WTAP_BLOCK_IF_STATS);
+                if_stats_mand = (wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(if_stats);
+                if_stats_mand->interface_id  = if_stats_mand_block->interface_id;
+                if_stats_mand->ts_high       = if_stats_mand_block->ts_high;
+                if_stats_mand->ts_low        = if_stats_mand_block->ts_low;
+
+                wtap_block_copy(if_stats, wblock->block);
+                g_array_append_val(wtapng_if_descr_mand->interface_statistics, if_stats);
+                wtapng_if_descr_mand->num_stat_entries++;
+            }
+            wtap_block_free(wblock->block);
+            break;
+
+        default:
+            /* XXX - improve handling of "unknown" blocks */
+            pcapng_debug("pcapng_process_block: Unknown block type 0x%08x", wblock->type);
+            break;
+    }
+}
+
 /* classic wtap: read packet */
 static gboolean
 pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 {
     pcapng_t *pcapng = (pcapng_t *)wth->priv;
     wtapng_block_t wblock;
-    wtap_block_t wtapng_if_descr;
-    wtap_block_t if_stats;
-    wtapng_if_stats_mandatory_t *if_stats_mand_block, *if_stats_mand;
-    wtapng_if_descr_mandatory_t *wtapng_if_descr_mand;
 
     wblock.frame_buffer  = wth->frame_buffer;
     wblock.packet_header = &wth->phdr;
@@ -2595,11 +2751,6 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 
         switch (wblock.type) {
 
-            case(BLOCK_TYPE_SHB):
-                pcapng_debug("pcapng_read: another section header block");
-                g_array_append_val(wth->shb_hdrs, wblock.block);
-                break;
-
             case(BLOCK_TYPE_PB):
             case(BLOCK_TYPE_SPB):
             case(BLOCK_TYPE_EPB):
@@ -2608,54 +2759,8 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
                 /* packet block - we've found a packet */
                 goto got_packet;
 
-            case(BLOCK_TYPE_IDB):
-                /* A new interface */
-                pcapng_debug("pcapng_read: block type BLOCK_TYPE_IDB");
-                pcapng_process_idb(wth, pcapng, &wblock);
-                wtap_block_free(wblock.block);
-                break;
-
-            case(BLOCK_TYPE_NRB):
-                /* More name resolution entries */
-                pcapng_debug("pcapng_read: block type BLOCK_TYPE_NRB");
-                if (wth->nrb_hdrs == NULL) {
-                    wth->nrb_hdrs = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
-                }
-                g_array_append_val(wth->nrb_hdrs, wblock.block);
-                break;
-
-            case(BLOCK_TYPE_ISB):
-                /* Another interface statistics report */
-                pcapng_debug("pcapng_read: block type BLOCK_TYPE_ISB");
-                if_stats_mand_block = (wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(wblock.block);
-                if (wth->interface_data->len <= if_stats_mand_block->interface_id) {
-                    pcapng_debug("pcapng_read: BLOCK_TYPE_ISB wblock.if_stats.interface_id %u >= number_of_interfaces", if_stats_mand_block->interface_id);
-                } else {
-                    /* Get the interface description */
-                    wtapng_if_descr = g_array_index(wth->interface_data, wtap_block_t, if_stats_mand_block->interface_id);
-                    wtapng_if_descr_mand = (wtapng_if_descr_mandatory_t*)wtap_block_get_mandatory_data(wtapng_if_descr);
-                    if (wtapng_if_descr_mand->num_stat_entries == 0) {
-                        /* First ISB found, no previous entry */
-                        pcapng_debug("pcapng_read: block type BLOCK_TYPE_ISB. First ISB found, no previous entry");
-                        wtapng_if_descr_mand->interface_statistics = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
-                    }
-
-                    if_stats = wtap_block_create(WTAP_BLOCK_IF_STATS);
-                    if_stats_mand = (wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(if_stats);
-                    if_stats_mand->interface_id  = if_stats_mand_block->interface_id;
-                    if_stats_mand->ts_high       = if_stats_mand_block->ts_high;
-                    if_stats_mand->ts_low        = if_stats_mand_block->ts_low;
-
-                    wtap_block_copy(if_stats, wblock.block);
-                    g_array_append_val(wtapng_if_descr_mand->interface_statistics, if_stats);
-                    wtapng_if_descr_mand->num_stat_entries++;
-                }
-                wtap_block_free(wblock.block);
-                break;
-
             default:
-                /* XXX - improve handling of "unknown" blocks */
-                pcapng_debug("pcapng_read: Unknown block type 0x%08x", wblock.type);
+                pcapng_process_block(wth, pcapng, &wblock);
                 break;
         }
     }
@@ -2711,6 +2816,327 @@ pcapng_seek_read(wtap *wth, gint64 seek_off,
 }
 
 
+/*
+ * Minimum FIB size = minimum block size + size of fixed length portion of FIB.
+ */
+#define MIN_FIB_SIZE    ((guint32)(MIN_BLOCK_SIZE + sizeof(pcapng_frame_index_block_t)))
+
+/*
+ * Look for a frame index block at the end of the file, and, if there is
+ * one, read its entries into pcapng->frame_index.  The position in
+ * wth->fh is left unchanged.
+ *
+ * We only do this for uncompressed files; finding the end of a compressed
+ * file would mean decompressing all of it.  A missing or damaged index
+ * isn't an error; we just don't use it.
+ */
+static gboolean
+pcapng_read_frame_index(wtap *wth, pcapng_t *pcapng, int *err, gchar **err_info)
+{
+    gint64 saved_offset, file_size;
+    guint32 block_total_length;
+    pcapng_block_header_t bh;
+    pcapng_frame_index_block_t fib;
+    frame_index_entry_t *entry;
+    GArray *frame_index = NULL;
+    guint32 i;
+
+    pcapng->frame_index_checked = TRUE;
+    if (file_iscompressed(wth->fh))
+        return TRUE;
+    file_size = wtap_file_size(wth, err);
+    if (file_size == -1)
+        return FALSE;
+    if (file_size < MIN_SHB_SIZE + MIN_FIB_SIZE)
+        return TRUE;
+    saved_offset = file_tell(wth->fh);
+
+    /* The last 4 bytes of the file are the length of the last block. */
+    if (file_seek(wth->fh, file_size - 4, SEEK_SET, err) == -1)
+        return FALSE;
+    if (!wtap_read_bytes(wth->fh, &block_total_length, sizeof block_total_length, err, err_info))
+        goto done;
+    if (pcapng->byte_swapped)
+        block_total_length = GUINT32_SWAP_LE_BE(block_total_length);
+    if (block_total_length < MIN_FIB_SIZE || (block_total_length % 4) != 0 ||
+        block_total_length > MAX_BLOCK_SIZE || block_total_length > file_size)
+        goto done;
+
+    if (file_seek(wth->fh, file_size - block_total_length, SEEK_SET, err) == -1)
+        return FALSE;
+    if (!wtap_read_bytes(wth->fh, &bh, sizeof bh, err, err_info))
+        goto done;
+    if (!wtap_read_bytes(wth->fh, &fib, sizeof fib, err, err_info))
+        goto done;
+    if (pcapng->byte_swapped) {
+        bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+        bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+        fib.magic             = GUINT32_SWAP_LE_BE(fib.magic);
+        fib.num_entries       = GUINT32_SWAP_LE_BE(fib.num_entries);
+    }
+    if (bh.block_type != BLOCK_TYPE_FIB ||
+        bh.block_total_length != block_total_length ||
+        fib.magic != PCAPNG_FRAME_INDEX_MAGIC ||
+        fib.num_entries == 0 ||
+        fib.num_entries != (block_total_length - MIN_FIB_SIZE) / sizeof(frame_index_entry_t) ||
+        (block_total_length - MIN_FIB_SIZE) % sizeof(frame_index_entry_t) != 0)
+        goto done;
+
+    frame_index = g_array_sized_new(FALSE, FALSE, sizeof(frame_index_entry_t), fib.num_entries);
+    g_array_set_size(frame_index, fib.num_entries);
+    if (!wtap_read_bytes(wth->fh, frame_index->data,
+                         fib.num_entries * (guint)sizeof(frame_index_entry_t),
+                         err, err_info)) {
+        g_array_free(frame_index, TRUE);
+        frame_index = NULL;
+        goto done;
+    }
+    for (i = 0; i < fib.num_entries; i++) {
+        entry = &g_array_index(frame_index, frame_index_entry_t, i);
+        if (pcapng->byte_swapped) {
+            entry->offset       = GUINT64_SWAP_LE_BE(entry->offset);
+            entry->frame_number = GUINT64_SWAP_LE_BE(entry->frame_number);
+            entry->timestamp    = GUINT64_SWAP_LE_BE(entry->timestamp);
+            entry->run_offset   = GUINT64_SWAP_LE_BE(entry->run_offset);
+        }
+        /* A run of packet blocks can't start after a block in it. */
+        if (entry->run_offset > entry->offset) {
+            g_array_free(frame_index, TRUE);
+            frame_index = NULL;
+            goto done;
+        }
+    }
+    pcapng_debug("pcapng_read_frame_index: %u entries", fib.num_entries);
+
+done:
+    if (*err != 0 && *err != WTAP_ERR_SHORT_READ) {
+        if (frame_index != NULL)
+            g_array_free(frame_index, TRUE);
+        return FALSE;
+    }
+    *err = 0;
+    g_free(*err_info);
+    *err_info = NULL;
+    pcapng->frame_index = frame_index;
+    if (file_seek(wth->fh, saved_offset, SEEK_SET, err) == -1)
+        return FALSE;
+    return TRUE;
+}
+
+/*
+ * If we have a frame index, jump to the last indexed packet before ts,
+ * if that's after the current position.
+ *
+ * As with the walk in pcapng_seek_time(), we mustn't skip any block other
+ * than an EPB, as pcapng_read() might have to process it for the packets
+ * that follow it, so we only jump to a packet if we're within the run of
+ * EPBs that leads up to it.  If we're not, we jump to the last indexed
+ * packet in our own run, if any, and let the walk take us to the next
+ * block that isn't an EPB; once it has processed that block, it asks us
+ * again.
+ *
+ * The index is checked against the packet block it points to; if they
+ * don't agree, for example because the file was concatenated with another
+ * one, we stop using it.
+ */
+static gboolean
+pcapng_seek_frame_index(wtap *wth, pcapng_t *pcapng, const nstime_t *ts,
+                        int *err, gchar **err_info)
+{
+    frame_index_entry_t *entry;
+    pcapng_block_header_t bh;
+    pcapng_enhanced_packet_block_t epb;
+    interface_info_t iface_info;
+    guint64 target, block_ts, epb_ns;
+    gint64 cur_offset;
+    guint lo, hi, mid, last;
+
+    if (!pcapng->frame_index_checked) {
+        if (!pcapng_read_frame_index(wth, pcapng, err, err_info))
+            return FALSE;
+    }
+    if (pcapng->frame_index == NULL || ts->secs < 0)
+        return TRUE;
+    target = (guint64)ts->secs * 1000000000 + ts->nsecs;
+
+    /* Find the first entry at or after ts; we want the one before it. */
+    lo = 0;
+    hi = pcapng->frame_index->len;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (g_array_index(pcapng->frame_index, frame_index_entry_t, mid).timestamp < target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return TRUE;
+    last = lo - 1;
+
+    /*
+     * Runs start in file order, so find the last entry up to that one
+     * whose run starts at or before where we are.
+     */
+    cur_offset = file_tell(wth->fh);
+    lo = 0;
+    hi = last + 1;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if ((gint64)g_array_index(pcapng->frame_index, frame_index_entry_t, mid).run_offset <= cur_offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return TRUE;
+    entry = &g_array_index(pcapng->frame_index, frame_index_entry_t, lo - 1);
+    if ((gint64)entry->offset <= cur_offset)
+        return TRUE;
+
+    if (file_seek(wth->fh, entry->offset, SEEK_SET, err) == -1)
+        return FALSE;
+    if (wtap_read_bytes(wth->fh, &bh, sizeof bh, err, err_info) &&
+        wtap_read_bytes(wth->fh, &epb, sizeof epb, err, err_info)) {
+        if (pcapng->byte_swapped) {
+            bh.block_type      = GUINT32_SWAP_LE_BE(bh.block_type);
+            epb.interface_id   = GUINT32_SWAP_LE_BE(epb.interface_id);
+            epb.timestamp_high = GUINT32_SWAP_LE_BE(epb.timestamp_high);
+            epb.timestamp_low  = GUINT32_SWAP_LE_BE(epb.timestamp_low);
+        }
+        if (bh.block_type == BLOCK_TYPE_EPB &&
+            epb.interface_id < pcapng->interfaces->len) {
+            iface_info = g_array_index(pcapng->interfaces, interface_info_t,
+                                       epb.interface_id);
+            block_ts = (((guint64)epb.timestamp_high) << 32) | ((guint64)epb.timestamp_low);
+            epb_ns = (block_ts / iface_info.time_units_per_second) * 1000000000 +
+                     ((block_ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second;
+            if (epb_ns == entry->timestamp) {
+                /* The index is good; the walk continues from here. */
+                return file_seek(wth->fh, entry->offset, SEEK_SET, err) != -1;
+            }
+        }
+    } else if (*err != 0 && *err != WTAP_ERR_SHORT_READ) {
+        return FALSE;
+    }
+
+    pcapng_debug("pcapng_seek_frame_index: index doesn't match the file, ignoring it");
+    *err = 0;
+    g_free(*err_info);
+    *err_info = NULL;
+    g_array_free(pcapng->frame_index, TRUE);
+    pcapng->frame_index = NULL;
+    return file_seek(wth->fh, cur_offset, SEEK_SET, err) != -1;
+}
+
+/*
+ * classic wtap: skip forward over Enhanced Packet Blocks with time stamps
+ * before ts, looking only at the block header and the fixed part of the
+ * EPB rather than reading the packet data and options.
+ *
+ * Blocks that aren't packet blocks, such as IDBs, NRBs, ISBs or custom
+ * blocks, are read and processed on the way, just as pcapng_read() would
+ * do, as the packets that follow might depend on them.  We stop in front
+ * of any other type of packet block, as getting its time stamp is more
+ * work; our caller reads forward from there.
+ */
+static gboolean
+pcapng_seek_time(wtap *wth, const nstime_t *ts, int *err, gchar **err_info)
+{
+    pcapng_t *pcapng = (pcapng_t *)wth->priv;
+    pcapng_block_header_t bh;
+    pcapng_enhanced_packet_block_t epb;
+    wtapng_block_t wblock;
+    interface_info_t iface_info;
+    gint64 block_off;
+    guint64 block_ts;
+    nstime_t epb_ts;
+
+    if (!pcapng_seek_frame_index(wth, pcapng, ts, err, err_info))
+        return FALSE;
+
+    wblock.frame_buffer  = wth->frame_buffer;
+    wblock.packet_header = &wth->phdr;
+
+    pcapng->add_new_ipv4 = wth->add_new_ipv4;
+    pcapng->add_new_ipv6 = wth->add_new_ipv6;
+
+    for (;;) {
+        block_off = file_tell(wth->fh);
+        if (!wtap_read_bytes_or_eof(wth->fh, &bh, sizeof bh, err, err_info))
+            break;
+        if (pcapng->byte_swapped) {
+            bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+            bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+        }
+        switch (bh.block_type) {
+
+            case(BLOCK_TYPE_EPB):
+                break;
+
+            case(BLOCK_TYPE_PB):
+            case(BLOCK_TYPE_SPB):
+            case(BLOCK_TYPE_SYSDIG_EVENT):
+            case(BLOCK_TYPE_SYSDIG_EVF):
+                goto done;
+
+            default:
+                /*
+                 * Not a packet block; process it, as pcapng_read()
+                 * would, and carry on after it.  If it's bogus, stop
+                 * in front of it and let pcapng_read() report that.
+                 */
+                if (file_seek(wth->fh, block_off, SEEK_SET, err) == -1)
+                    return FALSE;
+                if (pcapng_read_block(wth, wth->fh, pcapng, &wblock, err, err_info) != PCAPNG_BLOCK_OK) {
+                    wtap_block_free(wblock.block);
+                    goto done;
+                }
+                pcapng_process_block(wth, pcapng, &wblock);
+                if (!pcapng_seek_frame_index(wth, pcapng, ts, err, err_info))
+                    return FALSE;
+                continue;
+        }
+        if (bh.block_total_length < MIN_EPB_SIZE ||
+            (bh.block_total_length % 4) != 0 ||
+            bh.block_total_length > MAX_BLOCK_SIZE)
+            break;
+        if (!wtap_read_bytes_or_eof(wth->fh, &epb, sizeof epb, err, err_info))
+            break;
+        if (pcapng->byte_swapped) {
+            epb.interface_id   = GUINT32_SWAP_LE_BE(epb.interface_id);
+            epb.timestamp_high = GUINT32_SWAP_LE_BE(epb.timestamp_high);
+            epb.timestamp_low  = GUINT32_SWAP_LE_BE(epb.timestamp_low);
+        }
+        if (epb.interface_id >= pcapng->interfaces->len)
+            break;
+        iface_info = g_array_index(pcapng->interfaces, interface_info_t,
+                                   epb.interface_id);
+
+        block_ts = (((guint64)epb.timestamp_high) << 32) | ((guint64)epb.timestamp_low);
+        epb_ts.secs = (time_t)(block_ts / iface_info.time_units_per_second);
+        epb_ts.nsecs = (int)(((block_ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second);
+        if (nstime_cmp(&epb_ts, ts) >= 0)
+            break;
+
+        if (file_seek(wth->fh, block_off + bh.block_total_length, SEEK_SET, err) == -1)
+            return FALSE;
+    }
+
+done:
+    /*
+     * Go back to the start of the block we stopped at; if that was
+     * because of an EOF, short read or bogus block, pcapng_read()
+     * will report it.
+     */
+    *err = 0;
+    g_free(*err_info);
+    *err_info = NULL;
+    if (file_seek(wth->fh, block_off, SEEK_SET, err) == -1)
+        return FALSE;
+    return TRUE;
+}
+
+
 /* classic wtap: close capture file */
 static void
 pcapng_close(wtap *wth)
@@ -2719,6 +3145,8 @@ pcapng_close(wtap *wth)
 
     pcapng_debug("pcapng_close: closing file");
     g_array_free(pcapng->interfaces, TRUE);
+    if (pcapng->frame_index != NULL)
+        g_array_free(pcapng->frame_index, TRUE);
 }
 
 typedef struct pcapng_block_size_t
@@ -2945,6 +3373,8 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     gboolean have_options = FALSE;
     guint32 options_total_length = 0;
     struct option option_hdr;
+    const guint8 *comment;
+    guint16 opt_comment_len;
     guint32 comment_len = 0, comment_pad_len = 0;
     wtap_block_t int_data;
     wtapng_if_descr_mandatory_t *int_data_mand;
@@ -2962,10 +3392,19 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
         pad_len = 0;
     }
 
-    /* Check if we should write comment option */
+    /* Check if we should write comment option; if it came from a
+       pcapng file and hasn't been decoded, copy it straight over */
     if (phdr->opt_comment) {
-        have_options = TRUE;
+        comment = (const guint8 *)phdr->opt_comment;
         comment_len = (guint32)strlen(phdr->opt_comment) & 0xffff;
+    } else if ((comment = pcapng_find_packet_option(phdr, OPT_COMMENT, &opt_comment_len)) != NULL &&
+               opt_comment_len > 0) {
+        comment_len = opt_comment_len;
+    } else {
+        comment = NULL;
+    }
+    if (comment) {
+        have_options = TRUE;
         if ((comment_len % 4)) {
             comment_pad_len = 4 - (comment_len % 4);
         } else {
@@ -3065,7 +3504,7 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
      *                                between this packet and the preceding one.
      * opt_endofopt    0   0          It delimits the end of the optional fields. This block cannot be repeated within a given list of options.
      */
-    if (phdr->opt_comment) {
+    if (comment) {
         option_hdr.type         = OPT_COMMENT;
         option_hdr.value_length = comment_len;
         if (!wtap_dump_file_write(wdh, &option_hdr, 4, err))
@@ -3073,8 +3512,8 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
         wdh->bytes_dumped += 4;
 
         /* Write the comments string */
-        pcapng_debug("pcapng_write_enhanced_packet_block, comment:'%s' comment_len %u comment_pad_len %u" , phdr->opt_comment, comment_len, comment_pad_len);
-        if (!wtap_dump_file_write(wdh, phdr->opt_comment, comment_len, err))
+        pcapng_debug("pcapng_write_enhanced_packet_block, comment_len %u comment_pad_len %u" , comment_len, comment_pad_len);
+        if (!wtap_dump_file_write(wdh, comment, comment_len, err))
             return FALSE;
         wdh->bytes_dumped += comment_len;
 
@@ -4035,10 +4474,62 @@ pcapng_write_if_descr_block(wtap_dumper *wdh, wtap_block_t int_data, int *err)
     return TRUE;
 }
 
+/*
+ * Private per-wtap_dumper_t data, if we're writing a frame index.
+ */
+typedef struct {
+    frame_index_t frame_index;
+} pcapng_dump_t;
+
+void
+pcapng_dump_set_frame_index(wtap_dumper *wdh, guint32 packets, guint32 msecs)
+{
+    pcapng_dump_t *pcapng_dump;
+
+    if (wdh->priv != NULL) {
+        pcapng_dump = (pcapng_dump_t *)wdh->priv;
+        frame_index_cleanup(&pcapng_dump->frame_index);
+    } else {
+        pcapng_dump = (pcapng_dump_t *)g_malloc0(sizeof(pcapng_dump_t));
+        wdh->priv = pcapng_dump;
+    }
+    frame_index_init(&pcapng_dump->frame_index, packets, msecs);
+}
+
+static gboolean
+pcapng_write_frame_index_block(wtap_dumper *wdh, GArray *frame_index, int *err)
+{
+    pcapng_block_header_t bh;
+    pcapng_frame_index_block_t fib;
+    guint32 entries_len;
+
+    entries_len = frame_index->len * (guint32)sizeof(frame_index_entry_t);
+    bh.block_type = BLOCK_TYPE_FIB;
+    bh.block_total_length = MIN_FIB_SIZE + entries_len;
+    fib.magic = PCAPNG_FRAME_INDEX_MAGIC;
+    fib.num_entries = frame_index->len;
+
+    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof bh;
+    if (!wtap_dump_file_write(wdh, &fib, sizeof fib, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof fib;
+    if (!wtap_dump_file_write(wdh, frame_index->data, entries_len, err))
+        return FALSE;
+    wdh->bytes_dumped += entries_len;
+    if (!wtap_dump_file_write(wdh, &bh.block_total_length,
+                              sizeof bh.block_total_length, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof bh.block_total_length;
+    return TRUE;
+}
+
 static gboolean pcapng_dump(wtap_dumper *wdh,
                             const struct wtap_pkthdr *phdr,
                             const guint8 *pd, int *err, gchar **err_info _U_)
 {
+    gint64 offset = wdh->bytes_dumped;
     const union wtap_pseudo_header *pseudo_header = &phdr->pseudo_header;
 #ifdef HAVE_PLUGINS
     block_handler *handler;
@@ -4054,6 +4545,13 @@ static gboolean pcapng_dump(wtap_dumper *wdh,
             if (!pcapng_write_enhanced_packet_block(wdh, phdr, pseudo_header, pd, err)) {
                 return FALSE;
             }
+            if (wdh->priv != NULL) {
+                frame_index_add(&((pcapng_dump_t *)wdh->priv)->frame_index,
+                                offset, wdh->bytes_dumped,
+                                (phdr->presence_flags & WTAP_HAS_TS) && phdr->ts.secs >= 0 ?
+                                    (guint64)phdr->ts.secs * 1000000000 + phdr->ts.nsecs :
+                                    FRAME_INDEX_NO_TIMESTAMP);
+            }
             break;
 
         case REC_TYPE_FT_SPECIFIC_EVENT:
@@ -4097,6 +4595,8 @@ static gboolean pcapng_dump(wtap_dumper *wdh,
    Returns TRUE on success, FALSE on failure. */
 static gboolean pcapng_dump_finish(wtap_dumper *wdh, int *err)
 {
+    pcapng_dump_t *pcapng_dump = (pcapng_dump_t *)wdh->priv;
+    gboolean ret = TRUE;
     guint i, j;
 
     /* Flush any hostname resolution info we may have */
@@ -4117,13 +4617,23 @@ static gboolean pcapng_dump_finish(wtap_dumper *wdh, int *err)
             if_stats = g_array_index(int_data_mand->interface_statistics, wtap_block_t, j);
             pcapng_debug("pcapng_dump_finish: write ISB for interface %u", ((wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(if_stats))->interface_id);
             if (!pcapng_write_interface_statistics_block(wdh, if_stats, err)) {
-                return FALSE;
+                ret = FALSE;
+                goto done;
             }
         }
     }
 
+    /* The frame index must be the last block in the file. */
+    if (pcapng_dump != NULL && pcapng_dump->frame_index.entries->len != 0) {
+        if (!pcapng_write_frame_index_block(wdh, pcapng_dump->frame_index.entries, err))
+            ret = FALSE;
+    }
+
+done:
+    if (pcapng_dump != NULL)
+        frame_index_cleanup(&pcapng_dump->frame_index);
     pcapng_debug("pcapng_dump_finish");
-    return TRUE;
+    return ret;
 }
 
 
@@ -23,6 +23,7 @@
 
 #include <glib.h>
 #include "wtap.h"
+#include <wsutil/frame_index.h>
 #include "ws_symbol_export.h"
 
 /* pcapng: common block header file encoding for every block type */
@@ -59,6 +60,20 @@ typedef struct pcapng_interface_statistics_block_s {
     /* ... Options ... */
 } pcapng_interface_statistics_block_t;
 
+/* pcapng: frame index block file encoding; a local-use block, written
+   as the last block of the file by dumpcap and by our dumper, so its
+   magic number is what identifies it */
+typedef struct pcapng_frame_index_block_s {
+    guint32 magic;
+    guint32 num_entries;
+    /* ... Entries ... */
+} pcapng_frame_index_block_t;
+
+#define PCAPNG_FRAME_INDEX_MAGIC 0x46494458     /* "FIDX" */
+
+/* pcapng: frame index entry file encoding is frame_index_entry_t, from
+   wsutil/frame_index.h */
+
 struct pcapng_option_header {
     guint16 type;
     guint16 value_length;
@@ -70,7 +85,9 @@ struct pcapng_option_header {
 #define MIN_IDB_SIZE    ((guint32)(MIN_BLOCK_SIZE + sizeof(pcapng_interface_description_block_t)))
 
 wtap_open_return_val pcapng_open(wtap *wth, int *err, gchar **err_info);
+void pcapng_decode_packet_options(struct wtap_pkthdr *phdr);
 gboolean pcapng_dump_open(wtap_dumper *wdh, int *err);
+void pcapng_dump_set_frame_index(wtap_dumper *wdh, guint32 packets, guint32 msecs);
 int pcapng_dump_can_write_encap(int encap);
 
 #endif
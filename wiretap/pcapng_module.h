@@ -31,6 +31,7 @@
 #define BLOCK_TYPE_SYSDIG_EVENT 0x00000204 /* Sysdig Event Block */
 #define BLOCK_TYPE_SYSDIG_EVF   0x00000208 /* Sysdig Event Block with flags */
 #define BLOCK_TYPE_SHB 0x0A0D0D0A /* Section Header Block */
+#define BLOCK_TYPE_FIB 0x80000F1D /* Frame Index Block (local use) */
 /* TODO: the following are not yet well defined in the draft spec:
  * Compression Block
  * Encryption Block
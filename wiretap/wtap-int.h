@@ -40,6 +40,8 @@ typedef gboolean (*subtype_read_func)(struct wtap*, int*, char**, gint64*);
 typedef gboolean (*subtype_seek_read_func)(struct wtap*, gint64,
                                            struct wtap_pkthdr *, Buffer *buf,
                                            int *, char **);
+typedef gboolean (*subtype_seek_time_func)(struct wtap*, const nstime_t *,
+                                           int *, char **);
 
 /**
  * Struct holding data of the currently read file.
@@ -60,6 +62,7 @@ struct wtap {
 
     subtype_read_func           subtype_read;
     subtype_seek_read_func      subtype_seek_read;
+    subtype_seek_time_func      subtype_seek_time;      /**< position fh at or before the first record at or after a time, or NULL */
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
     int                         file_encap;    /* per-file, for those
@@ -81,9 +84,11 @@ struct wtap {
     wtap_new_ipv4_callback_t    add_new_ipv4;
     wtap_new_ipv6_callback_t    add_new_ipv6;
     GPtrArray                   *fast_seek;
+    gchar                       *fast_seek_index_path;  /**< sidecar to save fast_seek to, or NULL */
 };
 
 struct wtap_dumper;
+struct wtap_dump_async;
 
 /*
  * This could either be a FILE * or a gzFile.
@@ -100,8 +105,9 @@ struct wtap_dumper {
     int                     file_type_subtype;
     int                     snaplen;
     int                     encap;
-    gboolean                compressed;
+    wtap_compression_type   compression_type;
     gint64                  bytes_dumped;
+    struct wtap_dump_async  *async;         /**< background writer, or NULL if writing synchronously */
 
     void                    *priv;          /* this one holds per-file state and is free'd automatically by wtap_dump_close() */
     void                    *wslua_data;    /* this one holds wslua state info and is not free'd */
@@ -1147,6 +1147,15 @@ wtap_sequential_close(wtap *wth)
 		(*wth->subtype_sequential_close)(wth);
 
 	if (wth->fh != NULL) {
+		/*
+		 * If the sequential pass read all of a compressed file,
+		 * the fast seek points are complete; save them, so the
+		 * next open doesn't have to decompress the file again.
+		 */
+		if (wth->fast_seek_index_path != NULL &&
+		    file_iscompressed(wth->fh) && file_eof(wth->fh))
+			file_fast_seek_index_write(wth->fh, wth->fast_seek,
+			    wth->fast_seek_index_path);
 		file_close(wth->fh);
 		wth->fh = NULL;
 	}
@@ -1197,6 +1206,7 @@ wtap_close(wtap *wth)
 		g_ptr_array_foreach(wth->fast_seek, g_fast_seek_item_free, NULL);
 		g_ptr_array_free(wth->fast_seek, TRUE);
 	}
+	g_free(wth->fast_seek_index_path);
 
 	wtap_block_array_free(wth->shb_hdrs);
 	wtap_block_array_free(wth->nrb_hdrs);
@@ -1272,6 +1282,36 @@ wtap_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 	return TRUE;	/* success */
 }
 
+gboolean
+wtap_seek_time(wtap *wth, const nstime_t *ts, int *err, gchar **err_info,
+    gint64 *data_offset)
+{
+	*err = 0;
+	*err_info = NULL;
+	if (wth->subtype_seek_time != NULL) {
+		/*
+		 * Let the file type skip over as much of the file as
+		 * it can cheaply; it'll leave us at or before the
+		 * record we want.
+		 */
+		if (!wth->subtype_seek_time(wth, ts, err, err_info))
+			return FALSE;
+	}
+
+	/*
+	 * Read forward to the first record at or after the time we
+	 * were handed.  Records without time stamps are skipped, as
+	 * we can't tell where they fall.
+	 */
+	for (;;) {
+		if (!wtap_read(wth, err, err_info, data_offset))
+			return FALSE;
+		if ((wth->phdr.presence_flags & WTAP_HAS_TS) &&
+		    nstime_cmp(&wth->phdr.ts, ts) >= 0)
+			return TRUE;
+	}
+}
+
 /*
  * Read a given number of bytes from a file into a buffer or, if
  * buf is NULL, just discard them.
@@ -1386,6 +1426,25 @@ wtap_phdr_cleanup(struct wtap_pkthdr *phdr)
 	ws_buffer_free(&phdr->ft_specific_data);
 }
 
+void
+wtap_phdr_decode_options(struct wtap_pkthdr *phdr)
+{
+	/*
+	 * Only pcapng defers decoding its packet options at the moment;
+	 * it leaves them in ft_specific_data.
+	 */
+	if (phdr->presence_flags & WTAP_HAS_PACKET_OPTIONS)
+		pcapng_decode_packet_options(phdr);
+}
+
+const gchar *
+wtap_phdr_get_comment(struct wtap_pkthdr *phdr)
+{
+	if (phdr->opt_comment == NULL && (phdr->presence_flags & WTAP_HAS_COMMENTS))
+		wtap_phdr_decode_options(phdr);
+	return phdr->opt_comment;
+}
+
 gboolean
 wtap_seek_read(wtap *wth, gint64 seek_off,
 	struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info)
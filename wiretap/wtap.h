@@ -1253,6 +1253,7 @@ struct wtap_pkthdr {
 #define WTAP_HAS_COMMENTS      0x00000008  /**< comments */
 #define WTAP_HAS_DROP_COUNT    0x00000010  /**< drop count */
 #define WTAP_HAS_PACK_FLAGS    0x00000020  /**< packet flags */
+#define WTAP_HAS_PACKET_OPTIONS 0x00000040 /**< options not yet decoded; see wtap_phdr_get_comment() */
 
 /**
  * Holds the required data from pcapng:s Section Header block(SHB).
@@ -1343,6 +1344,15 @@ typedef struct wtap_dumper wtap_dumper;
 
 typedef struct wtap_reader *FILE_T;
 
+/** Types of compression for a file being written. */
+typedef enum {
+    WTAP_UNKNOWN_COMPRESSION = -1,
+    WTAP_UNCOMPRESSED,
+    WTAP_GZIP_COMPRESSED,
+    WTAP_ZSTD_COMPRESSED,   /**< zstd, in independent frames with a seek table */
+    WTAP_LZ4_COMPRESSED     /**< lz4, in independent frames */
+} wtap_compression_type;
+
 /* Similar to the wtap_open_routine_info for open routines, the following
  * wtap_wslua_file_info struct is used by wslua code for Lua-based file writers.
  *
@@ -1516,6 +1526,52 @@ struct file_type_subtype_info {
 WS_DLL_PUBLIC
 void wtap_init(void);
 
+/** Suffix appended to a capture file's name to get the name of its
+ * fast seek index sidecar file. */
+#define WTAP_FAST_SEEK_INDEX_SUFFIX ".fsidx"
+
+/**
+ * Enable or disable the fast seek index sidecar file.
+ *
+ * Random access to a compressed capture file requires seek points that
+ * are built while decompressing the whole file during the first pass.
+ * If enabled, those seek points are saved to "<filename>.fsidx" when
+ * the sequential pass reaches the end of a compressed file, and loaded
+ * from it by later wtap_open_offline() calls with do_random set, so
+ * random access works without decompressing the file again.  The index
+ * is ignored if the capture file's size or modification time changed.
+ *
+ * @param enable TRUE to use sidecar files, FALSE (the default) not to
+ */
+WS_DLL_PUBLIC
+void wtap_set_fast_seek_index(gboolean enable);
+
+/**
+ * Set the size of the read buffers for the sequential stream of files
+ * opened by later wtap_open_offline() calls.
+ *
+ * By default both the sequential and the random-access streams read
+ * the file a file system block at a time, which suits picking out
+ * single records but makes for a great many small reads on a pass
+ * through a large file on fast local storage or a high-latency network
+ * file system.  With a non-zero size, the sequential stream reads size
+ * bytes at a time (capped at 64 MiB), and where the OS supports it the
+ * file is marked for sequential access and kept being read ahead of the
+ * reader.  The random-access stream always keeps the small buffers and
+ * is marked for random access.  Pipes, including a standard input that
+ * is one, always keep the small buffers, so that records are handed out
+ * as they arrive.
+ *
+ * @param size buffer size in bytes; 1 to 8 MiB is a good range, and 0
+ * (the default) turns large buffers off
+ */
+WS_DLL_PUBLIC
+void wtap_set_sequential_read_buffer_size(guint size);
+
+/** A good wtap_set_sequential_read_buffer_size() size for programs that
+ * make a pass through the whole file */
+#define WTAP_SEQUENTIAL_READ_BUFFER_SIZE (4 * 1024 * 1024)
+
 /** On failure, "wtap_open_offline()" returns NULL, and puts into the
  * "int" pointed to by its second argument:
  *
@@ -1559,6 +1615,29 @@ WS_DLL_PUBLIC
 gboolean wtap_read(wtap *wth, int *err, gchar **err_info,
     gint64 *data_offset);
 
+/**
+ * Skip forward to the first record whose time stamp is at or after a
+ * given time, and read it, as wtap_read() would.  Records before it
+ * are skipped without being returned.
+ *
+ * This assumes the records in the file are in time stamp order (or
+ * close to it); for pcap and pcapng files, the search does not read
+ * every record before the one found, so records out of order around
+ * the requested time might be skipped.  The search starts at the
+ * current position in the file; it never goes backwards.
+ *
+ * @param wth The wtap to read from
+ * @param ts The time stamp to look for
+ * @param[out] err Set to a WTAP_ERR_ or errno value on failure
+ * @param[out] err_info Set to additional error information on failure
+ * @param[out] data_offset Set as for wtap_read()
+ * @return TRUE if a record was read, FALSE on EOF or failure, as
+ * for wtap_read()
+ */
+WS_DLL_PUBLIC
+gboolean wtap_seek_time(wtap *wth, const nstime_t *ts, int *err,
+    gchar **err_info, gint64 *data_offset);
+
 WS_DLL_PUBLIC
 gboolean wtap_seek_read (wtap *wth, gint64 seek_off,
         struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
@@ -1577,6 +1656,15 @@ void wtap_phdr_init(struct wtap_pkthdr *phdr);
 WS_DLL_PUBLIC
 void wtap_phdr_cleanup(struct wtap_pkthdr *phdr);
 
+/*** fill in opt_comment and drop_count from options the file format
+ *** left undecoded (WTAP_HAS_PACKET_OPTIONS) ***/
+WS_DLL_PUBLIC
+void wtap_phdr_decode_options(struct wtap_pkthdr *phdr);
+
+/*** get the packet comment, decoding it if necessary; NULL if there is none ***/
+WS_DLL_PUBLIC
+const gchar *wtap_phdr_get_comment(struct wtap_pkthdr *phdr);
+
 /*** get various information snippets about the current file ***/
 
 /** Return an approximation of the amount of data we've read sequentially
@@ -1746,6 +1834,41 @@ int wtap_dump_file_encap_type(const GArray *file_encaps);
 WS_DLL_PUBLIC
 gboolean wtap_dump_can_compress(int filetype);
 
+/**
+ * Return TRUE if we can write files with the given compression type,
+ * FALSE if not (because support for it wasn't built in).
+ */
+WS_DLL_PUBLIC
+gboolean wtap_can_write_compression_type(wtap_compression_type compression_type);
+
+/**
+ * Return the compression type with the given short name ("gzip", "zstd",
+ * "lz4", or "none"), or WTAP_UNKNOWN_COMPRESSION if there's no such
+ * type we can write.
+ */
+WS_DLL_PUBLIC
+wtap_compression_type wtap_name_to_compression_type(const char *name);
+
+/** Return the short name of a compression type, or NULL if we can't
+ * write it. */
+WS_DLL_PUBLIC
+const char *wtap_compression_type_name(wtap_compression_type compression_type);
+
+/** Return a description of a compression type, or NULL if we can't
+ * write it. */
+WS_DLL_PUBLIC
+const char *wtap_compression_type_description(wtap_compression_type compression_type);
+
+/** Return the file extension for a compression type, without the
+ * leading ".", or NULL for uncompressed files. */
+WS_DLL_PUBLIC
+const char *wtap_compression_type_extension(wtap_compression_type compression_type);
+
+/** Return a list of the short names of all compression types we can
+ * write; free it with g_slist_free(), but don't free the names. */
+WS_DLL_PUBLIC
+GSList *wtap_get_all_compression_type_names_list(void);
+
 /**
  * Return TRUE if this capture file format supports storing name
  * resolution information in it, FALSE if not.
@@ -1762,7 +1885,7 @@ gboolean wtap_dump_supports_comment_types(int filetype, guint32 comment_types);
 
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open(const char *filename, int file_type_subtype, int encap,
-    int snaplen, gboolean compressed, int *err);
+    int snaplen, wtap_compression_type compression_type, int *err);
 
 /**
  * @brief Opens a new capture file for writing.
@@ -1775,7 +1898,7 @@ wtap_dumper* wtap_dump_open(const char *filename, int file_type_subtype, int enc
  * @param file_type_subtype The WTAP_FILE_TYPE_SUBTYPE_XXX file type.
  * @param encap The WTAP_ENCAP_XXX encapsulation type (WTAP_ENCAP_PER_PACKET for multi)
  * @param snaplen The maximum packet capture length.
- * @param compressed True if file should be compressed.
+ * @param compression_type Type of compression to use when writing, if any.
  * @param shb_hdrs The section header block(s) information, or NULL.
  * @param idb_inf The interface description information, or NULL.
  * @param nrb_hdrs The name resolution blocks(s) comment/custom_opts information, or NULL.
@@ -1784,12 +1907,12 @@ wtap_dumper* wtap_dump_open(const char *filename, int file_type_subtype, int enc
  */
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open_ng(const char *filename, int file_type_subtype, int encap,
-    int snaplen, gboolean compressed, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
+    int snaplen, wtap_compression_type compression_type, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
     GArray* nrb_hdrs, int *err);
 
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open_tempfile(char **filenamep, const char *pfx,
-    int file_type_subtype, int encap, int snaplen, gboolean compressed,
+    int file_type_subtype, int encap, int snaplen, wtap_compression_type compression_type,
     int *err);
 
 /**
@@ -1805,7 +1928,7 @@ wtap_dumper* wtap_dump_open_tempfile(char **filenamep, const char *pfx,
  * @param file_type_subtype The WTAP_FILE_TYPE_SUBTYPE_XXX file type.
  * @param encap The WTAP_ENCAP_XXX encapsulation type (WTAP_ENCAP_PER_PACKET for multi)
  * @param snaplen The maximum packet capture length.
- * @param compressed True if file should be compressed.
+ * @param compression_type Type of compression to use when writing, if any.
  * @param shb_hdrs The section header block(s) information, or NULL.
  * @param idb_inf The interface description information, or NULL.
  * @param nrb_hdrs The name resolution blocks(s) comment/custom_opts information, or NULL.
@@ -1814,13 +1937,13 @@ wtap_dumper* wtap_dump_open_tempfile(char **filenamep, const char *pfx,
  */
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open_tempfile_ng(char **filenamep, const char *pfx,
-    int file_type_subtype, int encap, int snaplen, gboolean compressed,
+    int file_type_subtype, int encap, int snaplen, wtap_compression_type compression_type,
     GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
     GArray* nrb_hdrs, int *err);
 
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_fdopen(int fd, int file_type_subtype, int encap, int snaplen,
-    gboolean compressed, int *err);
+    wtap_compression_type compression_type, int *err);
 
 /**
  * @brief Creates a dumper for an existing file descriptor.
@@ -1833,7 +1956,7 @@ wtap_dumper* wtap_dump_fdopen(int fd, int file_type_subtype, int encap, int snap
  * @param file_type_subtype The WTAP_FILE_TYPE_SUBTYPE_XXX file type.
  * @param encap The WTAP_ENCAP_XXX encapsulation type (WTAP_ENCAP_PER_PACKET for multi)
  * @param snaplen The maximum packet capture length.
- * @param compressed True if file should be compressed.
+ * @param compression_type Type of compression to use when writing, if any.
  * @param shb_hdrs The section header block(s) information, or NULL.
  * @param idb_inf The interface description information, or NULL.
  * @param nrb_hdrs The name resolution blocks(s) comment/custom_opts information, or NULL.
@@ -1842,12 +1965,12 @@ wtap_dumper* wtap_dump_fdopen(int fd, int file_type_subtype, int encap, int snap
  */
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_fdopen_ng(int fd, int file_type_subtype, int encap, int snaplen,
-                gboolean compressed, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
+                wtap_compression_type compression_type, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
                 GArray* nrb_hdrs, int *err);
 
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open_stdout(int file_type_subtype, int encap, int snaplen,
-    gboolean compressed, int *err);
+    wtap_compression_type compression_type, int *err);
 
 /**
  * @brief Creates a dumper for the standard output.
@@ -1859,7 +1982,7 @@ wtap_dumper* wtap_dump_open_stdout(int file_type_subtype, int encap, int snaplen
  * @param file_type_subtype The WTAP_FILE_TYPE_SUBTYPE_XXX file type.
  * @param encap The WTAP_ENCAP_XXX encapsulation type (WTAP_ENCAP_PER_PACKET for multi)
  * @param snaplen The maximum packet capture length.
- * @param compressed True if file should be compressed.
+ * @param compression_type Type of compression to use when writing, if any.
  * @param shb_hdrs The section header block(s) information, or NULL.
  * @param idb_inf The interface description information, or NULL.
  * @param nrb_hdrs The name resolution blocks(s) comment/custom_opts information, or NULL.
@@ -1868,7 +1991,7 @@ wtap_dumper* wtap_dump_open_stdout(int file_type_subtype, int encap, int snaplen
  */
 WS_DLL_PUBLIC
 wtap_dumper* wtap_dump_open_stdout_ng(int file_type_subtype, int encap, int snaplen,
-                gboolean compressed, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
+                wtap_compression_type compression_type, GArray* shb_hdrs, wtapng_iface_descriptions_t *idb_inf,
                 GArray* nrb_hdrs, int *err);
 
 WS_DLL_PUBLIC
@@ -1876,6 +1999,38 @@ gboolean wtap_dump(wtap_dumper *, const struct wtap_pkthdr *, const guint8 *,
      int *err, gchar **err_info);
 WS_DLL_PUBLIC
 void wtap_dump_flush(wtap_dumper *);
+
+/**
+ * Hand the output of wdh to a background thread from now on, so that a
+ * slow output device doesn't hold up the caller. Data is collected in
+ * two large buffers; while one is being written out, the other one is
+ * filled. A write error is reported by the next wtap_dump() call or by
+ * wtap_dump_close(). Seeking and flushing wait for the pending data to
+ * be written first.
+ *
+ * @param wdh The dumper to write asynchronously.
+ * @return TRUE if writes are now asynchronous, FALSE if they remain
+ *         synchronous (threads not available or couldn't be started).
+ */
+WS_DLL_PUBLIC
+gboolean wtap_dump_set_async(wtap_dumper *wdh);
+
+/**
+ * Write a frame index block at the end of a pcapng file being written,
+ * so that readers can seek to a time without reading all of the packets
+ * before it. An index entry is recorded for the first packet and then
+ * whenever the given number of packets or of milliseconds of capture
+ * time have passed since the last entry. Must be called before the
+ * first wtap_dump() call.
+ *
+ * @param wdh The dumper; it must be writing pcapng.
+ * @param packets Packets between index entries, or 0 to ignore
+ * @param msecs Milliseconds between index entries, or 0 to ignore
+ * @return TRUE if an index will be written, FALSE if it can't be
+ *         (not pcapng, or both intervals 0).
+ */
+WS_DLL_PUBLIC
+gboolean wtap_dump_set_frame_index(wtap_dumper *wdh, guint32 packets, guint32 msecs);
 WS_DLL_PUBLIC
 gint64 wtap_get_bytes_dumped(wtap_dumper *);
 WS_DLL_PUBLIC
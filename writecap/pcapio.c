@@ -151,6 +151,18 @@ struct epb {
 };
 #define ENHANCED_PACKET_BLOCK_TYPE 0x00000006
 
+/* Frame Index Block without entries and trailing Block Total Length.
+   This is a local-use block type (high bit set), so the magic number
+   identifies it as ours; the same layout is read by wiretap/pcapng.c. */
+struct fib {
+        guint32 block_type;
+        guint32 block_total_length;
+        guint32 magic;
+        guint32 num_entries;
+};
+#define FRAME_INDEX_BLOCK_TYPE 0x80000F1D
+#define FRAME_INDEX_MAGIC      0x46494458      /* "FIDX" */
+
 struct option {
         guint16 type;
         guint16 value_length;
@@ -753,6 +765,39 @@ pcapng_write_interface_statistics_block(FILE* pfile,
         return write_to_file(pfile, (const guint8*)&block_total_length, sizeof(guint32), bytes_written, err);
 }
 
+gboolean
+pcapng_write_frame_index_block(FILE* pfile,
+                               const frame_index_entry_t *entries,
+                               guint32 num_entries,
+                               guint64 *bytes_written,
+                               int *err)
+{
+        struct fib fib;
+        guint32 block_total_length;
+        guint32 i;
+
+        block_total_length = (guint32)(sizeof(struct fib) +
+                                       num_entries * 4 * sizeof(guint64) +
+                                       sizeof(guint32));
+        fib.block_type = FRAME_INDEX_BLOCK_TYPE;
+        fib.block_total_length = block_total_length;
+        fib.magic = FRAME_INDEX_MAGIC;
+        fib.num_entries = num_entries;
+        if (!write_to_file(pfile, (const guint8*)&fib, sizeof(struct fib), bytes_written, err))
+                return FALSE;
+        for (i = 0; i < num_entries; i++) {
+                if (!write_to_file(pfile, (const guint8*)&entries[i].offset, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+                if (!write_to_file(pfile, (const guint8*)&entries[i].frame_number, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+                if (!write_to_file(pfile, (const guint8*)&entries[i].timestamp, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+                if (!write_to_file(pfile, (const guint8*)&entries[i].run_offset, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+        }
+        return write_to_file(pfile, (const guint8*)&block_total_length, sizeof(guint32), bytes_written, err);
+}
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
@@ -23,6 +23,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <wsutil/frame_index.h>
+
 /* Writing pcap files */
 
 /** Write the file header to a dump file.
@@ -102,6 +104,18 @@ pcapng_write_enhanced_packet_block(FILE* pfile,
                                    guint64 *bytes_written,
                                    int *err);
 
+/** Write a frame index block, a local-use block that lets readers
+ * seek to a packet by number or time stamp without reading the blocks
+ * before it.  It must be the last block in the file.  Readers that
+ * don't know about it skip it.
+ */
+extern gboolean
+pcapng_write_frame_index_block(FILE* pfile,
+                               const frame_index_entry_t *entries,
+                               guint32 num_entries,
+                               guint64 *bytes_written,
+                               int *err);
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
@@ -0,0 +1,112 @@
+/* frame_index.c
+ * Routines for building the sparse frame index of a pcapng file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "frame_index.h"
+
+void
+frame_index_init(frame_index_t *frame_index, guint32 packets, guint32 msecs)
+{
+    frame_index->entries = g_array_new(FALSE, FALSE, sizeof(frame_index_entry_t));
+    frame_index->packets_base = packets;
+    frame_index->msecs_base = msecs;
+    frame_index_reset(frame_index);
+}
+
+void
+frame_index_reset(frame_index_t *frame_index)
+{
+    g_array_set_size(frame_index->entries, 0);
+    frame_index->frames = 0;
+    frame_index->run_offset = 0;
+    frame_index->run_end = 0;
+    frame_index->packets = frame_index->packets_base;
+    frame_index->msecs = frame_index->msecs_base;
+}
+
+void
+frame_index_add(frame_index_t *frame_index, guint64 offset, guint64 end,
+                guint64 timestamp)
+{
+    frame_index_entry_t  entry;
+    frame_index_entry_t *last;
+    guint                i;
+
+    frame_index->frames++;
+    if (offset != frame_index->run_end) {
+        /* Something other than a packet block was written since the last one. */
+        frame_index->run_offset = offset;
+    }
+    frame_index->run_end = end;
+
+    if (timestamp == FRAME_INDEX_NO_TIMESTAMP)
+        return;
+    if (frame_index->entries->len != 0) {
+        last = &g_array_index(frame_index->entries, frame_index_entry_t,
+                              frame_index->entries->len - 1);
+        if (!(frame_index->packets != 0 &&
+              frame_index->frames >= last->frame_number + frame_index->packets) &&
+            !(frame_index->msecs != 0 &&
+              timestamp >= last->timestamp + (guint64)frame_index->msecs * 1000000))
+            return;
+    }
+    if (frame_index->entries->len == FRAME_INDEX_MAX_ENTRIES) {
+        /* Thin the index out, keeping the first entry. */
+        for (i = 0; 2 * i < frame_index->entries->len; i++) {
+            g_array_index(frame_index->entries, frame_index_entry_t, i) =
+                g_array_index(frame_index->entries, frame_index_entry_t, 2 * i);
+        }
+        g_array_set_size(frame_index->entries, i);
+        frame_index->packets *= 2;
+        frame_index->msecs *= 2;
+    }
+    entry.offset = offset;
+    entry.frame_number = frame_index->frames;
+    entry.timestamp = timestamp;
+    entry.run_offset = frame_index->run_offset;
+    g_array_append_val(frame_index->entries, entry);
+}
+
+void
+frame_index_cleanup(frame_index_t *frame_index)
+{
+    if (frame_index->entries != NULL) {
+        g_array_free(frame_index->entries, TRUE);
+        frame_index->entries = NULL;
+    }
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
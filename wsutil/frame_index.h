@@ -0,0 +1,135 @@
+/* frame_index.h
+ * Definitions for building the sparse frame index of a pcapng file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FRAME_INDEX_H__
+#define __FRAME_INDEX_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * The frame index block written at the end of a pcapng file by dumpcap
+ * and by wiretap's pcapng writer, and read back by wiretap's pcapng
+ * reader.  This is the code the two writers share to decide which
+ * packets get an entry.
+ */
+
+/** One entry in a frame index, as written to the file (in the byte
+ * order of the section). */
+typedef struct {
+    guint64 offset;         /**< offset of the packet's block in the file */
+    guint64 frame_number;   /**< number of the packet in the file, starting at 1 */
+    guint64 timestamp;      /**< packet time stamp, in nanoseconds since the Epoch */
+    guint64 run_offset;     /**< offset of the first of the packet blocks that
+                                 immediately precede this one, with no other
+                                 block between them; a reader at or after it
+                                 can go straight to offset without missing a
+                                 block it needs to process */
+} frame_index_entry_t;
+
+/** A frame index being built. */
+typedef struct {
+    GArray  *entries;       /**< frame_index_entry_t's */
+    guint64  frames;        /**< packets added so far */
+    guint64  run_offset;    /**< start of the current run of packet blocks */
+    guint64  run_end;       /**< end of the last packet block */
+    guint32  packets;       /**< packets between entries - 0 means don't care */
+    guint32  msecs;         /**< milliseconds between entries - 0 means don't care */
+    guint32  packets_base;  /**< packets as given to frame_index_init() */
+    guint32  msecs_base;    /**< msecs as given to frame_index_init() */
+} frame_index_t;
+
+/** Limit on the number of entries in a frame index; when it's reached,
+ * every other entry is dropped and the spacing between entries doubled.
+ */
+#define FRAME_INDEX_MAX_ENTRIES 65536
+
+/** Time stamp to pass to frame_index_add() for packets that don't have
+ * one; they are counted, but don't get an entry. */
+#define FRAME_INDEX_NO_TIMESTAMP G_MAXUINT64
+
+/**
+ * Start a frame index that gets an entry for the first packet, and then
+ * whenever the given number of packets or of milliseconds of capture time
+ * have passed since the last entry.
+ *
+ * @param frame_index The frame index.
+ * @param packets Packets between entries, or 0 to ignore
+ * @param msecs Milliseconds between entries, or 0 to ignore
+ */
+WS_DLL_PUBLIC void
+frame_index_init(frame_index_t *frame_index, guint32 packets, guint32 msecs);
+
+/**
+ * Empty a frame index, to start on a new file.
+ *
+ * @param frame_index The frame index.
+ */
+WS_DLL_PUBLIC void
+frame_index_reset(frame_index_t *frame_index);
+
+/**
+ * Note that a packet block was written, and add an entry for it if it's
+ * far enough from the last one.  Any other block written since the last
+ * packet block starts a new run of packet blocks.
+ *
+ * @param frame_index The frame index.
+ * @param offset Offset of the packet block in the file.
+ * @param end Offset of the end of the packet block in the file.
+ * @param timestamp Time stamp of the packet, in nanoseconds since the Epoch,
+ *                  or FRAME_INDEX_NO_TIMESTAMP.
+ */
+WS_DLL_PUBLIC void
+frame_index_add(frame_index_t *frame_index, guint64 offset, guint64 end,
+                guint64 timestamp);
+
+/**
+ * Free the entries of a frame index.
+ *
+ * @param frame_index The frame index.
+ */
+WS_DLL_PUBLIC void
+frame_index_cleanup(frame_index_t *frame_index);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_INDEX_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -23,6 +23,10 @@
  *
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
 #include <glib.h>
 #include "nstime.h"
 
@@ -299,6 +303,134 @@ nsfiletime_to_nstime(nstime_t *nstime, guint64 nsfiletime)
     return common_filetime_to_nstime(nstime, ftsecs, nsecs);
 }
 
+/*
+ * Parse an optional fraction of a second, consisting of a "." followed by
+ * up to nine digits, at *strp, and advance *strp past it.
+ */
+static gboolean
+parse_fraction(const char **strp, int *nsecs)
+{
+    const char *p = *strp;
+    int scale = NS_PER_S;
+
+    *nsecs = 0;
+    if (*p != '.')
+        return TRUE;
+    p++;
+    if (!g_ascii_isdigit(*p))
+        return FALSE;
+    while (g_ascii_isdigit(*p)) {
+        if (scale == 1)
+            return FALSE;   /* more precision than we can represent */
+        scale /= 10;
+        *nsecs += (*p - '0') * scale;
+        p++;
+    }
+    *strp = p;
+    return TRUE;
+}
+
+/*
+ * function: nstime_from_str
+ * converts "YYYY-MM-DD hh:mm:ss[.fraction]", in local time, or
+ * "[-]seconds[.fraction]", relative to the Epoch, to an nstime_t
+ * returns TRUE if the conversion succeeds, FALSE if it doesn't
+ */
+gboolean
+nstime_from_str(nstime_t *nstime, const char *str)
+{
+    struct tm tm;
+    int year, mon, mday, hour, min, sec, len;
+    const char *p;
+    gchar *endp;
+    gint64 secs;
+    gboolean negative;
+    int nsecs;
+    time_t t;
+
+    while (g_ascii_isspace(*str))
+        str++;
+
+    len = 0;
+    if (sscanf(str, "%4d-%2d-%2d %2d:%2d:%2d%n", &year, &mon, &mday,
+               &hour, &min, &sec, &len) == 6 && len != 0) {
+        p = str + len;
+        if (!parse_fraction(&p, &nsecs) || *p != '\0')
+            return FALSE;
+        if (mon < 1 || mon > 12 || mday < 1 || mday > 31 ||
+            hour > 23 || min > 59 || sec > 60)
+            return FALSE;
+
+        memset(&tm, 0, sizeof tm);
+        tm.tm_year = year - 1900;
+        tm.tm_mon = mon - 1;
+        tm.tm_mday = mday;
+        tm.tm_hour = hour;
+        tm.tm_min = min;
+        tm.tm_sec = sec;
+        tm.tm_isdst = -1;
+        t = mktime(&tm);
+        if (t == (time_t)-1)
+            return FALSE;
+        nstime->secs = t;
+        nstime->nsecs = nsecs;
+        return TRUE;
+    }
+
+    negative = (*str == '-');
+    if (!g_ascii_isdigit(str[negative ? 1 : 0]))
+        return FALSE;
+    secs = g_ascii_strtoll(str + (negative ? 1 : 0), &endp, 10);
+    p = endp;
+    if (!parse_fraction(&p, &nsecs) || *p != '\0')
+        return FALSE;
+    if (negative) {
+        secs = -secs;
+        if (nsecs != 0) {
+            secs--;
+            nsecs = NS_PER_S - nsecs;
+        }
+    }
+    nstime->secs = (time_t)secs;
+    if ((gint64)nstime->secs != secs)
+        return FALSE;   /* overflows time_t */
+    nstime->nsecs = nsecs;
+    return TRUE;
+}
+
+/*
+ * function: nstime_range_from_str
+ * converts "start,stop" to a pair of nstime_t's; an empty start or
+ * stop time is returned as "unset"
+ * returns TRUE if the conversion succeeds, FALSE if it doesn't
+ */
+gboolean
+nstime_range_from_str(nstime_t *start, nstime_t *stop, const char *str)
+{
+    const char *comma;
+    gchar *start_str;
+    gboolean ok;
+
+    comma = strchr(str, ',');
+    if (comma == NULL)
+        return FALSE;
+
+    nstime_set_unset(start);
+    nstime_set_unset(stop);
+    if (comma != str) {
+        start_str = g_strndup(str, comma - str);
+        ok = nstime_from_str(start, start_str);
+        g_free(start_str);
+        if (!ok)
+            return FALSE;
+    }
+    if (comma[1] != '\0') {
+        if (!nstime_from_str(stop, comma + 1))
+            return FALSE;
+    }
+    return TRUE;
+}
+
 /*
  * Editor modelines
  *
@@ -111,6 +111,19 @@ WS_DLL_PUBLIC gboolean filetime_to_nstime(nstime_t *nstime, guint64 filetime);
     FALSE on failure */
 WS_DLL_PUBLIC gboolean nsfiletime_to_nstime(nstime_t *nstime, guint64 nsfiletime);
 
+/** converts a string to nstime, returns TRUE on success, FALSE if the
+    string isn't a valid time; the string is either an absolute local time
+    in the form "YYYY-MM-DD hh:mm:ss[.fraction]" or a count of seconds
+    since the Epoch in the form "[-]seconds[.fraction]" */
+WS_DLL_PUBLIC gboolean nstime_from_str(nstime_t *nstime, const char *str);
+
+/** converts a time range of the form "start,stop", each of which is a
+    time as accepted by nstime_from_str(), to a pair of nstimes, returns
+    TRUE on success, FALSE on failure; either time may be empty, in which
+    case it is set to "unset" */
+WS_DLL_PUBLIC gboolean nstime_range_from_str(nstime_t *start, nstime_t *stop,
+                                             const char *str);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */